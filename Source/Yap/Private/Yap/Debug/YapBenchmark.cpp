@@ -0,0 +1,497 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/Debug/YapBenchmark.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Yap/YapLog.h"
+#include "Yap/YapSubsystem.h"
+#include "Yap/Debug/YapHeadlessWorld.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+// ------------------------------------------------------------------------------------------------
+
+namespace Yap
+{
+	namespace Benchmark
+	{
+	/**
+	 * Forwards to the real allocator, counting allocations made on one thread. Installed as GMalloc only while a scope is measuring, so
+	 * allocations made inside a scope bypass any proxy (e.g. memory trace) wrapped around the real allocator; run benchmarks without those.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		FMalloc* Inner = nullptr;
+
+		uint32 ThreadId = 0;
+
+		int64 Allocations = 0;
+
+		int64 AllocatedBytes = 0;
+
+		void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Record(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Record(Count);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Record(Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Record(Count);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		void Free(void* Original) override { Inner->Free(Original); }
+
+		SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+
+		bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+
+		void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+
+		bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+
+		bool ValidateHeap() override { return Inner->ValidateHeap(); }
+
+		const TCHAR* GetDescriptiveName() override { return TEXT("YapBenchmarkCountingMalloc"); }
+
+	private:
+		void Record(SIZE_T Size)
+		{
+			// Other threads keep allocating while we measure; only the benchmark's own thread is counted
+			if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				++Allocations;
+				AllocatedBytes += Size;
+			}
+		}
+	};
+
+	/** Never destroyed, and keeps forwarding to the real allocator once set: other threads may still be inside it briefly after it is uninstalled. */
+	FCountingMalloc& GetCountingMalloc()
+	{
+		static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+		return *CountingMalloc;
+	}
+
+	struct FScope
+	{
+		FScope(FYapBenchmarkResult& InResult)
+			: Result(InResult)
+		{
+			FCountingMalloc& CountingMalloc = GetCountingMalloc();
+
+			// Scopes don't nest; a previous scope leaves Inner pointing at the allocator it restored
+			check(GMalloc != &CountingMalloc);
+			check(CountingMalloc.Inner == nullptr || CountingMalloc.Inner == GMalloc);
+
+			CountingMalloc.Inner = GMalloc;
+			CountingMalloc.ThreadId = FPlatformTLS::GetCurrentThreadId();
+			CountingMalloc.Allocations = 0;
+			CountingMalloc.AllocatedBytes = 0;
+
+			GMalloc = &CountingMalloc;
+
+			StartSeconds = FPlatformTime::Seconds();
+		}
+
+		~FScope()
+		{
+			Result.TotalSeconds += FPlatformTime::Seconds() - StartSeconds;
+
+			FCountingMalloc& CountingMalloc = GetCountingMalloc();
+
+			GMalloc = CountingMalloc.Inner;
+
+			Result.Allocations += CountingMalloc.Allocations;
+			Result.AllocatedBytes += CountingMalloc.AllocatedBytes;
+
+			// Keep forwarding for stragglers (Inner stays set), but stop counting
+			CountingMalloc.ThreadId = 0;
+			CountingMalloc.Allocations = 0;
+			CountingMalloc.AllocatedBytes = 0;
+		}
+
+		FYapBenchmarkResult& Result;
+		double StartSeconds = 0.0;
+	};
+
+	TArray<FName> MakeNames(const TCHAR* Prefix, int32 Count)
+	{
+		TArray<FName> Names;
+		Names.Reserve(Count);
+
+		for (int32 i = 0; i < Count; ++i)
+		{
+			Names.Add(FName(Prefix, i + 1));
+		}
+
+		return Names;
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapBenchmark::SamplePeaks(UYapSubsystem& Subsystem, FYapBenchmarkResult& Result)
+{
+	Result.PeakSpeechCount = FMath::Max(Result.PeakSpeechCount, Subsystem.ActiveSpeechMap.GetSpeechCount());
+	Result.PeakConversationCount = FMath::Max(Result.PeakConversationCount, Subsystem.ActiveSpeechMap.GetConversationCount());
+	Result.PeakPromptHandleCount = FMath::Max(Result.PeakPromptHandleCount, Subsystem.PromptSets.Num());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapBenchmarkResult FYapBenchmark::RunFreeSpeech(UYapSubsystem& Subsystem, UObject* SpeechOwner, const FYapBenchmarkSettings& Settings, FYapBenchmarkResult& OutCancelResult)
+{
+	FYapBenchmarkResult Result;
+	Result.Name = TEXT("FreeSpeech");
+	Result.Operations = Settings.FreeSpeechCount;
+
+	TArray<FName> Speakers = Yap::Benchmark::MakeNames(TEXT("YapBenchSpeaker"), Settings.FreeSpeechCount);
+
+	TArray<FYapSpeechHandle> Handles;
+	Handles.Reserve(Settings.FreeSpeechCount);
+
+	{
+		Yap::Benchmark::FScope Scope(Result);
+
+		for (const FName& Speaker : Speakers)
+		{
+			FYapData_SpeechBegins Data;
+			Data.SpeakerID = Speaker;
+			Data.SpeechTime = Settings.SpeechTime;
+
+			FYapSpeechHandle Handle = Subsystem.GetNewSpeechHandle(Speaker, SpeechOwner, nullptr);
+			Subsystem.RunSpeech(Data, FYapDialogueNodeClassType(), Handle);
+
+			Handles.Add(Handle);
+		}
+	}
+
+	SamplePeaks(Subsystem, Result);
+
+	OutCancelResult.Name = TEXT("CancelStorm");
+	OutCancelResult.Operations = Handles.Num();
+
+	{
+		Yap::Benchmark::FScope Scope(OutCancelResult);
+
+		for (FYapSpeechHandle& Handle : Handles)
+		{
+			Subsystem.EndSpeech(Handle, EYapSpeechCompleteResult::Cancelled);
+		}
+	}
+
+	SamplePeaks(Subsystem, OutCancelResult);
+
+	return Result;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapBenchmarkResult FYapBenchmark::RunConversations(UYapSubsystem& Subsystem, const FYapBenchmarkSettings& Settings)
+{
+	FYapBenchmarkResult Result;
+	Result.Name = TEXT("QueuedConversations");
+	Result.Operations = Settings.ConversationCount * 2;
+
+	TArray<UObject*> Owners;
+	Owners.Reserve(Settings.ConversationCount);
+
+	for (int32 i = 0; i < Settings.ConversationCount; ++i)
+	{
+		Owners.Add(NewObject<UYapBenchmarkHandler>(&Subsystem));
+	}
+
+	const FName ConversationName("YapBenchConversation");
+
+	{
+		Yap::Benchmark::FScope Scope(Result);
+
+		for (UObject* Owner : Owners)
+		{
+			Subsystem.OpenConversation(ConversationName, Owner);
+		}
+	}
+
+	SamplePeaks(Subsystem, Result);
+
+	{
+		Yap::Benchmark::FScope Scope(Result);
+
+		while (Subsystem.ConversationQueue.Num() > 0)
+		{
+			FYapConversationHandle Handle = Subsystem.GetActiveConversation();
+
+			if (Subsystem.CloseConversation(Handle) == EYapConversationState::Undefined)
+			{
+				break;
+			}
+		}
+	}
+
+	return Result;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapBenchmarkResult FYapBenchmark::RunPrompts(UYapSubsystem& Subsystem, const FYapBenchmarkSettings& Settings)
+{
+	FYapBenchmarkResult Result;
+	Result.Name = TEXT("PromptMenus");
+	Result.Operations = Settings.PromptMenuCount * (Settings.PromptsPerMenu + 1);
+
+	UObject* Owner = NewObject<UYapBenchmarkHandler>(&Subsystem);
+
+	FYapConversationHandle ConversationHandle = Subsystem.OpenConversation(FName("YapBenchPrompts"), Owner).GetHandle();
+
+	TArray<FYapPromptHandle> Menu;
+	Menu.Reserve(Settings.PromptsPerMenu);
+
+	{
+		Yap::Benchmark::FScope Scope(Result);
+
+		for (int32 MenuIndex = 0; MenuIndex < Settings.PromptMenuCount; ++MenuIndex)
+		{
+			Menu.Reset();
+
+			for (int32 PromptIndex = 0; PromptIndex < Settings.PromptsPerMenu; ++PromptIndex)
+			{
+				FYapData_PlayerPromptCreated Data;
+				Data.Conversation = ConversationHandle;
+
+				Menu.Add(Subsystem.BroadcastPrompt(Data, FYapDialogueNodeClassType()));
+			}
+
+			FYapData_PlayerPromptsReady ReadyData;
+			ReadyData.Conversation = ConversationHandle;
+
+			Subsystem.OnFinishedBroadcastingPrompts(ReadyData, FYapDialogueNodeClassType());
+
+			if (Menu.Num() > 0)
+			{
+				UYapSubsystem::RunPrompt(Owner, Menu[0]);
+			}
+		}
+	}
+
+	SamplePeaks(Subsystem, Result);
+
+	Subsystem.CloseConversation(ConversationHandle);
+
+	return Result;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapBenchmarkResult FYapBenchmark::RunAdvanceStorm(UYapSubsystem& Subsystem, UObject* SpeechOwner, const FYapBenchmarkSettings& Settings)
+{
+	FYapBenchmarkResult Result;
+	Result.Name = TEXT("AdvanceStorm");
+	Result.Operations = Settings.AdvanceCount * (Settings.AdvanceSpeechCount + 1);
+
+	UObject* Owner = NewObject<UYapBenchmarkHandler>(&Subsystem);
+
+	const FName ConversationName("YapBenchAdvance");
+
+	FYapConversationHandle ConversationHandle = Subsystem.OpenConversation(ConversationName, Owner).GetHandle();
+
+	TArray<FName> Speakers = Yap::Benchmark::MakeNames(TEXT("YapBenchSpeaker"), Settings.AdvanceSpeechCount);
+
+	{
+		Yap::Benchmark::FScope Scope(Result);
+
+		for (int32 AdvanceIndex = 0; AdvanceIndex < Settings.AdvanceCount; ++AdvanceIndex)
+		{
+			for (const FName& Speaker : Speakers)
+			{
+				FYapData_SpeechBegins Data;
+				Data.Conversation = ConversationName;
+				Data.SpeakerID = Speaker;
+				Data.SpeechTime = Settings.SpeechTime;
+
+				FYapSpeechHandle Handle = Subsystem.GetNewSpeechHandle(Speaker, SpeechOwner, Owner);
+				Subsystem.RunSpeech(Data, FYapDialogueNodeClassType(), Handle);
+			}
+
+			SamplePeaks(Subsystem, Result);
+
+			UYapSubsystem::AdvanceConversation(Owner, ConversationHandle);
+		}
+	}
+
+	Subsystem.CloseConversation(ConversationHandle);
+
+	return Result;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TArray<FYapBenchmarkResult> FYapBenchmark::Run(UWorld* World, const FYapBenchmarkSettings& Settings)
+{
+	TArray<FYapBenchmarkResult> Results;
+
+	UYapSubsystem* Subsystem = UYapSubsystem::Get(World);
+
+	if (!Subsystem)
+	{
+		UE_LOG(LogYap, Error, TEXT("Benchmark could not find the Yap subsystem!"));
+		return Results;
+	}
+
+	UYapBenchmarkHandler* Handler = NewObject<UYapBenchmarkHandler>(World);
+
+	UYapSubsystem::RegisterConversationHandler(Handler, FYapDialogueNodeClassType());
+	UYapSubsystem::RegisterFreeSpeechHandler(Handler, FYapDialogueNodeClassType());
+
+	FYapBenchmarkResult CancelResult;
+
+	Results.Add(RunFreeSpeech(*Subsystem, Handler, Settings, CancelResult));
+	Results.Add(CancelResult);
+	Results.Add(RunConversations(*Subsystem, Settings));
+	Results.Add(RunPrompts(*Subsystem, Settings));
+	Results.Add(RunAdvanceStorm(*Subsystem, Handler, Settings));
+
+	UYapSubsystem::UnregisterConversationHandler(Handler, FYapDialogueNodeClassType());
+	UYapSubsystem::UnregisterFreeSpeechHandler(Handler, FYapDialogueNodeClassType());
+
+	for (const FYapBenchmarkResult& Result : Results)
+	{
+		UE_LOG(LogYap, Display, TEXT("Benchmark %-20s %8d ops %10.3f ms %8.3f us/op %8.2f allocs/op %10lld bytes peaks (speech %d, conversations %d, prompt handles %d)"),
+			*Result.Name, Result.Operations, Result.TotalSeconds * 1000.0, Result.GetMicrosecondsPerOp(), Result.GetAllocationsPerOp(), Result.AllocatedBytes,
+			Result.PeakSpeechCount, Result.PeakConversationCount, Result.PeakPromptHandleCount);
+	}
+
+	return Results;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TArray<FYapBenchmarkResult> FYapBenchmark::RunHeadless(const FYapBenchmarkSettings& Settings)
+{
+	UWorld* World = Yap::Debug::CreateHeadlessWorld(TEXT("YapBenchmarkWorld"));
+
+	TArray<FYapBenchmarkResult> Results = Run(World, Settings);
+
+	Yap::Debug::DestroyHeadlessWorld(World);
+
+	return Results;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapBenchmark::ToJson(const TArray<FYapBenchmarkResult>& Results, const FYapBenchmarkSettings& Settings)
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+
+	TSharedRef<FJsonObject> SettingsObject = MakeShared<FJsonObject>();
+	SettingsObject->SetNumberField(TEXT("FreeSpeechCount"), Settings.FreeSpeechCount);
+	SettingsObject->SetNumberField(TEXT("ConversationCount"), Settings.ConversationCount);
+	SettingsObject->SetNumberField(TEXT("PromptMenuCount"), Settings.PromptMenuCount);
+	SettingsObject->SetNumberField(TEXT("PromptsPerMenu"), Settings.PromptsPerMenu);
+	SettingsObject->SetNumberField(TEXT("AdvanceSpeechCount"), Settings.AdvanceSpeechCount);
+	SettingsObject->SetNumberField(TEXT("AdvanceCount"), Settings.AdvanceCount);
+
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetObjectField(TEXT("Settings"), SettingsObject);
+
+	TArray<TSharedPtr<FJsonValue>> ResultValues;
+
+	for (const FYapBenchmarkResult& Result : Results)
+	{
+		TSharedRef<FJsonObject> ResultObject = MakeShared<FJsonObject>();
+		ResultObject->SetStringField(TEXT("Name"), Result.Name);
+		ResultObject->SetNumberField(TEXT("Operations"), Result.Operations);
+		ResultObject->SetNumberField(TEXT("TotalMs"), Result.TotalSeconds * 1000.0);
+		ResultObject->SetNumberField(TEXT("UsPerOp"), Result.GetMicrosecondsPerOp());
+		ResultObject->SetNumberField(TEXT("Allocations"), static_cast<double>(Result.Allocations));
+		ResultObject->SetNumberField(TEXT("AllocationsPerOp"), Result.GetAllocationsPerOp());
+		ResultObject->SetNumberField(TEXT("AllocatedBytes"), static_cast<double>(Result.AllocatedBytes));
+		ResultObject->SetNumberField(TEXT("PeakSpeechCount"), Result.PeakSpeechCount);
+		ResultObject->SetNumberField(TEXT("PeakConversationCount"), Result.PeakConversationCount);
+		ResultObject->SetNumberField(TEXT("PeakPromptHandleCount"), Result.PeakPromptHandleCount);
+
+		ResultValues.Add(MakeShared<FJsonValueObject>(ResultObject));
+	}
+
+	Root->SetArrayField(TEXT("Results"), ResultValues);
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	FJsonSerializer::Serialize(Root, Writer);
+
+	return Output;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapBenchmark::SaveJson(const FString& Path, const TArray<FYapBenchmarkResult>& Results, const FYapBenchmarkSettings& Settings)
+{
+	if (!FFileHelper::SaveStringToFile(ToJson(Results, Settings), *Path))
+	{
+		UE_LOG(LogYap, Error, TEXT("Failed to write benchmark results to <%s>"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogYap, Display, TEXT("Benchmark results written to <%s>"), *Path);
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapBenchmark::GetDefaultResultsPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Yap") / TEXT("Benchmarks") / (FDateTime::Now().ToString() + TEXT(".json"));
+}
+
+// ================================================================================================
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithArgs YapBenchmarkCommand(
+	TEXT("Yap.Benchmark"),
+	TEXT("Run Yap subsystem stress benchmarks in a headless world and write JSON results. Optional arguments: output path, scale multiplier."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([] (const TArray<FString>& Args)
+	{
+		FYapBenchmarkSettings Settings;
+
+		if (Args.Num() > 1)
+		{
+			const float Scale = FMath::Max(FCString::Atof(*Args[1]), 0.01f);
+
+			Settings.FreeSpeechCount = FMath::Max(1, FMath::RoundToInt(Settings.FreeSpeechCount * Scale));
+			Settings.ConversationCount = FMath::Max(1, FMath::RoundToInt(Settings.ConversationCount * Scale));
+			Settings.PromptMenuCount = FMath::Max(1, FMath::RoundToInt(Settings.PromptMenuCount * Scale));
+			Settings.AdvanceCount = FMath::Max(1, FMath::RoundToInt(Settings.AdvanceCount * Scale));
+		}
+
+		TArray<FYapBenchmarkResult> Results = FYapBenchmark::RunHeadless(Settings);
+
+		FYapBenchmark::SaveJson(Args.Num() > 0 ? Args[0] : FYapBenchmark::GetDefaultResultsPath(), Results, Settings);
+	}));
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,972 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/Debug/YapDialogueSimulator.h"
+
+#include "FlowAsset.h"
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Yap/YapLog.h"
+#include "Yap/YapStreamableManager.h"
+#include "Yap/YapTrace.h"
+#include "Yap/Debug/YapHeadlessWorld.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+// ------------------------------------------------------------------------------------------------
+
+namespace Yap
+{
+	namespace Simulator
+	{
+	struct FFragmentInfo
+	{
+		/** Speech, padding and manual advance time, all in one; the simulation never needs them apart. */
+		float Time = 0.0f;
+
+		int32 ActivationLimit = 0;
+
+		bool bHasConditions = false;
+
+		FName PromptPinName;
+	};
+
+	struct FDialogueInfo
+	{
+		FGuid NodeGuid;
+
+		FString NodeName;
+
+		int32 FirstFragment = 0;
+
+		int32 NumFragments = 0;
+
+		int32 NodeActivationLimit = 0;
+
+		bool bHasConditions = false;
+
+		bool bPrompt = false;
+
+		bool bAutoSelectLastPrompt = false;
+
+		bool bRandomAllowsSelectingSameFragment = false;
+
+		EYapDialogueTalkSequencing Sequencing = EYapDialogueTalkSequencing::RunAll;
+	};
+
+	struct FNodeInfo
+	{
+		/** Index into FSimulation::Dialogues, INDEX_NONE for other flow nodes. */
+		int32 Dialogue = INDEX_NONE;
+
+		/** Connected output pins, as node indices. */
+		TMap<FName, int32> Outputs;
+
+		/** First connected output in pin order, followed by non-dialogue nodes. */
+		int32 PassThrough = INDEX_NONE;
+	};
+
+	/** Everything is flattened into index tables up front, so a playthrough touches no UObjects. */
+	class FSimulation
+	{
+	public:
+		FSimulation(UWorld* World, const UFlowAsset& FlowAsset, const FYapSimulationSettings& InSettings)
+			: Settings(InSettings)
+			, Random(InSettings.Seed)
+			, FlowAssetPath(&FlowAsset)
+		{
+			TMap<const UFlowNode*, int32> NodeIndices;
+			TArray<const UFlowNode*> FlowNodes;
+
+			for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset.GetNodes())
+			{
+				if (IsValid(Pair.Value))
+				{
+					NodeIndices.Add(Pair.Value, Nodes.Num());
+					FlowNodes.Add(Pair.Value);
+					Nodes.AddDefaulted();
+				}
+			}
+
+			for (int32 NodeIndex = 0; NodeIndex < FlowNodes.Num(); ++NodeIndex)
+			{
+				const UFlowNode* FlowNode = FlowNodes[NodeIndex];
+				FNodeInfo& Node = Nodes[NodeIndex];
+
+				for (const FFlowPin& Pin : FlowNode->GetOutputPins())
+				{
+					const UFlowNode* Connected = FlowAsset.GetNode(FlowNode->GetConnection(Pin.PinName).NodeGuid);
+
+					if (const int32* ConnectedIndex = Connected ? NodeIndices.Find(Connected) : nullptr)
+					{
+						Node.Outputs.Add(Pin.PinName, *ConnectedIndex);
+
+						if (Node.PassThrough == INDEX_NONE)
+						{
+							Node.PassThrough = *ConnectedIndex;
+						}
+					}
+				}
+
+				if (const UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(FlowNode))
+				{
+					Node.Dialogue = Dialogues.Num();
+					AddDialogue(World, DialogueNode);
+				}
+			}
+
+			const int32* Entry = NodeIndices.Find(FlowAsset.GetDefaultEntryNode());
+			EntryNode = Entry ? *Entry : INDEX_NONE;
+
+			FragmentActivations.SetNumZeroed(Fragments.Num());
+			FragmentRuns.SetNumZeroed(Fragments.Num());
+			FragmentExhaustions.SetNumZeroed(Fragments.Num());
+			NodeActivations.SetNumZeroed(Dialogues.Num());
+			NodeExhaustions.SetNumZeroed(Dialogues.Num());
+			EmptyPrompts.SetNumZeroed(Dialogues.Num());
+			LastRanFragment.Init(INDEX_NONE, Dialogues.Num());
+		}
+
+		bool HasEntry() const { return EntryNode != INDEX_NONE; }
+
+		const FYapSimulationSettings& GetSettings() const { return Settings; }
+
+		const FSoftObjectPath& GetFlowAssetPath() const { return FlowAssetPath; }
+
+		void ResetSession()
+		{
+			FMemory::Memzero(FragmentActivations.GetData(), FragmentActivations.Num() * sizeof(int32));
+			FMemory::Memzero(NodeActivations.GetData(), NodeActivations.Num() * sizeof(int32));
+
+			for (int32& LastRan : LastRanFragment)
+			{
+				LastRan = INDEX_NONE;
+			}
+		}
+
+		/** Plays the flow once from the entry node. Returns the virtual playtime. */
+		double RunOnce(FString& OutChoices, bool& bOutTruncated)
+		{
+			double Time = 0.0;
+			ScriptCursor = 0;
+			bOutTruncated = false;
+
+			int32 NodeIndex = EntryNode;
+			int32 Steps = 0;
+
+			while (NodeIndex != INDEX_NONE)
+			{
+				if (++Steps > Settings.MaxStepsPerRun)
+				{
+					bOutTruncated = true;
+					break;
+				}
+
+				const FNodeInfo& Node = Nodes[NodeIndex];
+
+				if (Node.Dialogue == INDEX_NONE)
+				{
+					NodeIndex = Node.PassThrough;
+					continue;
+				}
+
+				const FName OutputPin = RunDialogue(Node.Dialogue, Time, OutChoices);
+				const int32* Next = Node.Outputs.Find(OutputPin);
+
+				NodeIndex = Next ? *Next : INDEX_NONE;
+			}
+
+			return Time;
+		}
+
+		void FillReport(FYapSimulationReport& Report) const
+		{
+			for (int32 DialogueIndex = 0; DialogueIndex < Dialogues.Num(); ++DialogueIndex)
+			{
+				const FDialogueInfo& Dialogue = Dialogues[DialogueIndex];
+
+				if (NodeExhaustions[DialogueIndex] > 0)
+				{
+					Report.ExhaustedNodes.Add(MakeRef(Dialogue, 0, NodeExhaustions[DialogueIndex]));
+				}
+
+				if (EmptyPrompts[DialogueIndex] > 0)
+				{
+					Report.EmptyPrompts.Add(MakeRef(Dialogue, 0, EmptyPrompts[DialogueIndex]));
+				}
+
+				for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+				{
+					const int32 Fragment = Dialogue.FirstFragment + i;
+
+					if (FragmentRuns[Fragment] == 0)
+					{
+						Report.UnreachableFragments.Add(MakeRef(Dialogue, i, 0));
+					}
+
+					if (FragmentExhaustions[Fragment] > 0)
+					{
+						Report.ExhaustedFragments.Add(MakeRef(Dialogue, i, FragmentExhaustions[Fragment]));
+					}
+				}
+			}
+		}
+
+
+		/** Symbolic exploration: every condition can go either way and every activation limit can be met, so each node can leave through any output it is able to fire. */
+		void Explore(FYapPathCoverageReport& Report) const
+		{
+			struct FEdge
+			{
+				/** INDEX_NONE where the output is not connected and the flow stops. */
+				int32 Target;
+
+				double Cost;
+			};
+
+			TArray<TArray<FEdge>> Edges;
+			Edges.SetNum(Nodes.Num());
+
+			TArray<bool> ShadowedFragments;
+			ShadowedFragments.SetNumZeroed(Fragments.Num());
+
+			for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+			{
+				const FNodeInfo& Node = Nodes[NodeIndex];
+				TArray<FEdge>& NodeEdges = Edges[NodeIndex];
+
+				if (Node.Dialogue == INDEX_NONE)
+				{
+					for (const TPair<FName, int32>& Output : Node.Outputs)
+					{
+						NodeEdges.Add({ Output.Value, 0.0 });
+					}
+
+					if (NodeEdges.Num() == 0)
+					{
+						NodeEdges.Add({ INDEX_NONE, 0.0 });
+					}
+
+					continue;
+				}
+
+				const FDialogueInfo& Dialogue = Dialogues[Node.Dialogue];
+
+				auto AddOutput = [&Node, &NodeEdges] (FName PinName, double Cost)
+				{
+					const int32* Target = Node.Outputs.Find(PinName);
+					NodeEdges.Add({ Target ? *Target : INDEX_NONE, Cost });
+				};
+
+				bool bAllFragmentsGated = true;
+
+				for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+				{
+					const FFragmentInfo& Fragment = Fragments[Dialogue.FirstFragment + i];
+					bAllFragmentsGated &= Fragment.bHasConditions || Fragment.ActivationLimit > 0;
+				}
+
+				const bool bCanBypass = Dialogue.NumFragments == 0 || Dialogue.bHasConditions || Dialogue.NodeActivationLimit > 0 || bAllFragmentsGated;
+
+				if (Dialogue.bPrompt)
+				{
+					for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+					{
+						const FFragmentInfo& Fragment = Fragments[Dialogue.FirstFragment + i];
+						AddOutput(Fragment.PromptPinName, Fragment.Time + Settings.PromptDecisionTime);
+					}
+				}
+				else if (Dialogue.NumFragments > 0)
+				{
+					double OutCost = 0.0;
+					bool bShadowing = false;
+
+					for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+					{
+						const int32 FragmentIndex = Dialogue.FirstFragment + i;
+						const FFragmentInfo& Fragment = Fragments[FragmentIndex];
+
+						switch (Dialogue.Sequencing)
+						{
+							case EYapDialogueTalkSequencing::RunAll:
+							case EYapDialogueTalkSequencing::RunUntilFailure:
+							{
+								OutCost += Fragment.Time;
+								break;
+							}
+							case EYapDialogueTalkSequencing::SelectOne:
+							{
+								// An ungated fragment always runs, so later fragments never get a turn
+								ShadowedFragments[FragmentIndex] = bShadowing;
+								bShadowing |= !Fragment.bHasConditions && Fragment.ActivationLimit <= 0;
+
+								if (!ShadowedFragments[FragmentIndex])
+								{
+									OutCost = FMath::Max(OutCost, static_cast<double>(Fragment.Time));
+								}
+								break;
+							}
+							default:
+							{
+								OutCost = FMath::Max(OutCost, static_cast<double>(Fragment.Time));
+							}
+						}
+					}
+
+					AddOutput(UFlowNode_YapDialogue::OutputPinName, OutCost);
+				}
+
+				if (bCanBypass)
+				{
+					AddOutput(UFlowNode_YapDialogue::BypassPinName, 0.0);
+				}
+				else if (Node.Outputs.Contains(UFlowNode_YapDialogue::BypassPinName))
+				{
+					Report.DeadBranches.Add({ Dialogue.NodeGuid, Dialogue.NodeName, UFlowNode_YapDialogue::BypassPinName, TEXT("Bypass can never fire: the node and at least one fragment are ungated") });
+				}
+			}
+
+			// Reachability
+			TBitArray<> Reached(false, Nodes.Num());
+			TArray<int32> Frontier = { EntryNode };
+			Reached[EntryNode] = true;
+
+			while (Frontier.Num() > 0)
+			{
+				const int32 NodeIndex = Frontier.Pop(EAllowShrinking::No);
+
+				for (const FEdge& Edge : Edges[NodeIndex])
+				{
+					if (Edge.Target != INDEX_NONE && !Reached[Edge.Target])
+					{
+						Reached[Edge.Target] = true;
+						Frontier.Add(Edge.Target);
+					}
+				}
+			}
+
+			Report.Lines = Fragments.Num();
+
+			for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex)
+			{
+				if (Nodes[NodeIndex].Dialogue == INDEX_NONE)
+				{
+					continue;
+				}
+
+				const FDialogueInfo& Dialogue = Dialogues[Nodes[NodeIndex].Dialogue];
+
+				if (!Reached[NodeIndex])
+				{
+					Report.DeadBranches.Add({ Dialogue.NodeGuid, Dialogue.NodeName, NAME_None, TEXT("Node is unreachable from the entry node") });
+				}
+
+				for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+				{
+					if (Reached[NodeIndex] && !ShadowedFragments[Dialogue.FirstFragment + i])
+					{
+						++Report.ReachableLines;
+					}
+					else
+					{
+						Report.UnreachableFragments.Add(MakeRef(Dialogue, i, 0));
+					}
+				}
+			}
+
+			// Longest path, by depth-first enumeration of simple paths
+			struct FFrame
+			{
+				int32 Node;
+
+				int32 NextEdge;
+
+				double Time;
+			};
+
+			TBitArray<> OnPath(false, Nodes.Num());
+			TArray<FFrame> Stack = { { EntryNode, 0, 0.0 } };
+			OnPath[EntryNode] = true;
+
+			while (Stack.Num() > 0)
+			{
+				FFrame& Frame = Stack.Last();
+
+				if (!Edges[Frame.Node].IsValidIndex(Frame.NextEdge))
+				{
+					OnPath[Frame.Node] = false;
+					Stack.Pop(EAllowShrinking::No);
+					continue;
+				}
+
+				const FEdge& Edge = Edges[Frame.Node][Frame.NextEdge++];
+				const double Time = Frame.Time + Edge.Cost;
+
+				if (Edge.Target == INDEX_NONE || OnPath[Edge.Target])
+				{
+					Report.LongestPathSeconds = FMath::Max(Report.LongestPathSeconds, Time);
+
+					if (++Report.Paths >= Settings.MaxExploredPaths)
+					{
+						Report.bPathLimitReached = true;
+						break;
+					}
+
+					continue;
+				}
+
+				OnPath[Edge.Target] = true;
+				Stack.Add({ Edge.Target, 0, Time });
+			}
+		}
+
+	private:
+		void AddDialogue(UWorld* World, const UFlowNode_YapDialogue* DialogueNode)
+		{
+			const UYapNodeConfig& Config = DialogueNode->GetNodeConfig();
+
+			FDialogueInfo& Dialogue = Dialogues.AddDefaulted_GetRef();
+			Dialogue.NodeGuid = DialogueNode->GetGuid();
+			Dialogue.NodeName = DialogueNode->GetName();
+			Dialogue.FirstFragment = Fragments.Num();
+			Dialogue.NumFragments = DialogueNode->GetNumFragments();
+			Dialogue.NodeActivationLimit = DialogueNode->GetNodeActivationLimit();
+			Dialogue.bHasConditions = DialogueNode->GetNodeConditions().Num() > 0;
+			Dialogue.bPrompt = DialogueNode->IsPlayerPrompt();
+			Dialogue.bAutoSelectLastPrompt = Config.GetAutoSelectLastPrompt();
+			Dialogue.bRandomAllowsSelectingSameFragment = Config.DialoguePlayback.bRandomAllowsSelectingSameFragment;
+			Dialogue.Sequencing = DialogueNode->GetTalkSequencing();
+
+			for (uint8 i = 0; i < Dialogue.NumFragments; ++i)
+			{
+				const FYapFragment& Fragment = DialogueNode->GetFragment(i);
+
+				float SpeechTime;
+				float PaddingTime;
+
+				DialogueNode->GetFragmentTiming(World, i, Settings.MaturitySetting, Settings.bInConversation, SpeechTime, PaddingTime);
+
+				FFragmentInfo& Info = Fragments.AddDefaulted_GetRef();
+				Info.Time = SpeechTime + PaddingTime;
+				Info.ActivationLimit = Fragment.GetActivationLimit();
+				Info.bHasConditions = Fragment.GetConditions().Num() > 0;
+				Info.PromptPinName = Fragment.GetPromptPinName();
+
+				if (!DialogueNode->GetFragmentAutoAdvance(i, Settings.bInConversation))
+				{
+					Info.Time += Settings.ManualAdvanceTime;
+				}
+			}
+		}
+
+		bool PassConditions(bool bHasConditions)
+		{
+			if (!bHasConditions || Settings.Conditions == EYapSimulatedConditions::AssumePass)
+			{
+				return true;
+			}
+
+			return Random.FRand() < Settings.ConditionPassChance;
+		}
+
+		/** Mirrors FYapFragment::CanRun; activation limit first, then conditions. */
+		bool CanRunFragment(int32 Fragment)
+		{
+			const FFragmentInfo& Info = Fragments[Fragment];
+
+			if (Info.ActivationLimit > 0 && FragmentActivations[Fragment] >= Info.ActivationLimit)
+			{
+				++FragmentExhaustions[Fragment];
+				return false;
+			}
+
+			return PassConditions(Info.bHasConditions);
+		}
+
+		void RunFragment(int32 DialogueIndex, int32 LocalIndex, double& Time)
+		{
+			const int32 Fragment = Dialogues[DialogueIndex].FirstFragment + LocalIndex;
+
+			++FragmentActivations[Fragment];
+			++FragmentRuns[Fragment];
+			LastRanFragment[DialogueIndex] = LocalIndex;
+
+			Time += Fragments[Fragment].Time;
+		}
+
+		/** Mirrors UFlowNode_YapDialogue::ExecuteInput through to FinishNode. Returns the output pin the node leaves through. */
+		FName RunDialogue(int32 DialogueIndex, double& Time, FString& Choices)
+		{
+			const FDialogueInfo& Dialogue = Dialogues[DialogueIndex];
+
+			if (!PassConditions(Dialogue.bHasConditions))
+			{
+				return UFlowNode_YapDialogue::BypassPinName;
+			}
+
+			if (Dialogue.NodeActivationLimit > 0 && NodeActivations[DialogueIndex] >= Dialogue.NodeActivationLimit)
+			{
+				++NodeExhaustions[DialogueIndex];
+				return UFlowNode_YapDialogue::BypassPinName;
+			}
+
+			bool bAnyUnderLimit = false;
+
+			for (int32 i = 0; i < Dialogue.NumFragments && !bAnyUnderLimit; ++i)
+			{
+				const int32 Fragment = Dialogue.FirstFragment + i;
+				bAnyUnderLimit = Fragments[Fragment].ActivationLimit <= 0 || FragmentActivations[Fragment] < Fragments[Fragment].ActivationLimit;
+			}
+
+			if (!bAnyUnderLimit)
+			{
+				++NodeExhaustions[DialogueIndex];
+				return UFlowNode_YapDialogue::BypassPinName;
+			}
+
+			return Dialogue.bPrompt ? RunPrompt(DialogueIndex, Time, Choices) : RunTalk(DialogueIndex, Time);
+		}
+
+		FName RunPrompt(int32 DialogueIndex, double& Time, FString& Choices)
+		{
+			const FDialogueInfo& Dialogue = Dialogues[DialogueIndex];
+
+			Options.Reset();
+
+			for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+			{
+				if (CanRunFragment(Dialogue.FirstFragment + i))
+				{
+					Options.Add(i);
+				}
+			}
+
+			if (Options.Num() == 0)
+			{
+				++EmptyPrompts[DialogueIndex];
+				return UFlowNode_YapDialogue::BypassPinName;
+			}
+
+			int32 Chosen = Options[0];
+
+			if (Options.Num() > 1 || !Dialogue.bAutoSelectLastPrompt)
+			{
+				Time += Settings.PromptDecisionTime;
+				Chosen = Options[ChooseOption(Options.Num())];
+			}
+
+			RunFragment(DialogueIndex, Chosen, Time);
+			++NodeActivations[DialogueIndex];
+
+			if (!Choices.IsEmpty())
+			{
+				Choices += TEXT('>');
+			}
+
+			Choices += FString::Printf(TEXT("%s[%i]"), *Dialogue.NodeName, Chosen);
+
+			return Fragments[Dialogue.FirstFragment + Chosen].PromptPinName;
+		}
+
+		int32 ChooseOption(int32 NumOptions)
+		{
+			if (Settings.PromptChoice == EYapSimulatedPromptChoice::Scripted && Settings.ScriptedChoices.IsValidIndex(ScriptCursor))
+			{
+				return FMath::Clamp(Settings.ScriptedChoices[ScriptCursor++], 0, NumOptions - 1);
+			}
+
+			return Random.RandHelper(NumOptions);
+		}
+
+		/** Mirrors TryStartFragments then AdvanceFromFragment for each talk sequencing mode. */
+		FName RunTalk(int32 DialogueIndex, double& Time)
+		{
+			const FDialogueInfo& Dialogue = Dialogues[DialogueIndex];
+
+			bool bStarted = false;
+
+			if (Dialogue.Sequencing == EYapDialogueTalkSequencing::SelectRandom)
+			{
+				const int32 LastRan = LastRanFragment[DialogueIndex];
+
+				Options.Reset();
+
+				for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+				{
+					if (i == LastRan && !Dialogue.bRandomAllowsSelectingSameFragment)
+					{
+						continue;
+					}
+
+					if (CanRunFragment(Dialogue.FirstFragment + i))
+					{
+						Options.Add(i);
+					}
+				}
+
+				if (Options.Num() == 0 && LastRan != INDEX_NONE && CanRunFragment(Dialogue.FirstFragment + LastRan))
+				{
+					Options.Add(LastRan);
+				}
+
+				if (Options.Num() > 0)
+				{
+					RunFragment(DialogueIndex, Options[Random.RandHelper(Options.Num())], Time);
+					bStarted = true;
+				}
+			}
+			else
+			{
+				for (int32 i = 0; i < Dialogue.NumFragments; ++i)
+				{
+					if (!CanRunFragment(Dialogue.FirstFragment + i))
+					{
+						if (bStarted && Dialogue.Sequencing == EYapDialogueTalkSequencing::RunUntilFailure)
+						{
+							break;
+						}
+
+						continue;
+					}
+
+					RunFragment(DialogueIndex, i, Time);
+					bStarted = true;
+
+					if (Dialogue.Sequencing == EYapDialogueTalkSequencing::SelectOne)
+					{
+						break;
+					}
+				}
+			}
+
+			if (!bStarted)
+			{
+				return UFlowNode_YapDialogue::BypassPinName;
+			}
+
+			++NodeActivations[DialogueIndex];
+
+			return UFlowNode_YapDialogue::OutputPinName;
+		}
+
+		FYapSimulatedFragmentRef MakeRef(const FDialogueInfo& Dialogue, int32 FragmentIndex, int32 Count) const
+		{
+			FYapSimulatedFragmentRef Ref;
+			Ref.NodeGuid = Dialogue.NodeGuid;
+			Ref.NodeName = Dialogue.NodeName;
+			Ref.FragmentIndex = FragmentIndex;
+			Ref.Count = Count;
+			return Ref;
+		}
+
+		const FYapSimulationSettings Settings;
+
+		FRandomStream Random;
+
+		FSoftObjectPath FlowAssetPath;
+
+		int32 EntryNode = INDEX_NONE;
+
+		int32 ScriptCursor = 0;
+
+		TArray<FNodeInfo> Nodes;
+
+		TArray<FDialogueInfo> Dialogues;
+
+		TArray<FFragmentInfo> Fragments;
+
+		/** Scratch list of fragment indices, reused for prompt options and random candidates. */
+		TArray<int32> Options;
+
+		// Session state
+		TArray<int32> FragmentActivations;
+
+		TArray<int32> NodeActivations;
+
+		TArray<int32> LastRanFragment;
+
+		// Totals over the whole simulation
+		TArray<int32> FragmentRuns;
+
+		TArray<int32> FragmentExhaustions;
+
+		TArray<int32> NodeExhaustions;
+
+		TArray<int32> EmptyPrompts;
+	};
+
+	TSharedRef<FJsonObject> RefToJson(const FYapSimulatedFragmentRef& Ref, bool bWithFragment)
+	{
+		TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+		Object->SetStringField(TEXT("Node"), Ref.NodeName);
+		Object->SetStringField(TEXT("NodeGuid"), Ref.NodeGuid.ToString());
+
+		if (bWithFragment)
+		{
+			Object->SetNumberField(TEXT("Fragment"), Ref.FragmentIndex);
+		}
+
+		Object->SetNumberField(TEXT("Count"), Ref.Count);
+		return Object;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> RefsToJson(const TArray<FYapSimulatedFragmentRef>& Refs, bool bWithFragment)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+
+		for (const FYapSimulatedFragmentRef& Ref : Refs)
+		{
+			Values.Add(MakeShared<FJsonValueObject>(RefToJson(Ref, bWithFragment)));
+		}
+
+		return Values;
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+class FYapPreparedSimulation : public Yap::Simulator::FSimulation
+{
+public:
+	using FSimulation::FSimulation;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+TSharedPtr<FYapPreparedSimulation> FYapDialogueSimulator::Prepare(UWorld* World, const UFlowAsset* FlowAsset, const FYapSimulationSettings& Settings)
+{
+	YAP_TRACE_SCOPE(FYapDialogueSimulator::Prepare);
+
+	check(IsInGameThread());
+
+	if (!IsValid(FlowAsset))
+	{
+		UE_LOG(LogYap, Error, TEXT("Simulation needs a flow asset!"));
+		return nullptr;
+	}
+
+	TSharedPtr<FYapPreparedSimulation> Prepared = MakeShared<FYapPreparedSimulation>(World, *FlowAsset, Settings);
+
+	if (!Prepared->HasEntry())
+	{
+		UE_LOG(LogYap, Error, TEXT("Simulation could not find an entry node in <%s>"), *FlowAsset->GetPathName());
+		return nullptr;
+	}
+
+	return Prepared;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapSimulationReport FYapDialogueSimulator::Simulate(FYapPreparedSimulation& Prepared)
+{
+	YAP_TRACE_SCOPE(FYapDialogueSimulator::Simulate);
+
+	const FYapSimulationSettings& Settings = Prepared.GetSettings();
+
+	FYapSimulationReport Report;
+	Report.FlowAsset = Prepared.GetFlowAssetPath();
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	TMap<FString, int32> PathIndices;
+
+	FString Choices;
+
+	for (int32 RunIndex = 0; RunIndex < Settings.RunCount; ++RunIndex)
+	{
+		if (Settings.RunsPerSession > 0 && RunIndex % Settings.RunsPerSession == 0)
+		{
+			Prepared.ResetSession();
+		}
+
+		Choices.Reset();
+
+		bool bTruncated;
+		const double Playtime = Prepared.RunOnce(Choices, bTruncated);
+
+		int32& PathIndex = PathIndices.FindOrAdd(Choices, INDEX_NONE);
+
+		if (PathIndex == INDEX_NONE)
+		{
+			PathIndex = Report.Paths.AddDefaulted();
+			Report.Paths[PathIndex].Choices = Choices;
+		}
+
+		FYapSimulatedPath& Path = Report.Paths[PathIndex];
+		++Path.Runs;
+		Path.TotalPlaytime += Playtime;
+		Path.MinPlaytime = FMath::Min(Path.MinPlaytime, Playtime);
+		Path.MaxPlaytime = FMath::Max(Path.MaxPlaytime, Playtime);
+		Path.bTruncated |= bTruncated;
+
+		Report.TotalPlaytime += Playtime;
+		++Report.Runs;
+	}
+
+	Prepared.FillReport(Report);
+
+	Report.Paths.Sort([] (const FYapSimulatedPath& A, const FYapSimulatedPath& B) { return A.Runs > B.Runs; });
+
+	Report.WallSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+	UE_LOG(LogYap, Display, TEXT("Simulated <%s> %d times in %.3f ms (%.0f runs/s): %d paths, %d unreachable fragments, %d exhausted fragments, %d exhausted nodes, %d empty prompts"),
+		*Report.FlowAsset.GetAssetName(), Report.Runs, Report.WallSeconds * 1000.0, Report.GetRunsPerSecond(), Report.Paths.Num(),
+		Report.UnreachableFragments.Num(), Report.ExhaustedFragments.Num(), Report.ExhaustedNodes.Num(), Report.EmptyPrompts.Num());
+
+	return Report;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapPathCoverageReport FYapDialogueSimulator::Explore(const FYapPreparedSimulation& Prepared)
+{
+	YAP_TRACE_SCOPE(FYapDialogueSimulator::Explore);
+
+	FYapPathCoverageReport Report;
+	Report.FlowAsset = Prepared.GetFlowAssetPath();
+
+	Prepared.Explore(Report);
+
+	return Report;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapSimulationReport FYapDialogueSimulator::Run(UWorld* World, const UFlowAsset* FlowAsset, const FYapSimulationSettings& Settings)
+{
+	TSharedPtr<FYapPreparedSimulation> Prepared = Prepare(World, FlowAsset, Settings);
+
+	if (!Prepared)
+	{
+		return FYapSimulationReport();
+	}
+
+	return Simulate(*Prepared);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapSimulationReport FYapDialogueSimulator::RunHeadless(const UFlowAsset* FlowAsset, const FYapSimulationSettings& Settings)
+{
+	UWorld* World = Yap::Debug::CreateHeadlessWorld(TEXT("YapSimulationWorld"));
+
+	FYapSimulationReport Report = Run(World, FlowAsset, Settings);
+
+	Yap::Debug::DestroyHeadlessWorld(World);
+
+	return Report;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapDialogueSimulator::ToJson(const FYapSimulationReport& Report)
+{
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+
+	Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+	Root->SetStringField(TEXT("FlowAsset"), Report.FlowAsset.ToString());
+	Root->SetNumberField(TEXT("Runs"), Report.Runs);
+	Root->SetNumberField(TEXT("WallMs"), Report.WallSeconds * 1000.0);
+	Root->SetNumberField(TEXT("RunsPerSecond"), Report.GetRunsPerSecond());
+	Root->SetNumberField(TEXT("AveragePlaytime"), Report.Runs > 0 ? Report.TotalPlaytime / Report.Runs : 0.0);
+
+	TArray<TSharedPtr<FJsonValue>> PathValues;
+
+	for (const FYapSimulatedPath& Path : Report.Paths)
+	{
+		TSharedRef<FJsonObject> PathObject = MakeShared<FJsonObject>();
+		PathObject->SetStringField(TEXT("Choices"), Path.Choices);
+		PathObject->SetNumberField(TEXT("Runs"), Path.Runs);
+		PathObject->SetNumberField(TEXT("AveragePlaytime"), Path.GetAveragePlaytime());
+		PathObject->SetNumberField(TEXT("MinPlaytime"), Path.MinPlaytime);
+		PathObject->SetNumberField(TEXT("MaxPlaytime"), Path.MaxPlaytime);
+		PathObject->SetBoolField(TEXT("Truncated"), Path.bTruncated);
+
+		PathValues.Add(MakeShared<FJsonValueObject>(PathObject));
+	}
+
+	Root->SetArrayField(TEXT("Paths"), PathValues);
+	Root->SetArrayField(TEXT("UnreachableFragments"), Yap::Simulator::RefsToJson(Report.UnreachableFragments, true));
+	Root->SetArrayField(TEXT("ExhaustedFragments"), Yap::Simulator::RefsToJson(Report.ExhaustedFragments, true));
+	Root->SetArrayField(TEXT("ExhaustedNodes"), Yap::Simulator::RefsToJson(Report.ExhaustedNodes, false));
+	Root->SetArrayField(TEXT("EmptyPrompts"), Yap::Simulator::RefsToJson(Report.EmptyPrompts, false));
+
+	FString Output;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Output);
+	FJsonSerializer::Serialize(Root, Writer);
+
+	return Output;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueSimulator::SaveJson(const FString& Path, const FYapSimulationReport& Report)
+{
+	if (!FFileHelper::SaveStringToFile(ToJson(Report), *Path))
+	{
+		UE_LOG(LogYap, Error, TEXT("Failed to write simulation report to <%s>"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogYap, Display, TEXT("Simulation report written to <%s>"), *Path);
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapDialogueSimulator::GetDefaultReportPath(const UFlowAsset* FlowAsset)
+{
+	const FString AssetName = FlowAsset ? FlowAsset->GetName() : TEXT("Unknown");
+
+	return FPaths::ProjectSavedDir() / TEXT("Yap") / TEXT("Simulations") / (AssetName + TEXT("_") + FDateTime::Now().ToString() + TEXT(".json"));
+}
+
+// ================================================================================================
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithArgs YapSimulateCommand(
+	TEXT("Yap.Simulate"),
+	TEXT("Simulate a flow asset's dialogue in accelerated time and write a JSON report. Arguments: flow asset path, optional run count, seed, output path."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([] (const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			UE_LOG(LogYap, Display, TEXT("Usage: Yap.Simulate <FlowAssetPath> [RunCount] [Seed] [OutputPath]"));
+			return;
+		}
+
+		const UFlowAsset* FlowAsset = Cast<UFlowAsset>(FYapStreamableManager::LoadSynchronous(FSoftObjectPath(Args[0]), "Yap.Simulate", true));
+
+		if (!FlowAsset)
+		{
+			UE_LOG(LogYap, Error, TEXT("Yap.Simulate could not load flow asset <%s>"), *Args[0]);
+			return;
+		}
+
+		FYapSimulationSettings Settings;
+
+		if (Args.Num() > 1)
+		{
+			Settings.RunCount = FMath::Max(1, FCString::Atoi(*Args[1]));
+		}
+
+		if (Args.Num() > 2)
+		{
+			Settings.Seed = FCString::Atoi(*Args[2]);
+		}
+
+		FYapSimulationReport Report = FYapDialogueSimulator::RunHeadless(FlowAsset, Settings);
+
+		FYapDialogueSimulator::SaveJson(Args.Num() > 3 ? Args[3] : FYapDialogueSimulator::GetDefaultReportPath(FlowAsset), Report);
+	}));
+#endif
+
+#undef LOCTEXT_NAMESPACE
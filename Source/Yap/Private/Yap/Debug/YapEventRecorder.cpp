@@ -0,0 +1,396 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/Debug/YapEventRecorder.h"
+
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/Archive.h"
+#include "Yap/YapDataStructures.h"
+#include "Yap/YapLog.h"
+#include "Yap/Handles/YapPromptHandle.h"
+#include "Yap/Handles/YapSpeechHandle.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+const uint32 FYapEventRecorder::FileMagic = 0x52504159; // 'YAPR'
+
+const uint32 FYapEventRecorder::FileVersion = 1;
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::Start(UWorld* InWorld)
+{
+	if (bRecording)
+	{
+		UE_LOG(LogYap, Warning, TEXT("Event recorder was already recording, restarting!"));
+	}
+
+	World = InWorld;
+	Events.Reset();
+	StartTime = IsValid(InWorld) ? InWorld->GetTimeSeconds() : 0.0;
+	bRecording = true;
+
+	UE_LOG(LogYap, Display, TEXT("Event recorder started"));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::Stop(const FString& Path)
+{
+	if (!bRecording)
+	{
+		UE_LOG(LogYap, Warning, TEXT("Event recorder was not recording, ignoring stop request!"));
+		return;
+	}
+
+	bRecording = false;
+
+	UE_LOG(LogYap, Display, TEXT("Event recorder stopped, %d events captured"), Events.Num());
+
+	if (!Path.IsEmpty())
+	{
+		SaveToFile(Path, Events);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapRecordedEvent& FYapEventRecorder::AddEvent(EYapRecordedEventType Type)
+{
+	FYapRecordedEvent& Event = Events.AddDefaulted_GetRef();
+
+	Event.Type = Type;
+	Event.Time = World.IsValid() ? World->GetTimeSeconds() - StartTime : 0.0;
+
+	return Event;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordConversationOpened(const FYapConversationHandle& Handle, FName ConversationName, FName NodeType)
+{
+	FYapRecordedEvent& Event = AddEvent(EYapRecordedEventType::ConversationOpened);
+	Event.Handle = Handle.GetGuid();
+	Event.Conversation = Handle.GetGuid();
+	Event.Name = ConversationName;
+	Event.NodeType = NodeType;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordConversationClosed(const FYapConversationHandle& Handle)
+{
+	FYapRecordedEvent& Event = AddEvent(EYapRecordedEventType::ConversationClosed);
+	Event.Handle = Handle.GetGuid();
+	Event.Conversation = Handle.GetGuid();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordSpeechBegins(const FYapSpeechHandle& Handle, const FYapConversationHandle& Conversation, const FYapData_SpeechBegins& Data, FName NodeType)
+{
+	FYapRecordedEvent& Event = AddEvent(EYapRecordedEventType::SpeechBegins);
+	Event.Handle = Handle.GetGuid();
+	Event.Conversation = Conversation.GetGuid();
+	Event.Name = Data.SpeakerID;
+	Event.NodeType = NodeType;
+	Event.SpeechTime = Data.SpeechTime;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordSpeechEnds(const FYapSpeechHandle& Handle, EYapSpeechCompleteResult Result)
+{
+	// One terminal event per speech; interruptions get their own types so the replay driver can re-issue them
+	EYapRecordedEventType Type = EYapRecordedEventType::SpeechEnds;
+
+	if (Result == EYapSpeechCompleteResult::Advanced)
+	{
+		Type = EYapRecordedEventType::SpeechAdvanced;
+	}
+	else if (Result == EYapSpeechCompleteResult::Cancelled)
+	{
+		Type = EYapRecordedEventType::SpeechCancelled;
+	}
+
+	FYapRecordedEvent& Event = AddEvent(Type);
+	Event.Handle = Handle.GetGuid();
+	Event.Result = static_cast<uint8>(Result);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordPromptCreated(const FYapPromptHandle& Handle, const FYapConversationHandle& Conversation, FName SpeakerID)
+{
+	FYapRecordedEvent& Event = AddEvent(EYapRecordedEventType::PromptCreated);
+	Event.Handle = Handle.GetGuid();
+	Event.Conversation = Conversation.GetGuid();
+	Event.Name = SpeakerID;
+	Event.NodeType = Handle.GetNodeType() ? FName(Handle.GetNodeType()->GetPathName()) : NAME_None;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordPromptChosen(const FYapPromptHandle& Handle)
+{
+	FYapRecordedEvent& Event = AddEvent(EYapRecordedEventType::PromptChosen);
+	Event.Handle = Handle.GetGuid();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::RecordConversationAdvanced(const FYapConversationHandle& Handle)
+{
+	FYapRecordedEvent& Event = AddEvent(EYapRecordedEventType::ConversationAdvanced);
+	Event.Handle = Handle.GetGuid();
+	Event.Conversation = Handle.GetGuid();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapEventRecorder::GetDefaultRecordingPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Yap") / TEXT("Recordings") / (FDateTime::Now().ToString() + TEXT(".yaprec"));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapEventRecorder::SaveToFile(const FString& Path, const TArray<FYapRecordedEvent>& InEvents)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path));
+
+	if (!Writer)
+	{
+		UE_LOG(LogYap, Error, TEXT("Event recorder failed to open file for writing <%s>"), *Path);
+		return false;
+	}
+
+	WriteEvents(*Writer, InEvents);
+
+	bool bSuccess = Writer->Close() && !Writer->IsError();
+
+	UE_LOG(LogYap, Display, TEXT("Event recorder wrote %d events to <%s>"), InEvents.Num(), *Path);
+
+	return bSuccess;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapEventRecorder::LoadFromFile(const FString& Path, TArray<FYapRecordedEvent>& OutEvents)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+
+	if (!Reader)
+	{
+		UE_LOG(LogYap, Error, TEXT("Event recorder failed to open file for reading <%s>"), *Path);
+		return false;
+	}
+
+	SerializeEvents(*Reader, OutEvents);
+
+	return !Reader->IsError();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::SerializeEvents(FArchive& Ar, TArray<FYapRecordedEvent>& InOutEvents)
+{
+	if (Ar.IsSaving())
+	{
+		WriteEvents(Ar, InOutEvents);
+	}
+	else
+	{
+		ReadEvents(Ar, InOutEvents);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapEventRecorder::SerializeHeader(FArchive& Ar)
+{
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+
+	Ar << Magic;
+	Ar << Version;
+
+	if (Ar.IsLoading() && (Magic != FileMagic || Version != FileVersion))
+	{
+		UE_LOG(LogYap, Error, TEXT("Event recorder log has an unknown format (magic %x, version %d)"), Magic, Version);
+		Ar.SetError();
+		return false;
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::WriteEvents(FArchive& Ar, const TArray<FYapRecordedEvent>& InEvents)
+{
+	check(Ar.IsSaving());
+
+	SerializeHeader(Ar);
+
+	// Names and GUIDs repeat heavily (speaker IDs, conversation handles) so they are written once into tables and referenced by packed index. Index 0 is always None/invalid.
+	TArray<FString> NameTable;
+	TArray<FGuid> GuidTable;
+
+	TMap<FName, uint32> NameIndices;
+	TMap<FGuid, uint32> GuidIndices;
+
+	NameTable.Add(FString());
+	GuidTable.Add(FGuid());
+
+	auto AddName = [&NameTable, &NameIndices] (FName Name)
+	{
+		if (!Name.IsNone() && !NameIndices.Contains(Name))
+		{
+			NameIndices.Add(Name, NameTable.Add(Name.ToString()));
+		}
+	};
+
+	auto AddGuid = [&GuidTable, &GuidIndices] (const FGuid& Guid)
+	{
+		if (Guid.IsValid() && !GuidIndices.Contains(Guid))
+		{
+			GuidIndices.Add(Guid, GuidTable.Add(Guid));
+		}
+	};
+
+	for (const FYapRecordedEvent& Event : InEvents)
+	{
+		AddName(Event.Name);
+		AddName(Event.NodeType);
+		AddGuid(Event.Handle);
+		AddGuid(Event.Conversation);
+	}
+
+	Ar << NameTable;
+	Ar << GuidTable;
+
+	int32 Count = InEvents.Num();
+	Ar << Count;
+
+	uint64 PrevMicroseconds = 0;
+
+	for (const FYapRecordedEvent& Event : InEvents)
+	{
+		uint8 Type = static_cast<uint8>(Event.Type);
+		uint64 Microseconds = static_cast<uint64>(FMath::Max(Event.Time, 0.0) * 1000000.0);
+		uint32 Delta = static_cast<uint32>(FMath::Min<uint64>(Microseconds - FMath::Min(Microseconds, PrevMicroseconds), MAX_uint32));
+		uint32 HandleIndex = Event.Handle.IsValid() ? GuidIndices[Event.Handle] : 0;
+		uint32 ConversationIndex = Event.Conversation.IsValid() ? GuidIndices[Event.Conversation] : 0;
+		uint32 NameIndex = Event.Name.IsNone() ? 0 : NameIndices[Event.Name];
+		uint32 NodeTypeIndex = Event.NodeType.IsNone() ? 0 : NameIndices[Event.NodeType];
+
+		PrevMicroseconds = FMath::Max(Microseconds, PrevMicroseconds);
+
+		Ar << Type;
+		Ar.SerializeIntPacked(Delta);
+		Ar.SerializeIntPacked(HandleIndex);
+		Ar.SerializeIntPacked(ConversationIndex);
+		Ar.SerializeIntPacked(NameIndex);
+		Ar.SerializeIntPacked(NodeTypeIndex);
+
+		if (Event.Type == EYapRecordedEventType::SpeechBegins)
+		{
+			float SpeechTime = Event.SpeechTime;
+			Ar << SpeechTime;
+		}
+		else if (Event.Type == EYapRecordedEventType::SpeechEnds)
+		{
+			uint8 Result = Event.Result;
+			Ar << Result;
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapEventRecorder::ReadEvents(FArchive& Ar, TArray<FYapRecordedEvent>& OutEvents)
+{
+	check(Ar.IsLoading());
+
+	if (!SerializeHeader(Ar))
+	{
+		return;
+	}
+
+	TArray<FString> NameTable;
+	TArray<FGuid> GuidTable;
+
+	Ar << NameTable;
+	Ar << GuidTable;
+
+	int32 Count = 0;
+	Ar << Count;
+
+	if (Ar.IsError() || Count < 0 || NameTable.Num() == 0 || GuidTable.Num() == 0)
+	{
+		Ar.SetError();
+		return;
+	}
+
+	TArray<FName> Names;
+	Names.Reserve(NameTable.Num());
+
+	for (const FString& NameString : NameTable)
+	{
+		Names.Add(NameString.IsEmpty() ? NAME_None : FName(*NameString));
+	}
+
+	OutEvents.Reset(Count);
+
+	uint64 Microseconds = 0;
+
+	for (int32 i = 0; i < Count && !Ar.IsError(); ++i)
+	{
+		uint8 Type = 0;
+		uint32 Delta = 0;
+		uint32 HandleIndex = 0;
+		uint32 ConversationIndex = 0;
+		uint32 NameIndex = 0;
+		uint32 NodeTypeIndex = 0;
+
+		Ar << Type;
+		Ar.SerializeIntPacked(Delta);
+		Ar.SerializeIntPacked(HandleIndex);
+		Ar.SerializeIntPacked(ConversationIndex);
+		Ar.SerializeIntPacked(NameIndex);
+		Ar.SerializeIntPacked(NodeTypeIndex);
+
+		if (Type >= static_cast<uint8>(EYapRecordedEventType::MAX)
+			|| !GuidTable.IsValidIndex(HandleIndex) || !GuidTable.IsValidIndex(ConversationIndex)
+			|| !Names.IsValidIndex(NameIndex) || !Names.IsValidIndex(NodeTypeIndex))
+		{
+			UE_LOG(LogYap, Error, TEXT("Event recorder log is corrupt at record %d"), i);
+			Ar.SetError();
+			return;
+		}
+
+		Microseconds += Delta;
+
+		FYapRecordedEvent& Event = OutEvents.AddDefaulted_GetRef();
+		Event.Type = static_cast<EYapRecordedEventType>(Type);
+		Event.Time = Microseconds / 1000000.0;
+		Event.Handle = GuidTable[HandleIndex];
+		Event.Conversation = GuidTable[ConversationIndex];
+		Event.Name = Names[NameIndex];
+		Event.NodeType = Names[NodeTypeIndex];
+
+		if (Event.Type == EYapRecordedEventType::SpeechBegins)
+		{
+			Ar << Event.SpeechTime;
+		}
+		else if (Event.Type == EYapRecordedEventType::SpeechEnds)
+		{
+			Ar << Event.Result;
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,363 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/Debug/YapEventReplayDriver.h"
+
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "TimerManager.h"
+#include "UObject/Package.h"
+#include "Yap/YapLog.h"
+#include "Yap/YapSubsystem.h"
+#include "Yap/Debug/YapHeadlessWorld.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapEventReplayDriver::LoadFromFile(const FString& Path)
+{
+	Events.Reset();
+
+	if (!FYapEventRecorder::LoadFromFile(Path, Events))
+	{
+		return false;
+	}
+
+	UE_LOG(LogYap, Display, TEXT("Replay driver loaded %d events from <%s>"), Events.Num(), *Path);
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapEventReplayDriver::Start(UWorld* InWorld)
+{
+	if (!IsValid(InWorld))
+	{
+		UE_LOG(LogYap, Error, TEXT("Replay driver was started with an invalid world, ignoring!"));
+		return;
+	}
+
+	World = InWorld;
+	NextEventIndex = 0;
+	StartTime = World->GetTimeSeconds();
+
+	ConversationOwners.Empty();
+	ConversationHandles.Empty();
+	PromptHandles.Empty();
+
+	// Conversations don't currently carry a node type, so handlers for the default node type are always needed
+	RegisterForNodeType(NAME_None);
+
+	Pump();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapEventReplayDriver::Stop()
+{
+	for (TSubclassOf<UFlowNode_YapDialogue> NodeType : RegisteredNodeTypes)
+	{
+		UYapSubsystem::UnregisterConversationHandler(this, NodeType);
+		UYapSubsystem::UnregisterFreeSpeechHandler(this, NodeType);
+	}
+
+	RegisteredNodeTypes.Empty();
+	NextEventIndex = Events.Num();
+
+	if (IsValid(World))
+	{
+		World->GetTimerManager().ClearAllTimersForObject(this);
+	}
+
+	if (IsRooted())
+	{
+		RemoveFromRoot();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapEventReplayDriver::Pump()
+{
+	UYapSubsystem* Subsystem = UYapSubsystem::Get(World);
+
+	if (!Subsystem)
+	{
+		UE_LOG(LogYap, Error, TEXT("Replay driver could not find the Yap subsystem, stopping!"));
+		Stop();
+		return;
+	}
+
+	const double Elapsed = World->GetTimeSeconds() - StartTime;
+
+	while (NextEventIndex < Events.Num() && Events[NextEventIndex].Time <= Elapsed)
+	{
+		const FYapRecordedEvent& Event = Events[NextEventIndex];
+
+		++NextEventIndex;
+
+		Dispatch(*Subsystem, Event);
+	}
+
+	if (!IsFinished())
+	{
+		World->GetTimerManager().SetTimerForNextTick(this, &ThisClass::Pump);
+	}
+	else
+	{
+		UE_LOG(LogYap, Display, TEXT("Replay driver finished dispatching %d events"), Events.Num());
+
+		// Remaining speech completes on the subsystem's own timers and doesn't need the driver
+		Stop();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapEventReplayDriver::Dispatch(UYapSubsystem& Subsystem, const FYapRecordedEvent& Event)
+{
+	switch (Event.Type)
+	{
+		case EYapRecordedEventType::ConversationOpened:
+		{
+			RegisterForNodeType(Event.NodeType);
+
+			UObject* Owner = NewObject<UYapReplayConversationOwner>(this, MakeUniqueObjectName(this, UYapReplayConversationOwner::StaticClass(), *Event.Conversation.ToString()));
+			ConversationOwners.Add(Event.Conversation, Owner);
+
+			FYapConversation& Conversation = Subsystem.OpenConversation(Event.Name, Owner);
+			ConversationHandles.Add(Event.Conversation, Conversation.GetHandle());
+			break;
+		}
+		case EYapRecordedEventType::ConversationClosed:
+		{
+			if (FYapConversationHandle* Handle = ConversationHandles.Find(Event.Conversation))
+			{
+				FYapConversationHandle HandleCopy = *Handle;
+				Subsystem.CloseConversation(HandleCopy);
+			}
+			break;
+		}
+		case EYapRecordedEventType::SpeechBegins:
+		{
+			RegisterForNodeType(Event.NodeType);
+
+			UObject* ConversationOwner = Event.Conversation.IsValid() ? ConversationOwners.FindRef(Event.Conversation) : nullptr;
+
+			FYapData_SpeechBegins Data;
+			Data.SpeakerID = Event.Name;
+			Data.SpeechTime = Event.SpeechTime;
+
+			if (const FYapConversation* Conversation = ConversationOwner ? Subsystem.ActiveSpeechMap.FindConversationByOwner(ConversationOwner) : nullptr)
+			{
+				Data.Conversation = Conversation->GetConversationName();
+			}
+
+			FYapSpeechHandle Handle = Subsystem.GetNewSpeechHandle(Event.Handle, Event.Name, this, ConversationOwner);
+			Subsystem.RunSpeech(Data, ResolveNodeType(Event.NodeType), Handle);
+			break;
+		}
+		case EYapRecordedEventType::SpeechEnds:
+		{
+			// Normal completion is driven by the subsystem's own speech timers; interruptions are replayed from their own events
+			break;
+		}
+		case EYapRecordedEventType::PromptCreated:
+		{
+			RegisterForNodeType(Event.NodeType);
+
+			FYapData_PlayerPromptCreated Data;
+			Data.Conversation = ConversationHandles.FindRef(Event.Conversation);
+			Data.SpeakerName = Event.Name;
+
+			PromptHandles.Add(Event.Handle, Subsystem.BroadcastPrompt(Data, ResolveNodeType(Event.NodeType)));
+			break;
+		}
+		case EYapRecordedEventType::PromptChosen:
+		{
+			if (const FYapPromptHandle* Handle = PromptHandles.Find(Event.Handle))
+			{
+				UYapSubsystem::RunPrompt(this, *Handle);
+			}
+			break;
+		}
+		case EYapRecordedEventType::ConversationAdvanced:
+		{
+			if (const FYapConversationHandle* Handle = ConversationHandles.Find(Event.Conversation))
+			{
+				UYapSubsystem::AdvanceConversation(this, *Handle);
+			}
+			break;
+		}
+		case EYapRecordedEventType::SpeechCancelled:
+		case EYapRecordedEventType::SpeechAdvanced:
+		{
+			FYapSpeechHandle Handle(World, Event.Handle);
+
+			// Advancing a conversation ends its running speech itself, and that end was recorded right after the ConversationAdvanced event
+			if (!Subsystem.ActiveSpeechMap.IsSpeechRunning(Handle))
+			{
+				UE_LOG(LogYap, VeryVerbose, TEXT("Replay driver skipped ending speech [%s], it already ended"), *Handle.ToString());
+				break;
+			}
+
+			Subsystem.EndSpeech(Handle, Event.Type == EYapRecordedEventType::SpeechAdvanced ? EYapSpeechCompleteResult::Advanced : EYapSpeechCompleteResult::Cancelled);
+			break;
+		}
+		default:
+		{
+			UE_LOG(LogYap, Warning, TEXT("Replay driver skipped unknown event type %d"), static_cast<int32>(Event.Type));
+			break;
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapEventReplayDriver::RegisterForNodeType(FName NodeTypePath)
+{
+	TSubclassOf<UFlowNode_YapDialogue> NodeType = ResolveNodeType(NodeTypePath);
+
+	if (RegisteredNodeTypes.Contains(NodeType))
+	{
+		return;
+	}
+
+	RegisteredNodeTypes.Add(NodeType);
+
+	UYapSubsystem::RegisterConversationHandler(this, NodeType);
+	UYapSubsystem::RegisterFreeSpeechHandler(this, NodeType);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TSubclassOf<UFlowNode_YapDialogue> UYapEventReplayDriver::ResolveNodeType(FName NodeTypePath) const
+{
+	if (!NodeTypePath.IsNone())
+	{
+		if (UClass* NodeClass = FindObject<UClass>(nullptr, *NodeTypePath.ToString()))
+		{
+			if (NodeClass->IsChildOf(UFlowNode_YapDialogue::StaticClass()))
+			{
+				return NodeClass;
+			}
+		}
+
+		UE_LOG(LogYap, Warning, TEXT("Replay driver could not find node type <%s>, using default dialogue node type"), *NodeTypePath.ToString());
+	}
+
+	return UFlowNode_YapDialogue::StaticClass();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapEventReplayDriver::RunHeadless(const FString& Path, float TickRate, TArray<FYapRecordedEvent>* OutReplayedEvents)
+{
+	UYapEventReplayDriver* Driver = NewObject<UYapEventReplayDriver>(GetTransientPackage());
+
+	if (!Driver->LoadFromFile(Path) || Driver->Events.IsEmpty())
+	{
+		return false;
+	}
+
+	Driver->AddToRoot();
+
+	UWorld* ReplayWorld = Yap::Debug::CreateHeadlessWorld(TEXT("YapReplayWorld"));
+
+	UYapSubsystem* Subsystem = UYapSubsystem::Get(ReplayWorld);
+
+	if (OutReplayedEvents && Subsystem)
+	{
+		Subsystem->GetEventRecorder().Start(ReplayWorld);
+	}
+
+	Driver->Start(ReplayWorld);
+
+	const float DeltaSeconds = 1.0f / FMath::Max(TickRate, 1.0f);
+	const double EndTime = Driver->StartTime + Driver->Events.Last().Time + 2.0 * DeltaSeconds;
+
+	while (!Driver->IsFinished() || ReplayWorld->GetTimeSeconds() < EndTime)
+	{
+		ReplayWorld->Tick(LEVELTICK_All, DeltaSeconds);
+	}
+
+	if (OutReplayedEvents && Subsystem)
+	{
+		Subsystem->GetEventRecorder().Stop();
+		*OutReplayedEvents = Subsystem->GetEventRecorder().GetEvents();
+	}
+
+	Driver->Stop();
+
+	Yap::Debug::DestroyHeadlessWorld(ReplayWorld);
+
+	return true;
+}
+
+// ================================================================================================
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld YapRecorderStartCommand(
+	TEXT("Yap.Recorder.Start"),
+	TEXT("Start recording Yap subsystem events for this world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([] (UWorld* World)
+	{
+		if (UYapSubsystem* Subsystem = UYapSubsystem::Get(World))
+		{
+			Subsystem->GetEventRecorder().Start(World);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs YapRecorderStopCommand(
+	TEXT("Yap.Recorder.Stop"),
+	TEXT("Stop recording Yap subsystem events and write the log. Optional argument: file path (defaults to Saved/Yap/Recordings)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([] (const TArray<FString>& Args, UWorld* World)
+	{
+		if (UYapSubsystem* Subsystem = UYapSubsystem::Get(World))
+		{
+			Subsystem->GetEventRecorder().Stop(Args.Num() > 0 ? Args[0] : FYapEventRecorder::GetDefaultRecordingPath());
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs YapRecorderReplayCommand(
+	TEXT("Yap.Recorder.Replay"),
+	TEXT("Replay a Yap event log into this world. Argument: file path."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([] (const TArray<FString>& Args, UWorld* World)
+	{
+		if (Args.Num() == 0 || !IsValid(World))
+		{
+			UE_LOG(LogYap, Warning, TEXT("Yap.Recorder.Replay requires a file path"));
+			return;
+		}
+
+		UYapEventReplayDriver* Driver = NewObject<UYapEventReplayDriver>(World);
+
+		if (Driver->LoadFromFile(Args[0]))
+		{
+			// Rooted until it has finished; Stop() releases it
+			Driver->AddToRoot();
+			Driver->Start(World);
+		}
+	}));
+
+static FAutoConsoleCommandWithArgs YapRecorderReplayHeadlessCommand(
+	TEXT("Yap.Recorder.ReplayHeadless"),
+	TEXT("Replay a Yap event log into a temporary headless world. Arguments: file path, optional tick rate."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([] (const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			UE_LOG(LogYap, Warning, TEXT("Yap.Recorder.ReplayHeadless requires a file path"));
+			return;
+		}
+
+		float TickRate = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 60.0f;
+
+		UYapEventReplayDriver::RunHeadless(Args[0], TickRate);
+	}));
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,35 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/Debug/YapHeadlessWorld.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+UWorld* Yap::Debug::CreateHeadlessWorld(FName WorldName)
+{
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, WorldName);
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	return World;
+}
+
+void Yap::Debug::DestroyHeadlessWorld(UWorld* World)
+{
+	if (!IsValid(World))
+	{
+		return;
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,577 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/Editor/YapAudioIDAllocator.h"
+
+#if WITH_EDITOR
+
+#include "HAL/FileManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "Yap/YapLog.h"
+#include "Yap/Editor/YapAudioIDFormat.h"
+
+namespace Yap::AudioIDAllocator
+{
+	/** Same character rules as UYapBroker's default node ID: * is a letter, ? is a letter or digit, anything not valid in a file name becomes _ */
+	const TCHAR* Alphas = TEXT("ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+	const TCHAR* AlphaNumerics = TEXT("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+	const TCHAR* ValidLiterals = TEXT("!#$%&()+,-.;=@[]^_`{}~ 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
+
+	/** Registry file line recording the user's range. IDs never contain '/', as it is not a valid ID character. */
+	const TCHAR* RangePrefix = TEXT("//Range=");
+
+	/** First clear bit in [Begin, End), skipping full words. */
+	int64 FindFirstFree(const TBitArray<>& Bits, int64 Begin, int64 End)
+	{
+		const uint32* Words = Bits.GetData();
+
+		for (int64 Index = Begin; Index < End; )
+		{
+			const uint32 Word = Words[Index / NumBitsPerDWORD];
+			const int32 Bit = Index % NumBitsPerDWORD;
+
+			if (Bit == 0 && Word == MAX_uint32)
+			{
+				Index += NumBitsPerDWORD;
+				continue;
+			}
+
+			if ((Word & (1u << Bit)) == 0)
+			{
+				return Index;
+			}
+
+			++Index;
+		}
+
+		return INDEX_NONE;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapAudioIDAllocator::FKeyspace::Encode(int64 Index) const
+{
+	FString ID;
+	ID.GetCharArray().SetNumZeroed(Alphabets.Num() + 1);
+
+	for (int32 i = Alphabets.Num() - 1; i >= 0; --i)
+	{
+		if (Alphabets[i].Num() == 0)
+		{
+			ID[i] = Literals[i];
+			continue;
+		}
+
+		ID[i] = Alphabets[i][Index % Alphabets[i].Num()];
+		Index /= Alphabets[i].Num();
+	}
+
+	return ID;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int64 FYapAudioIDAllocator::FKeyspace::Decode(const FString& ID) const
+{
+	if (ID.Len() != Alphabets.Num())
+	{
+		return INDEX_NONE;
+	}
+
+	int64 Index = 0;
+
+	for (int32 i = 0; i < Alphabets.Num(); ++i)
+	{
+		const TCHAR Char = FChar::ToUpper(ID[i]);
+
+		if (Alphabets[i].Num() == 0)
+		{
+			if (Char != FChar::ToUpper(Literals[i]))
+			{
+				return INDEX_NONE;
+			}
+
+			continue;
+		}
+
+		const int32 Digit = Alphabets[i].Find(Char);
+
+		if (Digit == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		Index = Index * Alphabets[i].Num() + Digit;
+	}
+
+	return Index;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapAudioIDAllocator::FYapAudioIDAllocator()
+{
+	UserName = FPaths::MakeValidFileName(FPlatformProcess::UserName(false));
+
+	if (UserName.IsEmpty())
+	{
+		UserName = TEXT("Default");
+	}
+
+	UPackage::PackageSavedWithContextEvent.AddRaw(this, &FYapAudioIDAllocator::OnPackageSaved);
+
+	FCoreDelegates::OnPreExit.AddRaw(this, &FYapAudioIDAllocator::Flush);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapAudioIDAllocator& FYapAudioIDAllocator::Get()
+{
+	static FYapAudioIDAllocator Allocator;
+	return Allocator;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapAudioIDAllocator::GetRegistryDirectory()
+{
+	return FPaths::ProjectDir() / TEXT("Yap") / TEXT("AudioIDs");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapAudioIDAllocator::Allocate(const FYapAudioIDFormat& Format, const FString& IllegalCharacters, bool bRandom)
+{
+	TArray<FString> IDs;
+	AllocateMany(Format, IllegalCharacters, 1, bRandom, IDs);
+
+	return IDs.Num() > 0 ? IDs[0] : FString();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapAudioIDAllocator::AllocateMany(const FYapAudioIDFormat& Format, const FString& IllegalCharacters, int32 Count, bool bRandom, TArray<FString>& OutIDs)
+{
+	Refresh();
+
+	// Only users who allocate need a range
+	if (bUserRangeStale)
+	{
+		ClaimUserRange();
+		bUserRangeStale = false;
+	}
+
+	FKeyspace& Keyspace = FindOrAddKeyspace(Format, IllegalCharacters);
+
+	TArray<FString> NewIDs;
+	NewIDs.Reserve(Count);
+
+	for (int32 i = 0; i < Count; ++i)
+	{
+		const int64 Index = FindFreeIndex(Keyspace, bRandom);
+
+		if (Index == INDEX_NONE)
+		{
+			UE_LOG(LogYap, Error, TEXT("Every audio ID of the format '%s' is used (%lld); change the Node ID Format to allow more"), *Format.NodeIDFormat, Keyspace.Size);
+			break;
+		}
+
+		FString ID = Keyspace.Encode(Index);
+
+		MarkUsed(ID);
+		NewIDs.Add(MoveTemp(ID));
+	}
+
+	PendingIDs.Append(NewIDs);
+
+	OutIDs.Append(NewIDs);
+
+	return NewIDs.Num();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapAudioIDAllocator::Reserve(const TArray<FString>& IDs)
+{
+	Refresh();
+
+	int32 NumNew = 0;
+
+	for (const FString& ID : IDs)
+	{
+		if (!ID.IsEmpty() && !UsedIDs.Contains(ID))
+		{
+			MarkUsed(ID);
+			PendingIDs.Add(ID);
+			++NumNew;
+		}
+	}
+
+	return NumNew;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapAudioIDAllocator::IsUsed(const FString& ID)
+{
+	Refresh();
+
+	return UsedIDs.Contains(ID);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapAudioIDAllocator::FKeyspace& FYapAudioIDAllocator::FindOrAddKeyspace(const FYapAudioIDFormat& Format, const FString& IllegalCharacters)
+{
+	const FString Key = Format.NodeIDFormat + TEXT("|") + IllegalCharacters.ToUpper();
+
+	if (FKeyspace* Existing = Keyspaces.Find(Key))
+	{
+		return *Existing;
+	}
+
+	FKeyspace& Keyspace = Keyspaces.Add(Key);
+
+	const FString Illegal = IllegalCharacters.ToUpper();
+
+	auto MakeAlphabet = [&Illegal] (const TCHAR* Chars)
+	{
+		TArray<TCHAR> Alphabet;
+
+		for (const TCHAR* Char = Chars; *Char; ++Char)
+		{
+			int32 IllegalIndex;
+
+			if (!Illegal.FindChar(*Char, IllegalIndex))
+			{
+				Alphabet.Add(*Char);
+			}
+		}
+
+		return Alphabet;
+	};
+
+	for (const TCHAR Char : Format.NodeIDFormat)
+	{
+		TArray<TCHAR>& Alphabet = Keyspace.Alphabets.AddDefaulted_GetRef();
+		TCHAR& Literal = Keyspace.Literals.Add_GetRef(Char);
+
+		if (Char == '*')
+		{
+			Alphabet = MakeAlphabet(Yap::AudioIDAllocator::Alphas);
+		}
+		else if (Char == '?')
+		{
+			Alphabet = MakeAlphabet(Yap::AudioIDAllocator::AlphaNumerics);
+		}
+		else if (FCString::Strchr(Yap::AudioIDAllocator::ValidLiterals, Char) == nullptr)
+		{
+			Literal = '_';
+		}
+
+		if (Alphabet.Num() > 0)
+		{
+			// Stop counting once it is too big for a bitmap anyway
+			Keyspace.Size = Keyspace.Size > MaxBitmapSize ? Keyspace.Size : Keyspace.Size * Alphabet.Num();
+		}
+		else if (Char == '*' || Char == '?')
+		{
+			Keyspace.Size = 0;
+		}
+	}
+
+	if (Keyspace.Size > 0 && Keyspace.Size <= MaxBitmapSize)
+	{
+		Keyspace.Used.Init(false, Keyspace.Size);
+
+		for (const FString& ID : UsedIDs)
+		{
+			const int64 Index = Keyspace.Decode(ID);
+
+			if (Index != INDEX_NONE && !Keyspace.Used[Index])
+			{
+				Keyspace.Used[Index] = true;
+				++Keyspace.NumUsed;
+			}
+		}
+	}
+
+	return Keyspace;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int64 FYapAudioIDAllocator::FindFreeIndex(const FKeyspace& Keyspace, bool bRandom) const
+{
+	using namespace Yap::AudioIDAllocator;
+
+	if (Keyspace.Size <= 0)
+	{
+		return INDEX_NONE;
+	}
+
+	const int64 RangeSize = FMath::DivideAndRoundUp(Keyspace.Size, static_cast<int64>(NumUserRanges));
+	const int64 RangeStart = (UserRange * RangeSize) % Keyspace.Size;
+	const int64 RangeEnd = FMath::Min(RangeStart + RangeSize, Keyspace.Size);
+
+	const int64 Start = bRandom ? FMath::RandRange(RangeStart, RangeEnd - 1) : RangeStart;
+
+	if (Keyspace.UsesBitmap())
+	{
+		if (Keyspace.NumUsed >= Keyspace.Size)
+		{
+			return INDEX_NONE;
+		}
+
+		// This user's range first, from the starting point and then wrapping to the start of the range; then anywhere
+		int64 Index = FindFirstFree(Keyspace.Used, Start, RangeEnd);
+
+		if (Index == INDEX_NONE)
+		{
+			Index = FindFirstFree(Keyspace.Used, RangeStart, Start);
+		}
+
+		if (Index == INDEX_NONE)
+		{
+			Index = FindFirstFree(Keyspace.Used, 0, Keyspace.Size);
+		}
+
+		return Index;
+	}
+
+	// Too large to track; with fewer IDs in use than there are bits in a bitmap, nearly every probe is free
+	constexpr int32 MaxProbes = 4096;
+
+	for (int32 Probe = 0; Probe < MaxProbes; ++Probe)
+	{
+		const int64 Index = bRandom ? FMath::RandRange(static_cast<int64>(0), Keyspace.Size - 1) : (Start + Probe) % Keyspace.Size;
+
+		if (!UsedIDs.Contains(Keyspace.Encode(Index)))
+		{
+			return Index;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDAllocator::MarkUsed(const FString& ID)
+{
+	bool bAlreadyUsed = false;
+	UsedIDs.Add(ID, &bAlreadyUsed);
+
+	if (bAlreadyUsed)
+	{
+		return;
+	}
+
+	for (TPair<FString, FKeyspace>& Pair : Keyspaces)
+	{
+		FKeyspace& Keyspace = Pair.Value;
+
+		if (!Keyspace.UsesBitmap())
+		{
+			continue;
+		}
+
+		const int64 Index = Keyspace.Decode(ID);
+
+		if (Index != INDEX_NONE && !Keyspace.Used[Index])
+		{
+			Keyspace.Used[Index] = true;
+			++Keyspace.NumUsed;
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDAllocator::Refresh(bool bForce)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	if (!bForce && LastRefreshTime >= 0.0 && Now - LastRefreshTime < 1.0)
+	{
+		return;
+	}
+
+	LastRefreshTime = Now;
+
+	const FString Directory = GetRegistryDirectory();
+
+	TArray<FString> FileNames;
+	IFileManager::Get().FindFiles(FileNames, *(Directory / TEXT("*.txt")), true, false);
+
+	bool bLoadedAny = false;
+
+	for (const FString& FileName : FileNames)
+	{
+		const FString Path = Directory / FileName;
+		const FDateTime Timestamp = IFileManager::Get().GetTimeStamp(*Path);
+
+		const FDateTime* LastTimestamp = RegistryFileTimestamps.Find(Path);
+
+		if (LastTimestamp && *LastTimestamp == Timestamp)
+		{
+			continue;
+		}
+
+		RegistryFileTimestamps.Add(Path, Timestamp);
+
+		LoadRegistryFile(Path);
+
+		bLoadedAny = true;
+	}
+
+	if (bLoadedAny)
+	{
+		bUserRangeStale = true;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDAllocator::ClaimUserRange()
+{
+	const FString UserFilePath = GetUserFilePath();
+
+	TBitArray<> ClaimedByOthers(false, NumUserRanges);
+	bool bOwnRangeTaken = false;
+
+	const int32* OwnRange = ClaimedRanges.Find(UserFilePath);
+
+	for (const TPair<FString, int32>& Pair : ClaimedRanges)
+	{
+		if (Pair.Key == UserFilePath)
+		{
+			continue;
+		}
+
+		ClaimedByOthers[Pair.Value] = true;
+
+		// Claimed by both of us before either synced; the file which sorts first keeps it
+		if (OwnRange && *OwnRange == Pair.Value && Pair.Key < UserFilePath)
+		{
+			bOwnRangeTaken = true;
+		}
+	}
+
+	if (OwnRange && !bOwnRangeTaken)
+	{
+		UserRange = *OwnRange;
+		return;
+	}
+
+	const int32 FreeRange = ClaimedByOthers.Find(false);
+
+	if (FreeRange == INDEX_NONE)
+	{
+		// More users than ranges; share one, and rely on registries being synced
+		UserRange = GetTypeHash(UserName) % NumUserRanges;
+		UE_LOG(LogYap, Warning, TEXT("Every audio ID range is claimed by another user; sharing range %i. Sync the audio ID registry before adding dialogue nodes."), UserRange);
+		return;
+	}
+
+	const FString Line = Yap::AudioIDAllocator::RangePrefix + FString::FromInt(FreeRange) + LINE_TERMINATOR;
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(UserFilePath), true);
+
+	if (!FFileHelper::SaveStringToFile(Line, *UserFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogYap, Error, TEXT("Failed to record audio ID range in %s; make sure it is writable (checked out)"), *UserFilePath);
+	}
+	else
+	{
+		ClaimedRanges.Add(UserFilePath, FreeRange);
+		RegistryFileTimestamps.Add(UserFilePath, IFileManager::Get().GetTimeStamp(*UserFilePath));
+	}
+
+	UserRange = FreeRange;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDAllocator::LoadRegistryFile(const FString& Path)
+{
+	// IDs are only ever added, so re-reading a changed file only has to add what is new
+	FFileHelper::LoadFileToStringWithLineVisitor(*Path, [this, &Path] (FStringView Line)
+	{
+		Line.TrimStartAndEndInline();
+
+		if (Line.StartsWith(Yap::AudioIDAllocator::RangePrefix))
+		{
+			const int32 Range = FCString::Atoi(*FString(Line.RightChop(FCString::Strlen(Yap::AudioIDAllocator::RangePrefix))));
+
+			if (Range >= 0 && Range < NumUserRanges)
+			{
+				ClaimedRanges.Add(Path, Range);
+			}
+		}
+		else if (!Line.IsEmpty())
+		{
+			MarkUsed(FString(Line));
+		}
+	});
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDAllocator::Flush()
+{
+	if (PendingIDs.Num() == 0)
+	{
+		return;
+	}
+
+	FString Text;
+
+	for (const FString& ID : PendingIDs)
+	{
+		Text += ID;
+		Text += LINE_TERMINATOR;
+	}
+
+	const FString Path = GetUserFilePath();
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+
+	if (!FFileHelper::SaveStringToFile(Text, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogYap, Error, TEXT("Failed to write audio IDs to %s; make sure it is writable (checked out)"), *Path);
+		return;
+	}
+
+	PendingIDs.Empty();
+
+	// Our own additions are already known; don't read them back
+	RegistryFileTimestamps.Add(Path, IFileManager::Get().GetTimeStamp(*Path));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDAllocator::OnPackageSaved(const FString& PackageFileName, UPackage* Package, FObjectPostSaveContext SaveContext)
+{
+	if (SaveContext.IsProceduralSave())
+	{
+		return;
+	}
+
+	Flush();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapAudioIDAllocator::GetUserFilePath() const
+{
+	return GetRegistryDirectory() / (UserName + TEXT(".txt"));
+}
+
+#endif
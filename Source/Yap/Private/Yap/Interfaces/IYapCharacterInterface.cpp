@@ -6,6 +6,8 @@
 #include "GameplayTagContainer.h"
 #include "Yap/YapLog.h"
 #include "Yap/YapProjectSettings.h"
+#include "Yap/YapStreamableManager.h"
+#include "Engine/Texture2D.h"
 
 // ================================================================================================
 // Default C++ implementations, can be overridden by C++ classes
@@ -29,6 +31,13 @@ const UTexture2D* IYapCharacterInterface::GetCharacterPortrait(const FGameplayTa
     return K2_GetYapCharacterPortrait(MoodTag);
 }
 
+// ----------------------------------------------
+
+TSoftObjectPtr<UTexture2D> IYapCharacterInterface::GetCharacterPortraitAsset(const FGameplayTag& MoodTag) const
+{
+    return K2_GetYapCharacterPortraitAsset(MoodTag);
+}
+
 #if WITH_EDITOR
 bool IYapCharacterInterface::IsAsset_YapCharacter(const TSoftObjectPtr<UObject> AssetSoftPtr)
 {
@@ -190,3 +199,58 @@ const UTexture2D* IYapCharacterInterface::GetPortrait(const UObject* Character,
 
     return Texture;
 }
+
+// ----------------------------------------------
+
+TSoftObjectPtr<UTexture2D> IYapCharacterInterface::GetPortraitAsset(const UObject* Character, FGameplayTag MoodTag)
+{
+    if (const UClass* Class = Cast<UClass>(Character))
+    {
+        Character = Class->GetDefaultObject();
+    }
+    
+    TSoftObjectPtr<UTexture2D> Asset;
+    
+    if (IsValid(Character))
+    {        
+        if (const IYapCharacterInterface* Speaker = Cast<IYapCharacterInterface>(Character))
+        {
+            Asset = Speaker->GetCharacterPortraitAsset(MoodTag);
+        }
+        else if (Character->Implements<UYapCharacterInterface>())
+        {
+            Asset = IYapCharacterInterface::Execute_K2_GetYapCharacterPortraitAsset(Character, MoodTag);
+        }
+        else
+        {
+            UE_LOG(LogYap, Error, TEXT("IYapCharacterInterface::GetPortraitAsset failure - Object [%s] did not implement IYapCharacterInterface in C++ or blueprint!"), *Character->GetName());
+        }
+    }
+
+    return Asset;
+}
+
+// ----------------------------------------------
+
+TSharedPtr<FStreamableHandle> IYapCharacterInterface::RequestPortrait(const UObject* Character, FGameplayTag MoodTag, TFunction<void(const UTexture2D*)> OnLoaded)
+{
+    const TSoftObjectPtr<UTexture2D> Asset = GetPortraitAsset(Character, MoodTag);
+
+    // Characters which do not stream their portraits hand them out directly
+    if (Asset.IsNull())
+    {
+        OnLoaded(GetPortrait(Character, MoodTag));
+        return nullptr;
+    }
+
+    if (const UTexture2D* Texture = Asset.Get())
+    {
+        OnLoaded(Texture);
+        return nullptr;
+    }
+
+    return FYapStreamableManager::RequestAsyncLoad(Asset.ToSoftObjectPath(), FStreamableDelegate::CreateLambda([Asset, OnLoaded = MoveTemp(OnLoaded)] ()
+    {
+        OnLoaded(Asset.Get());
+    }));
+}
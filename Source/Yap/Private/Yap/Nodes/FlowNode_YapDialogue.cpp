@@ -2,6 +2,7 @@
 // This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license. 
 
 #include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "FlowAsset.h"
 
 #include "GameplayTagsManager.h"
 #include "GameplayTagsModule.h"
@@ -11,15 +12,21 @@
 #include "Yap/YapCondition.h"
 #include "Yap/YapFragment.h"
 #include "Yap/YapProjectSettings.h"
+#include "Yap/YapSaveState.h"
 #include "Yap/YapSquirrelNoise.h"
+#include "Yap/YapStreamableManager.h"
 #include "Yap/YapSubsystem.h"
+#include "Yap/YapTextFormatCache.h"
+#include "Yap/YapTrace.h"
 #include "Yap/Enums/YapLoadContext.h"
 #include "Engine/World.h"
+#include "Engine/Texture2D.h"
 #include "TimerManager.h"
 #include "Algo/ForEach.h"
 #include "Engine/Blueprint.h"
 #include "Yap/Enums/YapAutoAdvanceFlags.h"
 #include "Yap/Enums/YapInterruptibleFlags.h"
+#include "Yap/Editor/YapAudioIDAllocator.h"
 
 #define LOCTEXT_NAMESPACE "Yap"
 
@@ -53,32 +60,88 @@ UFlowNode_YapDialogue::UFlowNode_YapDialogue()
 
 int16 UFlowNode_YapDialogue::FindFragmentIndex(const FGuid& InFragmentGuid) const
 {
-	for (uint8 i = 0; i < Fragments.Num(); ++i)
+	if (const uint8* Index = FragmentIndicesByGuid.Find(InFragmentGuid))
 	{
-		if (Fragments[i].GetGuid() == InFragmentGuid)
+		// Fragments can be inserted, removed or reordered in the editor; verify the hit before trusting it
+		if (GetFragments().IsValidIndex(*Index) && GetFragments()[*Index].GetGuid() == InFragmentGuid)
 		{
-			return i;
+			return *Index;
 		}
 	}
+	else if (FragmentIndicesByGuid.Num() == GetFragments().Num())
+	{
+		return INDEX_NONE;
+	}
+
+	RebuildFragmentLookup();
 
-	return INDEX_NONE;
+	const uint8* Index = FragmentIndicesByGuid.Find(InFragmentGuid);
+	
+	return Index ? *Index : INDEX_NONE;
 }
 
 // ------------------------------------------------------------------------------------------------
 
-FYapFragment* UFlowNode_YapDialogue::FindTaggedFragment(const FGameplayTag& Tag)
+int16 UFlowNode_YapDialogue::FindFragmentIndex(FName FragmentID) const
 {
-	// TODO replace with new logic using FNames
-	/*
-	for (FYapFragment& Fragment : Fragments)
+	if (FragmentID.IsNone())
 	{
-		if (Fragment.GetFragmentTag() == Tag)
+		return INDEX_NONE;
+	}
+	
+	if (const uint8* Index = FragmentIndicesByID.Find(FragmentID))
+	{
+		if (GetFragments().IsValidIndex(*Index) && GetFragments()[*Index].GetFragmentID() == FragmentID)
 		{
-			return &Fragment;
+			return *Index;
 		}
 	}
-*/
-	return nullptr;
+	else if (FragmentIndicesByGuid.Num() == GetFragments().Num())
+	{
+		return INDEX_NONE;
+	}
+	
+	RebuildFragmentLookup();
+
+	const uint8* Index = FragmentIndicesByID.Find(FragmentID);
+	
+	return Index ? *Index : INDEX_NONE;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UFlowNode_YapDialogue::RebuildFragmentLookup() const
+{
+	FragmentIndicesByGuid.Reset();
+	FragmentIndicesByID.Reset();
+
+	const TArray<FYapFragment>& AllFragments = GetFragments();
+	
+	for (uint8 i = 0; i < AllFragments.Num(); ++i)
+	{
+		FragmentIndicesByGuid.Add(AllFragments[i].GetGuid(), i);
+
+		if (!AllFragments[i].GetFragmentID().IsNone())
+		{
+			FragmentIndicesByID.FindOrAdd(AllFragments[i].GetFragmentID(), i);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FYapFragment* UFlowNode_YapDialogue::FindFragmentByID(FName FragmentID) const
+{
+	int16 Index = FindFragmentIndex(FragmentID);
+
+	return Index != INDEX_NONE ? &GetFragments()[Index] : nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FYapFragment* UFlowNode_YapDialogue::FindTaggedFragment(const FGameplayTag& Tag) const
+{
+	return FindFragmentByID(Tag.GetTagName());
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -100,10 +163,10 @@ void UFlowNode_YapDialogue::OnCancel(UObject* Instigator, FYapSpeechHandle Handl
 		return;
 	}
 
-	FYapFragment& SkippedFragment = Fragments[FocusedFragmentIndex.Get(INDEX_NONE)];
+	FYapFragmentRunState& SkippedFragment = GetFragmentRunStateMutable(FocusedFragmentIndex.Get(INDEX_NONE));
 
 #if !UE_BUILD_SHIPPING
-	if (SkippedFragment.GetIsAwaitingManualAdvance())
+	if (SkippedFragment.bAwaitingManualAdvance)
 	{
 		UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: Manually advancing..."), *GetName(), FocusedFragmentIndex.Get(INDEX_NONE));
 	}
@@ -115,7 +178,7 @@ void UFlowNode_YapDialogue::OnCancel(UObject* Instigator, FYapSpeechHandle Handl
 	
 	for (uint8 i = 0; i <= FocusedFragmentIndex.Get(0); ++i)
 	{
-		GetWorld()->GetTimerManager().ClearTimer(Fragments[i].PaddingTimerHandle);
+		GetWorld()->GetTimerManager().ClearTimer(GetFragmentRunStateMutable(i).PaddingTimerHandle);
 	}
 
 	FragmentsInPadding.Empty();
@@ -143,12 +206,11 @@ void UFlowNode_YapDialogue::OnAdvanceConversation(UObject* Instigator, FYapConve
 	
 	auto RunningFragmentsCopy = RunningFragments;
 
-	bool bForceAdvance = Fragments[FocusedFragmentIndex.GetValue()].IsAwaitingManualAdvance() || !SpeakingFragments.Contains(FocusedSpeechHandle) && FragmentsInPadding.Contains(FocusedSpeechHandle);
+	bool bForceAdvance = GetFragmentRunState(FocusedFragmentIndex.GetValue()).bAwaitingManualAdvance || !SpeakingFragments.Contains(FocusedSpeechHandle) && FragmentsInPadding.Contains(FocusedSpeechHandle);
 	
 	for (auto& [SpeechHandle, Index] : RunningFragmentsCopy)
 	{
-		FYapFragment& Fragment = Fragments[Index];
-		FTimerHandle& PaddingTimerHandle = Fragment.PaddingTimerHandle;
+		FTimerHandle& PaddingTimerHandle = GetFragmentRunStateMutable(Index).PaddingTimerHandle;
 
 		if (PaddingTimerHandle.IsValid())
 		{
@@ -178,6 +240,14 @@ void UFlowNode_YapDialogue::FinishNode(FName OutputPinToTrigger)
 	bNodeActive = false;
 	FocusedFragmentIndex.Reset();
 	FocusedSpeechHandle.Invalidate();
+
+	ReleasePrompts();
+
+	// Whoever displays a portrait holds it from here on
+	for (FYapFragmentRunState& RunState : FragmentRunStates)
+	{
+		RunState.PortraitHandle.Reset();
+	}
 	
 	TriggerOutput(OutputPinToTrigger, true, EFlowPinActivationType::Default);
 }
@@ -219,6 +289,34 @@ float UFlowNode_YapDialogue::GetPadding(uint8 FragmentIndex, EYapMaturitySetting
 
 // ------------------------------------------------------------------------------------------------
 
+void UFlowNode_YapDialogue::GetFragmentTiming(UWorld* World, uint8 FragmentIndex, EYapMaturitySetting MaturitySetting, bool bInConversation, float& OutSpeechTime, float& OutPaddingTime) const
+{
+	const FYapFragment& Fragment = GetFragment(FragmentIndex);
+	const UYapNodeConfig& ActiveConfig = GetNodeConfig();
+
+	OutSpeechTime = Fragment.GetSpeechTime(World, MaturitySetting, ActiveConfig).Get(0.0f);
+	OutPaddingTime = 0.0f;
+
+	if (Fragment.GetUsesPadding(World, MaturitySetting, ActiveConfig))
+	{
+		OutPaddingTime = Fragment.GetProgressionTime(World, MaturitySetting, ActiveConfig);
+		
+		if (GetNodeType() == EYapDialogueNodeType::TalkAndAdvance)
+		{
+			OutSpeechTime = OutPaddingTime;
+			OutPaddingTime = 0.0f;
+		}
+	}
+
+	if (!GetFragmentAutoAdvance(FragmentIndex, bInConversation))
+	{
+		OutSpeechTime = OutPaddingTime;
+		OutPaddingTime = 0.0f;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
 bool UFlowNode_YapDialogue::CanSkip(FYapSpeechHandle Handle) const
 {
 	if (FocusedSpeechHandle != Handle || !Handle.IsValid())
@@ -228,10 +326,10 @@ bool UFlowNode_YapDialogue::CanSkip(FYapSpeechHandle Handle) const
 
 	check(FocusedFragmentIndex.IsSet());
 	
-	const FYapFragment& Fragment = Fragments[FocusedFragmentIndex.GetValue()];
+	const FYapFragmentRunState& RunState = GetFragmentRunState(FocusedFragmentIndex.GetValue());
 	
 	// The fragment is finished running, and this feature is only being used for manual advance
-	if (Fragment.IsAwaitingManualAdvance())
+	if (RunState.bAwaitingManualAdvance)
 	{
 		return true;
 	}
@@ -271,7 +369,7 @@ bool UFlowNode_YapDialogue::CanSkip(FYapSpeechHandle Handle) const
 
 	if (MinTimeElapsedToAllowSkip > 0)
 	{
-		float SpeechTimeElapsed = GetWorld()->GetTimeSeconds() - Fragment.GetStartTime();
+		float SpeechTimeElapsed = GetWorld()->GetTimeSeconds() - RunState.StartTime;
 
 		if ((SpeechTimeElapsed) < MinTimeElapsedToAllowSkip)
 		{
@@ -285,25 +383,98 @@ bool UFlowNode_YapDialogue::CanSkip(FYapSpeechHandle Handle) const
 
 // ------------------------------------------------------------------------------------------------
 
+FText UFlowNode_YapDialogue::FormatText(const FText& Text, const FYapFragment& Fragment) const
+{
+	if (!UYapProjectSettings::GetFormatDialogueTextArguments())
+	{
+		return Text;
+	}
+
+	return FYapTextFormatCache::Get().Format(Text, Fragment.GetSpeakerTag().GetTagName(), Fragment.GetDirectedAtTag().GetTagName(), UYapBroker::Get(this));
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void UFlowNode_YapDialogue::InitializeInstance()
 {
 	Super::InitializeInstance();
 
-	for (FYapFragment& Fragment : Fragments)
+	// Conditions are instanced per node instance (they need this instance's world); everything else about a fragment is immutable at runtime.
+	FragmentRunStates.SetNum(Fragments.Num());
+
+	for (int32 i = 0; i < Fragments.Num(); ++i)
 	{
-		if (Fragment.GetFragmentID().IsValid())
+		FragmentRunStates[i].Conditions = Fragments[i].GetConditionObjects();
+	}
+
+	// Flow duplicates the whole asset for each instance; read fragment content from the template asset's node rather than keeping a full copy per instance
+	UFlowNode_YapDialogue* Template = FindTemplateNode();
+
+	if (Template && Template->Fragments.Num() == Fragments.Num())
+	{
+		TemplateNode = Template;
+		Fragments.Empty();
+		FragmentIndicesByGuid.Empty();
+		FragmentIndicesByID.Empty();
+	}
+	
+	UYapSubsystem* Subsystem = GetWorld()->GetSubsystem<UYapSubsystem>();
+	
+	for (const FYapFragment& Fragment : GetFragments())
+	{
+		if (!Fragment.GetFragmentID().IsNone())
 		{
-			// TODO
-			UYapSubsystem* Subsystem = GetWorld()->GetSubsystem<UYapSubsystem>();
-			//Subsystem->RegisterTaggedFragment(Fragment.GetFragmentTag(), this);
+			Subsystem->RegisterTaggedFragment(Fragment.GetFragmentID(), this);
 		}
 	}
+
+	Subsystem->RegisterDialogueNode(this);
 	
 	TriggerPreload();
 }
 
 // ------------------------------------------------------------------------------------------------
 
+UFlowNode_YapDialogue* UFlowNode_YapDialogue::FindTemplateNode() const
+{
+	const UFlowAsset* FlowAsset = GetFlowAsset();
+	UFlowAsset* TemplateAsset = FlowAsset ? FlowAsset->GetTemplateAsset() : nullptr;
+
+	if (!TemplateAsset || TemplateAsset == FlowAsset)
+	{
+		return nullptr;
+	}
+
+	return Cast<UFlowNode_YapDialogue>(TemplateAsset->GetNode(GetGuid()));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UFlowNode_YapDialogue::DeinitializeInstance()
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UYapSubsystem* Subsystem = World->GetSubsystem<UYapSubsystem>())
+		{
+			for (const FYapFragment& Fragment : GetFragments())
+			{
+				if (!Fragment.GetFragmentID().IsNone())
+				{
+					Subsystem->UnregisterTaggedFragment(Fragment.GetFragmentID(), this);
+				}
+			}
+
+			Subsystem->UnregisterDialogueNode(this);
+		}
+
+		ReleasePrompts();
+	}
+	
+	Super::DeinitializeInstance();
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void UFlowNode_YapDialogue::ExecuteInput(const FName& PinName)
 {
 	if (CanEnterNode())
@@ -312,15 +483,16 @@ void UFlowNode_YapDialogue::ExecuteInput(const FName& PinName)
 
 		FocusedFragmentIndex.Reset();
 		FocusedSpeechHandle.Invalidate();
+
+		// Counted before starting: fragments which finish immediately can run the rest of the graph, and re-enter this node, before the start call returns
+		++NodeActivationCount;
 		
 		bool bStartedSuccessfully = IsPlayerPrompt() ? TryBroadcastPrompts() : TryStartFragments();
 
-		if (bStartedSuccessfully)
-		{			
-			++NodeActivationCount;
-		}
-		else
+		if (!bStartedSuccessfully)
 		{
+			--NodeActivationCount;
+			
 #if !UE_BUILD_SHIPPING
 			if (!Connections.Contains(BypassPinName))
 			{
@@ -374,6 +546,8 @@ bool UFlowNode_YapDialogue::CanEnterNode()
 
 bool UFlowNode_YapDialogue::CheckConditions()
 {
+	YAP_TRACE_SCOPE(UFlowNode_YapDialogue::CheckConditions);
+	
 	for (UYapCondition* Condition : Conditions)
 	{
 		if (!IsValid(Condition))
@@ -419,17 +593,120 @@ const UYapNodeConfig& UFlowNode_YapDialogue::GetNodeConfig() const
 		return *GetDefault<UYapNodeConfig>();
 	}
 
-	// TODO I should probably pin this somehow or make sure it's always loaded by Yap
-	return *ConfigAsset.LoadSynchronous();
+	// Pinned by the subsystem for the whole of play
+	if (const UYapSubsystem* Subsystem = UYapSubsystem::Get(GetWorld()))
+	{
+		if (const UYapNodeConfig* DefaultConfig = Subsystem->GetDefaultNodeConfig())
+		{
+			return *DefaultConfig;
+		}
+	}
+
+	// Editor use, outside of play
+	if (const UYapNodeConfig* DefaultConfig = FYapStreamableManager::LoadSynchronous(ConfigAsset, YAP_SYNC_LOAD_SITE))
+	{
+		return *DefaultConfig;
+	}
+
+	static bool bWarned_DefaultConfigFallback = false;
+
+	if (!bWarned_DefaultConfigFallback)
+	{
+		UE_LOG(LogYap, Error, TEXT("%s: could not load the default node config <%s>, using built-in config values instead!"), *GetName(), *ConfigAsset.ToString());
+		bWarned_DefaultConfigFallback = true;
+	}
+	
+	return *GetDefault<UYapNodeConfig>();
 }
 
 // ------------------------------------------------------------------------------------------------
 
 const FYapFragment& UFlowNode_YapDialogue::GetFragment(uint8 FragmentIndex) const
 {
-	check(Fragments.IsValidIndex(FragmentIndex));
+	check(GetFragments().IsValidIndex(FragmentIndex));
+
+	return GetFragments()[FragmentIndex];
+}
+
+// ------------------------------------------------------------------------------------------------
 
-	return Fragments[FragmentIndex];
+const FYapFragmentRunState& UFlowNode_YapDialogue::GetFragmentRunState(uint8 FragmentIndex) const
+{
+	static const FYapFragmentRunState IdleState;
+	
+	return FragmentRunStates.IsValidIndex(FragmentIndex) ? FragmentRunStates[FragmentIndex] : IdleState;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapFragmentRunState& UFlowNode_YapDialogue::GetFragmentRunStateMutable(uint8 FragmentIndex)
+{
+	// Templates in the editor (and fragments added while running in PIE) get run state on demand
+	if (FragmentIndex >= FragmentRunStates.Num())
+	{
+		int32 OldNum = FragmentRunStates.Num();
+		
+		FragmentRunStates.SetNum(FragmentIndex + 1);
+
+		for (int32 i = OldNum; i < FragmentRunStates.Num(); ++i)
+		{
+			if (GetFragments().IsValidIndex(i))
+			{
+				FragmentRunStates[i].Conditions = GetFragments()[i].GetConditionObjects();
+			}
+		}
+	}
+
+	return FragmentRunStates[FragmentIndex];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapNodeSaveRecord UFlowNode_YapDialogue::MakeSaveRecord() const
+{
+	FYapNodeSaveRecord Record;
+	Record.NodeActivationCount = NodeActivationCount;
+
+	const TArray<FYapFragment>& AllFragments = GetFragments();
+
+	if (AllFragments.IsValidIndex(LastRanFragment))
+	{
+		Record.LastRanFragment = AllFragments[LastRanFragment].GetGuid();
+	}
+
+	for (int32 i = 0; i < FragmentRunStates.Num() && i < AllFragments.Num(); ++i)
+	{
+		if (FragmentRunStates[i].ActivationCount > 0)
+		{
+			Record.FragmentActivationCounts.Add(AllFragments[i].GetGuid(), FragmentRunStates[i].ActivationCount);
+		}
+	}
+
+	return Record;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UFlowNode_YapDialogue::ApplySaveRecord(const FYapNodeSaveRecord& Record)
+{
+	NodeActivationCount = Record.NodeActivationCount;
+
+	LastRanFragment = Record.LastRanFragment.IsValid() ? FindFragmentIndex(Record.LastRanFragment) : INDEX_NONE;
+
+	for (FYapFragmentRunState& RunState : FragmentRunStates)
+	{
+		RunState.ActivationCount = 0;
+	}
+
+	for (const TPair<FGuid, int32>& Pair : Record.FragmentActivationCounts)
+	{
+		int16 FragmentIndex = FindFragmentIndex(Pair.Key);
+
+		if (FragmentIndex != INDEX_NONE)
+		{
+			GetFragmentRunStateMutable(FragmentIndex).ActivationCount = Pair.Value;
+		}
+	}
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -484,14 +761,14 @@ bool UFlowNode_YapDialogue::GetNodeAutoAdvance(bool bInConversation) const
 
 bool UFlowNode_YapDialogue::GetFragmentAutoAdvance(uint8 FragmentIndex, bool bInConversation) const
 {
-	check(Fragments.IsValidIndex(FragmentIndex));
+	check(GetFragments().IsValidIndex(FragmentIndex));
 
 	if (GetNodeType() == EYapDialogueNodeType::TalkAndAdvance)
 	{
 		return true;
 	}
 	
-	const FYapFragment& Fragment = Fragments[FragmentIndex]; 
+	const FYapFragment& Fragment = GetFragments()[FragmentIndex]; 
 	
 	// Use fragment override
 	if (Fragment.GetAutoAdvanceSetting().IsSet())
@@ -533,7 +810,7 @@ void UFlowNode_YapDialogue::InvalidateFragmentTags()
 
 bool UFlowNode_YapDialogue::TryBroadcastPrompts()
 {
-	PromptIndices.Empty(Fragments.Num());
+	ReleasePrompts();
 	
 	UYapSubsystem* Subsystem = GetWorld()->GetSubsystem<UYapSubsystem>();
 
@@ -544,19 +821,41 @@ bool UFlowNode_YapDialogue::TryBroadcastPrompts()
 		UE_LOG(LogYap, Warning, TEXT("Tried to broadcast prompt options but there was no active conversation!"));
 		return false;
 	}
+
+	if (Subsystem->IsFastForwarding(GetFlowAsset()))
+	{
+		if (Subsystem->GetFastForwardTarget() == EYapSkipTarget::End)
+		{
+			// Nobody is there to choose; take the first option the player could have picked
+			for (uint8 i = 0; i < GetNumFragments(); ++i)
+			{
+				if (RunFragment(i))
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		Subsystem->StopFastForward(true);
+	}
 	
 	FYapPromptHandle LastHandle;
+
+	const bool bTimingOnly = UYapProjectSettings::IsTimingOnly(GetWorld());
 	
- 	for (uint8 i = 0; i < Fragments.Num(); ++i)
+ 	for (uint8 i = 0; i < GetNumFragments(); ++i)
 	{
-		FYapFragment& Fragment = Fragments[i];
+		const FYapFragment& Fragment = GetFragment(i);
+		const FYapFragmentRunState& RunState = GetFragmentRunState(i);
 
- 		if (!Fragment.CheckConditions())
+ 		if (!FYapFragment::CheckConditions(RunState.Conditions))
  		{
  			continue;
  		}
  		
-		if (Fragment.IsActivationLimitMet())
+		if (Fragment.IsActivationLimitMet(RunState.ActivationCount))
 		{
 			continue;
 		}
@@ -567,29 +866,38 @@ bool UFlowNode_YapDialogue::TryBroadcastPrompts()
  		FYapData_PlayerPromptCreated Data;
  		Data.Conversation = Conversation->GetHandle();
 
- 		if (ActiveConfig.GetUsesDirectedAt())
+ 		if (ActiveConfig.GetUsesDirectedAt() && !bTimingOnly)
  		{
  			Data.DirectedAt = Fragment.GetDirectedAt(GetWorld(), EYapLoadContext::Sync);
  		}
 
  		if (ActiveConfig.GetUsesSpeaker())
  		{
- 			Data.Speaker = Fragment.GetSpeakerCharacter(GetWorld(), EYapLoadContext::Sync);
+ 			if (!bTimingOnly)
+ 			{
+ 				Data.Speaker = Fragment.GetSpeakerCharacter(GetWorld(), EYapLoadContext::Sync);
+ 			}
+ 			
 	 		Data.SpeakerName = Fragment.GetSpeakerTag().GetTagName();	
  		}
 
  		if (ActiveConfig.GetUsesMoodTags())
  		{
- 			Data.MoodTag = Fragment.GetMoodTag();
+ 			Data.MoodTag = Fragment.GetMoodTag(GetWorld());
  		}
  		
- 		Data.DialogueText = Bit.GetDialogueText();
-
- 		if (ActiveConfig.GetUsesTitleText(GetNodeType()))
+ 		if (!bTimingOnly)
  		{
- 			Data.TitleText = Bit.GetTitleText();
+ 			Data.DialogueText = FormatText(Bit.GetDialogueText(), Fragment);
+
+ 			if (ActiveConfig.GetUsesTitleText(GetNodeType()))
+ 			{
+ 				Data.TitleText = FormatText(Bit.GetTitleText(), Fragment);
+ 			}
  		}
  		
+		PrefetchPortrait(i, Data.Speaker.GetObject());
+		
 		LastHandle = Subsystem->BroadcastPrompt(Data, this->GetClass());
 
  		PromptIndices.Add(LastHandle, i);
@@ -620,7 +928,7 @@ bool UFlowNode_YapDialogue::TryBroadcastPrompts()
 
 void UFlowNode_YapDialogue::RunPrompt(uint8 FragmentIndex)
 {
-	UYapSubsystem::Get(GetWorld())->OnPromptChosen.RemoveDynamic(this, &ThisClass::OnPromptChosen);
+	ReleasePrompts();
 
 	if (!RunFragment(FragmentIndex))
 	{
@@ -630,6 +938,35 @@ void UFlowNode_YapDialogue::RunPrompt(uint8 FragmentIndex)
 
 // ------------------------------------------------------------------------------------------------
 
+void UFlowNode_YapDialogue::ReleasePrompts()
+{
+	UYapSubsystem* Subsystem = UYapSubsystem::Get(GetWorld());
+
+	if (Subsystem)
+	{
+		Subsystem->OnPromptChosen.RemoveDynamic(this, &ThisClass::OnPromptChosen);
+	}
+
+	if (PromptIndices.Num() == 0)
+	{
+		return;
+	}
+
+	// Every handle shares the menu's set, so any one of them releases it
+	if (Subsystem)
+	{
+		for (const TPair<FYapPromptHandle, uint8>& Pair : PromptIndices)
+		{
+			Subsystem->ReleasePromptSet(Pair.Key);
+			break;
+		}
+	}
+
+	PromptIndices.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
 bool UFlowNode_YapDialogue::TryStartFragments()
 {
 	bool bStartedSuccessfully = false;
@@ -638,23 +975,23 @@ bool UFlowNode_YapDialogue::TryStartFragments()
 	{
 		TArray<uint8> ValidFragments;
 
-		ValidFragments.Reserve(Fragments.Num());
+		ValidFragments.Reserve(GetNumFragments());
 
-		for (uint8 i = 0; i < Fragments.Num(); ++i)
+		for (uint8 i = 0; i < GetNumFragments(); ++i)
 		{
 			if (i == LastRanFragment && !GetNodeConfig().DialoguePlayback.bRandomAllowsSelectingSameFragment)
 			{
 				continue;
 			}
 			
-			if (Fragments[i].CanRun())
+			if (GetFragment(i).CanRun(GetFragmentRunState(i)))
 			{
 				ValidFragments.Add(i);
 			}
 		}
 
 		// If we didn't find any valid fragments but we culled out the last ran fragment, put it back in the pool.
-		if (ValidFragments.Num() == 0 && LastRanFragment != INDEX_NONE && Fragments.Num() > LastRanFragment)
+		if (ValidFragments.Num() == 0 && LastRanFragment != INDEX_NONE && GetNumFragments() > LastRanFragment)
 		{
 			ValidFragments.Add(LastRanFragment);
 		}
@@ -679,7 +1016,7 @@ bool UFlowNode_YapDialogue::TryStartFragments()
 	}
 	else
 	{
-		for (uint8 i = 0; i < Fragments.Num(); ++i)
+		for (uint8 i = 0; i < GetNumFragments(); ++i)
 		{
 			bStartedSuccessfully = RunFragment(i);
 
@@ -697,46 +1034,51 @@ bool UFlowNode_YapDialogue::TryStartFragments()
 
 bool UFlowNode_YapDialogue::RunFragment(uint8 FragmentIndex)
 {
+	YAP_TRACE_SCOPE(UFlowNode_YapDialogue::RunFragment);
+	
 	UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: RunFragment START -------------------------------"), *GetName(), FragmentIndex);
 
-	if (!Fragments.IsValidIndex(FragmentIndex))
+	if (!GetFragments().IsValidIndex(FragmentIndex))
 	{
 		UE_LOG(LogYap, Error, TEXT("FAILED - invalid fragment index [%i]"), FragmentIndex);
 		return false;
 	}
 
-	FYapFragment& Fragment = Fragments[FragmentIndex];
+	const FYapFragment& Fragment = GetFragment(FragmentIndex);
+	FYapFragmentRunState& RunState = GetFragmentRunStateMutable(FragmentIndex);
+
+	YAP_TRACE_FRAGMENT_CONTEXT(Fragment.GetGuid());
 
 	// TODO: the select random node needs to check this for all fragments. I should probably chop off the rest of this function into something else and call that from the random mode.
 	if (!FragmentCanRun(FragmentIndex))
 	{
 		UE_LOG(LogYap, VeryVerbose, TEXT("FAILED - FragmentCanRun returned false"));
-		Fragment.SetStartTime(-1.0);
-		Fragment.SetEndTime(-1.0);
+		RunState.StartTime = -1.0;
+		RunState.EndTime = -1.0;
 		return false;
 	}
 
 	LastRanFragment = FragmentIndex;
+
+	UYapSubsystem* Subsystem = GetWorld()->GetSubsystem<UYapSubsystem>();
+
+	if (Subsystem->IsFastForwarding(GetFlowAsset()))
+	{
+		SkipFragment(FragmentIndex);
+		return true;
+	}
 	
-	Fragment.SetRunState(EYapFragmentRunState::Running);
-	Fragment.ClearAwaitingManualAdvance();
+	RunState.RunState = EYapFragmentRunState::Running;
+	RunState.bAwaitingManualAdvance = false;
+
+	// Content below may be sync-loaded; under the Fail sync load policy a refused load stops this speech from running
+	FYapSyncLoadFailureScope SyncLoadFailureScope;
 	
 	const FYapBit& Bit = Fragment.GetBit(GetWorld());
 	const UYapNodeConfig& ActiveConfig = GetNodeConfig();
 
 	EYapMaturitySetting MaturitySetting = UYapBroker::Get(this).GetMaturitySetting();
 	
-	TOptional<float> SpeechTime = Fragment.GetSpeechTime(GetWorld(), MaturitySetting, ActiveConfig);
-
-	float EffectiveTime = 0.0f;
-	
-	if (SpeechTime.IsSet())
-	{
-		EffectiveTime = SpeechTime.GetValue();
-	}
-	
-	UYapSubsystem* Subsystem = GetWorld()->GetSubsystem<UYapSubsystem>();
-	
 	FYapData_SpeechBegins Data;
 
 	if (FYapConversation* Conversation = Subsystem->GetConversationByOwner(GetWorld(), GetFlowAsset()))
@@ -751,24 +1093,13 @@ bool UFlowNode_YapDialogue::RunFragment(uint8 FragmentIndex)
 	
 	bool bInConversation = InConversation != NAME_None;
 
-	float PaddingTime = 0;
+	// Only IDs and timing; nothing here would be shown or played
+	const bool bTimingOnly = UYapProjectSettings::IsTimingOnly(GetWorld());
 
-	if (Fragment.GetUsesPadding(GetWorld(), MaturitySetting, ActiveConfig))
-	{
-		PaddingTime = Fragment.GetProgressionTime(GetWorld(), MaturitySetting, ActiveConfig);
-		
-		if (GetNodeType() == EYapDialogueNodeType::TalkAndAdvance)
-		{
-			EffectiveTime = PaddingTime;
-			PaddingTime = 0;
-		}
-	}
+	float EffectiveTime;
+	float PaddingTime;
 
-	if (!GetFragmentAutoAdvance(FragmentIndex, bInConversation))
-	{
-		EffectiveTime = PaddingTime;
-		PaddingTime = 0;
-	}
+	GetFragmentTiming(GetWorld(), FragmentIndex, MaturitySetting, bInConversation, EffectiveTime, PaddingTime);
 	
 	if (ActiveConfig.GetUsesDirectedAt())
 	{
@@ -777,28 +1108,42 @@ bool UFlowNode_YapDialogue::RunFragment(uint8 FragmentIndex)
 
 	if (ActiveConfig.GetUsesSpeaker())
 	{
-		Data.Speaker = Fragment.GetSpeakerCharacter(GetWorld(), EYapLoadContext::Sync);
+		if (!bTimingOnly)
+		{
+			Data.Speaker = Fragment.GetSpeakerCharacter(GetWorld(), EYapLoadContext::Sync);
+		}
+		
 		Data.SpeakerID = Fragment.GetSpeakerTag().GetTagName();
 	}
 
 	if (ActiveConfig.GetUsesMoodTags())
 	{
-		Data.MoodTag = Fragment.GetMoodTag();
+		Data.MoodTag = Fragment.GetMoodTag(GetWorld());
 	}
 	
-	Data.DialogueText = Bit.GetDialogueText();
 	Data.SpeechTime = EffectiveTime;
+	Data.bSkippable = Fragment.GetInterruptible(GetInterruptible(bInConversation), bInConversation);
 
-	if (ActiveConfig.GetUsesAudioAsset())
+	if (!bTimingOnly)
 	{
-		Data.DialogueAudioAsset = Bit.GetAudioAsset<UObject>();		
+		Data.DialogueText = FormatText(Bit.GetDialogueText(), Fragment);
+
+		if (ActiveConfig.GetUsesAudioAsset())
+		{
+			Data.DialogueAudioAsset = Bit.GetAudioAsset<UObject>();		
+		}
+
+		if (!ActiveConfig.GetUsesTitleText(GetNodeType()))
+		{
+			Data.TitleText = FormatText(Bit.GetTitleText(), Fragment);
+		}
 	}
-	
-	Data.bSkippable = Fragment.GetInterruptible(GetInterruptible(bInConversation), bInConversation);
 
-	if (!ActiveConfig.GetUsesTitleText(GetNodeType()))
+	PrefetchPortrait(FragmentIndex, Data.Speaker.GetObject());
+
+	if (!IsPlayerPrompt() && (TalkSequencing == EYapDialogueTalkSequencing::RunAll || TalkSequencing == EYapDialogueTalkSequencing::RunUntilFailure))
 	{
-		Data.TitleText = Bit.GetTitleText();
+		PrefetchPortrait(FragmentIndex + 1);
 	}
 
 #if !UE_BUILD_SHIPPING
@@ -813,16 +1158,27 @@ bool UFlowNode_YapDialogue::RunFragment(uint8 FragmentIndex)
 		UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: [No Speaker] %s"), *GetName(), FragmentIndex, *Bit.GetDialogueText().ToString());		
 	}
 #endif
+
+	if (SyncLoadFailureScope.HasFailed())
+	{
+		UE_LOG(LogYap, Error, TEXT("%s [%i]: RunFragment FAILED - content was not loaded in time (sync load policy is Fail)"), *GetName(), FragmentIndex);
+		RunState.RunState = EYapFragmentRunState::Idle;
+		RunState.StartTime = -1.0;
+		RunState.EndTime = -1.0;
+		return false;
+	}
 	
 	// Make a handle for the pending speech and bind to completion events of it
 	FocusedSpeechHandle = Subsystem->GetNewSpeechHandle(Fragment.GetGuid(), Data.SpeakerID, Data.Speaker.GetObject(), bInConversation ? GetFlowAsset() : nullptr);
 	FocusedFragmentIndex = FragmentIndex;
 
+	Yap::Trace::FragmentBegin(Fragment.GetGuid(), FocusedSpeechHandle, this);
+
 	AddRunningFragment(FocusedSpeechHandle, FragmentIndex);
 	SpeakingFragments.Add(FocusedSpeechHandle);
 
-	Fragment.SetStartTime(GetWorld()->GetTimeSeconds());
-	Fragment.IncrementActivations();
+	RunState.StartTime = GetWorld()->GetTimeSeconds();
+	RunState.ActivationCount++;
 	
 	Subsystem->RunSpeech(Data, GetClass(), FocusedSpeechHandle);
 
@@ -840,7 +1196,7 @@ bool UFlowNode_YapDialogue::RunFragment(uint8 FragmentIndex)
 	
 	if (PaddingTime > 0)
 	{
-		GetWorld()->GetTimerManager().SetTimer(Fragment.PaddingTimerHandle, FTimerDelegate::CreateUObject(this, &ThisClass::OnPaddingComplete, FocusedSpeechHandle), PaddingTime, false);
+		GetWorld()->GetTimerManager().SetTimer(RunState.PaddingTimerHandle, FTimerDelegate::CreateUObject(this, &ThisClass::OnPaddingComplete, FocusedSpeechHandle), PaddingTime, false);
 		FragmentsInPadding.Add(FocusedSpeechHandle);	
 	}
 	
@@ -879,6 +1235,66 @@ void UFlowNode_YapDialogue::RemoveRunningFragment(const FYapSpeechHandle& Handle
 
 // ------------------------------------------------------------------------------------------------
 
+void UFlowNode_YapDialogue::PrefetchPortrait(uint8 FragmentIndex, const UObject* Speaker)
+{
+	if (!GetFragments().IsValidIndex(FragmentIndex) || !GetNodeConfig().GetUsesSpeaker() || UYapProjectSettings::IsTimingOnly(GetWorld()))
+	{
+		return;
+	}
+
+	FYapFragmentRunState& RunState = GetFragmentRunStateMutable(FragmentIndex);
+
+	if (RunState.PortraitHandle.IsValid())
+	{
+		return;
+	}
+
+	if (!Speaker && RunState.SpeakerHandle.IsValid() && RunState.SpeakerHandle->HasLoadCompleted())
+	{
+		Speaker = RunState.SpeakerHandle->GetLoadedAsset();
+	}
+
+	if (!IsValid(Speaker))
+	{
+		return;
+	}
+
+	const FGameplayTag MoodTag = GetNodeConfig().GetUsesMoodTags() ? GetFragment(FragmentIndex).GetMoodTag(GetWorld()) : FGameplayTag::EmptyTag;
+	const TSoftObjectPtr<UTexture2D> Portrait = IYapCharacterInterface::GetPortraitAsset(Speaker, MoodTag);
+
+	if (!Portrait.IsNull())
+	{
+		RunState.PortraitHandle = FYapStreamableManager::RequestAsyncLoad(Portrait.ToSoftObjectPath());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UFlowNode_YapDialogue::SkipFragment(uint8 FragmentIndex)
+{
+	UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: SkipFragment"), *GetName(), FragmentIndex);
+
+	FYapFragmentRunState& RunState = GetFragmentRunStateMutable(FragmentIndex);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	
+	RunState.StartTime = Now;
+	RunState.EndTime = Now;
+	RunState.ActivationCount++;
+	RunState.bAwaitingManualAdvance = false;
+
+	FocusedSpeechHandle.Invalidate();
+	FocusedFragmentIndex = FragmentIndex;
+
+	TriggerSpeechStartPin(FragmentIndex);
+	TriggerSpeechEndPin(FragmentIndex);
+
+	// The subsystem advances from this fragment once the call stack has unwound (see SkipConversation)
+	UYapSubsystem::Get(this)->RecordFastForwardFragment(this, FragmentIndex, IsPlayerPrompt());
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void UFlowNode_YapDialogue::BindToSubsystemSpeechCompleteEvent(const FYapSpeechHandle& Handle)
 {
 	UE_LOG(LogYap, VeryVerbose, TEXT("%s: Binding to Speech Completed Events {%s}"), *GetName(), *Handle.ToString());
@@ -915,8 +1331,6 @@ void UFlowNode_YapDialogue::OnSpeechComplete(UObject* Instigator, FYapSpeechHand
 	
 	UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: OnSpeechComplete {%s}"), *GetName(), *FragmentIndex, *Handle.ToString());
 
-	FYapFragment& Fragment = Fragments[*FragmentIndex];
-	
 	SpeakingFragments.Remove(Handle);
 
 	TriggerSpeechEndPin(*FragmentIndex);
@@ -973,9 +1387,10 @@ void UFlowNode_YapDialogue::FinishFragment(const FYapSpeechHandle& Handle, uint8
 {
 	UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: FinishFragment {%s}"), *GetName(), FragmentIndex, *Handle.ToString());
 		
-	FYapFragment& Fragment = Fragments[FragmentIndex];
+	FYapFragmentRunState& RunState = GetFragmentRunStateMutable(FragmentIndex);
 	
-	Fragment.SetEndTime(GetWorld()->GetTimeSeconds());
+	RunState.EndTime = GetWorld()->GetTimeSeconds();
+	RunState.PortraitHandle.Reset();
 
 	RemoveRunningFragment(Handle, FragmentIndex);
 }
@@ -990,8 +1405,6 @@ void UFlowNode_YapDialogue::TryAdvanceFromFragment(const FYapSpeechHandle& Handl
 		return;
 	}
 	
-	FYapFragment& Fragment = Fragments[FragmentIndex];
-
 	bool bInConversation = UYapSubsystem::IsNodeInConversation(this);
 	
 	// TODO When calling AdvanceFromFragment in Skip function, if the game is set to do manual advancement, this won't run. Push this into a separate function I can call or add another route into this.
@@ -1015,7 +1428,7 @@ void UFlowNode_YapDialogue::TryAdvanceFromFragment(const FYapSpeechHandle& Handl
 		{
 		*/
 			UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: TryAdvanceFromFragment failed - fragment awaiting manual advance"), *GetName(), FragmentIndex);
-			Fragment.SetAwaitingManualAdvance();
+			GetFragmentRunStateMutable(FragmentIndex).bAwaitingManualAdvance = true;
 		/*
 		}
 		*/
@@ -1026,16 +1439,17 @@ void UFlowNode_YapDialogue::AdvanceFromFragment(const FYapSpeechHandle& Handle,
 {
 	UE_LOG(LogYap, VeryVerbose, TEXT("%s [%i]: AdvanceFromFragment"), *GetName(), FragmentIndex);
 	
-	FYapFragment& Fragment = Fragments[FragmentIndex];
+	const FYapFragment& Fragment = GetFragment(FragmentIndex);
+	FYapFragmentRunState& RunState = GetFragmentRunStateMutable(FragmentIndex);
 	
-	Fragment.SetRunState(EYapFragmentRunState::Idle);
+	RunState.RunState = EYapFragmentRunState::Idle;
 	
 	if (FragmentIndex != FocusedFragmentIndex)
 	{
 		return;
 	}
 	
-	Fragment.ClearAwaitingManualAdvance();
+	RunState.bAwaitingManualAdvance = false;
 	
 	UYapSubsystem::Get(this)->OnAdvanceConversationDelegate.RemoveDynamic(this, &ThisClass::OnAdvanceConversation);
 
@@ -1055,7 +1469,7 @@ void UFlowNode_YapDialogue::AdvanceFromFragment(const FYapSpeechHandle& Handle,
 			}
 			case EYapDialogueTalkSequencing::RunAll:
 			{
-				for (uint8 NextIndex = FragmentIndex + 1; NextIndex < Fragments.Num(); ++NextIndex)
+				for (uint8 NextIndex = FragmentIndex + 1; NextIndex < GetNumFragments(); ++NextIndex)
 				{
 					if (RunFragment(NextIndex))
 					{
@@ -1070,14 +1484,12 @@ void UFlowNode_YapDialogue::AdvanceFromFragment(const FYapSpeechHandle& Handle,
 			}
 			case EYapDialogueTalkSequencing::RunUntilFailure:
 			{
-				for (uint8 NextIndex = FragmentIndex + 1; NextIndex < Fragments.Num(); ++NextIndex)
+				const uint8 NextIndex = FragmentIndex + 1;
+
+				if (NextIndex < GetNumFragments() && RunFragment(NextIndex))
 				{
-					if (!RunFragment(NextIndex))
-					{					
-						FinishNode(OutputPinName);
-						
-						return;
-					}
+					// The next fragment will continue execution
+					return;
 				}
 				
 				FinishNode(OutputPinName);
@@ -1102,7 +1514,7 @@ void UFlowNode_YapDialogue::AdvanceFromFragment(const FYapSpeechHandle& Handle,
 
 void UFlowNode_YapDialogue::TriggerSpeechStartPin(uint8 FragmentIndex)
 {
-	FYapFragment& Fragment = Fragments[FragmentIndex];
+	const FYapFragment& Fragment = GetFragment(FragmentIndex);
 	
 	if (Fragment.UsesStartPin())
 	{
@@ -1115,7 +1527,7 @@ void UFlowNode_YapDialogue::TriggerSpeechStartPin(uint8 FragmentIndex)
 
 void UFlowNode_YapDialogue::TriggerSpeechEndPin(uint8 FragmentIndex)
 {
-	FYapFragment& Fragment = Fragments[FragmentIndex];
+	const FYapFragment& Fragment = GetFragment(FragmentIndex);
 	
 	if (Fragment.UsesEndPin())
 	{
@@ -1141,7 +1553,7 @@ bool UFlowNode_YapDialogue::IsBypassPinRequired() const
 	}
 	
 	// If all of the fragments have conditions, we will need a bypass node in case all fragments are unusable
-	for (const FYapFragment& Fragment : Fragments)
+	for (const FYapFragment& Fragment : GetFragments())
 	{
 		if (Fragment.GetConditions().Num() == 0 && Fragment.GetActivationLimit() == 0)
 		{
@@ -1217,33 +1629,22 @@ bool UFlowNode_YapDialogue::IsOutputConnectedToPromptNode() const
 
 bool UFlowNode_YapDialogue::FragmentCanRun(uint8 FragmentIndex)
 {
-	const FYapFragment& Fragment = GetFragmentByIndex(FragmentIndex);
-	
-	if (!Fragment.CheckConditions())
-	{
-		return false;
-	}
-	
-	if (Fragment.IsActivationLimitMet())
-	{
-		return false;
-	}
-
-	return true;
+	return GetFragmentByIndex(FragmentIndex).CanRun(GetFragmentRunState(FragmentIndex));
 }
 
 // ------------------------------------------------------------------------------------------------
 
 const FYapFragment& UFlowNode_YapDialogue::GetFragmentByIndex(uint8 Index) const
 {
-	check(Fragments.IsValidIndex(Index));
+	check(GetFragments().IsValidIndex(Index));
 
-	return Fragments[Index];
+	return GetFragments()[Index];
 }
 
 #if WITH_EDITOR
 FYapFragment& UFlowNode_YapDialogue::GetFragmentMutableByIndex(uint8 Index)
 {
+	ensureMsgf(!TemplateNode, TEXT("Running instances share their template's fragments; edit the template node instead"));
 	check(Fragments.IsValidIndex(Index));
 
 	return Fragments[Index];
@@ -1269,9 +1670,7 @@ void UFlowNode_YapDialogue::OnPromptChosen(UObject* Instigator, FYapPromptHandle
 #if WITH_EDITOR
 FYapFragment& UFlowNode_YapDialogue::GetFragmentByIndexMutable(uint8 Index)
 {
-	check (Fragments.IsValidIndex(Index))
-
-	return Fragments[Index];
+	return GetFragmentMutableByIndex(Index);
 }
 #endif
 
@@ -1280,6 +1679,9 @@ FYapFragment& UFlowNode_YapDialogue::GetFragmentByIndexMutable(uint8 Index)
 #if WITH_EDITOR
 TArray<FYapFragment>& UFlowNode_YapDialogue::GetFragmentsMutable()
 {
+	// Instances hold no fragments of their own, so nothing written through this can reach the template asset
+	ensureMsgf(!TemplateNode, TEXT("Running instances share their template's fragments; edit the template node instead"));
+
 	return Fragments;
 }
 #endif
@@ -1367,9 +1769,9 @@ TArray<FFlowPin> UFlowNode_YapDialogue::GetContextOutputs() const
 		ContextOutputPins.Add(OutputPinName);
 	}
 
-	for (uint8 Index = 0; Index < Fragments.Num(); ++Index)
+	for (uint8 Index = 0; Index < GetNumFragments(); ++Index)
 	{
-		const FYapFragment& Fragment = Fragments[Index];
+		const FYapFragment& Fragment = GetFragment(Index);
 		
 		if (Fragment.UsesEndPin())
 		{
@@ -1612,10 +2014,10 @@ bool UFlowNode_YapDialogue::CheckActivationLimits() const
 	}
 
 	// If even one fragment has not met activation limits, we're OK
-	for (int i = 0; i < Fragments.Num(); ++i)
+	for (int i = 0; i < GetNumFragments(); ++i)
 	{
-		int32 ActivationLimit = Fragments[i].GetActivationLimit();
-		int32 ActivationCount = Fragments[i].GetActivationCount();
+		int32 ActivationLimit = GetFragment(i).GetActivationLimit();
+		int32 ActivationCount = GetFragmentRunState(i).ActivationCount;
 
 		if (ActivationLimit == 0 || ActivationCount < ActivationLimit)
 		{
@@ -1724,6 +2126,91 @@ void UFlowNode_YapDialogue::ForceReconstruction()
 
 // ------------------------------------------------------------------------------------------------
 
+#if WITH_EDITOR
+void UFlowNode_YapDialogue::OnTemplateEdited(const UFlowNode_YapDialogue* EditedNode)
+{
+	if (TemplateNode != EditedNode)
+	{
+		// This instance kept its own copy (the template had a different shape when it was instanced); copy the edit in, keeping run state by fragment GUID
+		TMap<FGuid, FYapFragmentRunState> RunStatesByGuid;
+
+		for (int32 i = 0; i < Fragments.Num() && i < FragmentRunStates.Num(); ++i)
+		{
+			RunStatesByGuid.Add(Fragments[i].GetGuid(), MoveTemp(FragmentRunStates[i]));
+		}
+
+		Fragments = EditedNode->Fragments;
+		
+		FragmentRunStates.Reset(Fragments.Num());
+
+		for (const FYapFragment& Fragment : Fragments)
+		{
+			if (FYapFragmentRunState* ExistingRunState = RunStatesByGuid.Find(Fragment.GetGuid()))
+			{
+				FragmentRunStates.Add(MoveTemp(*ExistingRunState));
+			}
+			else
+			{
+				FragmentRunStates.AddDefaulted_GetRef().Conditions = Fragment.GetConditionObjects();
+			}
+		}
+	}
+	else if (FragmentRunStates.Num() != GetNumFragments())
+	{
+		// Shared with the edited node; fragments were added or removed
+		const int32 OldNum = FragmentRunStates.Num();
+		
+		FragmentRunStates.SetNum(GetNumFragments());
+
+		for (int32 i = OldNum; i < FragmentRunStates.Num(); ++i)
+		{
+			FragmentRunStates[i].Conditions = GetFragments()[i].GetConditionObjects();
+		}
+	}
+
+	// The edit may have added, removed or reordered fragments
+	FragmentIndicesByGuid.Empty();
+	FragmentIndicesByID.Empty();
+
+	if (TemplateNode)
+	{
+		TemplateNode->FragmentIndicesByGuid.Empty();
+		TemplateNode->FragmentIndicesByID.Empty();
+	}
+
+	// Starts streaming newly assigned audio before the fragment runs
+	TriggerPreload();
+
+	if (PromptIndices.Num() == 0)
+	{
+		return;
+	}
+
+	UYapSubsystem* Subsystem = UYapSubsystem::Get(GetWorld());
+	
+	const FYapConversation* Conversation = UYapSubsystem::GetConversationByOwner(this, GetFlowAsset());
+
+	if (!Subsystem || !Conversation)
+	{
+		return;
+	}
+
+	FYapData_PlayerPromptsRefreshed Data;
+	Data.Conversation = Conversation->GetHandle();
+
+	ReleasePrompts();
+
+	Subsystem->OnPromptsRefreshed(Data, GetClass());
+
+	if (!TryBroadcastPrompts())
+	{
+		UE_LOG(LogYap, Warning, TEXT("%s: no prompts are available after editing; the conversation will not continue until the flow is restarted."), *GetName());
+	}
+}
+#endif
+
+// ------------------------------------------------------------------------------------------------
+
 #if WITH_EDITOR
 void UFlowNode_YapDialogue::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
 {
@@ -1835,6 +2322,12 @@ void UFlowNode_YapDialogue::PreSave(FObjectPreSaveContext SaveContext)
 			}
 		}
 	}
+
+	// Saved IDs are in use for good (audio may already be recorded against them), even if this node is later deleted
+	if (!IsTemplate() && !GEditor->IsPlayingSessionInEditor() && !SaveContext.IsCooking() && !SaveContext.IsProceduralSave() && !AudioID.IsEmpty())
+	{
+		FYapAudioIDAllocator::Get().Reserve({ AudioID });
+	}
 }
 #endif
 
@@ -1868,6 +2361,8 @@ void UFlowNode_YapDialogue::FixNode(UEdGraphNode* NewGraphNode)
 
 void UFlowNode_YapDialogue::PreloadContent()
 {
+	YAP_TRACE_SCOPE(UFlowNode_YapDialogue::PreloadContent);
+	
 	UWorld* World = GetWorld();
 
 #if WITH_EDITOR
@@ -1887,9 +2382,9 @@ void UFlowNode_YapDialogue::PreloadContent()
 	}
 #endif
 
-	for (FYapFragment& Fragment : Fragments)
+	for (uint8 i = 0; i < GetNumFragments(); ++i)
 	{
-		Fragment.PreloadContent(World, MaturitySetting, LoadContext);
+		GetFragment(i).PreloadContent(World, MaturitySetting, LoadContext, GetFragmentRunStateMutable(i));
 	}
 }
 
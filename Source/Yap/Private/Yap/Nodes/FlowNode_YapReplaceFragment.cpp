@@ -34,19 +34,18 @@ void UFlowNode_YapReplaceFragment::ExecuteInput(const FName& PinName)
 {
 	Super::ExecuteInput(PinName);
 
-	// TODO TODO TODO TODO aaaaaa
-	UE_LOG(LogYap, Warning, TEXT("Replacing fragment - unimplemented!"));
-
-	// TODO is this a bad idea? Can I save the changes to the flow node? Other systems Moth made do it so maybe it's 
-	FYapFragment* Fragment = GetWorld()->GetSubsystem<UYapSubsystem>()->FindTaggedFragment(TargetFragmentTag);
-
-	if (Fragment)
+	// The flow asset's fragment is shared by every instance of it and is never modified; the replacement lives in the subsystem's overlay
+	if (TargetFragmentTag.IsValid())
 	{
-		//Fragment->ReplaceBit(NewData);
-
-		// TODO should this have settings to control this? Yes probably. There may be times when I want to forcefully flip-flop back and forth.
-		// SignalMode = EFlowSignalMode::PassThrough;
+		UYapSubsystem::SetFragmentReplacement(this, TargetFragmentTag.GetTagName(), NewData);
 	}
+	else
+	{
+		UE_LOG(LogYap, Warning, TEXT("%s: No target fragment set, nothing was replaced"), *GetName());
+	}
+
+	// TODO should this have settings to control this? Yes probably. There may be times when I want to forcefully flip-flop back and forth.
+	// SignalMode = EFlowSignalMode::PassThrough;
 	
 	TriggerFirstOutput(true);
 }
@@ -0,0 +1,43 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Yap/Debug/YapBenchmark.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FYapSubsystemStressTest, "Yap.Performance.SubsystemStress", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapSubsystemStressTest::RunTest(const FString& Parameters)
+{
+	const FYapBenchmarkSettings Settings;
+
+	const TArray<FYapBenchmarkResult> Results = FYapBenchmark::RunHeadless(Settings);
+
+	if (!TestEqual(TEXT("Benchmark count"), Results.Num(), 5))
+	{
+		return false;
+	}
+
+	for (const FYapBenchmarkResult& Result : Results)
+	{
+		AddInfo(FString::Printf(TEXT("%s: %d ops, %.3f us/op, %.2f allocs/op, %lld bytes"), *Result.Name, Result.Operations, Result.GetMicrosecondsPerOp(), Result.GetAllocationsPerOp(), Result.AllocatedBytes));
+
+		AddAnalyticsItem(FString::Printf(TEXT("%s.UsPerOp=%f"), *Result.Name, Result.GetMicrosecondsPerOp()));
+		AddAnalyticsItem(FString::Printf(TEXT("%s.AllocationsPerOp=%f"), *Result.Name, Result.GetAllocationsPerOp()));
+	}
+
+	TestTrue(TEXT("Free speech ran"), Results[0].PeakSpeechCount > 0);
+	TestEqual(TEXT("Speech left after cancel storm"), Results[1].PeakSpeechCount, 0);
+	TestTrue(TEXT("Conversations queued"), Results[2].PeakConversationCount > 0);
+
+	// Kept between runs so regressions can be tracked across plugin updates
+	TestTrue(TEXT("Results written"), FYapBenchmark::SaveJson(FYapBenchmark::GetDefaultResultsPath(), Results, Settings));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,195 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Yap/YapDialogueDatabase.h"
+#include "Yap/Enums/YapMaturitySetting.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FYapDialogueDatabaseRoundTripTest, "Yap.DialogueDatabase.RoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FYapDialogueDatabaseCorruptionTest, "Yap.DialogueDatabase.Corruption", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// ------------------------------------------------------------------------------------------------
+
+namespace Yap::Tests
+{
+	static TArray<FYapDialogueDatabaseEntry> MakeDatabaseEntries(int32 Num)
+	{
+		TArray<FYapDialogueDatabaseEntry> Entries;
+
+		for (int32 i = 0; i < Num; ++i)
+		{
+			FYapDialogueDatabaseEntry& Entry = Entries.AddDefaulted_GetRef();
+
+			Entry.FragmentGuid = FGuid(1, 2, 3, i);
+			Entry.FragmentID = FName(*FString::Printf(TEXT("Line_%i"), i));
+			Entry.SpeakerID = (i % 2 == 0) ? FName("Alice") : FName("Bob");
+			Entry.TextNamespace[0] = TEXT("YapTest");
+			Entry.TextKey[0] = FString::Printf(TEXT("Key_%i"), i);
+			Entry.TextSource[0] = FString::Printf(TEXT("Line number %i"), i);
+			Entry.SpeechTime[0] = 1.0f + i;
+			Entry.AudioAsset[0] = FSoftObjectPath(FString::Printf(TEXT("/Game/Audio/Line_%i.Line_%i"), i, i));
+			Entry.OwningAsset = FSoftObjectPath(FString::Printf(TEXT("/Game/Dialogue/Flow_%i.Flow_%i"), i / 3, i / 3));
+			Entry.NodeGuid = FGuid(4, 5, 6, i / 2);
+			Entry.FragmentIndex = i % 2;
+
+			FYapTextCounts Counts;
+			Counts.Words = 3;
+			Counts.Characters = 11 + i;
+			Counts.Graphemes = 11 + i;
+
+			Entry.TextCounts = { Counts, FYapTextCounts() };
+		}
+
+		return Entries;
+	}
+
+	static FString GetDatabaseTestPath(const TCHAR* Name)
+	{
+		return FPaths::AutomationTransientDir() / TEXT("Yap") / Name;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabaseRoundTripTest::RunTest(const FString& Parameters)
+{
+	const TArray<FYapDialogueDatabaseEntry> Entries = Yap::Tests::MakeDatabaseEntries(10);
+
+	const FString Path = Yap::Tests::GetDatabaseTestPath(TEXT("RoundTrip.yapdb"));
+
+	if (!TestTrue(TEXT("Write"), FYapDialogueDatabase::Write(Path, Entries, { TEXT("en") })))
+	{
+		return false;
+	}
+
+	FYapDialogueDatabase Database;
+
+	if (!TestTrue(TEXT("Load"), Database.Load(Path)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Num"), Database.Num(), Entries.Num());
+	TestEqual(TEXT("NumCultures"), Database.NumCultures(), 1);
+	TestEqual(TEXT("FindCulture falls back to the parent language"), Database.FindCulture(TEXT("en-US")), 0);
+
+	for (const FYapDialogueDatabaseEntry& Entry : Entries)
+	{
+		const int32 Index = Database.FindFragment(Entry.FragmentGuid);
+
+		if (!TestNotEqual(TEXT("FindFragment"), Index, INDEX_NONE))
+		{
+			continue;
+		}
+
+		TestEqual(TEXT("FindFragmentByID"), Database.FindFragmentByID(Entry.FragmentID), Index);
+		TestEqual(TEXT("FragmentID"), Database.GetFragmentID(Index), Entry.FragmentID);
+		TestEqual(TEXT("SpeakerID"), Database.GetSpeakerID(Index), Entry.SpeakerID);
+		TestEqual(TEXT("SpeechTime"), Database.GetSpeechTime(Index, EYapMaturitySetting::Mature), Entry.SpeechTime[0]);
+		TestEqual(TEXT("Untimed child-safe line"), Database.GetSpeechTime(Index, EYapMaturitySetting::ChildSafe), -1.0f);
+		TestEqual(TEXT("AudioAsset"), Database.GetAudioAsset(Index, EYapMaturitySetting::Mature), Entry.AudioAsset[0]);
+		TestEqual(TEXT("OwningAsset"), Database.GetOwningAsset(Index), Entry.OwningAsset);
+		TestEqual(TEXT("NodeGuid"), Database.GetNodeGuid(Index), Entry.NodeGuid);
+		TestEqual(TEXT("FragmentIndex"), Database.GetFragmentIndex(Index), Entry.FragmentIndex);
+
+		FYapTextCounts Counts;
+		if (TestTrue(TEXT("GetTextCounts"), Database.GetTextCounts(Index, EYapMaturitySetting::Mature, 0, Counts)))
+		{
+			TestEqual(TEXT("Words"), Counts.Words, Entry.TextCounts[0].Words);
+			TestEqual(TEXT("Characters"), Counts.Characters, Entry.TextCounts[0].Characters);
+		}
+
+		int32 First = INDEX_NONE;
+		int32 Num = 0;
+		if (TestTrue(TEXT("GetAssetFragmentRange"), Database.GetAssetFragmentRange(Entry.OwningAsset, First, Num)))
+		{
+			TestTrue(TEXT("Fragment is within its asset's range"), Index >= First && Index < First + Num);
+		}
+	}
+
+	TestEqual(TEXT("Missing fragment"), Database.FindFragment(FGuid::NewGuid()), INDEX_NONE);
+	TestEqual(TEXT("Missing ID"), Database.FindFragmentByID("NotALine"), INDEX_NONE);
+
+	Database.Unload();
+	IFileManager::Get().Delete(*Path);
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabaseCorruptionTest::RunTest(const FString& Parameters)
+{
+	const FString SourcePath = Yap::Tests::GetDatabaseTestPath(TEXT("Source.yapdb"));
+	const FString CorruptPath = Yap::Tests::GetDatabaseTestPath(TEXT("Corrupt.yapdb"));
+
+	if (!TestTrue(TEXT("Write"), FYapDialogueDatabase::Write(SourcePath, Yap::Tests::MakeDatabaseEntries(10), { TEXT("en"), TEXT("ja") })))
+	{
+		return false;
+	}
+
+	TArray<uint8> Original;
+	if (!TestTrue(TEXT("Read back"), FFileHelper::LoadFileToArray(Original, *SourcePath)))
+	{
+		return false;
+	}
+
+	// Every rejected file logs an error
+	AddExpectedError(TEXT("is corrupt"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	FYapDialogueDatabase Database;
+
+	auto LoadsCorrupted = [&] (const TArray<uint8>& Bytes) -> bool
+	{
+		FFileHelper::SaveArrayToFile(Bytes, *CorruptPath);
+		const bool bLoaded = Database.Load(CorruptPath);
+		Database.Unload();
+		return bLoaded;
+	};
+
+	// Truncated anywhere, including inside the header and on a section boundary
+	for (int32 Size = 0; Size < Original.Num(); Size += (Size < 256) ? 1 : 61)
+	{
+		TArray<uint8> Truncated(Original.GetData(), Size);
+		TestFalse(FString::Printf(TEXT("Truncated to %i bytes"), Size), LoadsCorrupted(Truncated));
+	}
+
+	// Header fields are uint32s: Magic, Version, NumFragments, NumAssets, NumStrings, NumIndexSlots, NumCultures; section offsets are uint64s from byte 32
+	auto Patched = [&Original] (int32 ByteOffset, uint64 Value, int32 ValueSize)
+	{
+		TArray<uint8> Bytes = Original;
+		FMemory::Memcpy(Bytes.GetData() + ByteOffset, &Value, ValueSize);
+		return Bytes;
+	};
+
+	TestFalse(TEXT("Bad magic"), LoadsCorrupted(Patched(0, 0, 4)));
+	TestFalse(TEXT("Future version"), LoadsCorrupted(Patched(4, 999, 4)));
+	TestFalse(TEXT("Huge fragment count"), LoadsCorrupted(Patched(8, 0x7FFFFFFF, 4)));
+	TestFalse(TEXT("Huge asset count"), LoadsCorrupted(Patched(12, 0x7FFFFFFF, 4)));
+	TestFalse(TEXT("Huge string count"), LoadsCorrupted(Patched(16, 0xFFFFFFFF, 4)));
+	TestFalse(TEXT("Index slots not a power of two"), LoadsCorrupted(Patched(20, 3, 4)));
+	TestFalse(TEXT("Huge culture count"), LoadsCorrupted(Patched(24, 0x00FFFFFF, 4)));
+
+	for (int32 Section = 0; Section < 19; ++Section)
+	{
+		TestFalse(FString::Printf(TEXT("Section %i past the end"), Section), LoadsCorrupted(Patched(32 + Section * 8, Original.Num() - 2, 8)));
+		TestFalse(FString::Printf(TEXT("Section %i inside the header"), Section), LoadsCorrupted(Patched(32 + Section * 8, 0, 8)));
+	}
+
+	// The untouched file still loads
+	TestTrue(TEXT("Original loads"), LoadsCorrupted(Original));
+
+	IFileManager::Get().Delete(*SourcePath);
+	IFileManager::Get().Delete(*CorruptPath);
+
+	return true;
+}
+
+#endif
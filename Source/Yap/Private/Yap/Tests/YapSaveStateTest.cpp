@@ -0,0 +1,138 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Yap/YapSaveState.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FYapSaveStateRoundTripTest, "Yap.SaveState.RoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+// ------------------------------------------------------------------------------------------------
+
+namespace Yap::Tests
+{
+	static FYapNodeSaveRecord MakeSaveRecord(int32 NodeActivations, const FGuid& Fragment, int32 FragmentActivations)
+	{
+		FYapNodeSaveRecord Record;
+		Record.NodeActivationCount = NodeActivations;
+		Record.LastRanFragment = Fragment;
+		Record.FragmentActivationCounts.Add(Fragment, FragmentActivations);
+		return Record;
+	}
+
+	static TArray<uint8> WriteSaveState(FYapDialogueSaveState& State, bool bDelta)
+	{
+		TArray<uint8> Data;
+		FMemoryWriter Writer(Data);
+		State.Write(Writer, bDelta);
+		return Data;
+	}
+
+	static bool ReadSaveState(FYapDialogueSaveState& State, const TArray<uint8>& Data)
+	{
+		FMemoryReader Reader(Data);
+		return State.Read(Reader);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapSaveStateRoundTripTest::RunTest(const FString& Parameters)
+{
+	using namespace Yap::Tests;
+
+	// Duplicated flow assets share node GUIDs; their records must stay apart
+	const FGuid NodeGuid(1, 2, 3, 4);
+	const FGuid OtherNodeGuid(5, 6, 7, 8);
+	const FGuid FragmentGuid(9, 10, 11, 12);
+
+	const FYapNodeSaveKey KeyA { FSoftObjectPath(TEXT("/Game/Dialogue/A.A")), NodeGuid };
+	const FYapNodeSaveKey KeyB { FSoftObjectPath(TEXT("/Game/Dialogue/B.B")), NodeGuid };
+	const FYapNodeSaveKey KeyC { FSoftObjectPath(TEXT("/Game/Dialogue/B.B")), OtherNodeGuid };
+
+	FYapDialogueSaveState Source;
+	Source.Store(KeyA, MakeSaveRecord(1, FragmentGuid, 1));
+	Source.Store(KeyB, MakeSaveRecord(2, FragmentGuid, 5));
+	Source.Store(KeyC, MakeSaveRecord(3, FragmentGuid, 300));
+
+	const TArray<uint8> Full = WriteSaveState(Source, false);
+
+	TestFalse(TEXT("Writing clears changes"), Source.HasChanges());
+	TestTrue(TEXT("Unchanged state writes identical bytes"), WriteSaveState(Source, false) == Full);
+
+	FYapDialogueSaveState Loaded;
+
+	if (!TestTrue(TEXT("Read full"), ReadSaveState(Loaded, Full)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Record count"), Loaded.Num(), 3);
+
+	for (const FYapNodeSaveKey& Key : { KeyA, KeyB, KeyC })
+	{
+		const FYapNodeSaveRecord* Expected = Source.Find(Key);
+		const FYapNodeSaveRecord* Actual = Loaded.Find(Key);
+
+		if (TestNotNull(TEXT("Record found"), Actual))
+		{
+			TestTrue(TEXT("Record matches"), *Actual == *Expected);
+		}
+	}
+
+	// Delta: one record changes, one is erased, one is untouched
+	Source.Store(KeyB, MakeSaveRecord(4, FragmentGuid, 6));
+	Source.Remove(KeyC);
+
+	const TArray<uint8> Delta = WriteSaveState(Source, true);
+
+	TestTrue(TEXT("Delta is smaller than a full save"), Delta.Num() < Full.Num());
+
+	if (!TestTrue(TEXT("Read delta"), ReadSaveState(Loaded, Delta)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Record count after delta"), Loaded.Num(), 2);
+	TestNull(TEXT("Removed record is gone"), Loaded.Find(KeyC));
+
+	if (const FYapNodeSaveRecord* Record = Loaded.Find(KeyB))
+	{
+		TestEqual(TEXT("Changed record"), Record->NodeActivationCount, 4);
+	}
+	else
+	{
+		AddError(TEXT("Changed record is missing"));
+	}
+
+	if (const FYapNodeSaveRecord* Record = Loaded.Find(KeyA))
+	{
+		TestEqual(TEXT("Untouched record"), Record->NodeActivationCount, 1);
+	}
+	else
+	{
+		AddError(TEXT("Untouched record is missing"));
+	}
+
+	// A full save replaces everything, including records the delta left alone
+	FYapDialogueSaveState Empty;
+
+	TestTrue(TEXT("Read empty full"), ReadSaveState(Loaded, WriteSaveState(Empty, false)));
+	TestEqual(TEXT("Empty full save clears the store"), Loaded.Num(), 0);
+
+	// Truncated data is rejected and leaves the store alone
+	AddExpectedError(TEXT("Dialogue save state"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	TArray<uint8> Truncated(Full.GetData(), Full.Num() - 3);
+
+	TestFalse(TEXT("Truncated data is rejected"), ReadSaveState(Loaded, Truncated));
+	TestEqual(TEXT("Rejected data leaves the store alone"), Loaded.Num(), 0);
+
+	return true;
+}
+
+#endif
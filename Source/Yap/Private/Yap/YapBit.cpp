@@ -3,6 +3,8 @@
 
 #include "Yap/YapBit.h"
 
+#include "Internationalization/TextLocalizationManager.h"
+#include "Yap/YapBroker.h"
 #include "Yap/YapProjectSettings.h"
 #include "Yap/YapStreamableManager.h"
 #include "Yap/YapSubsystem.h"
@@ -33,7 +35,7 @@ bool FYapBit::HasAudioAsset() const
 
 // --------------------------------------------------------------------------------------------
 
-TOptional<float> FYapBit::GetSpeechTime(UWorld* World, EYapTimeMode TimeMode, EYapLoadContext LoadContext, const UYapNodeConfig& Config) const
+TOptional<float> FYapBit::GetSpeechTime(UWorld* World, EYapTimeMode TimeMode, EYapLoadContext LoadContext, const UYapNodeConfig& Config, const FYapTextCounts* TextCounts, const FString& TextCulture) const
 {
 	// TODO clamp minimums from project settings?
 	TOptional<float> Time;
@@ -52,7 +54,7 @@ TOptional<float> FYapBit::GetSpeechTime(UWorld* World, EYapTimeMode TimeMode, EY
 		}
 		case EYapTimeMode::TextTime:
 		{
-			Time = GetTextTime(Config);
+			Time = GetTextTime(World, Config, TextCounts, TextCulture);
 			break;
 		}
 		default:
@@ -72,6 +74,8 @@ TOptional<float> FYapBit::GetSpeechTime(UWorld* World, EYapTimeMode TimeMode, EY
 
 void FYapBit::LoadContent(EYapLoadContext LoadContext) const
 {
+	YAP_TRACE_SCOPE(FYapBit::LoadContent);
+	
 	if (!AudioAsset.IsPending())
 	{
 		return;
@@ -81,13 +85,12 @@ void FYapBit::LoadContent(EYapLoadContext LoadContext) const
 	{
 		case EYapLoadContext::Sync:
 		{
-			UE_LOG(LogYap, Warning, TEXT("Synchronously loading audio asset. This should not happen during gameplay! Try loading the flow asset sooner, or delaying dialogue.\nAsset: %s"), *AudioAsset->GetPathName());
-			(const_cast<FYapBit*>(this))->AudioAssetHandle = FYapStreamableManager::Get().RequestSyncLoad(AudioAsset.ToSoftObjectPath());
+			(const_cast<FYapBit*>(this))->AudioAssetHandle = FYapStreamableManager::RequestSyncLoad(AudioAsset.ToSoftObjectPath(), YAP_SYNC_LOAD_SITE);
 			break;
 		}
 		case EYapLoadContext::Async:
 		{
-			(const_cast<FYapBit*>(this))->AudioAssetHandle = FYapStreamableManager::Get().RequestAsyncLoad(AudioAsset.ToSoftObjectPath());
+			(const_cast<FYapBit*>(this))->AudioAssetHandle = FYapStreamableManager::RequestAsyncLoad(AudioAsset.ToSoftObjectPath());
 			break;
 		}
 		case EYapLoadContext::AsyncEditorOnly:
@@ -95,7 +98,7 @@ void FYapBit::LoadContent(EYapLoadContext LoadContext) const
 #if WITH_EDITOR
 			if (!GEditor->IsPlaySessionInProgress())
 			{
-				FYapStreamableManager::Get().RequestAsyncLoad(AudioAsset.ToSoftObjectPath());
+				FYapStreamableManager::RequestAsyncLoad(AudioAsset.ToSoftObjectPath());
 			}
 #endif
 			break;
@@ -105,14 +108,22 @@ void FYapBit::LoadContent(EYapLoadContext LoadContext) const
 
 // --------------------------------------------------------------------------------------------
 
-TOptional<float> FYapBit::GetTextTime(const UYapNodeConfig& NodeConfig) const
+TOptional<float> FYapBit::GetTextTime(UObject* WorldContext, const UYapNodeConfig& NodeConfig, const FYapTextCounts* TextCounts, const FString& TextCulture) const
 {
-	int32 TWPM = NodeConfig.DialoguePlayback.TimeSettings.TextWordsPerMinute;
-	int32 WordCount = DialogueText.GetWordCount();
-	double SecondsPerWord = 60.0 / (double)TWPM;
-	double MinTextTimeLength = NodeConfig.GetMinimumAutoTextTimeLength();
+	// Without cooked counts only the source text's word count is cached; its length stands in for the character count
+	int32 WordCount = TextCounts ? TextCounts->Words : DialogueText.GetWordCount();
+	int32 CharCount = TextCounts ? TextCounts->Characters : DialogueText.Get().ToString().Len();
+
+	// Timing depends on the language of the text, not on the language the editor or game is running in
+	const FString CultureName = TextCounts ? TextCulture : FTextLocalizationManager::Get().GetNativeCultureName(ELocalizedTextSourceCategory::Game);
+
+#if WITH_EDITOR
+	const UYapBroker& Broker = UYapBroker::GetInEditor(); 
+#else
+	const UYapBroker& Broker = UYapBroker::Get(WorldContext); 
+#endif
 	
-	return FMath::Max(WordCount * SecondsPerWord, MinTextTimeLength);
+	return Broker.CalculateTextTime(WordCount, CharCount, NodeConfig, CultureName);
 }
 
 // --------------------------------------------------------------------------------------------
@@ -144,34 +155,32 @@ TOptional<float> FYapBit::GetAudioTime(UObject* WorldContext, EYapLoadContext Lo
 
 // --------------------------------------------------------------------------------------------
 
-/*
-
-FYapBit& FYapBit::operator=(const FYapBitReplacement& Replacement)
+void FYapBit::ApplyReplacement(const TOptional<FYapText>& NewTitleText, const TOptional<FYapText>& NewDialogueText, const TOptional<TSoftObjectPtr<UObject>>& NewAudioAsset, const TOptional<float>& NewManualTime)
 {
-#define FLOWYAP_REPLACE(X) if (Replacement.X.IsSet()) {X = Replacement.X.GetValue(); }  
+	if (NewTitleText.IsSet())
+	{
+		TitleText = NewTitleText.GetValue();
+	}
 
-	FLOWYAP_REPLACE(SpeakerAsset);
-	FLOWYAP_REPLACE(DirectedAtAsset);
-	FLOWYAP_REPLACE(MatureTitleText);
+	if (NewDialogueText.IsSet())
+	{
+		DialogueText = NewDialogueText.GetValue();
 
-	if (Replacement.bOverrideMatureDialogueText)
+		// Replacement text is made at runtime and carries no word count; without one the line would only run for the minimum text time
+		DialogueText.WordCount = FYapText::CountText(DialogueText.Text.ToString()).Words;
+	}
+
+	if (NewAudioAsset.IsSet())
 	{
-		MatureDialogueText = Replacement.MatureDialogueText;
+		AudioAsset = NewAudioAsset.GetValue();
+		AudioAssetHandle.Reset();
+	}
+
+	if (NewManualTime.IsSet())
+	{
+		ManualTime = NewManualTime.GetValue();
 	}
-	
-	//FLOWYAP_REPLACE(MatureDialogueText);
-	FLOWYAP_REPLACE(SafeTitleText);
-	FLOWYAP_REPLACE(SafeDialogueText);
-	FLOWYAP_REPLACE(MatureAudioAsset);
-	FLOWYAP_REPLACE(SafeAudioAsset);
-	FLOWYAP_REPLACE(MoodTag);
-	FLOWYAP_REPLACE(TimeMode);
-	FLOWYAP_REPLACE(ManualTime);
-	
-#undef FLOWYAP_REPLACE
-	return *this;
 }
-*/
 
 // --------------------------------------------------------------------------------------------
 // EDITOR API
@@ -231,7 +240,7 @@ void FYapBit::RecalculateAudioTime(TOptional<float>& CachedTime)
 {
 	const UYapBroker& Broker = UYapBroker::GetInEditor();
 	
-	float NewCachedTime = Broker.GetAudioAssetDuration(AudioAsset.LoadSynchronous());
+	float NewCachedTime = Broker.GetAudioAssetDuration(FYapStreamableManager::LoadSynchronous(AudioAsset, YAP_SYNC_LOAD_SITE));
 
 	if (NewCachedTime > 0)
 	{
@@ -89,4 +89,18 @@ AActor* UYapBlueprintFunctionLibrary::FindYapCharacterActor(UObject* WorldContex
 
 // ------------------------------------------------------------------------------------------------
 
+bool UYapBlueprintFunctionLibrary::SaveDialogueState(UObject* WorldContext, TArray<uint8>& Data, bool bDelta)
+{
+	return UYapSubsystem::SaveDialogueState(WorldContext, Data, bDelta);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapBlueprintFunctionLibrary::LoadDialogueState(UObject* WorldContext, const TArray<uint8>& Data)
+{
+	return UYapSubsystem::LoadDialogueState(WorldContext, Data);
+}
+
+// ------------------------------------------------------------------------------------------------
+
 #undef LOCTEXT_NAMESPACE
@@ -4,23 +4,48 @@
 #include "Yap/YapBroker.h"
 
 #include "Components/AudioComponent.h"
-#include "Internationalization/BreakIterator.h"
 #include "Yap/YapRunningFragment.h" 
 #include "Yap/YapLog.h"
 #include "Yap/YapProjectSettings.h"
+#include "Yap/YapStreamableManager.h"
 #include "Yap/Handles/YapPromptHandle.h"
 #include "Yap/Enums/YapMaturitySetting.h"
 #include "Sound/SoundBase.h"
 #include "Yap/YapSubsystem.h"
+#include "Yap/YapText.h"
+#include "Yap/Editor/YapAudioIDAllocator.h"
 
 #define LOCTEXT_NAMESPACE "Yap"
 
+namespace Yap::Broker
+{
+	/** Roughly how many characters of a script without spaces read in the time of one word. */
+	static constexpr int32 CharactersPerWord = 2;
+
+	/** By the culture's language code, e.g. "ja" or "zh-Hans". An empty culture name (unknown) counts as space delimited. */
+	static bool IsSpaceDelimited(const FString& CultureName)
+	{
+		static const TSet<FString> NoSpaceLanguages = { TEXT("zh"), TEXT("ja"), TEXT("th"), TEXT("lo"), TEXT("km"), TEXT("my"), TEXT("bo") };
+
+		FString Language = CultureName;
+		int32 SeparatorIndex;
+
+		if (Language.FindChar('-', SeparatorIndex) || Language.FindChar('_', SeparatorIndex))
+		{
+			Language.LeftInline(SeparatorIndex);
+		}
+
+		return !NoSpaceLanguages.Contains(Language.ToLower());
+	}
+}
+
 // ================================================================================================
 
 TOptional<bool> UYapBroker::bImplemented_Initialize = false;
 TOptional<bool> UYapBroker::bImplemented_GetMaturitySetting = false;
 TOptional<bool> UYapBroker::bImplemented_GetPlaybackSpeed = false;
 TOptional<bool> UYapBroker::bImplemented_GetAudioAssetDuration = false;
+TOptional<bool> UYapBroker::bImplemented_GetTextArgument = false;
 #if WITH_EDITOR
 TOptional<bool> UYapBroker::bImplemented_PreviewAudioAsset = false;
 TOptional<bool> UYapBroker::bImplemented_GetNewNodeID = false;
@@ -31,6 +56,7 @@ bool UYapBroker::bWarned_Initialize = false;
 bool UYapBroker::bWarned_GetMaturitySetting = false;
 bool UYapBroker::bWarned_GetPlaybackSpeed = false;
 bool UYapBroker::bWarned_GetAudioAssetDuration = false;
+bool UYapBroker::bWarned_GetTextArgument = false;
 #if WITH_EDITOR
 bool UYapBroker::bWarned_PreviewAudioAsset = false;
 #endif
@@ -71,6 +97,15 @@ float UYapBroker::GetPlaybackSpeed() const
 
 // ------------------------------------------------------------------------------------------------
 
+FFormatArgumentValue UYapBroker::GetTextArgument(FName Argument, FName SpeakerID, FName DirectedAtID) const
+{
+	bool bShowUnimplementedWarning = !UYapProjectSettings::GetSuppressBrokerWarnings();
+	
+	return YAP_CALL_K2(GetTextArgument, bShowUnimplementedWarning, Argument, SpeakerID, DirectedAtID);
+}
+
+// ------------------------------------------------------------------------------------------------
+
 int32 UYapBroker::CalculateWordCount(const FText& Text) const
 {
 	if (GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_CalculateWordCount))) // TODO cache this? Switch To YAP_CALL_K2?
@@ -83,13 +118,26 @@ int32 UYapBroker::CalculateWordCount(const FText& Text) const
 
 // ------------------------------------------------------------------------------------------------
 
-float UYapBroker::CalculateTextTime(int32 WordCount, int32 CharCount, const UYapNodeConfig& NodeConfig) const
+bool UYapBroker::CanCalculateWordCountInParallel() const
+{
+	return !GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_CalculateWordCount));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float UYapBroker::CalculateTextTime(int32 WordCount, int32 CharCount, const UYapNodeConfig& NodeConfig, const FString& CultureName) const
 {
 	if (GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_CalculateTextTime))) // TODO cache this? Switch To YAP_CALL_K2?
 	{
 		return K2_CalculateTextTime(WordCount, CharCount, &NodeConfig);
 	}
 	
+	// Word counts of scripts written without spaces depend on the break iterator's dictionary; time those by characters instead
+	if (!Yap::Broker::IsSpaceDelimited(CultureName))
+	{
+		WordCount = FMath::DivideAndRoundUp(CharCount, Yap::Broker::CharactersPerWord);
+	}
+	
 	int32 TWPM = NodeConfig.DialoguePlayback.TimeSettings.TextWordsPerMinute;
 	float SecondsPerWord = 60.0 / (float)TWPM;
 	float TalkTime = WordCount * SecondsPerWord * GetPlaybackSpeed();
@@ -117,12 +165,9 @@ float UYapBroker::GetAudioAssetDuration(const UObject* AudioAsset) const
 	
 	for (const TSoftClassPtr<UObject>& Class : AudioAssetClasses)
 	{
-		if (Class.IsPending())
-		{
-			UE_LOG(LogYap, Warning, TEXT("Synchronously loading audio class asset - this should not happen!"));
-		}
+		UClass* LoadedClass = FYapStreamableManager::LoadSynchronous(Class, YAP_SYNC_LOAD_SITE, true);
 		
-		if (AudioAsset->IsA(Class.LoadSynchronous()))
+		if (LoadedClass && AudioAsset->IsA(LoadedClass))
 		{
 			bFoundClassMatch = true;
 			break;
@@ -359,23 +404,49 @@ FString UYapBroker::GenerateDialogueAudioID(const UFlowNode_YapDialogue* InNode)
 		}
 	}
 	
-	// Generate a new tag, making sure it isn't already in use in the graph by another dialogue node
-	FString NewID;
-	
-	int32 Safety = 0;
-	do 
+	const FYapAudioIDFormat& IDFormat = InNode->GetNodeConfig().GetAudioIDFormat();
+
+	// The allocator rules out every ID used anywhere in the project, including by deleted nodes
+	if (!GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED_TwoParams(UYapBroker, K2_GetNewNodeID, const FYapAudioIDFormat&, const TSet<FString>)))
 	{
-		if (Safety > 1000)
+		const FString NewID = GetNewNodeID(IDFormat, ExistingAudioIDs);
+
+		if (NewID.IsEmpty())
 		{
-			UE_LOG(LogYap, Error, TEXT("Failed to generate a unique dialogue tag after 1000 iterations!"));
-			return "";
+			UE_LOG(LogYap, Error, TEXT("Failed to generate a unique dialogue audio ID!"));
 		}
 		
-		NewID = GenerateRandomDialogueAudioID();
-		
-	} while (ExistingAudioIDs.Contains(NewID));
+		return NewID;
+	}
+
+	// Blueprint overrides don't go through the allocator; check what they return against it, and record it once it is known to be unique
+	FYapAudioIDAllocator& Allocator = FYapAudioIDAllocator::Get();
+	
+	constexpr int32 MaxAttempts = 16;
+
+	for (int32 Attempt = 0; Attempt < MaxAttempts; ++Attempt)
+	{
+		const FString NewID = GetNewNodeID(IDFormat, ExistingAudioIDs);
+
+		if (NewID.IsEmpty())
+		{
+			break;
+		}
+
+		if (ExistingAudioIDs.Contains(NewID) || Allocator.IsUsed(NewID))
+		{
+			UE_LOG(LogYap, Verbose, TEXT("Get New Node ID returned audio ID <%s>, which is already used; asking again"), *NewID);
+			continue;
+		}
 
-	return NewID;
+		Allocator.Reserve({ NewID });
+
+		return NewID;
+	}
+
+	UE_LOG(LogYap, Error, TEXT("Failed to generate a unique dialogue audio ID! Get New Node ID must return an ID which no dialogue node in the project has used."));
+
+	return "";
 }
 
 void UYapBroker::UpdateNodeFragmentIDs(UFlowNode_YapDialogue* InNode) const
@@ -411,26 +482,6 @@ void UYapBroker::UpdateNodeFragmentIDs(UFlowNode_YapDialogue* InNode) const
 	}
 }
 
-// ------------------------------------------------------------------------------------------------
-
-FString UYapBroker::GenerateRandomDialogueAudioID() const
-{
-	// TArray<char> AlphaNumerics {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F','G','H',/*'I',*/'J','K','L','M','N',/*'O',*/'P','Q','R','S','T','U','V','W','X','Y','Z'};
-	TArray<char> AlphaNumerics {'A','B','C','D','E','F','G','H',/*'I',*/'J','K','L','M','N',/*'O',*/'P','Q','R','S','T','U','V','W','X','Y','Z'};
-
-	const uint8 Size = 3;
-
-	FString String;
-	String.Reserve(Size);
-	
-	for (uint8 i = 0; i < Size; ++i)
-	{
-		uint8 RandIndex = FMath::RandHelper(AlphaNumerics.Num());
-		String += AlphaNumerics[RandIndex];
-	}
-
-	return String;
-}
 #endif
 
 // ------------------------------------------------------------------------------------------------
@@ -440,6 +491,7 @@ void UYapBroker::BeginPlay()
 	bWarned_Initialize = false;
 	bWarned_GetMaturitySetting = false;
 	bWarned_GetAudioAssetDuration = false;
+	bWarned_GetTextArgument = false;
 #if WITH_EDITOR
 	bWarned_PreviewAudioAsset = false;
 #endif
@@ -449,6 +501,7 @@ void UYapBroker::BeginPlay()
 	bImplemented_Initialize = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_Initialize));
 	bImplemented_GetMaturitySetting = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_GetMaturitySetting));
 	bImplemented_GetAudioAssetDuration = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_GetAudioAssetDuration));
+	bImplemented_GetTextArgument = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_GetTextArgument));
 #if WITH_EDITOR
 	bImplemented_PreviewAudioAsset = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UYapBroker, K2_PreviewAudioAsset));
 	bImplemented_GetNewNodeID = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED_TwoParams(UYapBroker, K2_GetNewNodeID, const FYapAudioIDFormat&, const TSet<FString>));
@@ -506,30 +559,7 @@ bool UYapBroker::ImplementsPreviewAudioAsset_Internal() const
 
 int32 UYapBroker::CalculateWordCount_DefaultImpl(const FText& Text) const
 {
-	// Utility to count the number of words within a string (we use a line-break iterator to avoid counting the whitespace between the words)
-	TSharedRef<IBreakIterator> LineBreakIterator = FBreakIterator::CreateLineBreakIterator();
-	auto CountWords = [&LineBreakIterator](const FString& InTextToCount) -> int32
-	{
-		int32 NumWords = 0;
-		LineBreakIterator->SetString(InTextToCount);
-
-		int32 PreviousBreak = 0;
-		int32 CurrentBreak;
-
-		while ((CurrentBreak = LineBreakIterator->MoveToNext()) != INDEX_NONE)
-		{
-			if (CurrentBreak > PreviousBreak)
-			{
-				++NumWords;
-			}
-			PreviousBreak = CurrentBreak;
-		}
-
-		LineBreakIterator->ClearString();
-		return NumWords;
-	};
-
-	return CountWords(Text.ToString());
+	return FYapText::CountWords(Text.ToString());
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -537,54 +567,12 @@ int32 UYapBroker::CalculateWordCount_DefaultImpl(const FText& Text) const
 #if WITH_EDITOR
 FString UYapBroker::GetNewNodeID_DefaultImpl(const FYapAudioIDFormat& IDFormat, const TSet<FString>& ExistingNodeIDs) const
 {
-	FString Pattern = IDFormat.NodeIDFormat;
-
-	TArray<TCHAR> IllegalChars = UYapProjectSettings::GetIllegalAudioIDCharacters().GetCharArray();
+	FYapAudioIDAllocator& Allocator = FYapAudioIDAllocator::Get();
 
-	// Note (not a to do) I could do this outside of this function before the loop. It might be a bit faster.
-	TArray<char> AlphaNumerics {'0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z'};
-	TArray<TCHAR> Alphas {'A','B','C','D','E','F','G','H','I','J','K','L','M','N','O','P','Q','R','S','T','U','V','W','X','Y','Z'};
-
-	for (int i = 0; i < IllegalChars.Num(); ++i)
-	{
-		AlphaNumerics.Remove(IllegalChars[i]);
-		Alphas.Remove(IllegalChars[i]);
-	}
-
-	TSet<TCHAR> ValidChars{'!', '#', '$', '%', '&', '(', ')', '+', ',', '-', '.', ';', '=', '@', '[', ']', '^', '_', '`', '{', '}', '~',
-	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
-	'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
-	'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
-	' '};
-
-	// The default implementation will simply replace special chars with random chars, this isn't rocket science
-	for (int i = 0; i < Pattern.Len(); ++i)
-	{
-		const TCHAR& Char = Pattern[i];
-
-		switch (Char)
-		{
-			case '*':
-			{
-				Pattern[i] = Alphas[FMath::RandHelper(Alphas.Num())];
-				break;
-			}
-			case '?':
-			{
-				Pattern[i] = AlphaNumerics[FMath::RandHelper(AlphaNumerics.Num())];
-			}
-			default:
-			{
-				// Replace invalid file characters with an underscore
-				if (!ValidChars.Contains(Char))
-				{
-					Pattern[i] = '_';
-				}
-			}
-		}
-	}
+	// The registry may not have seen these yet (e.g. nodes from before it existed, or not yet saved)
+	Allocator.Reserve(ExistingNodeIDs.Array());
 
-	return Pattern;
+	return Allocator.Allocate(IDFormat, UYapProjectSettings::GetIllegalAudioIDCharacters());
 }
 #endif
 
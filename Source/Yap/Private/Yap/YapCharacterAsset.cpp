@@ -4,6 +4,7 @@
 #include "Yap/YapCharacterAsset.h"
 
 #include "Yap/YapProjectSettings.h"
+#include "Yap/YapStreamableManager.h"
 
 #include "Engine/Texture2D.h"
 #include "Yap/Globals/YapMoodTags.h"
@@ -20,6 +21,13 @@ UYapCharacterAsset::UYapCharacterAsset() :
 // ------------------------------------------------------------------------------------------------
 
 const UTexture2D* UYapCharacterAsset::GetCharacterPortrait(const FGameplayTag& MoodTag) const
+{
+	return FYapStreamableManager::LoadSynchronous(GetCharacterPortraitAsset(MoodTag), YAP_SYNC_LOAD_SITE);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TSoftObjectPtr<UTexture2D> UYapCharacterAsset::GetCharacterPortraitAsset(const FGameplayTag& MoodTag) const
 {
 	if (MoodTag.IsValid())
 	{
@@ -27,7 +35,7 @@ const UTexture2D* UYapCharacterAsset::GetCharacterPortrait(const FGameplayTag& M
 
 		if (PortraitList)
 		{
-			const TObjectPtr<UTexture2D>* TexturePtr = PortraitList->Map.Find(MoodTag.GetTagName());
+			const TSoftObjectPtr<UTexture2D>* TexturePtr = PortraitList->Map.Find(MoodTag.GetTagName());
 			
 			if (TexturePtr)
 			{
@@ -8,6 +8,7 @@
 #include "Yap/YapProjectSettings.h"
 #include "Yap/YapStreamableManager.h"
 #include "Yap/YapSubsystem.h"
+#include "Yap/YapTrace.h"
 #include "Yap/Interfaces/IYapCharacterInterface.h"
 #include "Yap/YapCharacterRuntimeDefinition.h"
 
@@ -27,7 +28,7 @@ TSharedPtr<FStreamableHandle> FYapCharacterRegisteredInstance::RequestLoadAsync(
 		return nullptr;
 	}
 
-	return FYapStreamableManager::Get().RequestAsyncLoad(CharacterSoftPtr.ToSoftObjectPath());
+	return FYapStreamableManager::RequestAsyncLoad(CharacterSoftPtr.ToSoftObjectPath());
 }
 
 TSharedPtr<FStreamableHandle> FYapCharacterRegisteredInstance::RequestLoad()
@@ -36,13 +37,15 @@ TSharedPtr<FStreamableHandle> FYapCharacterRegisteredInstance::RequestLoad()
 	UE_LOG(LogYap, Display, TEXT("Sync-loading character <%s>."), *CharacterSoftPtr.GetAssetName());
 #endif
 
-	return FYapStreamableManager::Get().RequestSyncLoad(CharacterSoftPtr.ToSoftObjectPath());
+	return FYapStreamableManager::RequestSyncLoad(CharacterSoftPtr.ToSoftObjectPath(), YAP_SYNC_LOAD_SITE);
 }
 
 // ------------------------------------------------------------------------------------------------
 
 UObject* FYapCharacterRegisteredInstance::GetLoadedCharacter()
 {
+	YAP_TRACE_SCOPE(FYapCharacterRegisteredInstance::GetLoadedCharacter);
+	
 	if (IsValid(CharacterHardPtr))
 	{
 		return CharacterHardPtr;
@@ -53,14 +56,7 @@ UObject* FYapCharacterRegisteredInstance::GetLoadedCharacter()
 		return nullptr;
 	}
 
-	if (CharacterSoftPtr.IsPending())
-	{
-#if !UE_BUILD_SHIPPING
-		UE_LOG(LogYap, Warning, TEXT("Sync-loading character <%s>, this will cause a hitch! Try to request loading sooner."), *CharacterSoftPtr.GetAssetName());
-#endif
-	}
-
-	return CharacterSoftPtr.LoadSynchronous();
+	return FYapStreamableManager::LoadSynchronous(CharacterSoftPtr, YAP_SYNC_LOAD_SITE);
 }
 
 // ================================================================================================
@@ -147,6 +143,8 @@ void UYapCharacterManager::UnregisterCharacter(FName CharacterID)
 
 TScriptInterface<IYapCharacterInterface> UYapCharacterManager::FindCharacter(FName CharacterID)
 {
+	YAP_TRACE_SCOPE(UYapCharacterManager::FindCharacter);
+	
 	FYapCharacterRegisteredInstance* Existing = RegisteredCharacters.Find(CharacterID);
 
 	if (Existing)
@@ -20,17 +20,17 @@ UObject* FYapCharacterStaticDefinition::GetCharacter(TSharedPtr<FStreamableHandl
         {
             case EYapLoadContext::Async:
             {
-                Handle = FYapStreamableManager::Get().RequestAsyncLoad(CharacterAsset.ToSoftObjectPath());
+                Handle = FYapStreamableManager::RequestAsyncLoad(CharacterAsset.ToSoftObjectPath());
                 break;
             }
             case EYapLoadContext::AsyncEditorOnly:
             {
-                FYapStreamableManager::Get().RequestAsyncLoad(CharacterAsset.ToSoftObjectPath());
+                FYapStreamableManager::RequestAsyncLoad(CharacterAsset.ToSoftObjectPath());
                 break;
             }
             case EYapLoadContext::Sync:
             {
-                Handle = FYapStreamableManager::Get().RequestSyncLoad(CharacterAsset.ToSoftObjectPath());
+                Handle = FYapStreamableManager::RequestSyncLoad(CharacterAsset.ToSoftObjectPath(), YAP_SYNC_LOAD_SITE);
                 break;
             }
             default:
@@ -3,6 +3,8 @@
 
 #include "Yap/YapCondition.h"
 
+#include "Yap/YapTrace.h"
+
 #define LOCTEXT_NAMESPACE "Yap"
 
 // ------------------------------------------------------------------------------------------------
@@ -40,6 +42,8 @@ inline FLinearColor UYapCondition::GetColor_Implementation() const
 #undef LOCTEXT_NAMESPACE
 bool UYapCondition::EvaluateCondition_Internal()
 {
+	YAP_TRACE_SCOPE(UYapCondition::EvaluateCondition_Internal);
+	
 #if WITH_EDITOR
 	bool Value = EvaluateCondition();
 	LastEvaluation = Value;
@@ -43,6 +43,20 @@ void FYapConversation::RemoveRunningSpeech(FYapSpeechHandle FragmentHandle)
 
 // ------------------------------------------------------------------------------------------------
 
+void FYapConversation::AddOpenPrompt(const FYapPromptHandle& PromptHandle)
+{
+    OpenPrompts.Add(PromptHandle);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapConversation::ClearOpenPrompts()
+{
+    OpenPrompts.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void FYapConversation::StartOpening(UObject* Instigator)
 {
     bWantsToOpen = true;
@@ -72,6 +72,13 @@ FYapConversationHandle UYapConversationHandleBFL::AdvanceConversation(UObject* W
     return Handle;
 }
 
+FYapConversationHandle UYapConversationHandleBFL::SkipConversation(UObject* WorldContext, FYapConversationHandle Handle, EYapSkipTarget Target)
+{
+    UYapSubsystem::SkipConversation(WorldContext, Handle, Target);
+    
+    return Handle;
+}
+
 FYapConversationHandle UYapConversationHandleBFL::ApplyOpeningInterlock(FYapConversationHandle Handle, UObject* LockObject)
 {
     if (FYapConversation* Conversation = UYapSubsystem::GetConversationByHandle(LockObject, Handle))
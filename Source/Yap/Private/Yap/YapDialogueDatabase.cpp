@@ -0,0 +1,852 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapDialogueDatabase.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Internationalization/Culture.h"
+#include "Internationalization/Internationalization.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Yap/YapLog.h"
+#include "Yap/Enums/YapMaturitySetting.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+namespace Yap
+{
+	namespace DialogueDatabase
+	{
+	static int32 MaturityColumn(EYapMaturitySetting MaturitySetting)
+	{
+		return MaturitySetting == EYapMaturitySetting::ChildSafe ? 1 : 0;
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapDialogueDatabase::FYapDialogueDatabase()
+{
+}
+
+FYapDialogueDatabase::~FYapDialogueDatabase()
+{
+	Unload();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapDialogueDatabase& FYapDialogueDatabase::Get()
+{
+	static FYapDialogueDatabase Instance;
+	static bool bAttemptedLoad = false;
+
+	if (!bAttemptedLoad)
+	{
+		bAttemptedLoad = true;
+
+		if (FPaths::FileExists(GetDefaultPath()))
+		{
+			Instance.Load(GetDefaultPath());
+		}
+	}
+
+	return Instance;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapDialogueDatabase::GetDefaultPath()
+{
+	return FPaths::ProjectContentDir() / TEXT("Yap") / TEXT("DialogueDatabase.yapdb");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabase::Load(const FString& Path)
+{
+	Unload();
+
+	int64 Size = 0;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	MappedHandle.Reset(PlatformFile.OpenMapped(*Path));
+
+	if (MappedHandle.IsValid())
+	{
+		MappedRegion.Reset(MappedHandle->MapRegion());
+
+		if (MappedRegion.IsValid())
+		{
+			Data = MappedRegion->GetMappedPtr();
+			Size = MappedRegion->GetMappedSize();
+		}
+	}
+
+	if (!Data)
+	{
+		MappedRegion.Reset();
+		MappedHandle.Reset();
+
+		if (!FFileHelper::LoadFileToArray(Buffer, *Path))
+		{
+			UE_LOG(LogYap, Warning, TEXT("Could not read dialogue database <%s>"), *Path);
+			return false;
+		}
+
+		Data = Buffer.GetData();
+		Size = Buffer.Num();
+	}
+
+	if (!Validate(Size))
+	{
+		UE_LOG(LogYap, Error, TEXT("Dialogue database <%s> is corrupt or from a different version of Yap; rebuild it."), *Path);
+		Unload();
+		return false;
+	}
+
+	const FAssetRecord* Assets = GetSection<FAssetRecord>(ESection::Assets);
+
+	AssetLookup.Reserve(Header().NumAssets);
+
+	for (uint32 i = 0; i < Header().NumAssets; ++i)
+	{
+		AssetLookup.Add(FSoftObjectPath(GetStringAsFString(Assets[i].Path)), i);
+	}
+
+	CultureChangedHandle = FInternationalization::Get().OnCultureChanged().AddRaw(this, &FYapDialogueDatabase::OnCultureChanged);
+	OnCultureChanged();
+
+	UE_LOG(LogYap, Log, TEXT("Loaded dialogue database <%s>: %i fragments in %i assets, %i cultures (%s)"), *Path, Num(), AssetLookup.Num(), NumCultures(), MappedRegion.IsValid() ? TEXT("mapped") : TEXT("in memory"));
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueDatabase::Unload()
+{
+	if (CultureChangedHandle.IsValid() && FInternationalization::IsAvailable())
+	{
+		FInternationalization::Get().OnCultureChanged().Remove(CultureChangedHandle);
+	}
+
+	CultureChangedHandle.Reset();
+	CurrentCulture = INDEX_NONE;
+	Data = nullptr;
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	Buffer.Empty();
+	AssetLookup.Empty();
+
+#if WITH_EDITOR
+	EditedFragments.Empty();
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapDialogueDatabase::Num() const
+{
+	return IsLoaded() ? Header().NumFragments : 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapDialogueDatabase::FindFragment(const FGuid& FragmentGuid) const
+{
+	if (!IsLoaded() || !FragmentGuid.IsValid())
+	{
+		return INDEX_NONE;
+	}
+
+	const uint32 Mask = Header().NumIndexSlots - 1;
+	const uint32* Slots = GetSection<uint32>(ESection::GuidIndex);
+	const FGuid* Guids = GetSection<FGuid>(ESection::Guids);
+
+	// Slots hold fragment index + 1, zero is empty. The table is at most half full so probing is short.
+	for (uint32 Slot = HashGuid(FragmentGuid) & Mask; Slots[Slot] != 0; Slot = (Slot + 1) & Mask)
+	{
+		const uint32 Index = Slots[Slot] - 1;
+
+		if (Guids[Index] == FragmentGuid)
+		{
+#if WITH_EDITOR
+			if (EditedFragments.Contains(FragmentGuid))
+			{
+				return INDEX_NONE;
+			}
+#endif
+			return Index;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapDialogueDatabase::FindFragmentByID(FName FragmentID) const
+{
+	if (!IsLoaded() || FragmentID.IsNone())
+	{
+		return INDEX_NONE;
+	}
+
+	const FString LowerID = FragmentID.ToString().ToLower();
+	
+	const uint32 Mask = Header().NumIndexSlots - 1;
+	const uint32* Slots = GetSection<uint32>(ESection::IDIndex);
+	const uint32* IDs = GetSection<uint32>(ESection::FragmentIDs);
+
+	for (uint32 Slot = HashID(LowerID) & Mask; Slots[Slot] != 0; Slot = (Slot + 1) & Mask)
+	{
+		const uint32 Index = Slots[Slot] - 1;
+
+		if (GetStringAsFString(IDs[Index]).Equals(LowerID, ESearchCase::IgnoreCase))
+		{
+#if WITH_EDITOR
+			if (EditedFragments.Contains(GetSection<FGuid>(ESection::Guids)[Index]))
+			{
+				return INDEX_NONE;
+			}
+#endif
+			return Index;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FGuid FYapDialogueDatabase::GetFragmentGuid(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+	return GetSection<FGuid>(ESection::Guids)[Index];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FName FYapDialogueDatabase::GetFragmentID(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+	return FName(*GetStringAsFString(GetSection<uint32>(ESection::FragmentIDs)[Index]));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FName FYapDialogueDatabase::GetSpeakerID(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+	return FName(*GetStringAsFString(GetSection<uint32>(ESection::SpeakerIDs)[Index]));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FGameplayTag FYapDialogueDatabase::GetMoodTag(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+
+	const FString TagName = GetStringAsFString(GetSection<uint32>(ESection::MoodTags)[Index]);
+
+	if (TagName.IsEmpty())
+	{
+		return FGameplayTag::EmptyTag;
+	}
+
+	return FGameplayTag::RequestGameplayTag(FName(*TagName), false);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FText FYapDialogueDatabase::GetDialogueText(int32 Index, EYapMaturitySetting MaturitySetting) const
+{
+	check(Index >= 0 && Index < Num());
+
+	const int32 Cell = Yap::DialogueDatabase::MaturityColumn(MaturitySetting) * Num() + Index;
+
+	const FString Namespace = GetStringAsFString(GetSection<uint32>(ESection::TextNamespaces)[Cell]);
+	const FString Key = GetStringAsFString(GetSection<uint32>(ESection::TextKeys)[Cell]);
+	const FString Source = GetStringAsFString(GetSection<uint32>(ESection::TextSources)[Cell]);
+
+	if (!Key.IsEmpty())
+	{
+		FText Text = FText::FindTextInLiveTable_Advanced(Namespace, Key, &Source);
+
+		if (!Text.IsEmpty())
+		{
+			return Text;
+		}
+	}
+
+	return FText::FromString(Source);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+float FYapDialogueDatabase::GetSpeechTime(int32 Index, EYapMaturitySetting MaturitySetting) const
+{
+	check(Index >= 0 && Index < Num());
+	return GetSection<float>(ESection::SpeechTimes)[Yap::DialogueDatabase::MaturityColumn(MaturitySetting) * Num() + Index];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FSoftObjectPath FYapDialogueDatabase::GetAudioAsset(int32 Index, EYapMaturitySetting MaturitySetting) const
+{
+	check(Index >= 0 && Index < Num());
+	return FSoftObjectPath(GetStringAsFString(GetSection<uint32>(ESection::AudioAssets)[Yap::DialogueDatabase::MaturityColumn(MaturitySetting) * Num() + Index]));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FSoftObjectPath FYapDialogueDatabase::GetOwningAsset(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+
+	const FAssetRecord& Asset = GetSection<FAssetRecord>(ESection::Assets)[GetSection<uint32>(ESection::OwningAssets)[Index]];
+
+	return FSoftObjectPath(GetStringAsFString(Asset.Path));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FGuid FYapDialogueDatabase::GetNodeGuid(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+	return GetSection<FGuid>(ESection::NodeGuids)[Index];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+uint8 FYapDialogueDatabase::GetFragmentIndex(int32 Index) const
+{
+	check(Index >= 0 && Index < Num());
+	return GetSection<uint8>(ESection::FragmentIndices)[Index];
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapDialogueDatabase::NumCultures() const
+{
+	return IsLoaded() ? Header().NumCultures : 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapDialogueDatabase::GetCultureName(int32 CultureIndex) const
+{
+	check(CultureIndex >= 0 && CultureIndex < NumCultures());
+	return GetStringAsFString(GetSection<uint32>(ESection::Cultures)[CultureIndex]);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapDialogueDatabase::FindCulture(const FString& CultureName) const
+{
+	int32 ParentMatch = INDEX_NONE;
+
+	FString Language;
+	CultureName.Split(TEXT("-"), &Language, nullptr);
+
+	for (int32 i = 0; i < NumCultures(); ++i)
+	{
+		const FString Name = GetCultureName(i);
+
+		if (Name.Equals(CultureName, ESearchCase::IgnoreCase))
+		{
+			return i;
+		}
+
+		if (ParentMatch == INDEX_NONE && !Language.IsEmpty() && Name.Equals(Language, ESearchCase::IgnoreCase))
+		{
+			ParentMatch = i;
+		}
+	}
+
+	return ParentMatch;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabase::GetTextCounts(int32 Index, EYapMaturitySetting MaturitySetting, FYapTextCounts& OutCounts) const
+{
+	return GetTextCounts(Index, MaturitySetting, CurrentCulture, OutCounts);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapDialogueDatabase::GetCurrentCultureName() const
+{
+	return CurrentCulture != INDEX_NONE ? GetCultureName(CurrentCulture) : FString();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabase::GetTextCounts(int32 Index, EYapMaturitySetting MaturitySetting, int32 CultureIndex, FYapTextCounts& OutCounts) const
+{
+	if (CultureIndex < 0 || CultureIndex >= NumCultures())
+	{
+		return false;
+	}
+
+	check(Index >= 0 && Index < Num());
+
+	const int32 Column = Yap::DialogueDatabase::MaturityColumn(MaturitySetting);
+
+	OutCounts = GetSection<FYapTextCounts>(ESection::TextCounts)[(CultureIndex * 2 + Column) * Num() + Index];
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueDatabase::OnCultureChanged()
+{
+	CurrentCulture = FindCulture(FInternationalization::Get().GetCurrentLanguage()->GetName());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabase::GetAssetFragmentRange(const FSoftObjectPath& FlowAsset, int32& OutFirst, int32& OutNum) const
+{
+	const int32* AssetIndex = AssetLookup.Find(FlowAsset);
+
+	if (!AssetIndex)
+	{
+		return false;
+	}
+
+	const FAssetRecord& Asset = GetSection<FAssetRecord>(ESection::Assets)[*AssetIndex];
+
+	OutFirst = Asset.FirstFragment;
+	OutNum = Asset.NumFragments;
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FUtf8StringView FYapDialogueDatabase::GetString(uint32 StringIndex) const
+{
+	const uint32* Offsets = GetSection<uint32>(ESection::StringOffsets);
+	const UTF8CHAR* Chars = GetSection<UTF8CHAR>(ESection::StringData);
+
+	return FUtf8StringView(Chars + Offsets[StringIndex], Offsets[StringIndex + 1] - Offsets[StringIndex]);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapDialogueDatabase::GetStringAsFString(uint32 StringIndex) const
+{
+	FUtf8StringView View = GetString(StringIndex);
+
+	if (View.IsEmpty())
+	{
+		return FString();
+	}
+
+	FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(View.GetData()), View.Len());
+	return FString(Converted.Length(), Converted.Get());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueDatabase::Validate(int64 Size) const
+{
+	// Everything is read straight out of the file, so every section is bounds checked before anything reads from it
+	if (Size < static_cast<int64>(sizeof(FHeader)))
+	{
+		return false;
+	}
+
+	const FHeader& H = Header();
+
+	if (H.Magic != Magic || H.Version != Version)
+	{
+		return false;
+	}
+
+	if (H.NumIndexSlots == 0 || !FMath::IsPowerOfTwo(H.NumIndexSlots) || H.NumIndexSlots <= H.NumFragments || H.NumStrings == 0)
+	{
+		return false;
+	}
+
+	const uint64 N = H.NumFragments;
+
+	auto SectionFits = [&H, Size] (ESection Section, uint64 Count, uint64 Stride)
+	{
+		const uint64 Offset = H.SectionOffsets[static_cast<uint8>(Section)];
+
+		return Offset >= sizeof(FHeader) && Offset % 4 == 0 && Offset <= static_cast<uint64>(Size) && Count * Stride <= static_cast<uint64>(Size) - Offset;
+	};
+
+	const bool bSectionsFit =
+		SectionFits(ESection::Guids, N, sizeof(FGuid)) &&
+		SectionFits(ESection::FragmentIDs, N, sizeof(uint32)) &&
+		SectionFits(ESection::SpeakerIDs, N, sizeof(uint32)) &&
+		SectionFits(ESection::MoodTags, N, sizeof(uint32)) &&
+		SectionFits(ESection::TextNamespaces, 2 * N, sizeof(uint32)) &&
+		SectionFits(ESection::TextKeys, 2 * N, sizeof(uint32)) &&
+		SectionFits(ESection::TextSources, 2 * N, sizeof(uint32)) &&
+		SectionFits(ESection::SpeechTimes, 2 * N, sizeof(float)) &&
+		SectionFits(ESection::AudioAssets, 2 * N, sizeof(uint32)) &&
+		SectionFits(ESection::OwningAssets, N, sizeof(uint32)) &&
+		SectionFits(ESection::NodeGuids, N, sizeof(FGuid)) &&
+		SectionFits(ESection::FragmentIndices, N, sizeof(uint8)) &&
+		SectionFits(ESection::Assets, H.NumAssets, sizeof(FAssetRecord)) &&
+		SectionFits(ESection::GuidIndex, H.NumIndexSlots, sizeof(uint32)) &&
+		SectionFits(ESection::IDIndex, H.NumIndexSlots, sizeof(uint32)) &&
+		SectionFits(ESection::Cultures, H.NumCultures, sizeof(uint32)) &&
+		SectionFits(ESection::TextCounts, 2 * N * H.NumCultures, sizeof(FYapTextCounts)) &&
+		SectionFits(ESection::StringOffsets, static_cast<uint64>(H.NumStrings) + 1, sizeof(uint32));
+
+	if (!bSectionsFit)
+	{
+		return false;
+	}
+
+	// String offsets must be ordered and end inside the string data
+	const uint32* Offsets = GetSection<uint32>(ESection::StringOffsets);
+
+	for (uint32 i = 0; i < H.NumStrings; ++i)
+	{
+		if (Offsets[i] > Offsets[i + 1])
+		{
+			return false;
+		}
+	}
+
+	if (!SectionFits(ESection::StringData, Offsets[H.NumStrings], sizeof(UTF8CHAR)))
+	{
+		return false;
+	}
+
+	// Every reference into another table must be in range
+	auto StringsValid = [this, &H] (ESection Section, uint64 Count)
+	{
+		const uint32* Strings = GetSection<uint32>(Section);
+
+		for (uint64 i = 0; i < Count; ++i)
+		{
+			if (Strings[i] >= H.NumStrings)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	const bool bStringsValid =
+		StringsValid(ESection::FragmentIDs, N) &&
+		StringsValid(ESection::SpeakerIDs, N) &&
+		StringsValid(ESection::MoodTags, N) &&
+		StringsValid(ESection::TextNamespaces, 2 * N) &&
+		StringsValid(ESection::TextKeys, 2 * N) &&
+		StringsValid(ESection::TextSources, 2 * N) &&
+		StringsValid(ESection::AudioAssets, 2 * N) &&
+		StringsValid(ESection::Cultures, H.NumCultures);
+
+	if (!bStringsValid)
+	{
+		return false;
+	}
+
+	const FAssetRecord* Assets = GetSection<FAssetRecord>(ESection::Assets);
+
+	for (uint32 i = 0; i < H.NumAssets; ++i)
+	{
+		if (Assets[i].Path >= H.NumStrings || static_cast<uint64>(Assets[i].FirstFragment) + Assets[i].NumFragments > N)
+		{
+			return false;
+		}
+	}
+
+	const uint32* OwningAssets = GetSection<uint32>(ESection::OwningAssets);
+
+	for (uint64 i = 0; i < N; ++i)
+	{
+		if (OwningAssets[i] >= H.NumAssets)
+		{
+			return false;
+		}
+	}
+
+	// Slots hold fragment index + 1; lookups probe until an empty slot, so there must be one
+	for (ESection IndexSection : { ESection::GuidIndex, ESection::IDIndex })
+	{
+		const uint32* Slots = GetSection<uint32>(IndexSection);
+
+		bool bHasEmptySlot = false;
+
+		for (uint32 i = 0; i < H.NumIndexSlots; ++i)
+		{
+			if (Slots[i] > N)
+			{
+				return false;
+			}
+
+			bHasEmptySlot |= (Slots[i] == 0);
+		}
+
+		if (!bHasEmptySlot)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if WITH_EDITOR
+bool FYapDialogueDatabase::Write(const FString& Path, TArray<FYapDialogueDatabaseEntry> Entries, const TArray<FString>& Cultures)
+{
+	// Group fragments by asset so each asset's lines are one contiguous range
+	Entries.StableSort([] (const FYapDialogueDatabaseEntry& A, const FYapDialogueDatabaseEntry& B)
+	{
+		return A.OwningAsset.ToString() < B.OwningAsset.ToString();
+	});
+
+	const uint32 N = Entries.Num();
+
+	// String table; index 0 is always the empty string
+	TArray<FString> Strings = { FString() };
+	TMap<FString, uint32> StringIndices = { { FString(), 0 } };
+
+	auto AddString = [&Strings, &StringIndices] (const FString& String) -> uint32
+	{
+		if (const uint32* Existing = StringIndices.Find(String))
+		{
+			return *Existing;
+		}
+
+		uint32 NewIndex = Strings.Add(String);
+		StringIndices.Add(String, NewIndex);
+		return NewIndex;
+	};
+
+	TArray<FGuid> Guids;
+	TArray<uint32> FragmentIDs;
+	TArray<uint32> SpeakerIDs;
+	TArray<uint32> MoodTags;
+	TArray<uint32> TextNamespaces;
+	TArray<uint32> TextKeys;
+	TArray<uint32> TextSources;
+	TArray<float> SpeechTimes;
+	TArray<uint32> AudioAssets;
+	TArray<uint32> OwningAssets;
+	TArray<FGuid> NodeGuids;
+	TArray<uint8> FragmentIndices;
+	TArray<FAssetRecord> Assets;
+
+	Guids.Reserve(N);
+	FragmentIDs.Reserve(N);
+	SpeakerIDs.Reserve(N);
+	MoodTags.Reserve(N);
+	TextNamespaces.SetNumZeroed(2 * N);
+	TextKeys.SetNumZeroed(2 * N);
+	TextSources.SetNumZeroed(2 * N);
+	SpeechTimes.SetNumZeroed(2 * N);
+	AudioAssets.SetNumZeroed(2 * N);
+	OwningAssets.Reserve(N);
+	NodeGuids.Reserve(N);
+	FragmentIndices.Reserve(N);
+
+	for (uint32 i = 0; i < N; ++i)
+	{
+		const FYapDialogueDatabaseEntry& Entry = Entries[i];
+
+		Guids.Add(Entry.FragmentGuid);
+		FragmentIDs.Add(AddString(Entry.FragmentID.IsNone() ? FString() : Entry.FragmentID.ToString()));
+		SpeakerIDs.Add(AddString(Entry.SpeakerID.IsNone() ? FString() : Entry.SpeakerID.ToString()));
+		MoodTags.Add(AddString(Entry.MoodTag.IsNone() ? FString() : Entry.MoodTag.ToString()));
+
+		for (int32 Column = 0; Column < 2; ++Column)
+		{
+			const uint32 Cell = Column * N + i;
+
+			TextNamespaces[Cell] = AddString(Entry.TextNamespace[Column]);
+			TextKeys[Cell] = AddString(Entry.TextKey[Column]);
+			TextSources[Cell] = AddString(Entry.TextSource[Column]);
+			SpeechTimes[Cell] = Entry.SpeechTime[Column];
+			AudioAssets[Cell] = AddString(Entry.AudioAsset[Column].ToString());
+		}
+
+		const uint32 AssetPath = AddString(Entry.OwningAsset.ToString());
+
+		if (Assets.Num() == 0 || Assets.Last().Path != AssetPath)
+		{
+			Assets.Add({ AssetPath, i, 0 });
+		}
+
+		++Assets.Last().NumFragments;
+
+		OwningAssets.Add(Assets.Num() - 1);
+		NodeGuids.Add(Entry.NodeGuid);
+		FragmentIndices.Add(Entry.FragmentIndex);
+	}
+
+	// Text counts, one [culture][maturity] block of N at a time
+	TArray<uint32> CultureNames;
+	TArray<FYapTextCounts> TextCounts;
+	TextCounts.SetNumZeroed(Cultures.Num() * 2 * N);
+
+	for (int32 Culture = 0; Culture < Cultures.Num(); ++Culture)
+	{
+		CultureNames.Add(AddString(Cultures[Culture]));
+
+		for (uint32 i = 0; i < N; ++i)
+		{
+			const TArray<FYapTextCounts>& EntryCounts = Entries[i].TextCounts;
+
+			for (int32 Column = 0; Column < 2; ++Column)
+			{
+				if (EntryCounts.IsValidIndex(Culture * 2 + Column))
+				{
+					TextCounts[(Culture * 2 + Column) * N + i] = EntryCounts[Culture * 2 + Column];
+				}
+			}
+		}
+	}
+
+	// GUID index, kept at most half full
+	const uint32 NumIndexSlots = FMath::RoundUpToPowerOfTwo(FMath::Max(2 * N, 16u));
+	TArray<uint32> Slots;
+	Slots.SetNumZeroed(NumIndexSlots);
+
+	for (uint32 i = 0; i < N; ++i)
+	{
+		if (!Guids[i].IsValid())
+		{
+			continue;
+		}
+
+		uint32 Slot = HashGuid(Guids[i]) & (NumIndexSlots - 1);
+
+		while (Slots[Slot] != 0)
+		{
+			if (Guids[Slots[Slot] - 1] == Guids[i])
+			{
+				UE_LOG(LogYap, Warning, TEXT("Duplicate fragment GUID {%s} in <%s>, only the first occurrence will be indexed"), *Guids[i].ToString(), *Entries[i].OwningAsset.ToString());
+				break;
+			}
+
+			Slot = (Slot + 1) & (NumIndexSlots - 1);
+		}
+
+		if (Slots[Slot] == 0)
+		{
+			Slots[Slot] = i + 1;
+		}
+	}
+
+	// Fragment ID index, same sizing as the GUID index
+	TArray<uint32> IDSlots;
+	IDSlots.SetNumZeroed(NumIndexSlots);
+
+	for (uint32 i = 0; i < N; ++i)
+	{
+		if (Entries[i].FragmentID.IsNone())
+		{
+			continue;
+		}
+
+		const FString LowerID = Entries[i].FragmentID.ToString().ToLower();
+		
+		uint32 Slot = HashID(LowerID) & (NumIndexSlots - 1);
+
+		while (IDSlots[Slot] != 0)
+		{
+			if (Entries[IDSlots[Slot] - 1].FragmentID == Entries[i].FragmentID)
+			{
+				UE_LOG(LogYap, Warning, TEXT("Duplicate fragment ID [%s] in <%s>, only the first occurrence will be indexed"), *Entries[i].FragmentID.ToString(), *Entries[i].OwningAsset.ToString());
+				break;
+			}
+
+			Slot = (Slot + 1) & (NumIndexSlots - 1);
+		}
+
+		if (IDSlots[Slot] == 0)
+		{
+			IDSlots[Slot] = i + 1;
+		}
+	}
+	
+	// Flatten strings
+	TArray<uint32> StringOffsets;
+	TArray<UTF8CHAR> StringData;
+	StringOffsets.Reserve(Strings.Num() + 1);
+
+	for (const FString& String : Strings)
+	{
+		StringOffsets.Add(StringData.Num());
+
+		FTCHARToUTF8 Converted(*String, String.Len());
+		StringData.Append(reinterpret_cast<const UTF8CHAR*>(Converted.Get()), Converted.Length());
+	}
+
+	StringOffsets.Add(StringData.Num());
+
+	// Write everything out, each section aligned to 16 bytes
+	FHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = Magic;
+	Header.Version = Version;
+	Header.NumFragments = N;
+	Header.NumAssets = Assets.Num();
+	Header.NumStrings = Strings.Num();
+	Header.NumIndexSlots = NumIndexSlots;
+	Header.NumCultures = Cultures.Num();
+
+	TArray64<uint8> Out;
+	Out.AddZeroed(sizeof(FHeader));
+
+	auto WriteSection = [&Out, &Header] (ESection Section, const void* Src, int64 NumBytes)
+	{
+		Out.AddZeroed(Align(Out.Num(), 16) - Out.Num());
+		Header.SectionOffsets[static_cast<uint8>(Section)] = Out.Num();
+		Out.Append(static_cast<const uint8*>(Src), NumBytes);
+	};
+
+	WriteSection(ESection::Guids, Guids.GetData(), Guids.Num() * sizeof(FGuid));
+	WriteSection(ESection::FragmentIDs, FragmentIDs.GetData(), FragmentIDs.Num() * sizeof(uint32));
+	WriteSection(ESection::SpeakerIDs, SpeakerIDs.GetData(), SpeakerIDs.Num() * sizeof(uint32));
+	WriteSection(ESection::MoodTags, MoodTags.GetData(), MoodTags.Num() * sizeof(uint32));
+	WriteSection(ESection::TextNamespaces, TextNamespaces.GetData(), TextNamespaces.Num() * sizeof(uint32));
+	WriteSection(ESection::TextKeys, TextKeys.GetData(), TextKeys.Num() * sizeof(uint32));
+	WriteSection(ESection::TextSources, TextSources.GetData(), TextSources.Num() * sizeof(uint32));
+	WriteSection(ESection::SpeechTimes, SpeechTimes.GetData(), SpeechTimes.Num() * sizeof(float));
+	WriteSection(ESection::AudioAssets, AudioAssets.GetData(), AudioAssets.Num() * sizeof(uint32));
+	WriteSection(ESection::OwningAssets, OwningAssets.GetData(), OwningAssets.Num() * sizeof(uint32));
+	WriteSection(ESection::NodeGuids, NodeGuids.GetData(), NodeGuids.Num() * sizeof(FGuid));
+	WriteSection(ESection::FragmentIndices, FragmentIndices.GetData(), FragmentIndices.Num() * sizeof(uint8));
+	WriteSection(ESection::Assets, Assets.GetData(), Assets.Num() * sizeof(FAssetRecord));
+	WriteSection(ESection::GuidIndex, Slots.GetData(), Slots.Num() * sizeof(uint32));
+	WriteSection(ESection::IDIndex, IDSlots.GetData(), IDSlots.Num() * sizeof(uint32));
+	WriteSection(ESection::Cultures, CultureNames.GetData(), CultureNames.Num() * sizeof(uint32));
+	WriteSection(ESection::TextCounts, TextCounts.GetData(), TextCounts.Num() * sizeof(FYapTextCounts));
+	WriteSection(ESection::StringOffsets, StringOffsets.GetData(), StringOffsets.Num() * sizeof(uint32));
+	WriteSection(ESection::StringData, StringData.GetData(), StringData.Num() * sizeof(UTF8CHAR));
+
+	FMemory::Memcpy(Out.GetData(), &Header, sizeof(FHeader));
+
+	if (!FFileHelper::SaveArrayToFile(Out, *Path))
+	{
+		UE_LOG(LogYap, Error, TEXT("Failed to write dialogue database <%s>"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogYap, Display, TEXT("Wrote dialogue database <%s>: %i fragments, %i assets, %i cultures, %i strings, %lld bytes"), *Path, N, Assets.Num(), Cultures.Num(), Strings.Num(), Out.Num());
+
+	return true;
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,16 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapDialogueStateSubsystem.h"
+
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+
+FYapDialogueSaveState* UYapDialogueStateSubsystem::Find(const UWorld* World)
+{
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+
+	UYapDialogueStateSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UYapDialogueStateSubsystem>() : nullptr;
+
+	return Subsystem ? &Subsystem->SaveState : nullptr;
+}
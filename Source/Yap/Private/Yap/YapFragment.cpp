@@ -5,8 +5,11 @@
 
 #include "Yap/YapCharacterAsset.h"
 #include "Yap/YapCondition.h"
+#include "Yap/YapDialogueDatabase.h"
+#include "Yap/YapFragmentOverlay.h"
 #include "Yap/YapStreamableManager.h"
 #include "Yap/YapSubsystem.h"
+#include "Yap/YapTrace.h"
 #include "Yap/Enums/YapLoadContext.h"
 #include "Yap/Enums/YapAudioPriority.h"
 
@@ -17,6 +20,7 @@
 
 #if WITH_EDITOR
 #include "Yap/YapProjectSettings.h"
+#include "Serialization/ObjectWriter.h"
 #endif
 
 #define LOCTEXT_NAMESPACE "Yap"
@@ -27,14 +31,124 @@ FYapFragment::FYapFragment()
 	TimeMode = EYapTimeMode::Default;
 }
 
-bool FYapFragment::CanRun() const
+bool FYapFragment::Serialize(FArchive& Ar)
 {
-	return CheckActivationLimit() && CheckConditions();
+#if WITH_EDITOR
+	if (Ar.IsSaving() && Ar.IsCooking())
+	{
+		FYapFragment CookedFragment = MakeCookedCopy(UYapProjectSettings::GetCookedMaturity(Ar.CookingTarget()));
+		
+		SerializeAgainstDefaults(Ar, CookedFragment);
+		
+		return true;
+	}
+#endif
+
+	// Fall back to normal tagged property serialization
+	return false;
+}
+
+#if WITH_EDITOR
+FYapFragment FYapFragment::MakeCookedCopy(EYapMaturitySetting CookedMaturity) const
+{
+	FYapFragment CookedFragment = *this;
+
+	if (bEnableChildSafe && CookedMaturity != EYapMaturitySetting::Unspecified)
+	{
+		// Keep the one bit this build can show in the mature slot; with child-safe data disabled, every maturity setting resolves to it at runtime
+		if (CookedMaturity == EYapMaturitySetting::ChildSafe)
+		{
+			CookedFragment.MatureBit = ChildSafeBit;
+		}
+
+		const FYapBit& KeptBit = CookedFragment.MatureBit;
+
+		if (!KeptBit.HasDialogueText() && !KeptBit.HasAudioAsset())
+		{
+			UE_LOG(LogYap, Warning, TEXT("Fragment {%s} has no %s text or audio; it will be empty in this build"), *Guid.ToString(),
+				CookedMaturity == EYapMaturitySetting::ChildSafe ? TEXT("child-safe") : TEXT("mature"));
+		}
+		
+		CookedFragment.bEnableChildSafe = false;
+	}
+	
+	if (!CookedFragment.bEnableChildSafe)
+	{
+		CookedFragment.ChildSafeBit = FYapBit();
+	}
+
+	CookedFragment.PromptPin = FFlowPin();
+	CookedFragment.StartPin = FFlowPin();
+	CookedFragment.EndPin = FFlowPin();
+
+	return CookedFragment;
+}
+
+FSoftObjectPath FYapFragment::GetStrippedAudioAsset(EYapMaturitySetting CookedMaturity) const
+{
+	// Same choice of bits as MakeCookedCopy
+	const FYapBit* KeptBit = &MatureBit;
+	const FYapBit* StrippedBit = &ChildSafeBit;
+
+	if (bEnableChildSafe)
+	{
+		if (CookedMaturity == EYapMaturitySetting::Unspecified)
+		{
+			return FSoftObjectPath();
+		}
+		
+		if (CookedMaturity == EYapMaturitySetting::ChildSafe)
+		{
+			Swap(KeptBit, StrippedBit);
+		}
+	}
+
+	const FSoftObjectPath StrippedAudio = StrippedBit->GetDialogueAudioAsset_SoftPtr<UObject>().ToSoftObjectPath();
+
+	return StrippedAudio == KeptBit->GetDialogueAudioAsset_SoftPtr<UObject>().ToSoftObjectPath() ? FSoftObjectPath() : StrippedAudio;
+}
+
+void FYapFragment::MeasureSerializedSize(int64& OutEditorBytes, int64& OutCookedBytes) const
+{
+	// Both sides are written the same way, so the difference is only what MakeCookedCopy removes
+	TArray<uint8> EditorBytes;
+	FObjectWriter EditorWriter(EditorBytes);
+	FYapFragment EditorFragment = *this;
+	SerializeAgainstDefaults(EditorWriter, EditorFragment);
+	OutEditorBytes = EditorBytes.Num();
+	
+	TArray<uint8> CookedBytes;
+	FObjectWriter CookedWriter(CookedBytes);
+	CookedWriter.SetFilterEditorOnly(true);
+	FYapFragment CookedFragment = MakeCookedCopy();
+	SerializeAgainstDefaults(CookedWriter, CookedFragment);
+	OutCookedBytes = CookedBytes.Num();
+}
+
+void FYapFragment::SerializeAgainstDefaults(FArchive& Ar, FYapFragment& Fragment)
+{
+	// Loading constructs elements with FYapFragment(), so anything equal to a default fragment can be left out. The GUID always differs, so it is always written.
+	static FYapFragment Defaults;
+	
+	StaticStruct()->SerializeTaggedProperties(Ar, reinterpret_cast<uint8*>(&Fragment), StaticStruct(), reinterpret_cast<uint8*>(&Defaults));
+}
+#endif
+
+bool FYapFragment::CanRun(const FYapFragmentRunState& RunState) const
+{
+	return CheckActivationLimit(RunState.ActivationCount) && CheckConditions(RunState.Conditions);
 }
 
 bool FYapFragment::CheckConditions() const
 {
-	for (TObjectPtr<UYapCondition> Condition : Conditions)
+	return CheckConditions(Conditions);
+}
+
+bool FYapFragment::CheckConditions(const TArray<TObjectPtr<UYapCondition>>& InConditions)
+{
+	YAP_TRACE_SCOPE(FYapFragment::CheckConditions);
+	
+	for (TObjectPtr<UYapCondition> Condition : InConditions)
 	{
 		if (!IsValid(Condition))
 		{
@@ -57,35 +171,51 @@ void FYapFragment::ResetOptionalPins()
 	bShowOnEndPin = false;
 }
 
-void FYapFragment::PreloadContent(UWorld* World, EYapMaturitySetting MaturitySetting, EYapLoadContext LoadContext)
+void FYapFragment::PreloadContent(UWorld* World, EYapMaturitySetting MaturitySetting, EYapLoadContext LoadContext, FYapFragmentRunState& RunState) const
 {
+	YAP_TRACE_SCOPE(FYapFragment::PreloadContent);
+
+	// Nothing will be shown or played, and speech times come from the dialogue database
+	if (UYapProjectSettings::IsTimingOnly(World))
+	{
+		return;
+	}
+	
 	ResolveMaturitySetting(World, MaturitySetting);
 
 	// TODO: somehow, a flow graph should be able to work with "self" as the speaker, to make it possible to code flows for dynamic NPCs/dynamic speakers
 #if WITH_EDITOR
 	if (World && GEditor && GEditor->IsPlaySessionInProgress())
 	{
-		SpeakerHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(Speaker.GetTagName());
-		DirectedAtHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(DirectedAt.GetTagName());
+		RunState.SpeakerHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(Speaker.GetTagName());
+		RunState.DirectedAtHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(DirectedAt.GetTagName());
 	}
 	else if (GEditor)
 	{
-		UYapProjectSettings::FindCharacter(Speaker, SpeakerHandle, EYapLoadContext::AsyncEditorOnly);
-		UYapProjectSettings::FindCharacter(DirectedAt, DirectedAtHandle, EYapLoadContext::AsyncEditorOnly);
+		UYapProjectSettings::FindCharacter(Speaker, RunState.SpeakerHandle, EYapLoadContext::AsyncEditorOnly);
+		UYapProjectSettings::FindCharacter(DirectedAt, RunState.DirectedAtHandle, EYapLoadContext::AsyncEditorOnly);
 	}
 #else
-	SpeakerHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(Speaker.GetTagName());
-	DirectedAtHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(DirectedAt.GetTagName());
+	RunState.SpeakerHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(Speaker.GetTagName());
+	RunState.DirectedAtHandle = UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(DirectedAt.GetTagName());
 #endif
-	
-	if (MaturitySetting == EYapMaturitySetting::ChildSafe && bEnableChildSafe)
-	{
-		ChildSafeBit.LoadContent(LoadContext);
-	}
-	else
+
+	// Replacement characters started loading when the patch was set
+	if (const FYapFragmentPatch* Patch = FindPatch(World))
 	{
-		MatureBit.LoadContent(LoadContext);
+		if (Patch->Replacement.SpeakerAsset.IsSet())
+		{
+			RunState.SpeakerHandle = Patch->SpeakerHandle;
+		}
+
+		if (Patch->Replacement.DirectedAtAsset.IsSet())
+		{
+			RunState.DirectedAtHandle = Patch->DirectedAtHandle;
+		}
 	}
+	
+	// Through GetBit, so a replaced line preloads its replacement audio
+	GetBit(World, MaturitySetting).LoadContent(LoadContext);
 }
 
 const FGameplayTag& FYapFragment::GetSpeakerTag() const
@@ -98,15 +228,22 @@ const FGameplayTag& FYapFragment::GetDirectedAtTag() const
 	return DirectedAt;
 }
 
-const TScriptInterface<IYapCharacterInterface> FYapFragment::GetSpeakerCharacter(UWorld* World, EYapLoadContext LoadContext)
+const TScriptInterface<IYapCharacterInterface> FYapFragment::GetSpeakerCharacter(UWorld* World, EYapLoadContext LoadContext) const
 {
-	return GetCharacter_Internal(World, Speaker, SpeakerHandle, LoadContext);
+	if (const FYapFragmentPatch* Patch = FindPatch(World); Patch && Patch->Replacement.SpeakerAsset.IsSet())
+	{
+		return Patch->GetSpeaker(World, LoadContext);
+	}
+	
+	return GetCharacter_Internal(World, Speaker, LoadContext);
 }
 
+#if WITH_EDITOR
 bool FYapFragment::HasDeprecatedSpeakerAsset()
 {
 	return !SpeakerAsset.IsNull();
 }
+#endif
 
 bool FYapFragment::HasSpeakerAssigned()
 {
@@ -126,13 +263,20 @@ const TSoftObjectPtr<const UObject> FYapFragment::GetCharacterAsset(UWorld* Worl
 }
 */
 
-const TScriptInterface<IYapCharacterInterface> FYapFragment::GetDirectedAt(UWorld* World, EYapLoadContext LoadContext)
+const TScriptInterface<IYapCharacterInterface> FYapFragment::GetDirectedAt(UWorld* World, EYapLoadContext LoadContext) const
 {
-	return GetCharacter_Internal(World, DirectedAt, DirectedAtHandle, LoadContext);
+	if (const FYapFragmentPatch* Patch = FindPatch(World); Patch && Patch->Replacement.DirectedAtAsset.IsSet())
+	{
+		return Patch->GetDirectedAt(World, LoadContext);
+	}
+	
+	return GetCharacter_Internal(World, DirectedAt, LoadContext);
 }
 
-const TScriptInterface<IYapCharacterInterface> FYapFragment::GetCharacter_Internal(UWorld* World, const FGameplayTag& CharacterTag, TSharedPtr<FStreamableHandle>& Handle, EYapLoadContext LoadContext)
+const TScriptInterface<IYapCharacterInterface> FYapFragment::GetCharacter_Internal(UWorld* World, const FGameplayTag& CharacterTag, EYapLoadContext LoadContext) const
 {
+	YAP_TRACE_SCOPE(FYapFragment::GetCharacter_Internal);
+	
 	if (!CharacterTag.IsValid())
 	{
 		return nullptr;
@@ -144,7 +288,7 @@ const TScriptInterface<IYapCharacterInterface> FYapFragment::GetCharacter_Intern
 const FText& FYapFragment::GetDialogueText(UWorld* World, EYapMaturitySetting MaturitySetting) const
 {
 	const FYapBit& Preferredbit = GetBit(World, MaturitySetting);
-	const FYapBit& SecondaryBit = MatureBit; // Always fall back to the mature bit. Never fall back to the child-safe bit.
+	const FYapBit& SecondaryBit = GetBit(World, EYapMaturitySetting::Mature); // Always fall back to the mature bit. Never fall back to the child-safe bit.
 
 	if (Preferredbit.HasDialogueText())
 	{
@@ -157,7 +301,7 @@ const FText& FYapFragment::GetDialogueText(UWorld* World, EYapMaturitySetting Ma
 const FText& FYapFragment::GetTitleText(UWorld* World, EYapMaturitySetting MaturitySetting) const
 {
 	const FYapBit& Preferredbit = GetBit(World, MaturitySetting);
-	const FYapBit& SecondaryBit = MatureBit; // Always fall back to the mature bit. Never fall back to the child-safe bit.
+	const FYapBit& SecondaryBit = GetBit(World, EYapMaturitySetting::Mature); // Always fall back to the mature bit. Never fall back to the child-safe bit.
 
 	if (Preferredbit.HasTitleText())
 	{
@@ -170,7 +314,7 @@ const FText& FYapFragment::GetTitleText(UWorld* World, EYapMaturitySetting Matur
 const UObject* FYapFragment::GetAudioAsset(UWorld* World, EYapMaturitySetting MaturitySetting) const
 {
 	const FYapBit& Preferredbit = GetBit(World, MaturitySetting);
-	const FYapBit& SecondaryBit = MatureBit; // Always fall back to the mature bit. Never fall back to the child-safe bit.
+	const FYapBit& SecondaryBit = GetBit(World, EYapMaturitySetting::Mature); // Always fall back to the mature bit. Never fall back to the child-safe bit.
 
 	if (Preferredbit.HasAudioAsset())
 	{
@@ -189,32 +333,42 @@ const FYapBit& FYapFragment::GetBit(UWorld* World, EYapMaturitySetting MaturityS
 {
 	ResolveMaturitySetting(World, MaturitySetting);
 
-	if (MaturitySetting == EYapMaturitySetting::ChildSafe)
+	const FYapBit& SourceBit = (MaturitySetting == EYapMaturitySetting::ChildSafe) ? ChildSafeBit : MatureBit;
+
+	if (const FYapFragmentPatch* Patch = FindPatch(World))
 	{
-		return ChildSafeBit;
+		return Patch->GetBit(SourceBit, MaturitySetting);
 	}
 	
-	return MatureBit;
+	return SourceBit;
 }
 
-TOptional<float> FYapFragment::GetSpeechTime(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const
+const FYapFragmentPatch* FYapFragment::FindPatch(UWorld* World) const
 {
-	return GetSpeechTime(World, MaturitySetting, EYapLoadContext::Sync, NodeConfig);
-}
+	// Nothing is patched in the vast majority of frames; skip the subsystem lookup
+	if (!FYapFragmentOverlay::HasAnyPatches() || !World)
+	{
+		return nullptr;
+	}
 
-bool FYapFragment::IsAwaitingManualAdvance() const
-{
-	return bFragmentAwaitingManualAdvance;
+	const UYapSubsystem* Subsystem = World->GetSubsystem<UYapSubsystem>();
+
+	return Subsystem ? Subsystem->GetFragmentOverlay().Find(*this) : nullptr;
 }
 
-void FYapFragment::SetAwaitingManualAdvance()
+FGameplayTag FYapFragment::GetMoodTag(UWorld* World) const
 {
-	bFragmentAwaitingManualAdvance = true;
+	if (const FYapFragmentPatch* Patch = FindPatch(World); Patch && Patch->Replacement.MoodTag.IsSet())
+	{
+		return Patch->Replacement.MoodTag.GetValue();
+	}
+
+	return MoodTag;
 }
 
-void FYapFragment::ClearAwaitingManualAdvance()
+TOptional<float> FYapFragment::GetSpeechTime(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const
 {
-	bFragmentAwaitingManualAdvance = false;
+	return GetSpeechTime(World, MaturitySetting, EYapLoadContext::Sync, NodeConfig);
 }
 
 TOptional<float> FYapFragment::GetSpeechTime(UWorld* World, EYapMaturitySetting MaturitySetting, EYapLoadContext LoadContext, const UYapNodeConfig& NodeConfig) const
@@ -225,8 +379,52 @@ TOptional<float> FYapFragment::GetSpeechTime(UWorld* World, EYapMaturitySetting
 	{
 		return NullOpt;
 	}
+
+	// The database holds the fragment as authored; replaced lines are timed from their replacement instead
+	const bool bPatched = FindPatch(World) != nullptr;
+	
+	// Timing-only worlds use the precomputed speech time rather than loading audio to measure it
+	if (UYapProjectSettings::IsTimingOnly(World) && !bPatched)
+	{
+		const FYapDialogueDatabase& Database = FYapDialogueDatabase::Get();
+		const int32 DatabaseIndex = Database.FindFragment(Guid);
+
+		if (DatabaseIndex != INDEX_NONE)
+		{
+			ResolveMaturitySetting(World, MaturitySetting);
+			const float SpeechTime = Database.GetSpeechTime(DatabaseIndex, MaturitySetting);
+			
+			return SpeechTime >= 0.0f ? TOptional<float>(SpeechTime) : NullOpt;
+		}
+
+		static bool bWarnedMissingEntry = false;
+
+		if (!bWarnedMissingEntry)
+		{
+			UE_LOG(LogYap, Warning, TEXT("Fragment {%s} is not in the dialogue database; timing-only dialogue will load content to time it. Rebuild the dialogue database."), *Guid.ToString());
+			bWarnedMissingEntry = true;
+		}
+	}
+
+	// The word count saved with the fragment is of the source text; in a cooked game, time the line by the current culture's translation instead. Replaced lines use their replacement text's own count.
+	FYapTextCounts TextCounts;
+	FString TextCulture;
+	bool bHasTextCounts = false;
 	
-	return GetBit(World, MaturitySetting).GetSpeechTime(World, EffectiveTimeMode, LoadContext, NodeConfig);
+	if (EffectiveTimeMode == EYapTimeMode::TextTime && !GIsEditor && !bPatched)
+	{
+		const FYapDialogueDatabase& Database = FYapDialogueDatabase::Get();
+		const int32 DatabaseIndex = Database.FindFragment(Guid);
+
+		if (DatabaseIndex != INDEX_NONE)
+		{
+			ResolveMaturitySetting(World, MaturitySetting);
+			bHasTextCounts = Database.GetTextCounts(DatabaseIndex, MaturitySetting, TextCounts);
+			TextCulture = Database.GetCurrentCultureName();
+		}
+	}
+	
+	return GetBit(World, MaturitySetting).GetSpeechTime(World, EffectiveTimeMode, LoadContext, NodeConfig, bHasTextCounts ? &TextCounts : nullptr, TextCulture);
 }
 
 float FYapFragment::GetPaddingValue(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const
@@ -273,11 +471,6 @@ float FYapFragment::GetProgressionTime(UWorld* World, EYapMaturitySetting Maturi
 	return FMath::Max(SpeechTime + PaddingTime, 0.0f);
 }
 
-void FYapFragment::IncrementActivations()
-{
-	ActivationCount++;
-}
-
 /*
 void FYapFragment::ReplaceBit(EYapMaturitySetting MaturitySetting, const FYapBitReplacement& ReplacementBit)
 {
@@ -288,38 +481,42 @@ void FYapFragment::ReplaceBit(EYapMaturitySetting MaturitySetting, const FYapBit
 
 FFlowPin FYapFragment::GetPromptPin() const
 {
-	if (!PromptPin.IsValid())
+	// Cooked fragments don't store their pins (see MakeCookedCopy); they are rebuilt from the GUID without writing to the fragment, which may be shared
+	if (PromptPin.IsValid())
 	{
-		FYapFragment* MutableThis = const_cast<FYapFragment*>(this);
-		MutableThis->PromptPin = FName("Prompt_" + Guid.ToString());
-		MutableThis->PromptPin.PinToolTip = "Out";
+		return PromptPin;
 	}
+
+	FFlowPin Pin(FName("Prompt_" + Guid.ToString()));
+	Pin.PinToolTip = "Out";
 	
-	return PromptPin;
+	return Pin;
 }
 
 FFlowPin FYapFragment::GetEndPin() const
 {
-	if (!EndPin.IsValid())
+	if (EndPin.IsValid())
 	{
-		FYapFragment* MutableThis = const_cast<FYapFragment*>(this);
-		MutableThis->EndPin = FName("End_" + Guid.ToString());
-		MutableThis->PromptPin.PinToolTip = "Runs before end-padding time begins";
+		return EndPin;
 	}
+
+	FFlowPin Pin(FName("End_" + Guid.ToString()));
+	Pin.PinToolTip = "Runs before end-padding time begins";
 	
-	return EndPin;
+	return Pin;
 }
 
 FFlowPin FYapFragment::GetStartPin() const
 {
-	if (!StartPin.IsValid())
+	if (StartPin.IsValid())
 	{
-		FYapFragment* MutableThis = const_cast<FYapFragment*>(this);
-		MutableThis->StartPin = FName("Start_" + Guid.ToString());
-		MutableThis->StartPin.PinToolTip = "Runs when fragment starts playback";
+		return StartPin;
 	}
+
+	FFlowPin Pin(FName("Start_" + Guid.ToString()));
+	Pin.PinToolTip = "Runs when fragment starts playback";
 	
-	return StartPin;
+	return Pin;
 }
 
 void FYapFragment::ResolveMaturitySetting(UWorld* World, EYapMaturitySetting& MaturitySetting) const
@@ -369,7 +566,14 @@ EYapTimeMode FYapFragment::GetTimeMode(UWorld* World, const UYapNodeConfig& Node
 
 EYapTimeMode FYapFragment::GetTimeMode(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const
 {
-	EYapTimeMode EffectiveTimeMode = (TimeMode == EYapTimeMode::Default) ? NodeConfig.GetDefaultTimeModeSetting() : TimeMode;
+	EYapTimeMode FragmentTimeMode = TimeMode;
+
+	if (const FYapFragmentPatch* Patch = FindPatch(World); Patch && Patch->Replacement.TimeMode.IsSet())
+	{
+		FragmentTimeMode = Patch->Replacement.TimeMode.GetValue();
+	}
+	
+	EYapTimeMode EffectiveTimeMode = (FragmentTimeMode == EYapTimeMode::Default) ? NodeConfig.GetDefaultTimeModeSetting() : FragmentTimeMode;
 
 	// If audio mode is selected and there is no audio, fallback to text mode  
 	if (EffectiveTimeMode == EYapTimeMode::AudioTime_TextFallback)
@@ -436,13 +640,11 @@ void FYapFragment::InvalidateFragmentTag(UFlowNode_YapDialogue* OwnerNode)
 void FYapFragment::SetSpeaker(const FGameplayTag& CharacterTag)
 {
 	Speaker = CharacterTag;
-	SpeakerHandle = nullptr;
 }
 
 void FYapFragment::SetDirectedAt(const FGameplayTag& CharacterTag)
 {
 	DirectedAt = CharacterTag;
-	DirectedAtHandle = nullptr;
 }
 #endif
 
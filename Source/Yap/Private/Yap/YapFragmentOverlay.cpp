@@ -0,0 +1,318 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapFragmentOverlay.h"
+
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "Yap/YapCharacterAsset.h"
+#include "Yap/YapCharacterManager.h"
+#include "Yap/YapFragment.h"
+#include "Yap/YapLog.h"
+#include "Yap/YapProjectSettings.h"
+#include "Yap/YapStreamableManager.h"
+#include "Yap/YapSubsystem.h"
+#include "Yap/Enums/YapLoadContext.h"
+#include "Yap/Enums/YapMaturitySetting.h"
+
+int32 FYapFragmentOverlay::NumPatchesAllWorlds = 0;
+
+namespace Yap::Overlay
+{
+	constexpr uint8 Version = 1;
+
+	TSharedPtr<FStreamableHandle> RequestCharacterLoad(UWorld* World, const TSoftObjectPtr<UYapCharacterAsset>& Character, FGameplayTag& OutCharacterTag)
+	{
+		if (Character.IsNull())
+		{
+			OutCharacterTag = FGameplayTag();
+			return nullptr;
+		}
+
+		// Registered characters go through the character manager, as fragment speakers do, so runtime registrations apply to them too
+		OutCharacterTag = UYapProjectSettings::FindCharacterTag(TSoftObjectPtr<UObject>(Character.ToSoftObjectPath()));
+
+		if (OutCharacterTag.IsValid())
+		{
+			return UYapSubsystem::GetCharacterManager(World).RequestLoadAsync(OutCharacterTag.GetTagName());
+		}
+
+		return FYapStreamableManager::RequestAsyncLoad(Character.ToSoftObjectPath());
+	}
+
+	UObject* GetCharacter(UWorld* World, const TSoftObjectPtr<UYapCharacterAsset>& Character, const FGameplayTag& CharacterTag, EYapLoadContext LoadContext)
+	{
+		if (CharacterTag.IsValid())
+		{
+			return UYapSubsystem::GetCharacterManager(World).FindCharacter(CharacterTag.GetTagName()).GetObject();
+		}
+
+		if (UObject* Loaded = Character.Get())
+		{
+			return Loaded;
+		}
+
+		if (LoadContext == EYapLoadContext::Sync && !Character.IsNull())
+		{
+			return FYapStreamableManager::LoadSynchronous(Character, YAP_SYNC_LOAD_SITE);
+		}
+
+		return nullptr;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FYapBit& FYapFragmentPatch::GetBit(const FYapBit& SourceBit, EYapMaturitySetting MaturitySetting) const
+{
+	const bool bChildSafe = MaturitySetting == EYapMaturitySetting::ChildSafe;
+
+	TOptional<FYapBit>& PatchedBit = bChildSafe ? PatchedChildSafeBit : PatchedMatureBit;
+
+	if (!PatchedBit.IsSet())
+	{
+		PatchedBit.Emplace(SourceBit);
+
+		if (bChildSafe)
+		{
+			PatchedBit->ApplyReplacement(Replacement.SafeTitleText, Replacement.SafeDialogueText, Replacement.SafeAudioAsset, Replacement.ManualTime);
+		}
+		else
+		{
+			const TOptional<FYapText> DialogueText = Replacement.bOverrideMatureDialogueText ? TOptional<FYapText>(Replacement.MatureDialogueText) : NullOpt;
+
+			PatchedBit->ApplyReplacement(Replacement.MatureTitleText, DialogueText, Replacement.MatureAudioAsset, Replacement.ManualTime);
+		}
+	}
+
+	return PatchedBit.GetValue();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentPatch::RequestCharacterLoads(UWorld* World)
+{
+	bCharacterLoadsRequested = true;
+
+	SpeakerHandle = Replacement.SpeakerAsset.IsSet() ? Yap::Overlay::RequestCharacterLoad(World, Replacement.SpeakerAsset.GetValue(), SpeakerTag) : nullptr;
+	DirectedAtHandle = Replacement.DirectedAtAsset.IsSet() ? Yap::Overlay::RequestCharacterLoad(World, Replacement.DirectedAtAsset.GetValue(), DirectedAtTag) : nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+UObject* FYapFragmentPatch::GetSpeaker(UWorld* World, EYapLoadContext LoadContext) const
+{
+	return Yap::Overlay::GetCharacter(World, Replacement.SpeakerAsset.Get(TSoftObjectPtr<UYapCharacterAsset>()), SpeakerTag, LoadContext);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+UObject* FYapFragmentPatch::GetDirectedAt(UWorld* World, EYapLoadContext LoadContext) const
+{
+	return Yap::Overlay::GetCharacter(World, Replacement.DirectedAtAsset.Get(TSoftObjectPtr<UYapCharacterAsset>()), DirectedAtTag, LoadContext);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapFragmentOverlay::~FYapFragmentOverlay()
+{
+	Reset();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentOverlay::SetPatch(const FGuid& FragmentGuid, const FYapBitReplacement& Replacement)
+{
+	if (!PatchesByGuid.Contains(FragmentGuid))
+	{
+		++NumPatchesAllWorlds;
+	}
+
+	// Replaces the old patch and its loads; RequestCharacterLoads starts the new ones
+	FYapFragmentPatch& Patch = PatchesByGuid.Add(FragmentGuid);
+	Patch.Replacement = Replacement;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentOverlay::SetPatch(FName FragmentID, const FYapBitReplacement& Replacement)
+{
+	if (FragmentID.IsNone())
+	{
+		UE_LOG(LogYap, Warning, TEXT("Tried to replace fragment data without a fragment ID, ignoring!"));
+		return;
+	}
+
+	if (!PatchesByID.Contains(FragmentID))
+	{
+		++NumPatchesAllWorlds;
+	}
+
+	// Replaces the old patch and its loads; RequestCharacterLoads starts the new ones
+	FYapFragmentPatch& Patch = PatchesByID.Add(FragmentID);
+	Patch.Replacement = Replacement;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapFragmentOverlay::ClearPatch(const FGuid& FragmentGuid)
+{
+	const int32 Removed = PatchesByGuid.Remove(FragmentGuid);
+
+	NumPatchesAllWorlds -= Removed;
+
+	return Removed > 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapFragmentOverlay::ClearPatch(FName FragmentID)
+{
+	const int32 Removed = PatchesByID.Remove(FragmentID);
+
+	NumPatchesAllWorlds -= Removed;
+
+	return Removed > 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentOverlay::Reset()
+{
+	NumPatchesAllWorlds -= PatchesByGuid.Num() + PatchesByID.Num();
+
+	PatchesByGuid.Empty();
+	PatchesByID.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FYapFragmentPatch* FYapFragmentOverlay::Find(const FYapFragment& Fragment) const
+{
+	if (const FYapFragmentPatch* Patch = PatchesByGuid.Find(Fragment.GetGuid()))
+	{
+		return Patch;
+	}
+
+	if (!PatchesByID.IsEmpty() && !Fragment.GetFragmentID().IsNone())
+	{
+		return PatchesByID.Find(Fragment.GetFragmentID());
+	}
+
+	return nullptr;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentOverlay::RequestCharacterLoads(UWorld* World)
+{
+	if (!World)
+	{
+		return;
+	}
+	
+	for (TPair<FGuid, FYapFragmentPatch>& Pair : PatchesByGuid)
+	{
+		if (!Pair.Value.bCharacterLoadsRequested)
+		{
+			Pair.Value.RequestCharacterLoads(World);
+		}
+	}
+
+	for (TPair<FName, FYapFragmentPatch>& Pair : PatchesByID)
+	{
+		if (!Pair.Value.bCharacterLoadsRequested)
+		{
+			Pair.Value.RequestCharacterLoads(World);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentOverlay::InvalidatePatchedBits()
+{
+	for (TPair<FGuid, FYapFragmentPatch>& Pair : PatchesByGuid)
+	{
+		Pair.Value.PatchedMatureBit.Reset();
+		Pair.Value.PatchedChildSafeBit.Reset();
+	}
+
+	for (TPair<FName, FYapFragmentPatch>& Pair : PatchesByID)
+	{
+		Pair.Value.PatchedMatureBit.Reset();
+		Pair.Value.PatchedChildSafeBit.Reset();
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapFragmentOverlay::Serialize(FArchive& Ar)
+{
+	uint8 Version = Yap::Overlay::Version;
+	Ar << Version;
+
+	if (Ar.IsLoading() && Version != Yap::Overlay::Version)
+	{
+		UE_LOG(LogYap, Error, TEXT("Fragment replacements were saved with an unknown version (%d)"), Version);
+		Ar.SetError();
+		return;
+	}
+
+	// Replacements hold soft object paths and text; write those as strings so the data does not depend on anything being loaded
+	FObjectAndNameAsStringProxyArchive Proxy(Ar, false);
+
+	UScriptStruct* ReplacementStruct = FYapBitReplacement::StaticStruct();
+
+	if (Ar.IsSaving())
+	{
+		int32 NumByGuid = PatchesByGuid.Num();
+		int32 NumByID = PatchesByID.Num();
+
+		Proxy << NumByGuid;
+		Proxy << NumByID;
+
+		for (TPair<FGuid, FYapFragmentPatch>& Pair : PatchesByGuid)
+		{
+			Proxy << Pair.Key;
+			ReplacementStruct->SerializeItem(Proxy, &Pair.Value.Replacement, nullptr);
+		}
+
+		for (TPair<FName, FYapFragmentPatch>& Pair : PatchesByID)
+		{
+			Proxy << Pair.Key;
+			ReplacementStruct->SerializeItem(Proxy, &Pair.Value.Replacement, nullptr);
+		}
+	}
+	else
+	{
+		Reset();
+
+		int32 NumByGuid = 0;
+		int32 NumByID = 0;
+
+		Proxy << NumByGuid;
+		Proxy << NumByID;
+
+		for (int32 i = 0; i < NumByGuid && !Ar.IsError(); ++i)
+		{
+			FGuid FragmentGuid;
+			FYapBitReplacement Replacement;
+
+			Proxy << FragmentGuid;
+			ReplacementStruct->SerializeItem(Proxy, &Replacement, nullptr);
+
+			SetPatch(FragmentGuid, Replacement);
+		}
+
+		for (int32 i = 0; i < NumByID && !Ar.IsError(); ++i)
+		{
+			FName FragmentID;
+			FYapBitReplacement Replacement;
+
+			Proxy << FragmentID;
+			ReplacementStruct->SerializeItem(Proxy, &Replacement, nullptr);
+
+			SetPatch(FragmentID, Replacement);
+		}
+	}
+}
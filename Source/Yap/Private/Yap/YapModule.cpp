@@ -3,11 +3,19 @@
 
 #include "Yap/YapModule.h"
 
+#include "Yap/YapDialogueDatabase.h"
+
 #define LOCTEXT_NAMESPACE "Yap"
 
 void FYapModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+	// Cooked games map the dialogue database up front so fragment ID lookups never touch disk mid-game. The editor loads it on first use.
+	if (!GIsEditor)
+	{
+		FYapDialogueDatabase::Get();
+	}
 }
 
 void FYapModule::ShutdownModule()
@@ -0,0 +1,311 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapPortraitAtlas.h"
+
+#include "Engine/Canvas.h"
+#include "Engine/Texture2D.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Engine/World.h"
+#include "Kismet/KismetRenderingLibrary.h"
+#include "Yap/YapLog.h"
+#include "Yap/YapProjectSettings.h"
+#include "Yap/YapTrace.h"
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapPortraitAtlas::GetPortraitRect(const TScriptInterface<IYapCharacterInterface> Character, FGameplayTag MoodTag, FVector2D& UVMin, FVector2D& UVMax)
+{
+	FBox2f UVs;
+
+	if (!FindOrAddPortrait(Character.GetObject(), MoodTag, UVs))
+	{
+		return false;
+	}
+
+	UVMin = FVector2D(UVs.Min);
+	UVMax = FVector2D(UVs.Max);
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapPortraitAtlas::GetPortraitBrush(const TScriptInterface<IYapCharacterInterface> Character, FGameplayTag MoodTag, FSlateBrush& Brush)
+{
+	FBox2f UVs;
+
+	if (!FindOrAddPortrait(Character.GetObject(), MoodTag, UVs))
+	{
+		return false;
+	}
+
+	Brush.SetResourceObject(Atlas);
+	Brush.SetUVRegion(FBox2D(FVector2D(UVs.Min), FVector2D(UVs.Max)));
+	Brush.SetImageSize(FVector2D(CellSize, CellSize));
+	Brush.DrawAs = ESlateBrushDrawType::Image;
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapPortraitAtlas::FindOrAddPortrait(const UObject* Character, FGameplayTag MoodTag, FBox2f& OutUVs)
+{
+	YAP_TRACE_SCOPE(UYapPortraitAtlas::FindOrAddPortrait);
+
+	if (!IsValid(Character) || !Atlas)
+	{
+		return false;
+	}
+
+	const TTuple<TObjectKey<UObject>, FGameplayTag> Key(Character, MoodTag);
+
+	if (const int32* ExistingSlot = SlotLookup.Find(Key))
+	{
+		FYapPortraitAtlasSlot& Slot = Slots[*ExistingSlot];
+		Slot.LastUsedFrame = GFrameCounter;
+
+		if (!Slot.bReady)
+		{
+			return false;
+		}
+
+		OutUVs = GetSlotUVs(*ExistingSlot);
+		return true;
+	}
+
+	const int32 SlotIndex = AcquireSlot();
+
+	if (SlotIndex == INDEX_NONE)
+	{
+		UE_LOG(LogYap, Verbose, TEXT("Portrait atlas is full this frame; draw the portrait from its own texture instead"));
+		return false;
+	}
+
+	FYapPortraitAtlasSlot& Slot = Slots[SlotIndex];
+	Slot.Character = Key.Key;
+	Slot.MoodTag = MoodTag;
+	Slot.LastUsedFrame = GFrameCounter;
+	Slot.RequestTime = FPlatformTime::Seconds();
+	Slot.bOccupied = true;
+	Slot.bReady = false;
+
+	SlotLookup.Add(Key, SlotIndex);
+
+	Slot.LoadHandle = IYapCharacterInterface::RequestPortrait(Character, MoodTag, [WeakThis = TWeakObjectPtr<UYapPortraitAtlas>(this), Key, SlotIndex] (const UTexture2D* Texture)
+	{
+		UYapPortraitAtlas* This = WeakThis.Get();
+
+		// The cell may have been flushed or reused while the portrait was loading
+		if (This && This->SlotLookup.FindRef(Key, INDEX_NONE) == SlotIndex)
+		{
+			This->OnPortraitLoaded(SlotIndex, Texture);
+		}
+	});
+
+	return false;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapPortraitAtlas::Flush()
+{
+	for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+	{
+		Slots[SlotIndex] = FYapPortraitAtlasSlot();
+	}
+
+	SlotLookup.Empty();
+	PendingSlots.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapPortraitAtlas::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return UYapProjectSettings::GetEnablePortraitAtlas() && !IsRunningDedicatedServer() && Super::ShouldCreateSubsystem(Outer);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapPortraitAtlas::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapPortraitAtlas::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const int32 AtlasSize = UYapProjectSettings::GetPortraitAtlasSize();
+
+	CellSize = FMath::Min(UYapProjectSettings::GetPortraitAtlasCellSize(), AtlasSize);
+	CellsPerRow = AtlasSize / CellSize;
+
+	Slots.SetNum(CellsPerRow * CellsPerRow);
+
+	// Portraits are authored as sRGB color textures
+	Atlas = UKismetRenderingLibrary::CreateRenderTarget2D(this, AtlasSize, AtlasSize, RTF_RGBA8_SRGB, FLinearColor::Transparent, false);
+
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::DrawPendingSlots));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapPortraitAtlas::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+
+	Flush();
+
+	if (Atlas)
+	{
+		Atlas->ReleaseResource();
+		Atlas = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 UYapPortraitAtlas::AcquireSlot()
+{
+	int32 Oldest = INDEX_NONE;
+
+	for (int32 SlotIndex = 0; SlotIndex < Slots.Num(); ++SlotIndex)
+	{
+		const FYapPortraitAtlasSlot& Slot = Slots[SlotIndex];
+
+		if (!Slot.bOccupied)
+		{
+			return SlotIndex;
+		}
+
+		if (Slot.LastUsedFrame == GFrameCounter)
+		{
+			continue;
+		}
+
+		if (Oldest == INDEX_NONE || Slot.LastUsedFrame < Slots[Oldest].LastUsedFrame)
+		{
+			Oldest = SlotIndex;
+		}
+	}
+
+	if (Oldest != INDEX_NONE)
+	{
+		ReleaseSlot(Oldest);
+	}
+
+	return Oldest;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapPortraitAtlas::ReleaseSlot(int32 SlotIndex)
+{
+	FYapPortraitAtlasSlot& Slot = Slots[SlotIndex];
+
+	SlotLookup.Remove(TTuple<TObjectKey<UObject>, FGameplayTag>(Slot.Character, Slot.MoodTag));
+	PendingSlots.Remove(SlotIndex);
+
+	Slot = FYapPortraitAtlasSlot();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapPortraitAtlas::OnPortraitLoaded(int32 SlotIndex, const UTexture2D* Texture)
+{
+	FYapPortraitAtlasSlot& Slot = Slots[SlotIndex];
+
+	Slot.LoadHandle.Reset();
+
+	if (!IsValid(Texture))
+	{
+		// Nothing to draw; leave the cell claimed so the missing portrait is not requested every frame
+		return;
+	}
+
+	UTexture2D* MutableTexture = const_cast<UTexture2D*>(Texture);
+
+	// Draw from the top mip, not whatever the streamer has resident right now
+	MutableTexture->SetForceMipLevelsToBeResident(MaxStreamingWait);
+
+	Slot.PendingTexture = MutableTexture;
+	PendingSlots.AddUnique(SlotIndex);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapPortraitAtlas::DrawPendingSlots(float DeltaTime)
+{
+	if (PendingSlots.Num() == 0 || !Atlas)
+	{
+		return true;
+	}
+
+	YAP_TRACE_SCOPE(UYapPortraitAtlas::DrawPendingSlots);
+
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<int32, TInlineAllocator<16>> ReadySlots;
+
+	for (int32 SlotIndex : PendingSlots)
+	{
+		const FYapPortraitAtlasSlot& Slot = Slots[SlotIndex];
+
+		if (IsValid(Slot.PendingTexture) && (Slot.PendingTexture->IsFullyStreamedIn() || Now - Slot.RequestTime > MaxStreamingWait))
+		{
+			ReadySlots.Add(SlotIndex);
+		}
+	}
+
+	if (ReadySlots.Num() == 0)
+	{
+		return true;
+	}
+
+	UCanvas* Canvas;
+	FVector2D CanvasSize;
+	FDrawToRenderTargetContext Context;
+
+	UKismetRenderingLibrary::BeginDrawCanvasToRenderTarget(this, Atlas, Canvas, CanvasSize, Context);
+
+	for (int32 SlotIndex : ReadySlots)
+	{
+		FYapPortraitAtlasSlot& Slot = Slots[SlotIndex];
+
+		const FVector2D CellPosition((SlotIndex % CellsPerRow) * CellSize, (SlotIndex / CellsPerRow) * CellSize);
+
+		// Opaque replaces the whole cell, alpha included, so nothing of an evicted portrait remains
+		Canvas->K2_DrawTexture(Slot.PendingTexture, CellPosition, FVector2D(CellSize, CellSize), FVector2D::ZeroVector, FVector2D::UnitVector, FLinearColor::White, BLEND_Opaque);
+
+		Slot.PendingTexture = nullptr;
+		Slot.bReady = true;
+
+		PendingSlots.Remove(SlotIndex);
+	}
+
+	UKismetRenderingLibrary::EndDrawCanvasToRenderTarget(this, Context);
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FBox2f UYapPortraitAtlas::GetSlotUVs(int32 SlotIndex) const
+{
+	const float AtlasSize = CellsPerRow * CellSize;
+
+	// Half a texel in from the cell's edges so filtering never samples the neighbouring portrait
+	const float Inset = 0.5f / AtlasSize;
+
+	const FVector2f Min((SlotIndex % CellsPerRow) * CellSize / AtlasSize, (SlotIndex / CellsPerRow) * CellSize / AtlasSize);
+	const FVector2f Max = Min + FVector2f(CellSize / AtlasSize);
+
+	return FBox2f(Min + Inset, Max - Inset);
+}
@@ -5,12 +5,17 @@
 
 #if WITH_EDITOR
 #include "GameplayTagsManager.h"
+#include "Interfaces/ITargetPlatform.h"
 #endif
 #include "Engine/AssetManager.h"
+#include "Engine/World.h"
 #include "Yap/YapCharacterAsset.h"
 #include "Yap/Enums/YapLoadContext.h"
+#include "Yap/Enums/YapSyncLoadPolicy.h"
 #include "Yap/Globals/YapFileUtilities.h"
 #include "Yap/YapCharacterStaticDefinition.h"
+#include "Yap/YapStreamableManager.h"
+#include "Yap/YapLog.h"
 
 #define LOCTEXT_NAMESPACE "Yap"
 
@@ -41,7 +46,7 @@ const TArray<const UClass*> UYapProjectSettings::GetAllowableCharacterClasses()
 
 	for (auto& ClassSoftPtr : Get().DefaultCharacterClasses)
 	{
-		UClass* LoadedClass = ClassSoftPtr.LoadSynchronous();
+		UClass* LoadedClass = FYapStreamableManager::LoadSynchronous(ClassSoftPtr, YAP_SYNC_LOAD_SITE, true);
 		Classes.Add(LoadedClass);
 	}
 
@@ -75,11 +80,85 @@ TArray<const UClass*> UYapProjectSettings::GetCharacterClasses_SyncLoad()
 */
 #endif
 
+#if WITH_EDITOR
+EYapMaturitySetting UYapProjectSettings::GetCookedMaturity(const ITargetPlatform* TargetPlatform)
+{
+	// Called for every fragment the cook saves; the command line doesn't change, so parse it once
+	static const EYapMaturitySetting CommandLineLevel = []
+	{
+		FString CommandLineMaturity;
+
+		if (FParse::Value(FCommandLine::Get(), TEXT("YapCookMaturity="), CommandLineMaturity))
+		{
+			const int64 Value = StaticEnum<EYapMaturitySetting>()->GetValueByNameString(CommandLineMaturity);
+
+			if (Value != INDEX_NONE)
+			{
+				return static_cast<EYapMaturitySetting>(Value);
+			}
+
+			UE_LOG(LogYap, Warning, TEXT("Ignoring unknown -YapCookMaturity=%s; expected ChildSafe or Mature"), *CommandLineMaturity);
+		}
+
+		return EYapMaturitySetting::Unspecified;
+	}();
+
+	if (CommandLineLevel != EYapMaturitySetting::Unspecified)
+	{
+		return CommandLineLevel;
+	}
+
+	if (!TargetPlatform)
+	{
+		return EYapMaturitySetting::Unspecified;
+	}
+
+	const TMap<FString, EYapMaturitySetting>& Levels = Get().CookedMaturityLevels;
+	
+	// Exact target name (e.g. "WindowsClient") first, then the platform it belongs to (e.g. "Windows")
+	if (const EYapMaturitySetting* Level = Levels.Find(TargetPlatform->PlatformName()))
+	{
+		return *Level;
+	}
+
+	if (const EYapMaturitySetting* Level = Levels.Find(TargetPlatform->IniPlatformName()))
+	{
+		return *Level;
+	}
+
+	return EYapMaturitySetting::Unspecified;
+}
+#endif
+
+bool UYapProjectSettings::IsTimingOnly(const UWorld* World)
+{
+	if (!World || !World->IsGameWorld())
+	{
+		return false;
+	}
+	
+	switch (Get().TimingOnlyMode)
+	{
+		case EYapTimingOnlyMode::DedicatedServer:
+		{
+			return World->GetNetMode() == NM_DedicatedServer;
+		}
+		case EYapTimingOnlyMode::Always:
+		{
+			return true;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+}
+
 const TSubclassOf<UYapBroker> UYapProjectSettings::GetBrokerClass()
 {
 	const TSoftClassPtr<UYapBroker> BrokerClassSoftPtr = Get().BrokerClass;
 
-	TSubclassOf<UYapBroker> BrokerClass = BrokerClassSoftPtr.LoadSynchronous();
+	TSubclassOf<UYapBroker> BrokerClass = FYapStreamableManager::LoadSynchronous(BrokerClassSoftPtr, YAP_SYNC_LOAD_SITE, true);
 
 	if (BrokerClass == nullptr)
 	{
@@ -0,0 +1,297 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapSaveState.h"
+
+#include "Serialization/Archive.h"
+#include "Yap/YapLog.h"
+
+const uint32 FYapDialogueSaveState::FileMagic = 0x53504159; // 'YAPS'
+
+// 2: records are keyed by flow asset and node GUID
+// 3: UYapSubsystem writes fragment replacements after the records
+const uint32 FYapDialogueSaveState::FileVersion = 3;
+
+namespace Yap::SaveState
+{
+	enum EFlags : uint8
+	{
+		Delta = 1 << 0,
+	};
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapNodeSaveRecord::operator==(const FYapNodeSaveRecord& Other) const
+{
+	return NodeActivationCount == Other.NodeActivationCount
+		&& LastRanFragment == Other.LastRanFragment
+		&& FragmentActivationCounts.OrderIndependentCompareEqual(Other.FragmentActivationCounts);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FYapNodeSaveRecord* FYapDialogueSaveState::Find(const FYapNodeSaveKey& Key) const
+{
+	if (const FYapNodeSaveRecord* Record = Records.Find(Key))
+	{
+		return Record;
+	}
+
+	// Loaded from a version 1 snapshot, which did not know the flow asset
+	return Records.Find({ FSoftObjectPath(), Key.NodeGuid });
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueSaveState::Store(const FYapNodeSaveKey& Key, FYapNodeSaveRecord&& Record)
+{
+	if (Record.IsEmpty())
+	{
+		Remove(Key);
+		return;
+	}
+
+	FYapNodeSaveRecord* Existing = Records.Find(Key);
+
+	if (Existing && *Existing == Record)
+	{
+		return;
+	}
+
+	Records.Add(Key, MoveTemp(Record));
+	DirtyNodes.Add(Key);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueSaveState::Remove(const FYapNodeSaveKey& Key)
+{
+	if (Records.Remove(Key) > 0)
+	{
+		DirtyNodes.Add(Key);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueSaveState::Reset()
+{
+	Records.Empty();
+	DirtyNodes.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueSaveState::Write(FArchive& Ar, bool bDelta)
+{
+	check(Ar.IsSaving());
+
+	uint32 Magic = FileMagic;
+	uint32 Version = FileVersion;
+	uint8 Flags = bDelta ? Yap::SaveState::Delta : 0;
+
+	Ar << Magic;
+	Ar << Version;
+	Ar << Flags;
+
+	TArray<FYapNodeSaveKey> Keys;
+
+	if (bDelta)
+	{
+		Keys = DirtyNodes.Array();
+	}
+	else
+	{
+		Records.GetKeys(Keys);
+	}
+
+	// Sorted so that unchanged state always produces identical bytes, which keeps diffs between autosaves small
+	TMap<FString, TArray<FGuid>> NodesByAsset;
+
+	for (const FYapNodeSaveKey& Key : Keys)
+	{
+		NodesByAsset.FindOrAdd(Key.FlowAsset.ToString()).Add(Key.NodeGuid);
+	}
+
+	NodesByAsset.KeySort(TLess<FString>());
+
+	uint32 NumAssets = NodesByAsset.Num();
+	Ar.SerializeIntPacked(NumAssets);
+
+	for (TPair<FString, TArray<FGuid>>& Asset : NodesByAsset)
+	{
+		const FSoftObjectPath FlowAsset(Asset.Key);
+		
+		Asset.Value.Sort();
+		
+		uint32 NumNodes = Asset.Value.Num();
+		
+		Ar << Asset.Key;
+		Ar.SerializeIntPacked(NumNodes);
+
+		for (FGuid& NodeGuid : Asset.Value)
+		{
+			// Nodes removed since the last save are written as empty records, which erase them when the delta is read
+			FYapNodeSaveRecord Record = Records.FindRef({ FlowAsset, NodeGuid });
+
+			Ar << NodeGuid;
+			SerializeRecord(Ar, Record);
+		}
+	}
+
+	DirtyNodes.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueSaveState::Read(FArchive& Ar, uint32& OutVersion)
+{
+	check(Ar.IsLoading());
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint8 Flags = 0;
+
+	Ar << Magic;
+	Ar << Version;
+	Ar << Flags;
+
+	OutVersion = Version;
+
+	if (Ar.IsError() || Magic != FileMagic || Version == 0 || Version > FileVersion)
+	{
+		UE_LOG(LogYap, Error, TEXT("Dialogue save state has an unknown format (magic %x, version %d)"), Magic, Version);
+		return false;
+	}
+
+	TArray<TPair<FYapNodeSaveKey, FYapNodeSaveRecord>> ReadRecords;
+
+	if (Version == 1)
+	{
+		ReadVersion1Records(Ar, ReadRecords);
+	}
+	else
+	{
+		uint32 NumAssets = 0;
+		Ar.SerializeIntPacked(NumAssets);
+
+		for (uint32 AssetIndex = 0; AssetIndex < NumAssets && !Ar.IsError(); ++AssetIndex)
+		{
+			FString AssetPath;
+			uint32 NumNodes = 0;
+
+			Ar << AssetPath;
+			Ar.SerializeIntPacked(NumNodes);
+
+			const FSoftObjectPath FlowAsset(AssetPath);
+
+			for (uint32 i = 0; i < NumNodes && !Ar.IsError(); ++i)
+			{
+				TPair<FYapNodeSaveKey, FYapNodeSaveRecord>& Pair = ReadRecords.AddDefaulted_GetRef();
+
+				Pair.Key.FlowAsset = FlowAsset;
+				Ar << Pair.Key.NodeGuid;
+				SerializeRecord(Ar, Pair.Value);
+			}
+		}
+	}
+
+	if (Ar.IsError())
+	{
+		UE_LOG(LogYap, Error, TEXT("Dialogue save state is truncated or corrupt; nothing was loaded"));
+		return false;
+	}
+
+	if (!(Flags & Yap::SaveState::Delta))
+	{
+		Records.Empty(ReadRecords.Num());
+	}
+
+	for (TPair<FYapNodeSaveKey, FYapNodeSaveRecord>& Pair : ReadRecords)
+	{
+		if (Pair.Value.IsEmpty())
+		{
+			Records.Remove(Pair.Key);
+		}
+		else
+		{
+			Records.Add(Pair.Key, MoveTemp(Pair.Value));
+		}
+	}
+
+	// The store now matches what was saved
+	DirtyNodes.Empty();
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapDialogueSaveState::ReadVersion1Records(FArchive& Ar, TArray<TPair<FYapNodeSaveKey, FYapNodeSaveRecord>>& OutRecords)
+{
+	uint32 Count = 0;
+	Ar.SerializeIntPacked(Count);
+
+	OutRecords.Reserve(FMath::Min<uint32>(Count, Ar.TotalSize() / sizeof(FGuid)));
+
+	for (uint32 i = 0; i < Count && !Ar.IsError(); ++i)
+	{
+		TPair<FYapNodeSaveKey, FYapNodeSaveRecord>& Pair = OutRecords.AddDefaulted_GetRef();
+
+		Ar << Pair.Key.NodeGuid;
+		SerializeRecord(Ar, Pair.Value);
+	}
+
+	return !Ar.IsError();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueSaveState::SerializeRecord(FArchive& Ar, FYapNodeSaveRecord& Record)
+{
+	uint32 NodeActivationCount = FMath::Max(Record.NodeActivationCount, 0);
+	Ar.SerializeIntPacked(NodeActivationCount);
+	Record.NodeActivationCount = NodeActivationCount;
+
+	bool bHasLastRanFragment = Record.LastRanFragment.IsValid();
+	Ar << bHasLastRanFragment;
+
+	if (bHasLastRanFragment)
+	{
+		Ar << Record.LastRanFragment;
+	}
+
+	uint32 NumFragments = Record.FragmentActivationCounts.Num();
+	Ar.SerializeIntPacked(NumFragments);
+
+	if (Ar.IsSaving())
+	{
+		TArray<FGuid> FragmentGuids;
+		Record.FragmentActivationCounts.GetKeys(FragmentGuids);
+		FragmentGuids.Sort();
+
+		for (FGuid& FragmentGuid : FragmentGuids)
+		{
+			uint32 ActivationCount = FMath::Max(Record.FragmentActivationCounts[FragmentGuid], 0);
+
+			Ar << FragmentGuid;
+			Ar.SerializeIntPacked(ActivationCount);
+		}
+	}
+	else
+	{
+		Record.FragmentActivationCounts.Empty(FMath::Min<uint32>(NumFragments, UINT8_MAX + 1));
+
+		for (uint32 i = 0; i < NumFragments && !Ar.IsError(); ++i)
+		{
+			FGuid FragmentGuid;
+			uint32 ActivationCount = 0;
+
+			Ar << FragmentGuid;
+			Ar.SerializeIntPacked(ActivationCount);
+
+			Record.FragmentActivationCounts.Add(FragmentGuid, ActivationCount);
+		}
+	}
+}
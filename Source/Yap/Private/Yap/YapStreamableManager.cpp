@@ -0,0 +1,255 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapStreamableManager.h"
+
+#include "Yap/YapLog.h"
+#include "Yap/YapProjectSettings.h"
+#include "Yap/YapTrace.h"
+#include "Yap/Enums/YapSyncLoadPolicy.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#endif
+
+TArray<TWeakPtr<FStreamableHandle>> FYapStreamableManager::TrackedHandles;
+
+FCriticalSection FYapStreamableManager::TrackedHandlesLock;
+
+TArray<FYapSyncLoadRecord> FYapStreamableManager::SyncLoadRecords;
+
+int32 FYapStreamableManager::NextSyncLoadRecord = 0;
+
+int32 FYapStreamableManager::SyncLoadCount = 0;
+
+uint32 FYapStreamableManager::FailedLoadCounter = 0;
+
+// ------------------------------------------------------------------------------------------------
+
+namespace Yap
+{
+	namespace Loading
+	{
+	/** Sync loads in the editor (outside of PIE) are normal and are never policed. */
+	static bool IsGameplayRunning()
+	{
+#if WITH_EDITOR
+		if (GIsEditor)
+		{
+			return GEditor && GEditor->PlayWorld;
+		}
+#endif
+		return true;
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TSharedPtr<FStreamableHandle> FYapStreamableManager::RequestAsyncLoad(const FSoftObjectPath& Path, FStreamableDelegate OnLoaded)
+{
+	TSharedPtr<FStreamableHandle> Handle = Get().RequestAsyncLoad(Path, MoveTemp(OnLoaded));
+
+	TrackHandle(Handle);
+
+	return Handle;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TSharedPtr<FStreamableHandle> FYapStreamableManager::RequestSyncLoad(const FSoftObjectPath& Path, const ANSICHAR* CallSite)
+{
+	if (!PermitSyncLoad(Path, CallSite, false))
+	{
+		return nullptr;
+	}
+
+	YAP_TRACE_LOAD_WAIT(Path);
+	
+	TSharedPtr<FStreamableHandle> Handle = Get().RequestSyncLoad(Path);
+
+	TrackHandle(Handle);
+
+	return Handle;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+UObject* FYapStreamableManager::LoadSynchronous(const FSoftObjectPath& Path, const ANSICHAR* CallSite, bool bRequired)
+{
+	if (Path.IsNull())
+	{
+		return nullptr;
+	}
+
+	if (UObject* Loaded = Path.ResolveObject())
+	{
+		return Loaded;
+	}
+
+	if (!PermitSyncLoad(Path, CallSite, bRequired))
+	{
+		return nullptr;
+	}
+
+	YAP_TRACE_LOAD_WAIT(Path);
+	
+	return Path.TryLoad();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapStreamableManager::GetOutstandingHandleCount()
+{
+	int32 Count = 0;
+
+	FScopeLock Lock(&TrackedHandlesLock);
+
+	for (const TWeakPtr<FStreamableHandle>& WeakHandle : TrackedHandles)
+	{
+		TSharedPtr<FStreamableHandle> Handle = WeakHandle.Pin();
+
+		if (Handle.IsValid() && Handle->IsActive())
+		{
+			++Count;
+		}
+	}
+
+	return Count;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapStreamableManager::GetSyncLoadRecords(TArray<FYapSyncLoadRecord>& OutRecords)
+{
+	OutRecords.Reset(SyncLoadRecords.Num());
+
+	for (int32 i = 0; i < SyncLoadRecords.Num(); ++i)
+	{
+		OutRecords.Add(SyncLoadRecords[(NextSyncLoadRecord + i) % SyncLoadRecords.Num()]);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapStreamableManager::ClearSyncLoadRecords()
+{
+	SyncLoadRecords.Reset();
+	NextSyncLoadRecord = 0;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapStreamableManager::DumpSyncLoadRecords(FOutputDevice& Ar)
+{
+	TArray<FYapSyncLoadRecord> Records;
+	GetSyncLoadRecords(Records);
+
+	Ar.Logf(TEXT("Yap sync loads: %i total, showing the last %i during gameplay"), SyncLoadCount, Records.Num());
+
+	for (const FYapSyncLoadRecord& Record : Records)
+	{
+		Ar.Logf(TEXT("  [%.3f, frame %llu] %s <%s> from %s"),
+			Record.Time,
+			Record.Frame,
+			Record.bLoaded ? TEXT("Loaded") : TEXT("REFUSED"),
+			*Record.AssetPath.ToString(),
+			Record.CallSite ? ANSI_TO_TCHAR(Record.CallSite) : TEXT("unknown"));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapStreamableManager::PermitSyncLoad(const FSoftObjectPath& Path, const ANSICHAR* CallSite, bool bRequired)
+{
+	++SyncLoadCount;
+	
+	if (!Yap::Loading::IsGameplayRunning())
+	{
+		return true;
+	}
+
+	EYapSyncLoadPolicy Policy = UYapProjectSettings::GetSyncLoadPolicy();
+
+	bool bPermitted = bRequired || (Policy != EYapSyncLoadPolicy::Skip && Policy != EYapSyncLoadPolicy::Fail);
+
+	FYapSyncLoadRecord& Record = (SyncLoadRecords.Num() < MaxSyncLoadRecords) ? SyncLoadRecords.AddDefaulted_GetRef() : SyncLoadRecords[NextSyncLoadRecord];
+	NextSyncLoadRecord = (NextSyncLoadRecord + 1) % MaxSyncLoadRecords;
+	Record.AssetPath = Path;
+	Record.CallSite = CallSite;
+	Record.Time = FPlatformTime::Seconds();
+	Record.Frame = GFrameCounter;
+	Record.bLoaded = bPermitted;
+
+	const FString CallSiteString = CallSite ? ANSI_TO_TCHAR(CallSite) : TEXT("unknown");
+	
+	switch (Policy)
+	{
+		case EYapSyncLoadPolicy::Warn:
+		{
+			UE_LOG(LogYap, Warning, TEXT("Synchronously loading <%s> from %s, this will cause a hitch! Try to request loading sooner."), *Path.ToString(), *CallSiteString);
+			break;
+		}
+		case EYapSyncLoadPolicy::Ensure:
+		{
+			ensureMsgf(false, TEXT("Yap synchronously loading <%s> from %s"), *Path.ToString(), *CallSiteString);
+			break;
+		}
+		case EYapSyncLoadPolicy::Skip:
+		case EYapSyncLoadPolicy::Fail:
+		{
+			if (bRequired)
+			{
+				UE_LOG(LogYap, Error, TEXT("Synchronously loading <%s> from %s; this asset is required so the sync load policy cannot skip it."), *Path.ToString(), *CallSiteString);
+				break;
+			}
+			
+			UE_LOG(LogYap, Error, TEXT("Refused to synchronously load <%s> from %s (sync load policy: %s)."), *Path.ToString(), *CallSiteString, Policy == EYapSyncLoadPolicy::Skip ? TEXT("Skip") : TEXT("Fail"));
+
+			if (Policy == EYapSyncLoadPolicy::Fail)
+			{
+				++FailedLoadCounter;
+			}
+			
+			break;
+		}
+	}
+
+	return bPermitted;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapStreamableManager::TrackHandle(const TSharedPtr<FStreamableHandle>& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return;
+	}
+
+	FScopeLock Lock(&TrackedHandlesLock);
+
+	// Prune released handles whenever the array doubles, so the cost stays amortized O(1) per request
+	static int32 PruneThreshold = 64;
+
+	if (TrackedHandles.Num() >= PruneThreshold)
+	{
+		TrackedHandles.RemoveAllSwap([] (const TWeakPtr<FStreamableHandle>& WeakHandle)
+		{
+			return !WeakHandle.IsValid();
+		});
+
+		PruneThreshold = FMath::Max(64, TrackedHandles.Num() * 2);
+	}
+
+	TrackedHandles.Add(Handle);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithOutputDevice YapSyncLoadsCommand(
+	TEXT("Yap.SyncLoads"),
+	TEXT("Print every synchronous load Yap performed or refused during gameplay, with timestamps and call sites."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FYapStreamableManager::DumpSyncLoadRecords));
+#endif
@@ -20,9 +20,29 @@
 
 #include "GameFramework/Character.h"
 #include "Yap/YapCharacterManager.h"
+#include "Yap/YapStreamableManager.h"
+#include "Yap/YapDialogueDatabase.h"
+#include "Yap/YapDialogueStateSubsystem.h"
+#include "Yap/YapTextFormatCache.h"
+#include "FlowAsset.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Engine/Engine.h"
 
 #define LOCTEXT_NAMESPACE "Yap"
 
+DECLARE_STATS_GROUP(TEXT("Yap"), STATGROUP_Yap, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Speeches"), STAT_YapActiveSpeeches, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Running Conversations"), STAT_YapRunningConversations, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Conversations"), STAT_YapQueuedConversations, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Registered Handlers"), STAT_YapRegisteredHandlers, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Outstanding Streamable Handles"), STAT_YapStreamableHandles, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sync Loads (Session)"), STAT_YapSyncLoads, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Open Prompt Handles"), STAT_YapOpenPromptHandles, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FragileSpeechHandles"), STAT_YapFragileSpeechHandles, STATGROUP_Yap);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("TaggedFragments"), STAT_YapTaggedFragments, STATGROUP_Yap);
+
 #define YAP_BROADCAST_EVT_TARGS(NAME, CPPFUNC, K2FUNC) U##NAME, I##NAME, &I##NAME::CPPFUNC, &I##NAME::K2FUNC
 
 FName UYapSubsystem::Yap_UnnamedConvo("Yap.Conversation.__UnnamedConvo__");
@@ -275,6 +295,56 @@ TArray<FYapSpeechHandle> FYap__ActiveSpeechMap::GetHandles(const FYapConversatio
 	return { };
 }
 
+// ------------------------------------------------------------------------------------------------
+
+void FYap__ActiveSpeechMap::Dump(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("AllSpeech (%i):"), AllSpeech.Num());
+
+	for (const TPair<FYapSpeechHandle, FYap__ActiveSpeechContainer>& Pair : AllSpeech)
+	{
+		const FYap__ActiveSpeechContainer& Container = Pair.Value;
+		
+		Ar.Logf(TEXT("  {%s} Speaker <%s> Owner <%s> Conversation {%s} Timer <%s> Bound <%s>"),
+			*Pair.Key.ToString(),
+			*Container.SpeakerID.ToString(),
+			*GetNameSafe(Container.SpeechOwner),
+			Container.ConversationHandle.IsValid() ? *Container.ConversationHandle.ToString() : TEXT("none"),
+			Container.SpeechTimerHandle.IsValid() ? TEXT("set") : TEXT("none"),
+			Container.OnSpeechFinish.IsBound() ? TEXT("yes") : TEXT("no"));
+	}
+
+	Ar.Logf(TEXT("ContainersByOwner (%i):"), ContainersByOwner.Num());
+
+	for (const TPair<TObjectPtr<UObject>, FYapSpeechHandlesArray>& Pair : ContainersByOwner)
+	{
+		Ar.Logf(TEXT("  <%s>: %i handle(s)"), *GetNameSafe(Pair.Key), Pair.Value.Handles.Num());
+	}
+
+	Ar.Logf(TEXT("ContainersBySpeakerID (%i):"), ContainersBySpeakerID.Num());
+
+	for (const TPair<FName, FYapSpeechHandlesArray>& Pair : ContainersBySpeakerID)
+	{
+		Ar.Logf(TEXT("  <%s>: %i handle(s)"), *Pair.Key.ToString(), Pair.Value.Handles.Num());
+	}
+
+	Ar.Logf(TEXT("Conversations (%i):"), Conversations.Num());
+
+	for (const TPair<FYapConversationHandle, FYapConversation>& Pair : Conversations)
+	{
+		const FYapConversation& Conversation = Pair.Value;
+		
+		Ar.Logf(TEXT("  {%s} <%s> Owner <%s> State <%s> Running speech: %i"),
+			*Pair.Key.ToString(),
+			*Conversation.GetConversationName().ToString(),
+			*GetNameSafe(Conversation.GetOwner()),
+			*UEnum::GetValueAsString(Conversation.GetState()),
+			Conversation.GetRunningFragments().Num());
+	}
+
+	Ar.Logf(TEXT("ConversationsByOwner (%i):"), ConversationsByOwner.Num());
+}
+
 // ================================================================================================
 
 UYapSubsystem::UYapSubsystem()
@@ -529,24 +599,44 @@ EYapMaturitySetting UYapSubsystem::GetCurrentMaturitySetting(const UWorld* World
 
 // ------------------------------------------------------------------------------------------------
 
-void UYapSubsystem::RegisterTaggedFragment(const FGameplayTag& FragmentTag, UFlowNode_YapDialogue* DialogueNode)
+void UYapSubsystem::RegisterTaggedFragment(FName FragmentID, UFlowNode_YapDialogue* DialogueNode)
 {
-	if (TaggedFragments.Contains(FragmentTag))
+	if (TObjectPtr<UFlowNode_YapDialogue>* Existing = TaggedFragments.Find(FragmentID))
 	{
-		UE_LOG(LogYap, Warning, TEXT("Tried to register tagged fragment with tag [%s] but this tag was already registered! Find and fix the duplicate tag usage."), *FragmentTag.ToString()); // TODO if I pass in the full fragment I could log the dialogue text to make this easier for designers?
+		if (*Existing != DialogueNode)
+		{
+			UE_LOG(LogYap, Warning, TEXT("Tried to register fragment with ID [%s] but this ID was already registered by <%s>! Find and fix the duplicate ID usage."), *FragmentID.ToString(), *GetNameSafe(*Existing)); // TODO if I pass in the full fragment I could log the dialogue text to make this easier for designers?
+		}
+		
 		return;
 	}
 	
-	TaggedFragments.Add(FragmentTag, DialogueNode);
+	TaggedFragments.Add(FragmentID, DialogueNode);
 }
 
 // ------------------------------------------------------------------------------------------------
 
-FYapFragment* UYapSubsystem::FindTaggedFragment(const FGameplayTag& FragmentTag)
+void UYapSubsystem::UnregisterTaggedFragment(FName FragmentID, const UFlowNode_YapDialogue* DialogueNode)
 {
-	if (UFlowNode_YapDialogue** DialoguePtr = TaggedFragments.Find(FragmentTag))
+	if (TObjectPtr<UFlowNode_YapDialogue>* Existing = TaggedFragments.Find(FragmentID))
 	{
-		return (*DialoguePtr)->FindTaggedFragment(FragmentTag);
+		if (*Existing == DialogueNode)
+		{
+			TaggedFragments.Remove(FragmentID);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const FYapFragment* UYapSubsystem::FindFragmentByID(FName FragmentID) const
+{
+	if (const TObjectPtr<UFlowNode_YapDialogue>* DialoguePtr = TaggedFragments.Find(FragmentID))
+	{
+		if (IsValid(*DialoguePtr))
+		{
+			return (*DialoguePtr)->FindFragmentByID(FragmentID);
+		}
 	}
 
 	return nullptr;
@@ -554,6 +644,116 @@ FYapFragment* UYapSubsystem::FindTaggedFragment(const FGameplayTag& FragmentTag)
 
 // ------------------------------------------------------------------------------------------------
 
+const FYapFragment* UYapSubsystem::FindTaggedFragment(const FGameplayTag& FragmentTag) const
+{
+	return FindFragmentByID(FragmentTag.GetTagName());
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::SetFragmentReplacement(const UObject* WorldContext, FName FragmentID, const FYapBitReplacement& Replacement)
+{
+	if (UYapSubsystem* Subsystem = Get(WorldContext))
+	{
+		Subsystem->FragmentOverlay.SetPatch(FragmentID, Replacement);
+		Subsystem->FragmentOverlay.RequestCharacterLoads(Subsystem->GetWorld());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::SetFragmentReplacement(const UObject* WorldContext, const FGuid& FragmentGuid, const FYapBitReplacement& Replacement)
+{
+	if (UYapSubsystem* Subsystem = Get(WorldContext))
+	{
+		Subsystem->FragmentOverlay.SetPatch(FragmentGuid, Replacement);
+		Subsystem->FragmentOverlay.RequestCharacterLoads(Subsystem->GetWorld());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::ClearFragmentReplacement(const UObject* WorldContext, FName FragmentID)
+{
+	if (UYapSubsystem* Subsystem = Get(WorldContext))
+	{
+		Subsystem->FragmentOverlay.ClearPatch(FragmentID);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::ClearFragmentReplacement(const UObject* WorldContext, const FGuid& FragmentGuid)
+{
+	if (UYapSubsystem* Subsystem = Get(WorldContext))
+	{
+		Subsystem->FragmentOverlay.ClearPatch(FragmentGuid);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::ResolveTaggedFragment(FName FragmentID, FYapOnFragmentResolved OnResolved)
+{
+	YAP_TRACE_SCOPE(UYapSubsystem::ResolveTaggedFragment);
+	
+	if (TObjectPtr<UFlowNode_YapDialogue>* DialoguePtr = TaggedFragments.Find(FragmentID))
+	{
+		int16 FragmentIndex = IsValid(*DialoguePtr) ? (*DialoguePtr)->FindFragmentIndex(FragmentID) : INDEX_NONE;
+		
+		if (FragmentIndex != INDEX_NONE)
+		{
+			OnResolved.ExecuteIfBound(*DialoguePtr, FragmentIndex);
+			return;
+		}
+	}
+
+	const FYapDialogueDatabase& Database = FYapDialogueDatabase::Get();
+	
+	int32 DatabaseIndex = Database.FindFragmentByID(FragmentID);
+
+	if (DatabaseIndex == INDEX_NONE)
+	{
+		UE_LOG(LogYap, Warning, TEXT("ResolveTaggedFragment: fragment ID [%s] is not registered and is not in the dialogue database"), *FragmentID.ToString());
+		OnResolved.ExecuteIfBound(nullptr, 0);
+		return;
+	}
+
+	FSoftObjectPath OwningAsset = Database.GetOwningAsset(DatabaseIndex);
+	FGuid NodeGuid = Database.GetNodeGuid(DatabaseIndex);
+	FGuid FragmentGuid = Database.GetFragmentGuid(DatabaseIndex);
+
+	auto Finish = [OwningAsset, NodeGuid, FragmentGuid, FragmentID, OnResolved] ()
+	{
+		const UFlowAsset* FlowAsset = Cast<UFlowAsset>(OwningAsset.ResolveObject());
+
+		UFlowNode* const* Node = FlowAsset ? FlowAsset->GetNodes().Find(NodeGuid) : nullptr;
+		
+		const UFlowNode_YapDialogue* DialogueNode = Node ? Cast<UFlowNode_YapDialogue>(*Node) : nullptr;
+
+		int16 FragmentIndex = DialogueNode ? DialogueNode->FindFragmentIndex(FragmentGuid) : INDEX_NONE;
+		
+		if (FragmentIndex == INDEX_NONE)
+		{
+			UE_LOG(LogYap, Warning, TEXT("ResolveTaggedFragment: fragment ID [%s] could not be found in <%s>; the dialogue database may be stale"), *FragmentID.ToString(), *OwningAsset.ToString());
+			OnResolved.ExecuteIfBound(nullptr, 0);
+			return;
+		}
+		
+		OnResolved.ExecuteIfBound(DialogueNode, FragmentIndex);
+	};
+
+	if (OwningAsset.ResolveObject())
+	{
+		Finish();
+		return;
+	}
+
+	FYapStreamableManager::RequestAsyncLoad(OwningAsset, FStreamableDelegate::CreateLambda(Finish));
+}
+
+// ------------------------------------------------------------------------------------------------
+
 FYapConversation& UYapSubsystem::OpenConversation(FName ConversationName, UObject* ConversationOwner)
 {
 	if (!ConversationName.IsValid())
@@ -564,6 +764,11 @@ FYapConversation& UYapSubsystem::OpenConversation(FName ConversationName, UObjec
 	FYapConversationHandle NewHandle;
 	FYapConversation& NewConversation = ActiveSpeechMap.AddConversation(ConversationName, ConversationOwner, NewHandle);
 
+	if (EventRecorder.IsRecording())
+	{
+		EventRecorder.RecordConversationOpened(NewHandle, ConversationName, NewConversation.GetNodeType() ? FName(NewConversation.GetNodeType()->GetPathName()) : NAME_None);
+	}
+
 	ConversationQueue.EmplaceAt(0, NewHandle);
 	
 	if (ConversationQueue.Num() == 1)
@@ -583,6 +788,11 @@ EYapConversationState UYapSubsystem::CloseConversation(FYapConversationHandle& H
 	{
 		check(ConversationQueue.Contains(Handle));
 
+		if (EventRecorder.IsRecording())
+		{
+			EventRecorder.RecordConversationClosed(Handle);
+		}
+
 		return StartClosingConversation(Handle);
 	}
 
@@ -674,6 +884,8 @@ EYapConversationState UYapSubsystem::StartClosingConversation(FYapConversationHa
 		{
 			ConversationQueue.Remove(Handle);
 
+			ReleaseConversationPromptSet(Handle);
+
 			ActiveSpeechMap.RemoveConversation(Handle);
 			
 			Handle.Invalidate();
@@ -727,6 +939,8 @@ void UYapSubsystem::StartNextQueuedConversation()
 void UYapSubsystem::OnActiveConversationClosed(UObject* Instigator, FYapConversationHandle Handle)
 {	
 	ConversationQueue.Remove(Handle);
+
+	ReleaseConversationPromptSet(Handle);
 	
 	ActiveSpeechMap.RemoveConversation(Handle);
 	
@@ -750,7 +964,46 @@ FYapPromptHandle UYapSubsystem::BroadcastPrompt(const FYapData_PlayerPromptCreat
 		return NullHandle;
 	}
 	
-	PromptHandleConversationTags.Add(Handle, ConversationHandle);
+	TSharedPtr<FYapPromptSet> PromptSet;
+
+	if (const TSharedRef<FYapPromptSet>* ExistingSet = ConversationPromptSets.Find(ConversationHandle))
+	{
+		PromptSet = *ExistingSet;
+	}
+
+	if (PromptSet.IsValid() && PromptSet->bSealed)
+	{
+		// A new menu replaces one which was never answered
+		UE_LOG(LogYap, Verbose, TEXT("Releasing unanswered prompt menu in conversation {%s}"), *ConversationHandle.ToString());
+		
+		ReleasePromptSet(PromptSet.ToSharedRef());
+		PromptSet.Reset();
+	}
+
+	if (!PromptSet.IsValid())
+	{
+#if !UE_BUILD_SHIPPING
+		CheckForLeakedPrompts(false);
+#endif
+		
+		PromptSet = MakeShared<FYapPromptSet>();
+		PromptSet->Conversation = ConversationHandle;
+		
+		ConversationPromptSets.Add(ConversationHandle, PromptSet.ToSharedRef());
+	}
+
+	PromptSet->Handles.Add(Handle);
+	PromptSets.Add(Handle, PromptSet.ToSharedRef());
+
+	if (FYapConversation* Conversation = ActiveSpeechMap.FindConversation(ConversationHandle))
+	{
+		Conversation->AddOpenPrompt(Handle);
+	}
+
+	if (EventRecorder.IsRecording())
+	{
+		EventRecorder.RecordPromptCreated(Handle, ConversationHandle, Data.SpeakerName);
+	}
 
 	auto* HandlerArray = FindConversationHandlerArray(NodeType);
 
@@ -763,6 +1016,11 @@ FYapPromptHandle UYapSubsystem::BroadcastPrompt(const FYapData_PlayerPromptCreat
 
 void UYapSubsystem::OnFinishedBroadcastingPrompts(const FYapData_PlayerPromptsReady& Data, FYapDialogueNodeClassType NodeType)
 {
+	if (const TSharedRef<FYapPromptSet>* PromptSet = ConversationPromptSets.Find(Data.Conversation))
+	{
+		(*PromptSet)->bSealed = true;
+	}
+	
 	auto* HandlerArray = FindConversationHandlerArray(NodeType);
 
 	BroadcastEventHandlerFunc<YAP_BROADCAST_EVT_TARGS(YapConversationHandler, OnConversationPlayerPromptsReady, Execute_K2_ConversationPlayerPromptsReady)>(HandlerArray, Data);
@@ -770,8 +1028,92 @@ void UYapSubsystem::OnFinishedBroadcastingPrompts(const FYapData_PlayerPromptsRe
 
 // ------------------------------------------------------------------------------------------------
 
+void UYapSubsystem::OnPromptsRefreshed(const FYapData_PlayerPromptsRefreshed& Data, FYapDialogueNodeClassType NodeType)
+{
+	auto* HandlerArray = FindConversationHandlerArray(NodeType);
+
+	BroadcastEventHandlerFunc<YAP_BROADCAST_EVT_TARGS(YapConversationHandler, OnConversationPlayerPromptsRefreshed, Execute_K2_ConversationPlayerPromptsRefreshed)>(HandlerArray, Data);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::ReleasePromptSet(const FYapPromptHandle& Handle)
+{
+	if (const TSharedRef<FYapPromptSet>* PromptSet = PromptSets.Find(Handle))
+	{
+		// Copy the reference; releasing removes it from the map
+		ReleasePromptSet(TSharedRef<FYapPromptSet>(*PromptSet));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::ReleasePromptSet(const TSharedRef<FYapPromptSet>& PromptSet)
+{
+	for (const FYapPromptHandle& Handle : PromptSet->Handles)
+	{
+		PromptSets.Remove(Handle);
+	}
+
+	const TSharedRef<FYapPromptSet>* ConversationSet = ConversationPromptSets.Find(PromptSet->Conversation);
+
+	if (ConversationSet && *ConversationSet == PromptSet)
+	{
+		ConversationPromptSets.Remove(PromptSet->Conversation);
+
+		if (FYapConversation* Conversation = ActiveSpeechMap.FindConversation(PromptSet->Conversation))
+		{
+			Conversation->ClearOpenPrompts();
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::ReleaseConversationPromptSet(const FYapConversationHandle& ConversationHandle)
+{
+	if (const TSharedRef<FYapPromptSet>* PromptSet = ConversationPromptSets.Find(ConversationHandle))
+	{
+		ReleasePromptSet(TSharedRef<FYapPromptSet>(*PromptSet));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::CheckForLeakedPrompts(bool bWorldEnding) const
+{
+	TSet<const FYapPromptSet*> Leaked;
+
+	for (const TPair<FYapPromptHandle, TSharedRef<FYapPromptSet>>& Pair : PromptSets)
+	{
+		if (bWorldEnding || !ActiveSpeechMap.HasConversation(Pair.Value->Conversation))
+		{
+			Leaked.Add(&Pair.Value.Get());
+		}
+	}
+
+	for (const FYapPromptSet* PromptSet : Leaked)
+	{
+		UE_LOG(LogYap, Warning, TEXT("Prompt menu with %i handles in conversation {%s} was never released%s"), PromptSet->Handles.Num(), *PromptSet->Conversation.ToString(),
+			bWorldEnding ? TEXT(" before the world ended") : TEXT(" and outlived its conversation"));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
 void UYapSubsystem::RunSpeech(const FYapData_SpeechBegins& SpeechData, FYapDialogueNodeClassType NodeType, const FYapSpeechHandle& SpeechHandle)
 {
+	YAP_TRACE_SCOPE(UYapSubsystem::RunSpeech);
+
+	Yap::Trace::SpeechBegin(SpeechHandle, SpeechData.SpeakerID, SpeechData.Conversation, SpeechData.SpeechTime);
+	
+	if (EventRecorder.IsRecording())
+	{
+		FYapConversationHandle ConversationHandle = (SpeechData.Conversation != NAME_None) ? ActiveSpeechMap.FindSpeechConversationHandle(SpeechHandle) : FYapConversationHandle();
+		
+		EventRecorder.RecordSpeechBegins(SpeechHandle, ConversationHandle, SpeechData, FName(NodeType.Get()->GetPathName()));
+	}
+	
 	TArray<FYapSpeechHandle> ActiveSpeechHandle = ActiveSpeechMap.GetHandles(SpeechData.SpeakerID);
 
 	UFlowNode_YapDialogue* CDO = NodeType.Get()->GetDefaultObject<UFlowNode_YapDialogue>();
@@ -901,6 +1243,7 @@ void UYapSubsystem::RunPrompt(UObject* WorldContext, const FYapPromptHandle& Han
 	if (!IsValid(WorldContext))
 	{
 		UE_LOG(LogYap, Error, TEXT("Tried to call UYapSubsystem::RunPrompt with a null world context, ignoring!"));
+		return;
 	}
 	
 	if (!Handle.IsValid())
@@ -910,34 +1253,42 @@ void UYapSubsystem::RunPrompt(UObject* WorldContext, const FYapPromptHandle& Han
 	}
 
 	UYapSubsystem* Subsystem = Get(WorldContext);
+
+	const TSharedRef<FYapPromptSet>* FoundSet = Subsystem->PromptSets.Find(Handle);
+
+	// Every prompt belongs to a menu; a handle without one was already chosen or released (e.g. chosen twice, or after a newer menu replaced it)
+	if (!FoundSet)
+	{
+		UE_LOG(LogYap, Warning, TEXT("UYapSubsystem::RunPrompt - prompt {%s} is no longer open, ignoring"), *Handle.ToString());
+		return;
+	}
+
+	const TSharedRef<FYapPromptSet> PromptSet = *FoundSet;
+
+	if (Subsystem->EventRecorder.IsRecording())
+	{
+		Subsystem->EventRecorder.RecordPromptChosen(Handle);
+	}
 	
 	// Broadcast to game listeners
 	FYapData_PlayerPromptChosen Data;
 
-	FYapConversationHandle* ConversationHandle = Subsystem->PromptHandleConversationTags.Find(Handle);
+	const FYapConversation* Conversation = GetConversationByHandle(WorldContext, PromptSet->Conversation);
 
-	if (ConversationHandle)
+	if (Conversation)
 	{
-		const FYapConversation* Conversation = GetConversationByHandle(WorldContext, *ConversationHandle);
-
-		if (Conversation)
-		{
-			auto* HandlerArray = Subsystem->FindConversationHandlerArray(Conversation->GetNodeType());
-		
-			BroadcastEventHandlerFunc<YAP_BROADCAST_EVT_TARGS(YapConversationHandler, OnConversationPlayerPromptChosen, Execute_K2_ConversationPlayerPromptChosen)>(HandlerArray, Data, Handle);
-		}
-		else
-		{
-			// TODO error handling!
-		}
+		auto* HandlerArray = Subsystem->FindConversationHandlerArray(Conversation->GetNodeType());
+	
+		BroadcastEventHandlerFunc<YAP_BROADCAST_EVT_TARGS(YapConversationHandler, OnConversationPlayerPromptChosen, Execute_K2_ConversationPlayerPromptChosen)>(HandlerArray, Data, Handle);
 	}
 	else
 	{
-		auto* HandlerArray = Subsystem->FindFreeSpeechHandlerArray(Handle.GetNodeType());
-	
-		BroadcastEventHandlerFunc<YAP_BROADCAST_EVT_TARGS(YapConversationHandler, OnConversationPlayerPromptChosen, Execute_K2_ConversationPlayerPromptChosen)>(HandlerArray, Data, Handle);
+		UE_LOG(LogYap, Warning, TEXT("UYapSubsystem::RunPrompt - conversation {%s} of prompt {%s} is no longer running; handlers were not told"), *PromptSet->Conversation.ToString(), *Handle.ToString());
 	}
 
+	// The menu is answered; the rest of its handles are dead
+	Subsystem->ReleasePromptSet(PromptSet);
+
 	// Broadcast to Yap systems
 	Subsystem->OnPromptChosen.Broadcast(Subsystem, Handle);
 }
@@ -1038,7 +1389,7 @@ bool UYapSubsystem::EndSpeech(FYapSpeechHandle& Handle, EYapSpeechCompleteResult
 
 	FYapSpeechHandle HandleCopy = Handle;
 	Handle.Invalidate();
-	
+
 	FTimerHandle TimerHandle = ActiveSpeechMap.FindTimerHandle(HandleCopy);
 	
 	if (TimerHandle.IsValid())
@@ -1076,6 +1427,11 @@ void UYapSubsystem::AdvanceConversation(UObject* Instigator, const FYapConversat
 		return;
 	}
 	
+	if (Subsystem->EventRecorder.IsRecording())
+	{
+		Subsystem->EventRecorder.RecordConversationAdvanced(ConversationHandle);
+	}
+	
 	TArray<FYapSpeechHandle> RunningFragments = ConversationPtr->GetRunningFragments();
 	
 	//UE_LOG(LogYap, VeryVerbose, TEXT("Subsystem: AdvanceConversation CALLING ONADVANCECONVERSATIONDELEGATE [%s]"), *ConversationHandle.ToString());
@@ -1092,6 +1448,317 @@ void UYapSubsystem::AdvanceConversation(UObject* Instigator, const FYapConversat
 	UE_LOG(LogYap, VeryVerbose, TEXT("Subsystem: AdvanceConversation FINISH [%s]"), *ConversationHandle.ToString());
 }
 
+// ------------------------------------------------------------------------------------------------
+
+int32 UYapSubsystem::SkipConversation(UObject* Instigator, const FYapConversationHandle& ConversationHandle, EYapSkipTarget Target)
+{
+	YAP_TRACE_SCOPE(UYapSubsystem::SkipConversation);
+	
+	UYapSubsystem* Subsystem = Get(Instigator);
+
+	FYapConversation* ConversationPtr = Subsystem ? Subsystem->ActiveSpeechMap.FindConversation(ConversationHandle) : nullptr;
+
+	if (!ConversationPtr)
+	{
+		UE_LOG(LogYap, Warning, TEXT("UYapSubsystem::SkipConversation - could not find conversation for handle {%s}"), *ConversationHandle.ToString());
+		return 0;
+	}
+
+	if (Subsystem->FastForward.IsSet())
+	{
+		UE_LOG(LogYap, Warning, TEXT("UYapSubsystem::SkipConversation {%s} ignored - already skipping a conversation"), *ConversationHandle.ToString());
+		return 0;
+	}
+
+	// The conversation may close while skipping; keep what the summary broadcast needs
+	const TSubclassOf<UFlowNode_YapDialogue> NodeType = ConversationPtr->GetNodeType();
+	
+	FYapFastForward& State = Subsystem->FastForward.Emplace();
+	State.ConversationOwner = ConversationPtr->GetOwner();
+	State.Target = Target;
+	State.RemainingFragments = MaxSkippedFragments;
+	State.bActive = true;
+	State.Summary.Conversation = ConversationHandle;
+	State.Summary.Target = Target;
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	// Advancing finishes the running speech; its dialogue node then runs everything after it synchronously, taking the fast path in RunFragment
+	AdvanceConversation(Instigator, ConversationHandle);
+
+	// Each skipped fragment queues itself instead of advancing in place, so the flow graph is walked one fragment at a time from here
+	TArray<FYapFastForwardStep>& PendingSteps = Subsystem->FastForward->PendingSteps;
+	
+	for (int32 i = 0; i < PendingSteps.Num(); ++i)
+	{
+		const FYapFastForwardStep Step = PendingSteps[i];
+
+		if (UFlowNode_YapDialogue* DialogueNode = Step.Node.Get())
+		{
+			DialogueNode->AdvanceFromFragment(FYapSpeechHandle(), Step.FragmentIndex);
+		}
+	}
+
+	FYapData_ConversationSkipped Summary = MoveTemp(Subsystem->FastForward->Summary);
+	
+	Subsystem->FastForward.Reset();
+
+	UE_LOG(LogYap, Display, TEXT("Subsystem: Skipped %i fragments of conversation {%s} in %.2f ms%s"), Summary.SkippedFragments.Num(), *ConversationHandle.ToString(),
+		(FPlatformTime::Seconds() - StartSeconds) * 1000.0, Summary.bReachedLimit ? TEXT(" (stopped at fragment limit)") : TEXT(""));
+
+	auto* HandlerArray = Subsystem->FindConversationHandlerArray(NodeType);
+
+	BroadcastEventHandlerFunc<YAP_BROADCAST_EVT_TARGS(YapConversationHandler, OnConversationSkipped, Execute_K2_ConversationSkipped)>(HandlerArray, Summary);
+
+	return Summary.SkippedFragments.Num();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapSubsystem::IsFastForwarding(const UObject* ConversationOwner) const
+{
+	return FastForward.IsSet() && FastForward->bActive && FastForward->ConversationOwner == ConversationOwner;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+EYapSkipTarget UYapSubsystem::GetFastForwardTarget() const
+{
+	return FastForward.IsSet() ? FastForward->Target : EYapSkipTarget::NextPrompt;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::RecordFastForwardFragment(UFlowNode_YapDialogue* DialogueNode, uint8 FragmentIndex, bool bAutoChosenPrompt)
+{
+	check(FastForward.IsSet());
+
+	FastForward->Summary.SkippedFragments.Add(DialogueNode->GetFragment(FragmentIndex).GetGuid());
+	FastForward->PendingSteps.Add({ DialogueNode, FragmentIndex });
+
+	if (bAutoChosenPrompt)
+	{
+		++FastForward->Summary.AutoChosenPrompts;
+	}
+
+	if (--FastForward->RemainingFragments <= 0)
+	{
+		UE_LOG(LogYap, Warning, TEXT("Subsystem: Skipping conversation {%s} stopped after %i fragments; the dialogue probably loops"), *FastForward->Summary.Conversation.ToString(), MaxSkippedFragments);
+		
+		FastForward->Summary.bReachedLimit = true;
+		StopFastForward(false);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::StopFastForward(bool bStoppedAtPrompt)
+{
+	if (FastForward.IsSet())
+	{
+		FastForward->bActive = false;
+		FastForward->Summary.bStoppedAtPrompt = bStoppedAtPrompt;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapSubsystem::SaveDialogueState(const UObject* WorldContext, TArray<uint8>& OutData, bool bDelta)
+{
+	YAP_TRACE_SCOPE(UYapSubsystem::SaveDialogueState);
+
+	UYapSubsystem* Subsystem = Get(WorldContext);
+
+	if (!Subsystem)
+	{
+		return false;
+	}
+
+	FYapDialogueSaveState& SaveState = Subsystem->GetDialogueSaveState();
+
+	for (const TWeakObjectPtr<UFlowNode_YapDialogue>& DialogueNode : Subsystem->LiveDialogueNodes)
+	{
+		if (DialogueNode.IsValid())
+		{
+			SaveState.Store(MakeSaveKey(DialogueNode.Get()), DialogueNode->MakeSaveRecord());
+		}
+	}
+
+	OutData.Reset();
+
+	FMemoryWriter Writer(OutData);
+	SaveState.Write(Writer, bDelta);
+
+	// Replacements are sparse and few, so they are always written whole
+	Subsystem->FragmentOverlay.Serialize(Writer);
+
+	UE_LOG(LogYap, Verbose, TEXT("Saved dialogue state for %d nodes (%d bytes%s)"), SaveState.Num(), OutData.Num(), bDelta ? TEXT(", delta") : TEXT(""));
+
+	return !Writer.IsError();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool UYapSubsystem::LoadDialogueState(const UObject* WorldContext, const TArray<uint8>& Data)
+{
+	YAP_TRACE_SCOPE(UYapSubsystem::LoadDialogueState);
+
+	UYapSubsystem* Subsystem = Get(WorldContext);
+
+	if (!Subsystem)
+	{
+		return false;
+	}
+
+	FYapDialogueSaveState& SaveState = Subsystem->GetDialogueSaveState();
+
+	FMemoryReader Reader(Data);
+
+	uint32 Version = 0;
+
+	if (!SaveState.Read(Reader, Version))
+	{
+		return false;
+	}
+
+	if (Version >= FYapDialogueSaveState::ReplacementsVersion)
+	{
+		Subsystem->FragmentOverlay.Serialize(Reader);
+
+		if (Reader.IsError())
+		{
+			UE_LOG(LogYap, Error, TEXT("Fragment replacements in the dialogue save state are corrupt; they were not restored"));
+			Subsystem->FragmentOverlay.Reset();
+		}
+
+		Subsystem->FragmentOverlay.RequestCharacterLoads(Subsystem->GetWorld());
+	}
+	else
+	{
+		Subsystem->FragmentOverlay.Reset();
+	}
+
+	// Running nodes take on the loaded state now, including nodes which have no saved state (they reset)
+	for (const TWeakObjectPtr<UFlowNode_YapDialogue>& DialogueNode : Subsystem->LiveDialogueNodes)
+	{
+		if (DialogueNode.IsValid())
+		{
+			const FYapNodeSaveRecord* Record = SaveState.Find(MakeSaveKey(DialogueNode.Get()));
+
+			DialogueNode->ApplySaveRecord(Record ? *Record : FYapNodeSaveRecord());
+		}
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::RegisterDialogueNode(UFlowNode_YapDialogue* DialogueNode)
+{
+	LiveDialogueNodes.Add(DialogueNode);
+
+	if (const FYapNodeSaveRecord* Record = GetDialogueSaveState().Find(MakeSaveKey(DialogueNode)))
+	{
+		DialogueNode->ApplySaveRecord(*Record);
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::UnregisterDialogueNode(UFlowNode_YapDialogue* DialogueNode)
+{
+	LiveDialogueNodes.RemoveAllSwap([DialogueNode] (const TWeakObjectPtr<UFlowNode_YapDialogue>& Node)
+	{
+		return !Node.IsValid() || Node.Get() == DialogueNode;
+	});
+
+	// Without persistence, activation counts only live as long as the flow asset instance
+	if (UYapProjectSettings::GetPersistDialogueState())
+	{
+		GetDialogueSaveState().Store(MakeSaveKey(DialogueNode), DialogueNode->MakeSaveRecord());
+	}
+	else
+	{
+		GetDialogueSaveState().Remove(MakeSaveKey(DialogueNode));
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapDialogueSaveState& UYapSubsystem::GetDialogueSaveState()
+{
+	FYapDialogueSaveState* GameSaveState = UYapDialogueStateSubsystem::Find(GetWorld());
+
+	return GameSaveState ? *GameSaveState : LocalDialogueSaveState;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapNodeSaveKey UYapSubsystem::MakeSaveKey(const UFlowNode_YapDialogue* DialogueNode)
+{
+	const UFlowAsset* FlowAsset = DialogueNode->GetFlowAsset();
+	const UFlowAsset* TemplateAsset = FlowAsset ? FlowAsset->GetTemplateAsset() : nullptr;
+
+	return { FSoftObjectPath(TemplateAsset ? TemplateAsset : FlowAsset), DialogueNode->GetGuid() };
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if WITH_EDITOR
+void UYapSubsystem::HotPatchDialogueNode(const UFlowNode_YapDialogue* EditedNode)
+{
+	if (!GEngine || !IsValid(EditedNode))
+	{
+		return;
+	}
+
+	// The database was built from the old content; lookups of these fragments now fall back to the fragments themselves
+	FYapDialogueDatabase& Database = FYapDialogueDatabase::Get();
+
+	for (const FYapFragment& Fragment : EditedNode->GetFragments())
+	{
+		Database.MarkFragmentEdited(Fragment.GetGuid());
+	}
+
+	// Keyed by text ID, which an edit of the source string keeps
+	FYapTextFormatCache::Get().Reset();
+
+	for (const FWorldContext& WorldContext : GEngine->GetWorldContexts())
+	{
+		UWorld* World = WorldContext.World();
+
+		if (!World || World->WorldType != EWorldType::PIE)
+		{
+			continue;
+		}
+
+		UYapSubsystem* Subsystem = World->GetSubsystem<UYapSubsystem>();
+
+		if (!Subsystem)
+		{
+			continue;
+		}
+
+		Subsystem->FragmentOverlay.InvalidatePatchedBits();
+
+		// Copied; refreshed prompts can be chosen immediately (auto-select), which may finish nodes and unregister them
+		TArray<TWeakObjectPtr<UFlowNode_YapDialogue>> DialogueNodes = Subsystem->LiveDialogueNodes;
+
+		for (const TWeakObjectPtr<UFlowNode_YapDialogue>& DialogueNode : DialogueNodes)
+		{
+			// Instances are matched through their template asset and node GUID
+			if (DialogueNode.IsValid() && DialogueNode->FindTemplateNode() == EditedNode)
+			{
+				DialogueNode->OnTemplateEdited(EditedNode);
+			}
+		}
+	}
+}
+#endif
+
+// ------------------------------------------------------------------------------------------------
+
 bool UYapSubsystem::EmitSpeechResult(const FYapSpeechHandle& Handle, EYapSpeechCompleteResult Result)
 {	
 	FYapSpeechEvent Evt = ActiveSpeechMap.FindSpeechFinishedEvent(Handle);
@@ -1099,6 +1766,13 @@ bool UYapSubsystem::EmitSpeechResult(const FYapSpeechHandle& Handle, EYapSpeechC
 	FTimerHandle Timer = ActiveSpeechMap.FindTimerHandle(Handle);
 
 	ActiveSpeechMap.RemoveSpeech(Handle);
+
+	if (EventRecorder.IsRecording())
+	{
+		EventRecorder.RecordSpeechEnds(Handle, Result);
+	}
+
+	Yap::Trace::SpeechEnd(Handle, Result);
 	
 	Evt.Broadcast(this, Handle, Result);
 	
@@ -1204,12 +1878,51 @@ void UYapSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	bGetGameMaturitySettingWarningIssued = false;
 
 	NoiseGenerator = NewObject<UYapSquirrel>(this);
+
+	const TSoftObjectPtr<UYapNodeConfig>& DefaultNodeConfigAsset = UYapProjectSettings::GetDefaultNodeConfig();
+
+	if (!DefaultNodeConfigAsset.IsNull())
+	{
+		// Required: under the Skip and Fail sync load policies nodes would otherwise run with the wrong config
+		DefaultNodeConfig = FYapStreamableManager::LoadSynchronous(DefaultNodeConfigAsset, YAP_SYNC_LOAD_SITE, true);
+
+		if (!DefaultNodeConfig)
+		{
+			UE_LOG(LogYap, Error, TEXT("Failed to load the default node config <%s>!"), *DefaultNodeConfigAsset.ToString());
+		}
+	}
+
+#if STATS
+	if (GetWorld() && GetWorld()->IsGameWorld())
+	{
+		StatsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this] (float DeltaTime)
+		{
+			UpdateStats();
+			return true;
+		}));
+	}
+#endif
 }
 
 // ------------------------------------------------------------------------------------------------
 
 void UYapSubsystem::Deinitialize()
 {
+#if !UE_BUILD_SHIPPING
+	CheckForLeakedPrompts(true);
+#endif
+
+	FragmentOverlay.Reset();
+	
+#if STATS
+	FTSTicker::GetCoreTicker().RemoveTicker(StatsTickerHandle);
+	StatsTickerHandle.Reset();
+#endif
+	
+	if (EventRecorder.IsRecording())
+	{
+		EventRecorder.Stop(FYapEventRecorder::GetDefaultRecordingPath());
+	}
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -1254,4 +1967,87 @@ bool UYapSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
 
 // ------------------------------------------------------------------------------------------------
 
+void UYapSubsystem::DumpState(FOutputDevice& Ar) const
+{
+	Ar.Logf(TEXT("Yap subsystem state for world <%s>"), *GetNameSafe(GetWorld()));
+
+	Ar.Logf(TEXT("ConversationQueue (%i), active is last:"), ConversationQueue.Num());
+
+	for (const FYapConversationHandle& Handle : ConversationQueue)
+	{
+		Ar.Logf(TEXT("  {%s}"), *Handle.ToString());
+	}
+
+	for (const TPair<TSubclassOf<UFlowNode_YapDialogue>, FYapHandlersArray>& Pair : ConversationHandlers)
+	{
+		Ar.Logf(TEXT("Conversation handlers for <%s>: %i"), *GetNameSafe(Pair.Key), Pair.Value.Array.Num());
+	}
+	
+	for (const TPair<TSubclassOf<UFlowNode_YapDialogue>, FYapHandlersArray>& Pair : FreeSpeechHandlers)
+	{
+		Ar.Logf(TEXT("Free speech handlers for <%s>: %i"), *GetNameSafe(Pair.Key), Pair.Value.Array.Num());
+	}
+
+	Ar.Logf(TEXT("Open prompt handles: %i in %i conversations"), PromptSets.Num(), ConversationPromptSets.Num());
+	Ar.Logf(TEXT("FragileSpeechHandles: %i"), FragileSpeechHandles.Num());
+	Ar.Logf(TEXT("TaggedFragments: %i"), TaggedFragments.Num());
+	Ar.Logf(TEXT("Outstanding streamable handles: %i"), FYapStreamableManager::GetOutstandingHandleCount());
+	Ar.Logf(TEXT("Sync loads this session: %i"), FYapStreamableManager::GetSyncLoadCount());
+
+	ActiveSpeechMap.Dump(Ar);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void UYapSubsystem::UpdateStats() const
+{
+#if STATS
+	int32 HandlerCount = 0;
+
+	for (const TPair<TSubclassOf<UFlowNode_YapDialogue>, FYapHandlersArray>& Pair : ConversationHandlers)
+	{
+		HandlerCount += Pair.Value.Array.Num();
+	}
+	
+	for (const TPair<TSubclassOf<UFlowNode_YapDialogue>, FYapHandlersArray>& Pair : FreeSpeechHandlers)
+	{
+		HandlerCount += Pair.Value.Array.Num();
+	}
+
+	// The conversation map holds queued conversations too; the first one in the queue is the one running
+	const int32 QueuedCount = FMath::Max(ConversationQueue.Num() - 1, 0);
+
+	SET_DWORD_STAT(STAT_YapActiveSpeeches, ActiveSpeechMap.GetSpeechCount());
+	SET_DWORD_STAT(STAT_YapRunningConversations, FMath::Max(ActiveSpeechMap.GetConversationCount() - QueuedCount, 0));
+	SET_DWORD_STAT(STAT_YapQueuedConversations, QueuedCount);
+	SET_DWORD_STAT(STAT_YapRegisteredHandlers, HandlerCount);
+	SET_DWORD_STAT(STAT_YapStreamableHandles, FYapStreamableManager::GetOutstandingHandleCount());
+	SET_DWORD_STAT(STAT_YapSyncLoads, FYapStreamableManager::GetSyncLoadCount());
+	SET_DWORD_STAT(STAT_YapOpenPromptHandles, PromptSets.Num());
+	SET_DWORD_STAT(STAT_YapFragileSpeechHandles, FragileSpeechHandles.Num());
+	SET_DWORD_STAT(STAT_YapTaggedFragments, TaggedFragments.Num());
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice YapDumpCommand(
+	TEXT("Yap.Dump"),
+	TEXT("Print the Yap subsystem's runtime state, including every active speech and conversation."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([] (const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UYapSubsystem* Subsystem = UYapSubsystem::Get(World))
+		{
+			Subsystem->DumpState(Ar);
+		}
+		else
+		{
+			Ar.Logf(TEXT("No Yap subsystem in this world"));
+		}
+	}));
+#endif
+
+// ------------------------------------------------------------------------------------------------
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
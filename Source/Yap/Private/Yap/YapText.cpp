@@ -3,8 +3,388 @@
 
 #include "Yap/YapText.h"
 
+#include "Async/ParallelFor.h"
+#include "Internationalization/BreakIterator.h"
+#include "Misc/ThreadSingleton.h"
+#include "Yap/YapBroker.h"
+#include "Yap/YapLog.h"
 #include "Yap/YapProjectSettings.h"
 #include "Yap/YapSubsystem.h"
+#include "Yap/YapTrace.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+	#include <arm_neon.h>
+	#define YAP_TEXT_COUNT_NEON 1
+#elif PLATFORM_ENABLE_VECTORINTRINSICS
+	#include <emmintrin.h>
+	#define YAP_TEXT_COUNT_SSE 1
+#endif
+
+#ifndef YAP_TEXT_COUNT_NEON
+	#define YAP_TEXT_COUNT_NEON 0
+#endif
+
+#ifndef YAP_TEXT_COUNT_SSE
+	#define YAP_TEXT_COUNT_SSE 0
+#endif
+
+namespace Yap
+{
+	namespace TextCount
+	{
+	/** Classification of up to eight UTF-16 code units, one bit per unit. */
+	struct FBlockMasks
+	{
+		/** ASCII whitespace, the only word separator on the fast path. */
+		uint32 Space = 0;
+
+		/** Space plus NEL and no-break space, which are skipped when counting characters but do not separate words. */
+		uint32 Whitespace = 0;
+
+		/** Hyphen-minus, hyphen, en dash and em dash. */
+		uint32 Hyphen = 0;
+
+		uint32 Digit = 0;
+
+		/** A unit which may be or start a combining mark; graphemes then need the character boundary iterator. */
+		bool bCombining = false;
+
+		/** A unit outside IsSimpleScript. Words then need the line-break iterator. */
+		bool bComplexScript = false;
+	};
+
+	/**
+	 * Latin (including Latin-1 Supplement, Extended-A/B and Extended Additional), Greek, Cyrillic, Armenian, Hebrew and Arabic, plus the
+	 * General Punctuation marks dialogue is full of (dashes, curly quotes, ellipsis). The General Punctuation spaces, separators and format
+	 * characters (U+2000-200F, U+2028-202F, U+205F-206F) are left to the line-break iterator.
+	 */
+	FORCEINLINE bool IsSimpleScript(uint32 Char)
+	{
+		return Char < 0x0700 || (Char - 0x1E00) <= 0xFF || (Char - 0x2010) <= 0x17 || (Char - 0x2030) <= 0x2E;
+	}
+
+	FORCEINLINE void ClassifyUnits(const TCHAR* Units, int32 Count, FBlockMasks& Out)
+	{
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const uint32 Char = static_cast<uint32>(Units[i]);
+			const uint32 Bit = 1u << i;
+
+			const bool bSpace = Char == 0x20 || (Char - 0x09) <= 4;
+
+			Out.Space |= bSpace ? Bit : 0;
+			Out.Whitespace |= (bSpace || Char == 0x85 || Char == 0xA0) ? Bit : 0;
+			Out.Hyphen |= (Char == '-' || Char == 0x2010 || (Char - 0x2013) <= 1) ? Bit : 0;
+			Out.Digit |= ((Char - '0') <= 9) ? Bit : 0;
+			Out.bCombining |= (Char - 0x0300) <= 0x6F || (Char - 0x0483) <= (0x06FF - 0x0483);
+			Out.bComplexScript |= !IsSimpleScript(Char);
+		}
+	}
+
+#if YAP_TEXT_COUNT_SSE
+	FORCEINLINE uint32 MoveMask(__m128i Mask)
+	{
+		return static_cast<uint32>(_mm_movemask_epi8(_mm_packs_epi16(Mask, _mm_setzero_si128())));
+	}
+
+	/** Lanes where Min <= Char <= Max. SSE2 has no unsigned 16-bit compare, so saturate (Char - Min) against the range size instead. */
+	FORCEINLINE __m128i InRange(__m128i Chars, int16 Min, int16 Size)
+	{
+		return _mm_cmpeq_epi16(_mm_subs_epu16(_mm_sub_epi16(Chars, _mm_set1_epi16(Min)), _mm_set1_epi16(Size)), _mm_setzero_si128());
+	}
+#elif YAP_TEXT_COUNT_NEON
+	FORCEINLINE uint32 MoveMask(uint16x8_t Mask)
+	{
+		static const uint16 LaneBits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+		return vaddvq_u16(vandq_u16(Mask, vld1q_u16(LaneBits)));
+	}
+
+	FORCEINLINE uint16x8_t InRange(uint16x8_t Chars, uint16 Min, uint16 Size)
+	{
+		return vcleq_u16(vsubq_u16(Chars, vdupq_n_u16(Min)), vdupq_n_u16(Size));
+	}
+#endif
+
+	/** Classifies eight code units (16 bytes) at once. */
+	FORCEINLINE void ClassifyBlock(const TCHAR* Units, FBlockMasks& Out)
+	{
+#if YAP_TEXT_COUNT_SSE
+		if constexpr (sizeof(TCHAR) == sizeof(uint16))
+		{
+			const __m128i Chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Units));
+
+			const __m128i Space = _mm_or_si128(_mm_cmpeq_epi16(Chars, _mm_set1_epi16(0x20)), InRange(Chars, 0x09, 4));
+			const __m128i Whitespace = _mm_or_si128(Space, _mm_or_si128(_mm_cmpeq_epi16(Chars, _mm_set1_epi16(0x85)), _mm_cmpeq_epi16(Chars, _mm_set1_epi16(0xA0))));
+			const __m128i Hyphen = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(Chars, _mm_set1_epi16('-')), _mm_cmpeq_epi16(Chars, _mm_set1_epi16(0x2010))), InRange(Chars, 0x2013, 1));
+			const __m128i Combining = _mm_or_si128(InRange(Chars, 0x0300, 0x6F), InRange(Chars, 0x0483, 0x06FF - 0x0483));
+			const __m128i Simple = _mm_or_si128(_mm_or_si128(InRange(Chars, 0x0000, 0x06FF), InRange(Chars, 0x1E00, 0xFF)), _mm_or_si128(InRange(Chars, 0x2010, 0x17), InRange(Chars, 0x2030, 0x2E)));
+
+			Out.Space = MoveMask(Space);
+			Out.Whitespace = MoveMask(Whitespace);
+			Out.Hyphen = MoveMask(Hyphen);
+			Out.Digit = MoveMask(InRange(Chars, '0', 9));
+			Out.bCombining = MoveMask(Combining) != 0;
+			Out.bComplexScript = MoveMask(Simple) != 0xFF;
+		}
+		else
+#elif YAP_TEXT_COUNT_NEON
+		if constexpr (sizeof(TCHAR) == sizeof(uint16))
+		{
+			const uint16x8_t Chars = vld1q_u16(reinterpret_cast<const uint16*>(Units));
+
+			const uint16x8_t Space = vorrq_u16(vceqq_u16(Chars, vdupq_n_u16(0x20)), InRange(Chars, 0x09, 4));
+			const uint16x8_t Whitespace = vorrq_u16(Space, vorrq_u16(vceqq_u16(Chars, vdupq_n_u16(0x85)), vceqq_u16(Chars, vdupq_n_u16(0xA0))));
+			const uint16x8_t Hyphen = vorrq_u16(vorrq_u16(vceqq_u16(Chars, vdupq_n_u16('-')), vceqq_u16(Chars, vdupq_n_u16(0x2010))), InRange(Chars, 0x2013, 1));
+			const uint16x8_t Combining = vorrq_u16(InRange(Chars, 0x0300, 0x6F), InRange(Chars, 0x0483, 0x06FF - 0x0483));
+			const uint16x8_t Simple = vorrq_u16(vorrq_u16(InRange(Chars, 0x0000, 0x06FF), InRange(Chars, 0x1E00, 0xFF)), vorrq_u16(InRange(Chars, 0x2010, 0x17), InRange(Chars, 0x2030, 0x2E)));
+
+			Out.Space = MoveMask(Space);
+			Out.Whitespace = MoveMask(Whitespace);
+			Out.Hyphen = MoveMask(Hyphen);
+			Out.Digit = MoveMask(InRange(Chars, '0', 9));
+			Out.bCombining = MoveMask(Combining) != 0;
+			Out.bComplexScript = MoveMask(Simple) != 0xFF;
+		}
+		else
+#endif
+		{
+			ClassifyUnits(Units, 8, Out);
+		}
+	}
+
+	/**
+	 * Counts words and characters of text in space-delimited scripts, 64 code units per pass. A word starts after whitespace, or after a dash
+	 * inside a word unless a digit or another dash follows ("well-known" is two words, "-5" and "a--b" one and two).
+	 * This approximates the line-break iterator rather than matching it: ICU also breaks after '/' and some other symbols and around em
+	 * dashes next to digits, which count as one word here. Returns false as soon as the text needs the line-break iterator.
+	 */
+	bool CountSpaceDelimited(const FString& Text, int32& OutWords, int32& OutCharacters, bool& bOutHasCombining)
+	{
+		const TCHAR* Units = *Text;
+		const int32 Len = Text.Len();
+
+		// The start of the text behaves as if preceded by whitespace
+		uint64 PrevSpace = ~0ull;
+		uint64 PrevHyphen = 0;
+
+		OutWords = 0;
+		OutCharacters = 0;
+		bOutHasCombining = false;
+
+		for (int32 ChunkStart = 0; ChunkStart < Len; ChunkStart += 64)
+		{
+			const int32 ChunkLen = FMath::Min(64, Len - ChunkStart);
+
+			uint64 Space = 0;
+			uint64 Whitespace = 0;
+			uint64 Hyphen = 0;
+			uint64 Digit = 0;
+
+			for (int32 BlockStart = 0; BlockStart < ChunkLen; BlockStart += 8)
+			{
+				FBlockMasks Masks;
+
+				if (ChunkLen - BlockStart >= 8)
+				{
+					ClassifyBlock(Units + ChunkStart + BlockStart, Masks);
+				}
+				else
+				{
+					ClassifyUnits(Units + ChunkStart + BlockStart, ChunkLen - BlockStart, Masks);
+				}
+
+				if (Masks.bComplexScript)
+				{
+					return false;
+				}
+
+				bOutHasCombining |= Masks.bCombining;
+
+				Space |= static_cast<uint64>(Masks.Space) << BlockStart;
+				Whitespace |= static_cast<uint64>(Masks.Whitespace) << BlockStart;
+				Hyphen |= static_cast<uint64>(Masks.Hyphen) << BlockStart;
+				Digit |= static_cast<uint64>(Masks.Digit) << BlockStart;
+			}
+
+			// Past the end of the text is whitespace
+			if (ChunkLen < 64)
+			{
+				const uint64 Padding = ~0ull << ChunkLen;
+				Space |= Padding;
+				Whitespace |= Padding;
+			}
+
+			const uint64 PrevIsSpace = (Space << 1) | (PrevSpace >> 63);
+			const uint64 PrevIsHyphen = (Hyphen << 1) | (PrevHyphen >> 63);
+			const uint64 PrevPrevIsSpace = (Space << 2) | (PrevSpace >> 62);
+
+			const uint64 WordStarts = ~Space & (PrevIsSpace | (PrevIsHyphen & ~PrevPrevIsSpace & ~Hyphen & ~Digit));
+
+			OutWords += FMath::CountBits(WordStarts);
+			OutCharacters += FMath::CountBits(~Whitespace);
+
+			PrevSpace = Space;
+			PrevHyphen = Hyphen;
+		}
+
+		return true;
+	}
+
+	/** ICU break iterators are slow to create; keep one of each per thread. */
+	struct FBreakIterators : public TThreadSingleton<FBreakIterators>
+	{
+		TSharedRef<IBreakIterator> LineBreak = FBreakIterator::CreateLineBreakIterator();
+
+		TSharedRef<IBreakIterator> Grapheme = FBreakIterator::CreateCharacterBoundaryIterator();
+	};
+
+	/** Counts segments between breaks; with bSkipWhitespace, segments which start with whitespace are not counted. */
+	int32 CountSegments(IBreakIterator& Iterator, const FString& Text, bool bSkipWhitespace)
+	{
+		Iterator.SetString(Text);
+
+		int32 NumSegments = 0;
+		int32 PreviousBreak = 0;
+
+		for (int32 CurrentBreak = Iterator.MoveToNext(); CurrentBreak != INDEX_NONE; CurrentBreak = Iterator.MoveToNext())
+		{
+			if (CurrentBreak > PreviousBreak && !(bSkipWhitespace && FChar::IsWhitespace(Text[PreviousBreak])))
+			{
+				++NumSegments;
+			}
+
+			PreviousBreak = CurrentBreak;
+		}
+
+		Iterator.ClearString();
+
+		return NumSegments;
+	}
+
+	int32 CountCharacters(const FString& Text)
+	{
+		int32 NumCharacters = 0;
+
+		// A surrogate pair counts once
+		for (TCHAR Char : Text)
+		{
+			if (!FChar::IsWhitespace(Char) && !StringConv::IsLowSurrogate(Char))
+			{
+				++NumCharacters;
+			}
+		}
+
+		return NumCharacters;
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 FYapText::CountWords(const FString& InText)
+{
+	int32 NumWords;
+	int32 NumCharacters;
+	bool bHasCombining;
+	
+	if (Yap::TextCount::CountSpaceDelimited(InText, NumWords, NumCharacters, bHasCombining))
+	{
+		return NumWords;
+	}
+
+	return Yap::TextCount::CountSegments(*Yap::TextCount::FBreakIterators::Get().LineBreak, InText, false);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapTextCounts FYapText::CountText(const FString& InText)
+{
+	FYapTextCounts Counts;
+
+	if (InText.IsEmpty())
+	{
+		return Counts;
+	}
+
+	auto Saturate = [] (int32 Value) { return static_cast<uint16>(FMath::Min(Value, static_cast<int32>(MAX_uint16))); };
+
+	Yap::TextCount::FBreakIterators& Iterators = Yap::TextCount::FBreakIterators::Get();
+
+	int32 NumWords;
+	int32 NumCharacters;
+	int32 NumGraphemes;
+	bool bHasCombining;
+
+	if (Yap::TextCount::CountSpaceDelimited(InText, NumWords, NumCharacters, bHasCombining))
+	{
+		// Without combining marks every non-whitespace code unit is its own grapheme
+		NumGraphemes = bHasCombining ? Yap::TextCount::CountSegments(*Iterators.Grapheme, InText, true) : NumCharacters;
+	}
+	else
+	{
+		NumWords = Yap::TextCount::CountSegments(*Iterators.LineBreak, InText, false);
+		NumCharacters = Yap::TextCount::CountCharacters(InText);
+		NumGraphemes = Yap::TextCount::CountSegments(*Iterators.Grapheme, InText, true);
+	}
+
+	Counts.Words = Saturate(NumWords);
+	Counts.Characters = Saturate(NumCharacters);
+	Counts.Graphemes = Saturate(NumGraphemes);
+
+	return Counts;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if WITH_EDITOR
+int32 FYapText::RecountWords(TConstArrayView<FYapText*> Texts)
+{
+	YAP_TRACE_SCOPE(FYapText::RecountWords);
+	
+	const UYapBroker& Broker = UYapBroker::GetInEditor();
+
+	TArray<int32> NewWordCounts;
+	NewWordCounts.SetNumUninitialized(Texts.Num());
+
+	auto Count = [&Broker, &Texts, &NewWordCounts] (int32 Index)
+	{
+		const FText& Text = Texts[Index]->Text;
+		NewWordCounts[Index] = Text.IsEmptyOrWhitespace() ? 0 : Broker.CalculateWordCount(Text);
+	};
+
+	if (Broker.CanCalculateWordCountInParallel())
+	{
+		ParallelFor(Texts.Num(), Count);
+	}
+	else
+	{
+		for (int32 Index = 0; Index < Texts.Num(); ++Index)
+		{
+			Count(Index);
+		}
+	}
+
+	int32 NumChanged = 0;
+
+	for (int32 Index = 0; Index < Texts.Num(); ++Index)
+	{
+		if (NewWordCounts[Index] < 0)
+		{
+			UE_LOG(LogYap, Error, TEXT("Could not calculate word count!"));
+		}
+
+		if (Texts[Index]->WordCount != NewWordCounts[Index])
+		{
+			Texts[Index]->WordCount = NewWordCounts[Index];
+			++NumChanged;
+		}
+	}
+
+	return NumChanged;
+}
+#endif
+
+// ------------------------------------------------------------------------------------------------
 
 #if WITH_EDITOR
 void FYapText::Set(const FText& InText)
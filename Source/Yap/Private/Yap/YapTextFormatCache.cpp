@@ -0,0 +1,165 @@
+﻿// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license. 
+
+#include "Yap/YapTextFormatCache.h"
+
+#include "Internationalization/TextLocalizationManager.h"
+#include "Yap/YapBroker.h"
+#include "Yap/YapLog.h"
+#include "Yap/YapTrace.h"
+
+namespace Yap
+{
+	namespace TextFormat
+	{
+	void AppendValueKey(FString& Key, const FFormatArgumentValue& Value)
+	{
+		switch (Value.GetType())
+		{
+			case EFormatArgumentType::Int:
+			{
+				Key.Appendf(TEXT("i%lld"), static_cast<long long>(Value.GetIntValue()));
+				break;
+			}
+			case EFormatArgumentType::UInt:
+			{
+				Key.Appendf(TEXT("u%llu"), static_cast<unsigned long long>(Value.GetUIntValue()));
+				break;
+			}
+			case EFormatArgumentType::Float:
+			{
+				Key.Appendf(TEXT("f%.9g"), Value.GetFloatValue());
+				break;
+			}
+			case EFormatArgumentType::Double:
+			{
+				Key.Appendf(TEXT("d%.17g"), Value.GetDoubleValue());
+				break;
+			}
+			case EFormatArgumentType::Text:
+			{
+				Key += TEXT("t");
+				Key += Value.GetTextValue().ToString();
+				break;
+			}
+			case EFormatArgumentType::Gender:
+			{
+				Key.Appendf(TEXT("g%i"), static_cast<int32>(Value.GetGenderValue()));
+				break;
+			}
+		}
+
+		// Unit separator; cannot appear in dialogue
+		Key.AppendChar(TCHAR(0x1F));
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapTextFormatCache& FYapTextFormatCache::Get()
+{
+	static FYapTextFormatCache Cache;
+	return Cache;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FText FYapTextFormatCache::Format(const FText& Pattern, FName SpeakerID, FName DirectedAtID, const UYapBroker& Broker)
+{
+	YAP_TRACE_SCOPE(FYapTextFormatCache::Format);
+
+	check(IsInGameThread());
+
+	if (Pattern.IsEmpty())
+	{
+		return Pattern;
+	}
+
+	const uint16 CurrentTextRevision = FTextLocalizationManager::Get().GetTextRevision();
+
+	if (CurrentTextRevision != TextRevision)
+	{
+		Reset();
+		TextRevision = CurrentTextRevision;
+	}
+
+	FPattern& Compiled = FindOrCompile(Pattern);
+
+	if (Compiled.ArgumentNames.Num() == 0)
+	{
+		return Pattern;
+	}
+
+	FFormatNamedArguments Arguments;
+	FString ResultKey;
+
+	for (int32 i = 0; i < Compiled.ArgumentNames.Num(); ++i)
+	{
+		FFormatArgumentValue Value = Broker.GetTextArgument(Compiled.ArgumentFNames[i], SpeakerID, DirectedAtID);
+
+		Yap::TextFormat::AppendValueKey(ResultKey, Value);
+		Arguments.Add(Compiled.ArgumentNames[i], MoveTemp(Value));
+	}
+
+	if (const FText* Result = Compiled.Results.Find(ResultKey))
+	{
+		return *Result;
+	}
+
+	if (Compiled.Results.Num() >= MaxResultsPerPattern)
+	{
+		Compiled.Results.Reset();
+	}
+
+	return Compiled.Results.Add(MoveTemp(ResultKey), FText::Format(Compiled.Format, MoveTemp(Arguments)));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapTextFormatCache::Reset()
+{
+	KeyedPatterns.Empty();
+	LiteralPatterns.Empty();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapTextFormatCache::FPattern& FYapTextFormatCache::FindOrCompile(const FText& Pattern)
+{
+	const FTextId TextId = FTextInspector::GetTextId(Pattern);
+
+	FPattern* Existing = TextId.IsEmpty() ? LiteralPatterns.Find(Pattern.ToString()) : KeyedPatterns.Find(TextId);
+
+	if (Existing)
+	{
+		return *Existing;
+	}
+
+	YAP_TRACE_SCOPE(FYapTextFormatCache::Compile);
+
+	FPattern Compiled;
+	Compiled.Format = FTextFormat(Pattern);
+
+	if (Compiled.Format.IsValid())
+	{
+		Compiled.Format.GetFormatArgumentNames(Compiled.ArgumentNames);
+
+		for (const FString& ArgumentName : Compiled.ArgumentNames)
+		{
+			Compiled.ArgumentFNames.Add(FName(ArgumentName));
+		}
+	}
+	else
+	{
+		// Shown unformatted, like FText::Format would
+		UE_LOG(LogYap, Warning, TEXT("Dialogue text is not a valid format pattern: %s"), *Pattern.ToString());
+	}
+
+	if (TextId.IsEmpty())
+	{
+		return LiteralPatterns.Add(Pattern.ToString(), MoveTemp(Compiled));
+	}
+
+	return KeyedPatterns.Add(TextId, MoveTemp(Compiled));
+}
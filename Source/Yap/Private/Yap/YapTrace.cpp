@@ -0,0 +1,166 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "Yap/YapTrace.h"
+
+#include "Yap/Handles/YapSpeechHandle.h"
+
+#define LOCTEXT_NAMESPACE "Yap"
+
+#if YAP_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_DEFINE(YapChannel);
+
+UE_TRACE_EVENT_BEGIN(Yap, SpeechBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(float, SpeechTime)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Handle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Speaker)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Conversation)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Yap, SpeechEnd)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint8, Result)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Handle)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Yap, FragmentBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Fragment)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Handle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Node)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Yap, LoadWait)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Asset)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Fragment)
+UE_TRACE_EVENT_END()
+
+namespace Yap
+{
+	namespace Trace
+	{
+	/** Fragment being run on this thread, see FFragmentContextScope. */
+	static thread_local FGuid CurrentFragmentGuid;
+	}
+}
+
+#endif
+
+// ------------------------------------------------------------------------------------------------
+
+void Yap::Trace::SpeechBegin(const FYapSpeechHandle& Handle, FName SpeakerID, FName Conversation, float SpeechTime)
+{
+#if YAP_TRACE_ENABLED
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(YapChannel))
+	{
+		return;
+	}
+
+	const FString HandleString = Handle.ToString();
+	const FString SpeakerString = SpeakerID.ToString();
+	const FString ConversationString = Conversation.IsNone() ? FString() : Conversation.ToString();
+
+	UE_TRACE_LOG(Yap, SpeechBegin, YapChannel)
+		<< SpeechBegin.Cycle(FPlatformTime::Cycles64())
+		<< SpeechBegin.SpeechTime(SpeechTime)
+		<< SpeechBegin.Handle(*HandleString, HandleString.Len())
+		<< SpeechBegin.Speaker(*SpeakerString, SpeakerString.Len())
+		<< SpeechBegin.Conversation(*ConversationString, ConversationString.Len());
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Yap::Trace::SpeechEnd(const FYapSpeechHandle& Handle, EYapSpeechCompleteResult Result)
+{
+#if YAP_TRACE_ENABLED
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(YapChannel))
+	{
+		return;
+	}
+
+	const FString HandleString = Handle.ToString();
+
+	UE_TRACE_LOG(Yap, SpeechEnd, YapChannel)
+		<< SpeechEnd.Cycle(FPlatformTime::Cycles64())
+		<< SpeechEnd.Result(static_cast<uint8>(Result))
+		<< SpeechEnd.Handle(*HandleString, HandleString.Len());
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Yap::Trace::FragmentBegin(const FGuid& FragmentGuid, const FYapSpeechHandle& Handle, const UObject* DialogueNode)
+{
+#if YAP_TRACE_ENABLED
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(YapChannel))
+	{
+		return;
+	}
+
+	const FString FragmentString = FragmentGuid.ToString();
+	const FString HandleString = Handle.ToString();
+	const FString NodeString = GetPathNameSafe(DialogueNode);
+
+	UE_TRACE_LOG(Yap, FragmentBegin, YapChannel)
+		<< FragmentBegin.Cycle(FPlatformTime::Cycles64())
+		<< FragmentBegin.Fragment(*FragmentString, FragmentString.Len())
+		<< FragmentBegin.Handle(*HandleString, HandleString.Len())
+		<< FragmentBegin.Node(*NodeString, NodeString.Len());
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void Yap::Trace::LoadWait(const FSoftObjectPath& AssetPath, uint64 StartCycle, uint64 EndCycle)
+{
+#if YAP_TRACE_ENABLED
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(YapChannel))
+	{
+		return;
+	}
+
+	const FString AssetString = AssetPath.ToString();
+	const FString FragmentString = CurrentFragmentGuid.IsValid() ? CurrentFragmentGuid.ToString() : FString();
+
+	UE_TRACE_LOG(Yap, LoadWait, YapChannel)
+		<< LoadWait.StartCycle(StartCycle)
+		<< LoadWait.EndCycle(EndCycle)
+		<< LoadWait.Asset(*AssetString, AssetString.Len())
+		<< LoadWait.Fragment(*FragmentString, FragmentString.Len());
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+
+#if YAP_TRACE_ENABLED
+Yap::Trace::FFragmentContextScope::FFragmentContextScope(const FGuid& FragmentGuid)
+	: PreviousGuid(CurrentFragmentGuid)
+{
+	CurrentFragmentGuid = FragmentGuid;
+}
+
+Yap::Trace::FFragmentContextScope::~FFragmentContextScope()
+{
+	CurrentFragmentGuid = PreviousGuid;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Yap::Trace::FLoadWaitScope::FLoadWaitScope(const FSoftObjectPath& InAssetPath)
+	: AssetPath(InAssetPath)
+	, StartCycle(FPlatformTime::Cycles64())
+{
+}
+
+Yap::Trace::FLoadWaitScope::~FLoadWaitScope()
+{
+	LoadWait(AssetPath, StartCycle, FPlatformTime::Cycles64());
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
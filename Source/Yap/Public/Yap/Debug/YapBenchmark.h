@@ -0,0 +1,118 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Yap/Interfaces/IYapConversationHandler.h"
+#include "Yap/Interfaces/IYapFreeSpeechHandler.h"
+
+#include "YapBenchmark.generated.h"
+
+class UYapSubsystem;
+
+// ================================================================================================
+
+/** Handler which ignores every event, so benchmarks measure Yap rather than game UI. */
+UCLASS(Transient)
+class UYapBenchmarkHandler : public UObject, public IYapConversationHandler, public IYapFreeSpeechHandler
+{
+	GENERATED_BODY()
+
+public:
+	void OnConversationOpened(FYapData_ConversationOpened Data, FYapConversationHandle Handle) override { }
+
+	void OnConversationSpeechBegins(FYapData_SpeechBegins Data, FYapSpeechHandle Handle) override { }
+
+	void OnConversationPlayerPromptCreated(FYapData_PlayerPromptCreated Data, FYapPromptHandle Handle) override { }
+
+	void OnConversationPlayerPromptsReady(FYapData_PlayerPromptsReady Data) override { }
+
+	void OnConversationPlayerPromptChosen(FYapData_PlayerPromptChosen Data, FYapPromptHandle Handle) override { }
+
+	void OnTalkSpeechBegins(FYapData_SpeechBegins Data, FYapSpeechHandle Handle) override { }
+};
+
+// ================================================================================================
+
+struct FYapBenchmarkSettings
+{
+	/** Concurrent free speeches started (and then cancelled). */
+	int32 FreeSpeechCount = 1000;
+
+	/** Conversations queued and then closed. */
+	int32 ConversationCount = 200;
+
+	/** Prompt menus broadcast. */
+	int32 PromptMenuCount = 200;
+
+	/** Options per prompt menu. */
+	int32 PromptsPerMenu = 6;
+
+	/** Speeches running in a conversation for each advance. */
+	int32 AdvanceSpeechCount = 8;
+
+	/** Number of conversation advances. */
+	int32 AdvanceCount = 500;
+
+	/** Speech time used for timed speech; long enough that timers never fire during a run. */
+	float SpeechTime = 1000.0f;
+};
+
+// ================================================================================================
+
+struct FYapBenchmarkResult
+{
+	FString Name;
+
+	int32 Operations = 0;
+
+	double TotalSeconds = 0.0;
+
+	/** Heap allocations (including reallocations) made on the benchmark's thread while the operations ran. */
+	int64 Allocations = 0;
+
+	/** Bytes requested by those allocations. */
+	int64 AllocatedBytes = 0;
+
+	int32 PeakSpeechCount = 0;
+
+	int32 PeakConversationCount = 0;
+
+	int32 PeakPromptHandleCount = 0;
+
+	double GetMicrosecondsPerOp() const { return Operations > 0 ? TotalSeconds * 1000000.0 / Operations : 0.0; }
+
+	double GetAllocationsPerOp() const { return Operations > 0 ? static_cast<double>(Allocations) / Operations : 0.0; }
+};
+
+// ================================================================================================
+
+/**
+ * Stress benchmarks for the conversation and bark paths of UYapSubsystem. Runs against a world's subsystem with a no-op
+ * handler registered; use RunHeadless to run inside a temporary world. Runs as the Yap.Performance.SubsystemStress automation test, or
+ * from the console with Yap.Benchmark.
+ */
+struct YAP_API FYapBenchmark
+{
+	static TArray<FYapBenchmarkResult> Run(UWorld* World, const FYapBenchmarkSettings& Settings);
+
+	static TArray<FYapBenchmarkResult> RunHeadless(const FYapBenchmarkSettings& Settings);
+
+	static FString ToJson(const TArray<FYapBenchmarkResult>& Results, const FYapBenchmarkSettings& Settings);
+
+	static bool SaveJson(const FString& Path, const TArray<FYapBenchmarkResult>& Results, const FYapBenchmarkSettings& Settings);
+
+	/** Default location for results, Saved/Yap/Benchmarks/<timestamp>.json */
+	static FString GetDefaultResultsPath();
+
+private:
+	static FYapBenchmarkResult RunFreeSpeech(UYapSubsystem& Subsystem, UObject* SpeechOwner, const FYapBenchmarkSettings& Settings, FYapBenchmarkResult& OutCancelResult);
+
+	static FYapBenchmarkResult RunConversations(UYapSubsystem& Subsystem, const FYapBenchmarkSettings& Settings);
+
+	static FYapBenchmarkResult RunPrompts(UYapSubsystem& Subsystem, const FYapBenchmarkSettings& Settings);
+
+	static FYapBenchmarkResult RunAdvanceStorm(UYapSubsystem& Subsystem, UObject* SpeechOwner, const FYapBenchmarkSettings& Settings);
+
+	static void SamplePeaks(UYapSubsystem& Subsystem, FYapBenchmarkResult& Result);
+};
@@ -0,0 +1,213 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Yap/Enums/YapMaturitySetting.h"
+
+class UFlowAsset;
+class UFlowNode;
+class UFlowNode_YapDialogue;
+
+// ================================================================================================
+
+enum class EYapSimulatedPromptChoice : uint8
+{
+	/** Pick a random available prompt. */
+	Random,
+
+	/** Pick prompts from ScriptedChoices in order (index into the available prompts, clamped); random once the script runs out. */
+	Scripted,
+};
+
+// ------------------------------------------------------------------------------------------------
+
+enum class EYapSimulatedConditions : uint8
+{
+	/** Every condition passes. Finds what is reachable at all. */
+	AssumePass,
+
+	/** Every condition passes with ConditionPassChance. Approximates game state without running condition logic. */
+	Random,
+};
+
+// ================================================================================================
+
+struct FYapSimulationSettings
+{
+	/** Number of complete playthroughs of the flow asset. Fragment and node activation counts carry across runs, like a flow asset which is replayed. */
+	int32 RunCount = 10000;
+
+	/** Runs reset activation counts after this many playthroughs; 1 means every run starts fresh. */
+	int32 RunsPerSession = 1;
+
+	int32 Seed = 0;
+
+	EYapMaturitySetting MaturitySetting = EYapMaturitySetting::Mature;
+
+	/** Assume the dialogue runs inside a conversation (affects auto-advance and interruptibility flags). */
+	bool bInConversation = true;
+
+	EYapSimulatedPromptChoice PromptChoice = EYapSimulatedPromptChoice::Random;
+
+	TArray<int32> ScriptedChoices;
+
+	EYapSimulatedConditions Conditions = EYapSimulatedConditions::AssumePass;
+
+	float ConditionPassChance = 0.5f;
+
+	/** Virtual seconds the player takes to pick a prompt. */
+	float PromptDecisionTime = 2.0f;
+
+	/** Virtual seconds the player takes to advance a fragment which does not auto-advance. */
+	float ManualAdvanceTime = 0.5f;
+
+	/** Node visits after which a run is cut off; guards against flows which loop forever. */
+	int32 MaxStepsPerRun = 10000;
+
+	/** Complete paths after which Explore stops enumerating; reachability is still exact, the longest path becomes a lower bound. */
+	int32 MaxExploredPaths = 100000;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+struct FYapSimulatedFragmentRef
+{
+	FGuid NodeGuid;
+
+	FString NodeName;
+
+	uint8 FragmentIndex = 0;
+
+	/** Number of times this happened over the simulation (meaning depends on the list it is in). */
+	int32 Count = 0;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+struct FYapSimulatedPath
+{
+	/** Prompt choices made along the path, as "NodeName[FragmentIndex]" joined with '>'. Empty for flows without prompts. */
+	FString Choices;
+
+	int32 Runs = 0;
+
+	double TotalPlaytime = 0.0;
+
+	double MinPlaytime = TNumericLimits<double>::Max();
+
+	double MaxPlaytime = 0.0;
+
+	/** True if runs along this path hit MaxStepsPerRun. */
+	bool bTruncated = false;
+
+	double GetAveragePlaytime() const { return Runs > 0 ? TotalPlaytime / Runs : 0.0; }
+};
+
+// ------------------------------------------------------------------------------------------------
+
+struct FYapSimulationReport
+{
+	FSoftObjectPath FlowAsset;
+
+	int32 Runs = 0;
+
+	double WallSeconds = 0.0;
+
+	double TotalPlaytime = 0.0;
+
+	TArray<FYapSimulatedPath> Paths;
+
+	/** Fragments which never ran in any playthrough. */
+	TArray<FYapSimulatedFragmentRef> UnreachableFragments;
+
+	/** Fragments skipped because their activation limit was met; Count is the number of skips. */
+	TArray<FYapSimulatedFragmentRef> ExhaustedFragments;
+
+	/** Dialogue nodes bypassed because their node activation limit was met; FragmentIndex is unused. */
+	TArray<FYapSimulatedFragmentRef> ExhaustedNodes;
+
+	/** Player prompt nodes entered with no valid option; FragmentIndex is unused. */
+	TArray<FYapSimulatedFragmentRef> EmptyPrompts;
+
+	double GetRunsPerSecond() const { return WallSeconds > 0.0 ? Runs / WallSeconds : 0.0; }
+};
+
+// ------------------------------------------------------------------------------------------------
+
+struct FYapDeadBranch
+{
+	FGuid NodeGuid;
+
+	FString NodeName;
+
+	/** None if the whole node is dead. */
+	FName PinName;
+
+	FString Reason;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/** Result of FYapDialogueSimulator::Explore. Conditions are symbolic: any condition may pass or fail, and any activation limit may be met. */
+struct FYapPathCoverageReport
+{
+	FSoftObjectPath FlowAsset;
+
+	/** Fragments in the asset. */
+	int32 Lines = 0;
+
+	int32 ReachableLines = 0;
+
+	/** Complete paths enumerated. A path ends at an unconnected output or where it loops back onto itself. */
+	int32 Paths = 0;
+
+	/** True if MaxExploredPaths cut enumeration short; LongestPathSeconds is then a lower bound. */
+	bool bPathLimitReached = false;
+
+	/** Worst case virtual playtime of any enumerated path, taking the longest fragments at every choice. */
+	double LongestPathSeconds = 0.0;
+
+	TArray<FYapSimulatedFragmentRef> UnreachableFragments;
+
+	TArray<FYapDeadBranch> DeadBranches;
+};
+
+// ================================================================================================
+
+/** A flow asset flattened for simulation. Built on the game thread by Prepare; afterwards it touches no UObjects, so separate ones can be simulated or explored in parallel. */
+class FYapPreparedSimulation;
+
+// ================================================================================================
+
+/**
+ * Plays a flow asset's dialogue without running the flow: no node instances, timers, handlers, UI or audio playback. Walks the
+ * template graph from the default entry node, applying the dialogue node's own rules (conditions, activation limits, talk sequencing,
+ * prompts) and advancing a virtual clock by each fragment's speech and padding time, as computed by UFlowNode_YapDialogue::GetFragmentTiming.
+ *
+ * When sampling, non-dialogue nodes are treated as pass-through along their first connected output; Explore follows all of them. Fragment
+ * Start/End pins are never followed, since they run in parallel with the dialogue. Run from the console with Yap.Simulate.
+ */
+struct YAP_API FYapDialogueSimulator
+{
+	/** World is only used as the context for speech time (broker audio durations); it is not ticked. */
+	static FYapSimulationReport Run(UWorld* World, const UFlowAsset* FlowAsset, const FYapSimulationSettings& Settings);
+
+	/** Game thread only. Returns null if the asset has no entry node. */
+	static TSharedPtr<FYapPreparedSimulation> Prepare(UWorld* World, const UFlowAsset* FlowAsset, const FYapSimulationSettings& Settings);
+
+	/** Runs Settings.RunCount sampled playthroughs. Safe to call from any thread. */
+	static FYapSimulationReport Simulate(FYapPreparedSimulation& Prepared);
+
+	/** Enumerates every path symbolically instead of sampling. Safe to call from any thread. */
+	static FYapPathCoverageReport Explore(const FYapPreparedSimulation& Prepared);
+
+	static FYapSimulationReport RunHeadless(const UFlowAsset* FlowAsset, const FYapSimulationSettings& Settings);
+
+	static FString ToJson(const FYapSimulationReport& Report);
+
+	static bool SaveJson(const FString& Path, const FYapSimulationReport& Report);
+
+	/** Default location for reports, Saved/Yap/Simulations/<asset>_<timestamp>.json */
+	static FString GetDefaultReportPath(const UFlowAsset* FlowAsset);
+};
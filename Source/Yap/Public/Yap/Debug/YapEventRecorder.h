@@ -0,0 +1,131 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+struct FYapSpeechHandle;
+struct FYapPromptHandle;
+struct FYapConversationHandle;
+struct FYapData_SpeechBegins;
+enum class EYapSpeechCompleteResult : uint8;
+
+// ================================================================================================
+
+enum class EYapRecordedEventType : uint8
+{
+	ConversationOpened,
+	ConversationClosed,
+	SpeechBegins,
+	SpeechEnds,
+	PromptCreated,
+	PromptChosen,
+	ConversationAdvanced,
+	SpeechCancelled,
+	SpeechAdvanced,
+	MAX
+};
+
+// ================================================================================================
+
+/** A single recorded subsystem event. Fields which do not apply to the event type are left at defaults. */
+struct YAP_API FYapRecordedEvent
+{
+	/** World time (seconds) relative to the start of the recording. */
+	double Time = 0.0;
+
+	EYapRecordedEventType Type = EYapRecordedEventType::MAX;
+
+	/** Speech, prompt or conversation handle, depending on the event type. */
+	FGuid Handle;
+
+	/** Conversation the event belongs to. Invalid for free speech. */
+	FGuid Conversation;
+
+	/** Conversation name for conversation events, speaker ID for speech and prompt events. */
+	FName Name;
+
+	/** Path name of the dialogue node class which produced the event. */
+	FName NodeType;
+
+	/** Only used by SpeechBegins. */
+	float SpeechTime = 0.0f;
+
+	/** Only used by SpeechEnds; an EYapSpeechCompleteResult. */
+	uint8 Result = 0;
+};
+
+// ================================================================================================
+
+/**
+ * Captures every UYapSubsystem event into memory while recording. Stopping the recorder writes a compact binary log:
+ * a name table and GUID table followed by packed records (type byte, delta-microseconds, table indices).
+ * Use UYapEventReplayDriver to re-feed a log into a world.
+ */
+class YAP_API FYapEventRecorder
+{
+public:
+	static const uint32 FileMagic;
+
+	static const uint32 FileVersion;
+
+	// ------------------------------------------
+	// STATE
+	// ------------------------------------------
+private:
+	bool bRecording = false;
+
+	double StartTime = 0.0;
+
+	TWeakObjectPtr<UWorld> World;
+
+	TArray<FYapRecordedEvent> Events;
+
+	// ------------------------------------------
+	// API
+	// ------------------------------------------
+public:
+	void Start(UWorld* InWorld);
+
+	/** Stops recording. If a path is given, the log is written to it. */
+	void Stop(const FString& Path = FString());
+
+	bool IsRecording() const { return bRecording; }
+
+	const TArray<FYapRecordedEvent>& GetEvents() const { return Events; }
+
+	void RecordConversationOpened(const FYapConversationHandle& Handle, FName ConversationName, FName NodeType);
+
+	void RecordConversationClosed(const FYapConversationHandle& Handle);
+
+	void RecordSpeechBegins(const FYapSpeechHandle& Handle, const FYapConversationHandle& Conversation, const FYapData_SpeechBegins& Data, FName NodeType);
+
+	/** The one terminal event for a speech: SpeechEnds when it ran out, SpeechAdvanced or SpeechCancelled when it was interrupted. */
+	void RecordSpeechEnds(const FYapSpeechHandle& Handle, EYapSpeechCompleteResult Result);
+
+	void RecordPromptCreated(const FYapPromptHandle& Handle, const FYapConversationHandle& Conversation, FName SpeakerID);
+
+	void RecordPromptChosen(const FYapPromptHandle& Handle);
+
+	void RecordConversationAdvanced(const FYapConversationHandle& Handle);
+
+	/** Default location for recordings, Saved/Yap/Recordings/<timestamp>.yaprec */
+	static FString GetDefaultRecordingPath();
+
+	static bool SaveToFile(const FString& Path, const TArray<FYapRecordedEvent>& InEvents);
+
+	static bool LoadFromFile(const FString& Path, TArray<FYapRecordedEvent>& OutEvents);
+
+	static void SerializeEvents(FArchive& Ar, TArray<FYapRecordedEvent>& InOutEvents);
+
+private:
+	FYapRecordedEvent& AddEvent(EYapRecordedEventType Type);
+
+	static bool SerializeHeader(FArchive& Ar);
+
+	static void WriteEvents(FArchive& Ar, const TArray<FYapRecordedEvent>& InEvents);
+
+	static void ReadEvents(FArchive& Ar, TArray<FYapRecordedEvent>& OutEvents);
+};
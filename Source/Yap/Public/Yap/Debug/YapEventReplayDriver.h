@@ -0,0 +1,107 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Yap/Debug/YapEventRecorder.h"
+#include "Yap/Interfaces/IYapConversationHandler.h"
+#include "Yap/Interfaces/IYapFreeSpeechHandler.h"
+
+#include "YapEventReplayDriver.generated.h"
+
+class UYapSubsystem;
+class UFlowNode_YapDialogue;
+
+// ================================================================================================
+
+/** Stand-in for whatever object owned a recorded conversation (normally a flow asset). */
+UCLASS(Transient)
+class UYapReplayConversationOwner : public UObject
+{
+	GENERATED_BODY()
+};
+
+// ================================================================================================
+
+/**
+ * Re-feeds a log captured by FYapEventRecorder into a world's Yap subsystem, reproducing the recorded sequence and timing.
+ * Conversation, prompt and speech handles from the log are mapped onto freshly created ones.
+ * Speech which ended normally is not replayed explicitly; the subsystem's own speech timers reproduce it. Neither is speech which was ended
+ * by a replayed conversation advance.
+ * The driver registers itself as a no-op handler so that replays do not require any game UI.
+ */
+UCLASS(Transient)
+class YAP_API UYapEventReplayDriver : public UObject, public IYapConversationHandler, public IYapFreeSpeechHandler
+{
+	GENERATED_BODY()
+
+	// ------------------------------------------
+	// STATE
+	// ------------------------------------------
+protected:
+	TArray<FYapRecordedEvent> Events;
+
+	int32 NextEventIndex = 0;
+
+	double StartTime = 0.0;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UWorld> World;
+
+	/** Stand-in owner objects for recorded conversations, keyed by recorded conversation GUID. */
+	UPROPERTY(Transient)
+	TMap<FGuid, TObjectPtr<UObject>> ConversationOwners;
+
+	UPROPERTY(Transient)
+	TMap<FGuid, FYapConversationHandle> ConversationHandles;
+
+	UPROPERTY(Transient)
+	TMap<FGuid, FYapPromptHandle> PromptHandles;
+
+	TSet<TSubclassOf<UFlowNode_YapDialogue>> RegisteredNodeTypes;
+
+	// ------------------------------------------
+	// API
+	// ------------------------------------------
+public:
+	bool LoadFromFile(const FString& Path);
+
+	void SetEvents(const TArray<FYapRecordedEvent>& InEvents) { Events = InEvents; }
+
+	/** Starts feeding events into the world. Events are dispatched from the world's timer manager, so the world must be ticking. */
+	void Start(UWorld* InWorld);
+
+	void Stop();
+
+	bool IsFinished() const { return NextEventIndex >= Events.Num(); }
+
+	/** Creates a bare game world, replays the log into it by ticking at a fixed rate, then destroys the world. Returns false if the log could not be loaded. */
+	static bool RunHeadless(const FString& Path, float TickRate = 60.0f, TArray<FYapRecordedEvent>* OutReplayedEvents = nullptr);
+
+	UWorld* GetWorld() const override { return World; }
+
+protected:
+	void Pump();
+
+	void Dispatch(UYapSubsystem& Subsystem, const FYapRecordedEvent& Event);
+
+	void RegisterForNodeType(FName NodeTypePath);
+
+	TSubclassOf<UFlowNode_YapDialogue> ResolveNodeType(FName NodeTypePath) const;
+
+	// ------------------------------------------
+	// Handler interfaces - intentionally no-ops
+	// ------------------------------------------
+public:
+	void OnConversationOpened(FYapData_ConversationOpened Data, FYapConversationHandle Handle) override { }
+
+	void OnConversationSpeechBegins(FYapData_SpeechBegins Data, FYapSpeechHandle Handle) override { }
+
+	void OnConversationPlayerPromptCreated(FYapData_PlayerPromptCreated Data, FYapPromptHandle Handle) override { }
+
+	void OnConversationPlayerPromptsReady(FYapData_PlayerPromptsReady Data) override { }
+
+	void OnConversationPlayerPromptChosen(FYapData_PlayerPromptChosen Data, FYapPromptHandle Handle) override { }
+
+	void OnTalkSpeechBegins(FYapData_SpeechBegins Data, FYapSpeechHandle Handle) override { }
+};
@@ -0,0 +1,20 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+namespace Yap
+{
+	namespace Debug
+	{
+	/** Creates a bare game world with no level content, registered with the engine and begun play. Used for replays and benchmarks. */
+	YAP_API UWorld* CreateHeadlessWorld(FName WorldName);
+
+	/** Tears down a world made by CreateHeadlessWorld. */
+	YAP_API void DestroyHeadlessWorld(UWorld* World);
+	}
+}
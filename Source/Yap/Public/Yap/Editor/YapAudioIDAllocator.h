@@ -0,0 +1,128 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#if WITH_EDITOR
+
+#include "Containers/BitArray.h"
+#include "UObject/ObjectSaveContext.h"
+
+class UPackage;
+struct FYapAudioIDFormat;
+
+// ================================================================================================
+
+/**
+ * Allocates dialogue node audio IDs (see FYapAudioIDFormat::NodeIDFormat) which no other node in the project has used. Every ID which was
+ * allocated, or seen on a saved dialogue node, is recorded in a registry on disk and never handed out again, so audio recorded against a
+ * deleted node's ID can never be picked up by a new one.
+ *
+ * Each format's keyspace is enumerated and tracked with a bitmap, so an allocation is a bit search rather than retries against a set of
+ * strings. The keyspace is split into ranges and each user allocates from their own range first, so two people adding nodes at the same time
+ * do not hand out the same ID before their registries are synced. Each user claims the lowest range no other user's registry file claims and
+ * records it in their own file; if two users claimed the same range before syncing, the one whose file sorts later claims another. The registry is one text file per user (GetRegistryDirectory), appended to
+ * only by that user, so it merges cleanly in source control; other users' files are re-read when they change. New IDs are written to it in
+ * batches (see Flush), not on every allocation.
+ *
+ * Editor only, game thread only.
+ */
+class YAP_API FYapAudioIDAllocator
+{
+public:
+	FYapAudioIDAllocator();
+
+	static FYapAudioIDAllocator& Get();
+
+	/** <Project>/Yap/AudioIDs/. Submit this folder to source control. */
+	static FString GetRegistryDirectory();
+
+	/**
+	 * Returns a new ID, or an empty string if every ID of the format is used. bRandom picks a random free ID in this user's range, otherwise
+	 * the first free one. IllegalCharacters are excluded from the wildcard characters of the format.
+	 */
+	FString Allocate(const FYapAudioIDFormat& Format, const FString& IllegalCharacters, bool bRandom = true);
+
+	/** Bulk version of Allocate (e.g. re-IDing a folder of flow assets); the registry is written once. Returns the number allocated. */
+	int32 AllocateMany(const FYapAudioIDFormat& Format, const FString& IllegalCharacters, int32 Count, bool bRandom, TArray<FString>& OutIDs);
+
+	/** Records IDs which are in use, e.g. found on dialogue nodes. Returns how many were not already recorded. */
+	int32 Reserve(const TArray<FString>& IDs);
+
+	bool IsUsed(const FString& ID);
+
+	/** Appends IDs recorded since the last flush to this user's registry file. Runs whenever a package is saved and on exit. */
+	void Flush();
+
+private:
+	/** Every ID one NodeIDFormat (with one set of illegal characters) can produce, in mixed radix: one digit per character of the format. */
+	struct FKeyspace
+	{
+		/** Per character of the format; empty for characters which are copied as-is. */
+		TArray<TArray<TCHAR>> Alphabets;
+
+		/** Per character of the format; the character used where there is no alphabet. */
+		TArray<TCHAR> Literals;
+
+		int64 Size = 1;
+
+		/** Only for keyspaces up to MaxBitmapSize; larger ones probe UsedIDs at random, which stays fast while they are sparse. */
+		TBitArray<> Used;
+
+		int32 NumUsed = 0;
+
+		bool UsesBitmap() const { return Used.Num() > 0; }
+
+		FString Encode(int64 Index) const;
+
+		/** INDEX_NONE if the ID is not of this format. */
+		int64 Decode(const FString& ID) const;
+	};
+
+	static constexpr int64 MaxBitmapSize = 1 << 24;
+
+	static constexpr int32 NumUserRanges = 64;
+
+	FKeyspace& FindOrAddKeyspace(const FYapAudioIDFormat& Format, const FString& IllegalCharacters);
+
+	/** INDEX_NONE if the keyspace is full. */
+	int64 FindFreeIndex(const FKeyspace& Keyspace, bool bRandom) const;
+
+	void MarkUsed(const FString& ID);
+
+	/** Loads registry files which are new or changed since last read; checks at most once a second unless forced. */
+	void Refresh(bool bForce = false);
+
+	/** Keeps the range recorded in this user's file, unless another user's file claims it too and sorts first; otherwise claims and records the lowest free range. */
+	void ClaimUserRange();
+
+	void LoadRegistryFile(const FString& Path);
+
+	void OnPackageSaved(const FString& PackageFileName, UPackage* Package, FObjectPostSaveContext SaveContext);
+
+	FString GetUserFilePath() const;
+
+	TSet<FString> UsedIDs;
+
+	/** Recorded but not yet written to this user's registry file. */
+	TArray<FString> PendingIDs;
+
+	TMap<FString, FKeyspace> Keyspaces;
+
+	TMap<FString, FDateTime> RegistryFileTimestamps;
+
+	/** Range claimed by each registry file (a "#Range=" line), by file path. */
+	TMap<FString, int32> ClaimedRanges;
+
+	double LastRefreshTime = -1.0;
+
+	/** Which of the NumUserRanges this user allocates from first; INDEX_NONE until claimed. */
+	int32 UserRange = INDEX_NONE;
+
+	/** Set when registry files were (re)loaded, as they may claim ranges. */
+	bool bUserRangeStale = true;
+
+	FString UserName;
+};
+
+#endif
@@ -0,0 +1,15 @@
+﻿// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license. 
+
+#pragma once
+
+/** How far UYapSubsystem::SkipConversation fast-forwards a conversation. */
+UENUM(BlueprintType)
+enum class EYapSkipTarget : uint8
+{
+	/** Stop at the next player prompt and broadcast it normally. */
+	NextPrompt,
+
+	/** Keep going until the conversation's dialogue runs out, taking the first available option at every player prompt. */
+	End,
+};
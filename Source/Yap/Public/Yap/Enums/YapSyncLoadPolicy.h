@@ -0,0 +1,14 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license. 
+
+#pragma once
+
+/** What Yap does when it has to synchronously load an asset during gameplay. */
+UENUM()
+enum class EYapSyncLoadPolicy : uint8
+{
+	Warn,	// Load the asset and log a warning
+	Ensure,	// Load the asset and trigger an ensure
+	Skip,	// Do not load the asset; speech runs without it
+	Fail,	// Do not load the asset; the speech fails to run
+};
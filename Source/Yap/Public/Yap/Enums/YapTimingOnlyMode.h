@@ -0,0 +1,13 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license. 
+
+#pragma once
+
+/** When Yap runs dialogue from IDs and precomputed durations only, without loading characters, audio or building text. */
+UENUM()
+enum class EYapTimingOnlyMode : uint8
+{
+	Off,				// Dialogue always loads and broadcasts its full content
+	DedicatedServer,	// Dedicated servers run dialogue timing-only
+	Always,				// Every game world runs dialogue timing-only; for testing server behaviour in PIE
+};
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Yap/Enums/YapSkipTarget.h"
 #include "YapConversationHandle.generated.h"
 
 UDELEGATE()
@@ -99,6 +100,10 @@ public:
     /** Call this function to either skip running dialogue or to manually advance stepped dialogue. */
     UFUNCTION(BlueprintCallable, Category = "Yap|ConversationHandle", meta = (WorldContext = "WorldContext"))
     static UPARAM(DisplayName = "Handle") FYapConversationHandle AdvanceConversation(UObject* WorldContext, FYapConversationHandle Handle);
+
+    /** Fast-forward the conversation to its next player prompt or to its end; skipped fragments still count as ran and fire their pins. Handlers receive a single Conv. Skipped event. */
+    UFUNCTION(BlueprintCallable, Category = "Yap|ConversationHandle", meta = (WorldContext = "WorldContext"))
+    static UPARAM(DisplayName = "Handle") FYapConversationHandle SkipConversation(UObject* WorldContext, FYapConversationHandle Handle, EYapSkipTarget Target);
     
     /** Apply an interlock on Conversation Opening to prevent the "Open Conversation" flow node from finishing. Play animations or await other things before finally finishing the Open Conversation node. */
     UFUNCTION(BlueprintCallable, Category = "Yap|ConversationHandle", meta = (DefaultToSelf = "LockObject"))
@@ -7,6 +7,7 @@
 #include "GameplayTagContainer.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "Templates/SubclassOf.h"
+#include "Yap/Handles/YapConversationHandle.h"
 
 #include "YapPromptHandle.generated.h"
 
@@ -73,6 +74,23 @@ FORCEINLINE uint32 GetTypeHash(const FYapPromptHandle& Struct)
 
 // ================================================================================================
 
+/**
+ * The prompts of one player prompt menu. The subsystem creates one when a menu's first prompt is broadcast and every handle of the menu
+ * shares it. The set is released as a unit when a prompt is chosen, the conversation closes, or the dialogue node exits, after which none of
+ * its handles are known to the subsystem.
+ */
+struct YAP_API FYapPromptSet
+{
+	FYapConversationHandle Conversation;
+
+	TArray<FYapPromptHandle> Handles;
+
+	/** Set once every prompt of the menu has been broadcast; the conversation's next prompt starts a new set. */
+	bool bSealed = false;
+};
+
+// ================================================================================================
+
 /**
  * Function library for prompt handles.
  */
@@ -10,6 +10,10 @@
 #include "IYapCharacterInterface.generated.h"
 
 class UFlowNode_YapDialogue;
+struct FStreamableHandle;
+
+UDELEGATE()
+DECLARE_DYNAMIC_DELEGATE_OneParam(FYapPortraitLoadedDelegate, const UTexture2D*, Portrait);
 
 UINTERFACE(MinimalAPI, Blueprintable, BlueprintType)
 class UYapCharacterInterface : public UInterface
@@ -37,9 +41,18 @@ public:
     /** Try to get the supplied character's color. Will log an error if the character does not implement the interface. */
     static FLinearColor GetColor(const UObject* Character);
 
-    /** Try to get the supplied character's portrait. Will log an error if the character does not implement the interface. */
+    /** Try to get the supplied character's portrait. Will log an error if the character does not implement the interface. Portraits which are not resident are loaded synchronously; prefer RequestPortrait. */
     static const UTexture2D* GetPortrait(const UObject* Character, FGameplayTag MoodTag = FGameplayTag::EmptyTag);
 
+    /** The supplied character's portrait as a soft reference, without loading it. Null if the character does not stream its portraits. */
+    static TSoftObjectPtr<UTexture2D> GetPortraitAsset(const UObject* Character, FGameplayTag MoodTag = FGameplayTag::EmptyTag);
+
+    /**
+     * Streams in the supplied character's portrait and calls OnLoaded with it, immediately if it is already resident. Keep the texture referenced
+     * (e.g. in a widget brush) for as long as it is shown; nothing else holds it. The returned handle may be used to cancel or wait for the load.
+     */
+    static TSharedPtr<FStreamableHandle> RequestPortrait(const UObject* Character, FGameplayTag MoodTag, TFunction<void(const UTexture2D*)> OnLoaded);
+
 public:
     // -----------------------------------------------------
     // Public C++ Interface - Override these in a C++ class which inherits this interface, and use if you implement the interface solely in C++ in your game.
@@ -54,6 +67,9 @@ public:
     /** Override this on a C++ class. Pass in nullptr for the dialogue node type to use the default Yap Node type. */
     virtual const UTexture2D* GetCharacterPortrait(const FGameplayTag& MoodTag) const;
 
+    /** Override this on a C++ class whose portraits are soft references, so Yap can stream them on demand instead of calling GetCharacterPortrait. */
+    virtual TSoftObjectPtr<UTexture2D> GetCharacterPortraitAsset(const FGameplayTag& MoodTag) const;
+
 protected:
     // -----------------------------------------------------
     // Blueprint Interface - Override these in a blueprint on which you've added this interface
@@ -71,6 +87,10 @@ protected:
     UFUNCTION(BlueprintImplementableEvent, Category = "Yap|Character", DisplayName = "Get Portrait")
     const UTexture2D* K2_GetYapCharacterPortrait(const FGameplayTag& MoodTag) const;
 
+    /** Optionally implement this on a blueprint whose portraits are soft references. If it returns nothing, Get Portrait is used instead. */
+    UFUNCTION(BlueprintImplementableEvent, Category = "Yap|Character", DisplayName = "Get Portrait Asset")
+    TSoftObjectPtr<UTexture2D> K2_GetYapCharacterPortraitAsset(const FGameplayTag& MoodTag) const;
+
 #if WITH_EDITOR
 public:
     static bool IsAsset_YapCharacter(const TSoftObjectPtr<UObject> Asset);
@@ -109,4 +129,14 @@ class UYapCharacterBFL : public UBlueprintFunctionLibrary
     {
         return IYapCharacterInterface::GetPortrait(Character.GetObject(), MoodTag);
     }
+
+    /** Stream in the supplied character's portrait; OnLoaded runs once it is resident (straight away if it already is). */
+    UFUNCTION(BlueprintCallable, Category = "Yap|Character")
+    static void LoadPortraitAsync(const TScriptInterface<IYapCharacterInterface> Character, FGameplayTag MoodTag, FYapPortraitLoadedDelegate OnLoaded)
+    {
+        IYapCharacterInterface::RequestPortrait(Character.GetObject(), MoodTag, [OnLoaded] (const UTexture2D* Portrait)
+        {
+            OnLoaded.ExecuteIfBound(Portrait);
+        });
+    }
 };
\ No newline at end of file
@@ -61,6 +61,14 @@ protected:
 	/** Code to run when a player prompt is ran. Do NOT call Parent when overriding. */
 	UFUNCTION(BlueprintImplementableEvent, DisplayName = "Conv. Player Prompt Chosen")
 	void K2_ConversationPlayerPromptChosen(FYapData_PlayerPromptChosen Data, FYapPromptHandle Handle);
+
+	/** Code to run when open player prompts are replaced, e.g. after their dialogue was edited while playing in editor. Remove the current prompt entries; the new ones are emitted next. Do NOT call Parent when overriding. */
+	UFUNCTION(BlueprintImplementableEvent, DisplayName = "Conv. Player Prompts Refreshed")
+	void K2_ConversationPlayerPromptsRefreshed(FYapData_PlayerPromptsRefreshed Data);
+
+	/** Code to run once after a conversation was fast-forwarded; skipped fragments emit no other events. Do NOT call Parent when overriding. */
+	UFUNCTION(BlueprintImplementableEvent, DisplayName = "Conv. Skipped")
+	void K2_ConversationSkipped(FYapData_ConversationSkipped Data);
 	
 	// -----------------------------------------------------
 	// C++ Interface - Override these in a C++ class which inherits this interface
@@ -96,6 +104,18 @@ public:
 	{
 		K2_ConversationPlayerPromptChosen(Data, Handle);
 	}
+	
+	/** Code to run when open player prompts are replaced, e.g. after their dialogue was edited while playing in editor. Remove the current prompt entries; the new ones are emitted next. Do NOT call Super when overriding. */
+	YAP_API virtual void OnConversationPlayerPromptsRefreshed(FYapData_PlayerPromptsRefreshed Data)
+	{
+		K2_ConversationPlayerPromptsRefreshed(Data);
+	}
+	
+	/** Code to run once after a conversation was fast-forwarded; skipped fragments emit no other events. Do NOT call Super when overriding. */
+	YAP_API virtual void OnConversationSkipped(FYapData_ConversationSkipped Data)
+	{
+		K2_ConversationSkipped(Data);
+	}
 };
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include "FlowNode_YapDialogue.generated.h"
 
 class UYapCharacterAsset;
+struct FYapNodeSaveRecord;
 
 // ------------------------------------------------------------------------------------------------
 /**
@@ -83,6 +84,7 @@ class YAP_API UFlowNode_YapDialogue : public UFlowNode
 	friend class SFlowGraphNode_YapFragmentWidget;
 	friend class SYapConditionDetailsViewWidget;
 	friend class UFlowGraphNode_YapDialogue;
+	friend class UYapReassignAudioIDsCommandlet;
 #endif
 	friend struct FYapDialogueActiveSmartObject;
 
@@ -139,7 +141,7 @@ protected:
     UPROPERTY(EditAnywhere, Category = "Default")
 	FString AudioID = "";
 	
-	/** Actual dialogue contents. */
+	/** Actual dialogue contents. Emptied on running instances, which read their template node's fragments instead (see GetFragments). */
     UPROPERTY(EditAnywhere, Category = "Default")
 	TArray<FYapFragment> Fragments;
 
@@ -185,12 +187,26 @@ protected:
 	UPROPERTY(Transient)
 	TSet<FYapSpeechHandle> SpeakingFragments;
 
+	/** Lazily built lookup of fragment GUID to index; rebuilt on any miss, so edits to the fragments array never leave it stale for long. */
+	mutable TMap<FGuid, uint8> FragmentIndicesByGuid;
+
+	/** Lazily built lookup of FragmentID to index, built alongside FragmentIndicesByGuid. */
+	mutable TMap<FName, uint8> FragmentIndicesByID;
+
 	/**  */
 	UPROPERTY(Transient)
 	TSet<FYapSpeechHandle> FragmentsInPadding;
 
 	UPROPERTY(Transient)
 	int32 LastRanFragment = INDEX_NONE;
+
+	/** Per-fragment mutable state of this node instance, parallel to the fragments array. */
+	UPROPERTY(Transient)
+	TArray<FYapFragmentRunState> FragmentRunStates;
+
+	/** Set on running instances; this node in the instance's template asset, which owns the fragment content. */
+	UPROPERTY(Transient)
+	TObjectPtr<UFlowNode_YapDialogue> TemplateNode;
 	
 	// ============================================================================================
 	// PUBLIC API
@@ -213,13 +229,24 @@ public:
 	/** How many times is this dialogue node allowed to successfully run? */
 	int32 GetNodeActivationLimit() const { return NodeActivationLimit; }
 
+	/** Activation counts and the last ran fragment of this node instance, for UYapSubsystem's dialogue save state. */
+	FYapNodeSaveRecord MakeSaveRecord() const;
+
+	/** Restores a record from MakeSaveRecord. Fragments which no longer exist on the node are ignored. */
+	void ApplySaveRecord(const FYapNodeSaveRecord& Record);
+
 	const FYapFragment& GetFragment(uint8 FragmentIndex) const;
 	
-	/** Dialogue fragments getter. */
-	const TArray<FYapFragment>& GetFragments() const { return Fragments; }
+	/** Dialogue fragments getter. Running instances share their template node's fragments. */
+	const TArray<FYapFragment>& GetFragments() const { return TemplateNode ? TemplateNode->Fragments : Fragments; }
 
 	/** Simple helper function. */
-	uint8 GetNumFragments() const { return Fragments.Num(); }
+	uint8 GetNumFragments() const { return GetFragments().Num(); }
+
+	/** Run state of a fragment on this node instance. Nodes which are not running return a default (idle) state. */
+	const FYapFragmentRunState& GetFragmentRunState(uint8 FragmentIndex) const;
+
+	FYapFragmentRunState& GetFragmentRunStateMutable(uint8 FragmentIndex);
 
 	/**  */
 	bool GetInterruptible(bool bInConversation) const;
@@ -236,14 +263,28 @@ public:
 	bool GetFragmentAutoAdvance(uint8 FragmentIndex, bool bInConversation) const;
 
 	int32 GetRunningFragmentIndex() const { return FocusedFragmentIndex.Get(INDEX_NONE); }
-	
-	// TODO this sucks can I register the fragments some other way instead
-	/** Finds the first fragment on this dialogue containing a tag. */
-	FYapFragment* FindTaggedFragment(const FGameplayTag& Tag);
+
+	/** How long a fragment holds the node when it runs: speech time (until the speech ends) and padding time after it. Used by RunFragment. */
+	void GetFragmentTiming(UWorld* World, uint8 FragmentIndex, EYapMaturitySetting MaturitySetting, bool bInConversation, float& OutSpeechTime, float& OutPaddingTime) const;
+
+	/** Conditions which must pass to enter this node. */
+	const TArray<TObjectPtr<UYapCondition>>& GetNodeConditions() const { return Conditions; }
+
+	/** How Talk nodes run their fragments. */
+	EYapDialogueTalkSequencing GetTalkSequencing() const { return TalkSequencing; }
+
+	/** Finds the fragment on this dialogue using a fragment ID. */
+	const FYapFragment* FindFragmentByID(FName FragmentID) const;
+
+	/** Legacy wrapper; fragment tags are now FName fragment IDs, so this finds by the tag's name. */
+	const FYapFragment* FindTaggedFragment(const FGameplayTag& Tag) const;
 
 protected:
 	bool CanSkip(FYapSpeechHandle Handle) const;
 
+	/** Fills in {Argument} tokens through the broker if enabled in project settings (see FYapTextFormatCache), otherwise returns Text. */
+	FText FormatText(const FText& Text, const FYapFragment& Fragment) const;
+
 #if WITH_EDITOR
 public:
 	const FString& GetAudioIDRoot() const { return AudioID; }
@@ -258,6 +299,9 @@ protected:
 private:
 	void InvalidateFragmentTags();
 
+	/** Called on running instances when their template node is edited during a play session (see UYapSubsystem::HotPatchDialogueNode). Refreshes fragments and run states. */
+	void OnTemplateEdited(const UFlowNode_YapDialogue* EditedNode);
+
 	const TArray<UYapCondition*>& GetConditions() const { return Conditions; }
 	
 	TArray<UYapCondition*>& GetConditionsMutable() { return MutableView(Conditions); }
@@ -280,6 +324,12 @@ protected:
 	/** UFlowNodeBase override */
 	void InitializeInstance() override;
 
+	/** This node in the flow asset this instance was created from, found by node GUID. Null on template nodes. */
+	UFlowNode_YapDialogue* FindTemplateNode() const;
+
+	/** UFlowNodeBase override */
+	void DeinitializeInstance() override;
+
 	/** UFlowNodeBase override */
 	void ExecuteInput(const FName& PinName) override;
 
@@ -298,11 +348,20 @@ protected:
 	bool TryBroadcastPrompts();
 
 	void RunPrompt(uint8 Uint8);
+
+	/** Releases this node's prompt menu, if it has one open, and stops listening for a choice. */
+	void ReleasePrompts();
 	
 	bool TryStartFragments();
 
 	bool RunFragment(uint8 FragmentIndex);
 
+	/** Starts streaming in the speaker's portrait for a fragment which is running or about to. Speaker is looked up from the fragment's preload if not given; nothing is loaded synchronously. */
+	void PrefetchPortrait(uint8 FragmentIndex, const UObject* Speaker = nullptr);
+
+	/** Resolves a fragment instantly while the subsystem is fast-forwarding this conversation: counts, pins and sequencing apply, nothing is spoken or broadcast. */
+	void SkipFragment(uint8 FragmentIndex);
+
 	void AddRunningFragment(const FYapSpeechHandle& Handle, uint8 FragmentIndex);
 
 	void RemoveRunningFragment(const FYapSpeechHandle& Handle, uint8 FragmentIndex);
@@ -334,6 +393,13 @@ public:
 	
 	int16 FindFragmentIndex(const FGuid& InFragmentGuid) const;
 
+	int16 FindFragmentIndex(FName FragmentID) const;
+
+private:
+	void RebuildFragmentLookup() const;
+
+public:
+
 	const FYapFragment& GetFragmentByIndex(uint8 Index) const;
 
 #if WITH_EDITOR
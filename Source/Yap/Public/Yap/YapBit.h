@@ -5,6 +5,8 @@
 
 #include "YapLog.h"
 #include "YapText.h"
+#include "YapStreamableManager.h"
+#include "YapTrace.h"
 #include "Yap/Globals/YapEditorWarning.h"
 
 #if WITH_EDITOR
@@ -117,8 +119,11 @@ public:
 	/** Loads the audio asset. */
 	void LoadContent(EYapLoadContext LoadContext) const;
 	
-	/** Gets the evaluated time duration to be used for this bit (incorporating project default settings and fallbacks) */
-	TOptional<float> GetSpeechTime(UWorld* World, EYapTimeMode TimeMode, EYapLoadContext LoadContext, const UYapNodeConfig& Config) const;
+	/** Gets the evaluated time duration to be used for this bit (incorporating project default settings and fallbacks). TextCounts, if given, replaces the editor-time word count (e.g. counts of the current culture's translation); TextCulture is the culture they were counted in. */
+	TOptional<float> GetSpeechTime(UWorld* World, EYapTimeMode TimeMode, EYapLoadContext LoadContext, const UYapNodeConfig& Config, const FYapTextCounts* TextCounts = nullptr, const FString& TextCulture = FString()) const;
+
+	/** Overwrites whichever values are set. Only used on copies made for runtime bit replacement (see FYapFragmentOverlay), never on fragment content. */
+	void ApplyReplacement(const TOptional<FYapText>& NewTitleText, const TOptional<FYapText>& NewDialogueText, const TOptional<TSoftObjectPtr<UObject>>& NewAudioAsset, const TOptional<float>& NewManualTime);
 
 	// --------------------------------------------------------------------------------------------
 	// INTERNAL API
@@ -128,8 +133,8 @@ protected:
 	/** Getter for manual time setting value. */
 	TOptional<float> GetManualTime() const { return ManualTime; }
 
-	/** Calculates the current text time. */
-	TOptional<float> GetTextTime(const UYapNodeConfig& NodeConfig) const;
+	/** Calculates the current text time through the broker, from the given counts (of TextCulture) if any, otherwise from the source text (of the project's native culture). */
+	TOptional<float> GetTextTime(UObject* WorldContext, const UYapNodeConfig& NodeConfig, const FYapTextCounts* TextCounts = nullptr, const FString& TextCulture = FString()) const;
 
 	/** Gets the current time of the audio asset. */
 	TOptional<float> GetAudioTime(UObject* WorldContext, EYapLoadContext LoadContext) const;
@@ -148,6 +153,9 @@ public:
 	
 	void SetManualTime(float NewValue) { ManualTime = NewValue; }
 
+	/** Adds the dialogue and title text, for bulk word recounts (FYapText::RecountWords). */
+	void GetTextsMutable(TArray<FYapText*>& OutTexts) { OutTexts.Add(&DialogueText); OutTexts.Add(&TitleText); }
+
 private:
 	void RecalculateTextWordCount(FText& Text, float& CachedTime);
 
@@ -185,9 +193,9 @@ const T* FYapBit::GetAudioAsset() const
 	}
 #endif
 
-	return AudioAsset.LoadSynchronous();
+	return Cast<T>(FYapStreamableManager::LoadSynchronous(AudioAsset, YAP_SYNC_LOAD_SITE));
 }
 
 // ================================================================================================
 
-#undef LOCTEXT_NAMESPACE
\ No newline at end of file
+#undef LOCTEXT_NAMESPACE
@@ -59,6 +59,14 @@ public:
 	/**  */
 	UFUNCTION(BlueprintCallable, Category = "Yap|Character", meta = (WorldContext = "WorldContext"))
 	static AActor* FindYapCharacterActor(UObject* WorldContext, FName CharacterID);
+
+	/** Compact binary snapshot of dialogue state (activation counts, last ran fragments) to store in your save game. See UYapSubsystem::SaveDialogueState. */
+	UFUNCTION(BlueprintCallable, Category = "Yap|Save", meta = (WorldContext = "WorldContext"))
+	static bool SaveDialogueState(UObject* WorldContext, TArray<uint8>& Data, bool bDelta = false);
+
+	/** Restores a snapshot from Save Dialogue State. */
+	UFUNCTION(BlueprintCallable, Category = "Yap|Save", meta = (WorldContext = "WorldContext"))
+	static bool LoadDialogueState(UObject* WorldContext, const TArray<uint8>& Data);
 };
 
 
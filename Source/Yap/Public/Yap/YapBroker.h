@@ -44,14 +44,20 @@ public:
 
 	/** Use this to modify speaking time by a scalar multiplier. Does NOT affect anything when fragments are using audio duration. Do NOT call Super. */
 	virtual float GetPlaybackSpeed() const;
+
+	/** Supplies the value of a {Argument} token in dialogue text, e.g. {PlayerName} or {ItemCount}. Only used when Format Dialogue Text Arguments is enabled in project settings. Return numbers as numbers so plural forms work. Do NOT call Super. */
+	virtual FFormatArgumentValue GetTextArgument(FName Argument, FName SpeakerID, FName DirectedAtID) const;
 	
 	// - - - - - EDITOR FUNCTIONS - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 	/** Provides a word count estimate of a given piece of FText. A default implementation of this function exists. Do NOT call Super. */
 	virtual int32 CalculateWordCount(const FText& Text) const;
 
-	/** Use this to fully override how your game calculates text time. The default implementation of this function will use your node config setting UYapNodeConfig.DialoguePlayback.TimeSettings.TextWordsPerMinute multiplied by GetPlaybackSpeed from your UYapBroker. Do NOT call Super. */
-	virtual float CalculateTextTime(int32 WordCount, int32 CharCount, const UYapNodeConfig&  NodeConfig) const;
+	/** Bulk recounts call CalculateWordCount from worker threads when this is true. The default is false only if Calculate Word Count is implemented in Blueprint; override it if your C++ CalculateWordCount is not thread safe. */
+	virtual bool CanCalculateWordCountInParallel() const;
+
+	/** Use this to fully override how your game calculates text time. The default implementation of this function will use your node config setting UYapNodeConfig.DialoguePlayback.TimeSettings.TextWordsPerMinute multiplied by GetPlaybackSpeed from your UYapBroker; when CultureName (the language of the counted text, e.g. "ja") is written without spaces (Chinese, Japanese, Thai...) it counts two characters as a word. Do NOT call Super. */
+	virtual float CalculateTextTime(int32 WordCount, int32 CharCount, const UYapNodeConfig&  NodeConfig, const FString& CultureName) const;
 	
 	/** Override this if you use 3rd party audio (WWise, FMOD). Cast to your audio type and return the duration length in seconds. Do NOT call Super. */
 	virtual float GetAudioAssetDuration(const UObject* AudioAsset) const;
@@ -84,6 +90,9 @@ protected:
 	
 	UFUNCTION(BlueprintImplementableEvent, DisplayName = "Get Playback Speed", meta = (ToolTip = "Use this to modify speaking time by a scalar multiplier, return 1.0 for no change. Does NOT affect anything when fragments are using audio duration!"))
 	float K2_GetPlaybackSpeed() const;
+
+	UFUNCTION(BlueprintImplementableEvent, DisplayName = "Get Text Argument", meta = (ToolTip = "Use this to supply the value of a {Argument} token in dialogue text, e.g. {PlayerName}. Only used when Format Dialogue Text Arguments is enabled in project settings. Override in C++ to supply numbers or genders for plural and gender forms."))
+	FText K2_GetTextArgument(FName Argument, FName SpeakerID, FName DirectedAtID) const;
 	
 	// - - - - - EDITOR FUNCTIONS - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 	
@@ -124,6 +133,7 @@ private:
 	static TOptional<bool> bImplemented_GetMaturitySetting;
 	static TOptional<bool> bImplemented_GetPlaybackSpeed;
 	static TOptional<bool> bImplemented_GetAudioAssetDuration;
+	static TOptional<bool> bImplemented_GetTextArgument;
 #if WITH_EDITOR
 	static TOptional<bool> bImplemented_PreviewAudioAsset;
 	static TOptional<bool> bImplemented_GetNewNodeID;
@@ -135,6 +145,7 @@ private:
 	static bool bWarned_GetMaturitySetting;
 	static bool bWarned_GetPlaybackSpeed;
 	static bool bWarned_GetAudioAssetDuration;
+	static bool bWarned_GetTextArgument;
 #if WITH_EDITOR
 	static bool bWarned_PreviewAudioAsset;
 #endif
@@ -153,8 +164,6 @@ public:
 	FString GenerateDialogueAudioID(const UFlowNode_YapDialogue* InNode) const;
 
 	void UpdateNodeFragmentIDs(UFlowNode_YapDialogue* InNode) const;
-private:
-	virtual FString GenerateRandomDialogueAudioID() const;
 #endif
 	
 #if WITH_EDITOR
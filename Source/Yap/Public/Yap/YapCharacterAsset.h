@@ -24,9 +24,9 @@ struct YAP_API FYapPortraitList
 {
 	GENERATED_BODY()
 
-	/** Texture for each mood. Moods are stored as FNames instead of Gameplay Tags for easier handling. */
+	/** Texture for each mood. Moods are stored as FNames instead of Gameplay Tags for easier handling. Soft, so a character only loads the moods it shows. */
 	UPROPERTY(EditAnywhere, Category = "Default", EditFixedSize, meta=(ReadOnlyKeys, ForceInlineRow))
-	TMap<FName, TObjectPtr<UTexture2D>> Map;
+	TMap<FName, TSoftObjectPtr<UTexture2D>> Map;
 };
 
 // ================================================================================================
@@ -57,7 +57,7 @@ protected:
 	
 	/** Default portrait texture. This is used when a fragment has "no" mood tag and is also used for the asset thumbnail. */
 	UPROPERTY(EditAnywhere, Category = "Portraits", DisplayName = "Default Portrait")
-	TObjectPtr<UTexture2D> Portrait;
+	TSoftObjectPtr<UTexture2D> Portrait;
 
 	// These use FNames instead of FGameplayTags to avoid interfering with the asset referencer (allowing me to automatically populate this list without preventing users from deleting gameplay tags)
 	/** Portrait textures, raw map access (this is normally the same as the customized view above, you do not normally need to edit this). If you edit this you will need to close and reopen the asset. */ 
@@ -77,6 +77,8 @@ public:
 	
 	const UTexture2D* GetCharacterPortrait(const FGameplayTag& MoodTag) const override;
 
+	TSoftObjectPtr<UTexture2D> GetCharacterPortraitAsset(const FGameplayTag& MoodTag) const override;
+
 	/* IYapSpeaker Interface */
 	// --------------------- //
 
@@ -57,6 +57,7 @@ protected:
     UPROPERTY(Transient)
     TArray<FYapSpeechHandle> RunningSpeech;
 
+    /** Prompts of the menu the conversation is currently showing. Kept in step with the subsystem's prompt set for this conversation. */
     UPROPERTY(Transient)
     TArray<FYapPromptHandle> OpenPrompts;
 
@@ -120,6 +121,12 @@ public:
     void AddRunningFragment(FYapSpeechHandle Handle);
 
     void RemoveRunningSpeech(FYapSpeechHandle Handle);
+
+    const TArray<FYapPromptHandle>& GetOpenPrompts() const { return OpenPrompts; }
+
+    void AddOpenPrompt(const FYapPromptHandle& PromptHandle);
+
+    void ClearOpenPrompts();
     
     // -----
     
@@ -12,6 +12,7 @@ struct FYapRunningFragment;
 struct FYapBit;
 
 #include "Yap/Handles/YapConversationHandle.h"
+#include "Yap/Enums/YapSkipTarget.h"
 
 #include "YapDataStructures.generated.h"
 
@@ -35,7 +36,7 @@ struct FYapData_ConversationOpened
 
 // ------------------------------------------------------------------------------------------------
 
-/** Struct containing all the data for this event. */
+/** Struct containing all the data for this event. When dialogue runs timing-only (project settings, e.g. on dedicated servers) only the IDs, speech time and skippable flag are filled in. */
 USTRUCT(BlueprintType, DisplayName = "Yap Speech Begins")
 struct FYapData_SpeechBegins
 {
@@ -90,7 +91,7 @@ struct FYapData_SpeechBegins
 
 // ------------------------------------------------------------------------------------------------
 
-/** Struct containing all the data for this event. */
+/** Struct containing all the data for this event. When dialogue runs timing-only, the characters and text are left empty. */
 USTRUCT(BlueprintType, DisplayName = "Yap Player Prompt Created")
 struct FYapData_PlayerPromptCreated
 {
@@ -153,4 +154,50 @@ struct FYapData_PlayerPromptChosen
 
 // ------------------------------------------------------------------------------------------------
 
+/** Struct containing all the data for this event. */
+USTRUCT(BlueprintType, DisplayName = "Yap Player Prompts Refreshed")
+struct FYapData_PlayerPromptsRefreshed
+{
+	GENERATED_BODY()
+
+	/** Conversation whose prompts were replaced. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	FYapConversationHandle Conversation;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+/** Struct containing all the data for this event. */
+USTRUCT(BlueprintType, DisplayName = "Yap Conversation Skipped")
+struct FYapData_ConversationSkipped
+{
+	GENERATED_BODY()
+
+	/** Conversation which was skipped. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	FYapConversationHandle Conversation;
+
+	/** What the skip was asked to do. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	EYapSkipTarget Target = EYapSkipTarget::NextPrompt;
+
+	/** Fragments resolved without being spoken, in the order they would have played. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	TArray<FGuid> SkippedFragments;
+
+	/** Player prompts which were chosen automatically (first available option) while skipping to the end. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	int32 AutoChosenPrompts = 0;
+
+	/** True if the skip stopped at a player prompt; its prompts were broadcast normally. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	bool bStoppedAtPrompt = false;
+
+	/** True if the skip gave up after too many fragments (e.g. the dialogue loops); the last fragment is running normally. */
+    UPROPERTY(BlueprintReadOnly, Category = "Default")
+	bool bReachedLimit = false;
+};
+
+// ------------------------------------------------------------------------------------------------
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
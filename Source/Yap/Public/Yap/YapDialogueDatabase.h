@@ -0,0 +1,222 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "Yap/YapText.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+enum class EYapMaturitySetting : uint8;
+
+// ================================================================================================
+
+#if WITH_EDITOR
+/** One fragment's worth of data, as gathered by the editor before writing the database. Index 0 of each pair is mature, 1 is child-safe. */
+struct FYapDialogueDatabaseEntry
+{
+	FGuid FragmentGuid;
+
+	FName FragmentID;
+
+	FName SpeakerID;
+
+	FName MoodTag;
+
+	FString TextNamespace[2];
+
+	FString TextKey[2];
+
+	FString TextSource[2];
+
+	/** Negative if the fragment is untimed. */
+	float SpeechTime[2] = { -1.0f, -1.0f };
+
+	FSoftObjectPath AudioAsset[2];
+
+	FSoftObjectPath OwningAsset;
+
+	FGuid NodeGuid;
+
+	uint8 FragmentIndex = 0;
+
+	/** Counts of the localized dialogue text, [CultureIndex * 2 + MaturityColumn], for the cultures passed to Write. */
+	TArray<FYapTextCounts> TextCounts;
+};
+#endif
+
+// ================================================================================================
+
+/**
+ * Flattened, read-only table of every dialogue fragment in the project, built during cook (see YapEditor's FYapDialogueDatabaseBuilder).
+ * Lets game code read a line's speaker, mood, text, duration or audio path by fragment GUID without loading the owning flow asset.
+ *
+ * The file is a struct-of-arrays: each column is a contiguous section, strings are deduplicated into one table, and an open-addressed
+ * hash of fragment GUIDs gives O(1) lookup. Text counts for timing are stored per culture (see GetTextCounts). The file is memory-mapped where the platform allows it (stage it as non-UFS), otherwise read into memory.
+ */
+class YAP_API FYapDialogueDatabase
+{
+public:
+	FYapDialogueDatabase();
+
+	~FYapDialogueDatabase();
+
+	/** The project's database, loaded from GetDefaultPath() on first use. */
+	static FYapDialogueDatabase& Get();
+
+	/** Content/Yap/DialogueDatabase.yapdb */
+	static FString GetDefaultPath();
+
+	bool Load(const FString& Path);
+
+	void Unload();
+
+	bool IsLoaded() const { return Data != nullptr; }
+
+	int32 Num() const;
+
+	/** Returns INDEX_NONE if the fragment is not in the database. */
+	int32 FindFragment(const FGuid& FragmentGuid) const;
+
+	/** Finds a fragment by its FragmentID (fragment tag). Returns INDEX_NONE if no fragment uses the ID. */
+	int32 FindFragmentByID(FName FragmentID) const;
+
+	FGuid GetFragmentGuid(int32 Index) const;
+
+	FName GetFragmentID(int32 Index) const;
+
+	FName GetSpeakerID(int32 Index) const;
+
+	FGameplayTag GetMoodTag(int32 Index) const;
+
+	/** Resolves the text through the live localization table, so it follows the current culture. */
+	FText GetDialogueText(int32 Index, EYapMaturitySetting MaturitySetting) const;
+
+	/** Negative if the fragment is untimed. */
+	float GetSpeechTime(int32 Index, EYapMaturitySetting MaturitySetting) const;
+
+	FSoftObjectPath GetAudioAsset(int32 Index, EYapMaturitySetting MaturitySetting) const;
+
+	/** The flow asset which contains the fragment. */
+	FSoftObjectPath GetOwningAsset(int32 Index) const;
+
+	FGuid GetNodeGuid(int32 Index) const;
+
+	/** Cultures which have text counts, e.g. "en", "ja", "pt-BR". */
+	int32 NumCultures() const;
+
+	FString GetCultureName(int32 CultureIndex) const;
+
+	/** Finds a culture by exact name, then by its parent language ("pt-BR" falls back to "pt"). Returns INDEX_NONE if neither is present. */
+	int32 FindCulture(const FString& CultureName) const;
+
+	/** Word, character and grapheme counts of the line's text in the current language. Returns false if the current language has no counts. */
+	bool GetTextCounts(int32 Index, EYapMaturitySetting MaturitySetting, FYapTextCounts& OutCounts) const;
+
+	/** The culture the current language's text counts are of (see FindCulture), or empty if the current language has none. */
+	FString GetCurrentCultureName() const;
+
+	bool GetTextCounts(int32 Index, EYapMaturitySetting MaturitySetting, int32 CultureIndex, FYapTextCounts& OutCounts) const;
+
+	uint8 GetFragmentIndex(int32 Index) const;
+
+	/** Fragments of one flow asset are stored contiguously, in node then fragment order. Returns false if the asset has no dialogue. */
+	bool GetAssetFragmentRange(const FSoftObjectPath& FlowAsset, int32& OutFirst, int32& OutNum) const;
+
+#if WITH_EDITOR
+	/** The fragment was edited after the database was built (e.g. during a play session). Lookups no longer find it, so callers fall back to the fragment itself. Cleared on unload. */
+	void MarkFragmentEdited(const FGuid& FragmentGuid) { EditedFragments.Add(FragmentGuid); }
+
+	static bool Write(const FString& Path, TArray<FYapDialogueDatabaseEntry> Entries, const TArray<FString>& Cultures = TArray<FString>());
+#endif
+
+private:
+	enum class ESection : uint8
+	{
+		Guids,
+		FragmentIDs,
+		SpeakerIDs,
+		MoodTags,
+		TextNamespaces,
+		TextKeys,
+		TextSources,
+		SpeechTimes,
+		AudioAssets,
+		OwningAssets,
+		NodeGuids,
+		FragmentIndices,
+		Assets,
+		GuidIndex,
+		IDIndex,
+		Cultures,
+		TextCounts,
+		StringOffsets,
+		StringData,
+		MAX
+	};
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumFragments;
+		uint32 NumAssets;
+		uint32 NumStrings;
+		uint32 NumIndexSlots;
+		uint32 NumCultures;
+		uint64 SectionOffsets[static_cast<uint8>(ESection::MAX)];
+	};
+
+	struct FAssetRecord
+	{
+		uint32 Path;
+		uint32 FirstFragment;
+		uint32 NumFragments;
+	};
+
+	template<typename T>
+	const T* GetSection(ESection Section) const
+	{
+		return reinterpret_cast<const T*>(Data + Header().SectionOffsets[static_cast<uint8>(Section)]);
+	}
+
+	const FHeader& Header() const { return *reinterpret_cast<const FHeader*>(Data); }
+
+	FUtf8StringView GetString(uint32 StringIndex) const;
+
+	FString GetStringAsFString(uint32 StringIndex) const;
+
+	static uint32 HashGuid(const FGuid& Guid) { return GetTypeHash(Guid); }
+
+	/** FNames compare case-insensitively, so IDs are hashed and compared lowercased. */
+	static uint32 HashID(const FString& LowerID) { return FCrc::StrCrc32(*LowerID); }
+
+	bool Validate(int64 Size) const;
+
+	void OnCultureChanged();
+
+	static constexpr uint32 Magic = 0x44504159; // 'YAPD'
+
+	static constexpr uint32 Version = 3;
+
+	const uint8* Data = nullptr;
+
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	/** Fallback storage when the file cannot be mapped. */
+	TArray64<uint8> Buffer;
+
+	TMap<FSoftObjectPath, int32> AssetLookup;
+
+	/** Culture matching the current language, refreshed when the language changes. */
+	int32 CurrentCulture = INDEX_NONE;
+
+	FDelegateHandle CultureChangedHandle;
+
+#if WITH_EDITOR
+	TSet<FGuid> EditedFragments;
+#endif
+};
@@ -0,0 +1,28 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Yap/YapSaveState.h"
+
+#include "YapDialogueStateSubsystem.generated.h"
+
+/**
+ * Holds the dialogue save state (see FYapDialogueSaveState) for the whole game session, so activation counts survive map travel.
+ * UYapSubsystem reads and writes it; worlds without a game instance (e.g. editor preview worlds) keep their own state instead.
+ */
+UCLASS()
+class YAP_API UYapDialogueStateSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Null if the world has no game instance. */
+	static FYapDialogueSaveState* Find(const UWorld* World);
+
+	FYapDialogueSaveState& GetSaveState() { return SaveState; }
+
+private:
+	FYapDialogueSaveState SaveState;
+};
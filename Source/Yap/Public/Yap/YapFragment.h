@@ -3,8 +3,8 @@
 
 #pragma once
 #include "YapBit.h"
+#include "YapFragmentRunState.h"
 #include "GameplayTagContainer.h"
-#include "Engine/TimerHandle.h"
 #include "Runtime/Launch/Resources/Version.h"
 
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION < 5
@@ -25,20 +25,11 @@ class UYapCharacterAsset;
 class UYapCondition;
 class UFlowNode_YapDialogue;
 struct FFlowPin;
+struct FYapFragmentPatch;
 enum class EYapMaturitySetting : uint8;
 
 // ================================================================================================
 
-UENUM()
-enum class EYapFragmentRunState : uint8
-{
-	Idle		= 0,
-	Running		= 1,
-	//InPadding	= 2,
-};
-
-// ================================================================================================
-
 /**
  * Fragments contain all of the actual data and settings required for a segment of speech to run.
  * 
@@ -68,15 +59,21 @@ protected:
 	UPROPERTY()
 	TArray<TObjectPtr<UYapCondition>> Conditions;
 
+#if WITH_EDITORONLY_DATA
+	/** Deprecated, fixed up into Speaker on save. Never cooked. */
 	UPROPERTY()
 	TSoftObjectPtr<UObject> SpeakerAsset;
-
+#endif
+	
 	UPROPERTY()
 	FGameplayTag Speaker;
-	
+
+#if WITH_EDITORONLY_DATA
+	/** Deprecated, fixed up into DirectedAt on save. Never cooked. */
 	UPROPERTY()
 	TSoftObjectPtr<UObject> DirectedAtAsset;
-
+#endif
+	
 	UPROPERTY()
 	FGameplayTag DirectedAt;
 	
@@ -140,9 +137,6 @@ protected:
 	// TODO should this be serialized or transient
 	UPROPERTY(Transient)
 	uint8 IndexInDialogue = 0; 
-
-	UPROPERTY(Transient)
-	int32 ActivationCount = 0;
 	
 	UPROPERTY()
 	FFlowPin PromptPin;
@@ -152,90 +146,76 @@ protected:
 
 	UPROPERTY()
 	FFlowPin EndPin;
-
-	UPROPERTY(Transient)
-	EYapFragmentRunState RunState = EYapFragmentRunState::Idle;
-
-	/** When was the current running fragment started? */
-	UPROPERTY(Transient)
-	double StartTime = -1;
-
-	/** When did the most recently ran fragment finish? */
-	UPROPERTY(Transient)
-	double EndTime = -1;
-
-	/**  */
-	UPROPERTY(Transient)
-	bool bRunning = false;
 	
-	/**  */
-	UPROPERTY(Transient)
-	bool bFragmentAwaitingManualAdvance = false;
+	// Run state (activation count, timers, load handles...) lives in FYapFragmentRunState, owned by the running dialogue node.
 	
+	// ==========================================
+	// SERIALIZATION
 public:
-	
-	/**  */
-	UPROPERTY(Transient)
-	FTimerHandle PaddingTimerHandle;
-	
-	// ASSET LOADING
-protected:
-	
+	/** Writes a lean copy of the fragment when cooking (see MakeCookedCopy); otherwise uses normal tagged property serialization. */
+	bool Serialize(FArchive& Ar);
+
+#if WITH_EDITOR
 	/**
-	 * 
+	 * Returns the fragment as it will be cooked: the child-safe bit is dropped if child-safe data is disabled, and the pins (which are
+	 * derived from the GUID on demand) are cleared.
+	 * If CookedMaturity is set, only that level's bit is kept (as the mature bit, with child-safe data disabled); the other bit is not saved.
 	 */
-	TSharedPtr<FStreamableHandle> SpeakerHandle;
-	
-	TSharedPtr<FStreamableHandle> DirectedAtHandle;
+	FYapFragment MakeCookedCopy(EYapMaturitySetting CookedMaturity = EYapMaturitySetting::Unspecified) const;
 
-	// EDITOR
-#if WITH_EDITOR
+	/** The audio of the bit MakeCookedCopy drops for CookedMaturity, or a null path if it keeps every audio asset (or the dropped bit shares the kept one's). */
+	FSoftObjectPath GetStrippedAudioAsset(EYapMaturitySetting CookedMaturity = EYapMaturitySetting::Unspecified) const;
 
+	/** Measures the fragment's tagged-property size before and after MakeCookedCopy. Both are written against a default fragment, so the difference is only what the cooked copy removes. */
+	void MeasureSerializedSize(int64& OutEditorBytes, int64& OutCookedBytes) const;
+	
+private:
+	/** Plain tagged property serialization, using a default fragment as the defaults so values left at their defaults are skipped. */
+	static void SerializeAgainstDefaults(FArchive& Ar, FYapFragment& Fragment);
 #endif
 	
 	// ==========================================
 	// API
 public:
-	bool CanRun() const;
+	bool CanRun(const FYapFragmentRunState& RunState) const;
 	
+	/** Evaluates the fragment's own conditions. At runtime, use CanRun, which evaluates the running node instance's conditions. */
 	bool CheckConditions() const;
+
+	static bool CheckConditions(const TArray<TObjectPtr<UYapCondition>>& InConditions);
 	
 	void ResetOptionalPins();
 	
-	void PreloadContent(UWorld* World, EYapMaturitySetting MaturitySetting, EYapLoadContext LoadContext);
+	void PreloadContent(UWorld* World, EYapMaturitySetting MaturitySetting, EYapLoadContext LoadContext, FYapFragmentRunState& RunState) const;
 	
 	const FGameplayTag& GetSpeakerTag() const;
 	
 	const FGameplayTag& GetDirectedAtTag() const;
 
-	const TScriptInterface<IYapCharacterInterface> GetSpeakerCharacter(UWorld* World, EYapLoadContext LoadContext); // Non-const because of async loading handle
+	const TScriptInterface<IYapCharacterInterface> GetSpeakerCharacter(UWorld* World, EYapLoadContext LoadContext) const;
 
+#if WITH_EDITOR
 	bool HasDeprecatedSpeakerAsset();
+#endif
 	
 	bool HasSpeakerAssigned();
 
 	//const TSoftObjectPtr<const UObject> GetCharacterAsset(UWorld* World, const FGameplayTag& CharacterTag, TSharedPtr<FStreamableHandle>& Handle, EYapLoadContext LoadContext) const;
 	
-	const TScriptInterface<IYapCharacterInterface> GetDirectedAt(UWorld* World, EYapLoadContext LoadContext); // Non-const because of async loading handle
+	const TScriptInterface<IYapCharacterInterface> GetDirectedAt(UWorld* World, EYapLoadContext LoadContext) const;
 	
 private:
-	const TScriptInterface<IYapCharacterInterface> GetCharacter_Internal(UWorld* World, const FGameplayTag& CharacterTag, TSharedPtr<FStreamableHandle>& Handle, EYapLoadContext LoadContext);
+	const TScriptInterface<IYapCharacterInterface> GetCharacter_Internal(UWorld* World, const FGameplayTag& CharacterTag, EYapLoadContext LoadContext) const;
 
 public:
 	// TODO I don't think fragments should know where their position is!
 	uint8 GetIndexInDialogue() const { return IndexInDialogue; }
 	
-	int32 GetActivationCount() const { return ActivationCount; }
-
-	void SetRunState(EYapFragmentRunState NewState) { RunState = NewState; }
-	
-	EYapFragmentRunState GetRunState() const { return RunState; }
-	
 	int32 GetActivationLimit() const { return ActivationLimit; }
 
-	bool CheckActivationLimit() const { if (ActivationLimit <= 0) return true; return ActivationCount < ActivationLimit; }
+	bool CheckActivationLimit(int32 ActivationCount) const { if (ActivationLimit <= 0) return true; return ActivationCount < ActivationLimit; }
 
-	bool IsActivationLimitMet() const { if (ActivationLimit <= 0) return false; return ActivationCount >= ActivationLimit; }
+	bool IsActivationLimitMet(int32 ActivationCount) const { if (ActivationLimit <= 0) return false; return ActivationCount >= ActivationLimit; }
 
 	const FText& GetDialogueText(UWorld* World, EYapMaturitySetting MaturitySetting) const;
 	
@@ -257,20 +237,6 @@ public:
 
 	TOptional<float> GetSpeechTime(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const;
 
-	double GetStartTime() const { return StartTime; }
-
-	void SetStartTime(double InTime) { StartTime = InTime; }
-
-	double GetEndTime() const { return EndTime; }
-
-	void SetEndTime(double InTime) { EndTime = InTime; }
-
-	bool IsAwaitingManualAdvance() const;
-
-	void SetAwaitingManualAdvance();
-	
-	void ClearAwaitingManualAdvance();
-
 	TOptional<float> GetSpeechTime(UWorld* World, EYapMaturitySetting MaturitySetting, EYapLoadContext LoadContext, const UYapNodeConfig& NodeConfig) const;
 	
 public:
@@ -281,8 +247,6 @@ public:
 	bool GetUsesPadding(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const;
 
 	float GetProgressionTime(UWorld* World, EYapMaturitySetting MaturitySetting, const UYapNodeConfig& NodeConfig) const;
-	
-	void IncrementActivations();
 
 	const FName& GetFragmentID() const { return FragmentID; } 
 
@@ -299,6 +263,8 @@ public:
 
 	const TArray<UYapCondition*>& GetConditions() const { return Conditions; }
 
+	const TArray<TObjectPtr<UYapCondition>>& GetConditionObjects() const { return Conditions; }
+
 	FFlowPin GetPromptPin() const;
 
 	FFlowPin GetEndPin() const;
@@ -306,6 +272,9 @@ public:
 	FFlowPin GetStartPin() const;;
 
 	void ResolveMaturitySetting(UWorld* World, EYapMaturitySetting& MaturitySetting) const;
+
+	/** The world's runtime bit replacement of this fragment, if it has one (see FYapFragmentOverlay). */
+	const FYapFragmentPatch* FindPatch(UWorld* World) const;
 	
 	TOptional<EYapInterruptibleFlags> GetSkippableSetting() const { return InterruptibleFlags; }
 	
@@ -325,6 +294,9 @@ public:
 
 	FGameplayTag GetMoodTag() const { return MoodTag; }
 
+	/** Mood tag, including any runtime bit replacement in the world. */
+	FGameplayTag GetMoodTag(UWorld* World) const;
+
 	const TArray<FInstancedStruct>& GetData() const { return Data; }
 	
 	bool IsTimeModeNone() const;
@@ -340,6 +312,9 @@ public:
 #if WITH_EDITOR
 public:
 	FYapBit& GetBitMutable(EYapMaturitySetting MaturitySetting);
+
+	/** Adds the text of both bits, for bulk word recounts (FYapText::RecountWords). */
+	void GetTextsMutable(TArray<FYapText*>& OutTexts) { MatureBit.GetTextsMutable(OutTexts); ChildSafeBit.GetTextsMutable(OutTexts); }
 		
 	void SetIndexInDialogue(uint8 NewValue) { IndexInDialogue = NewValue; }
 
@@ -383,4 +358,13 @@ public:
 	
 	void SetDirectedAt(const FGameplayTag& CharacterTag);
 #endif
+};
+
+template<>
+struct TStructOpsTypeTraits<FYapFragment> : public TStructOpsTypeTraitsBase2<FYapFragment>
+{
+	enum
+	{
+		WithSerializer = true,
+	};
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Yap/YapBit.h"
+#include "Yap/YapBitReplacement.h"
+
+struct FStreamableHandle;
+struct FYapFragment;
+enum class EYapLoadContext : uint8;
+enum class EYapMaturitySetting : uint8;
+
+// ================================================================================================
+
+/** A runtime replacement of some of a fragment's data. */
+struct YAP_API FYapFragmentPatch
+{
+	FYapBitReplacement Replacement;
+
+	/** Copies of the fragment's bits with the replacement applied, made the first time each one is read. */
+	mutable TOptional<FYapBit> PatchedMatureBit;
+
+	mutable TOptional<FYapBit> PatchedChildSafeBit;
+
+	/** IDs of the replacement speaker and directed-at characters, if they are registered characters (see UYapProjectSettings::FindCharacterTag). */
+	FGameplayTag SpeakerTag;
+
+	FGameplayTag DirectedAtTag;
+
+	/** Keep the replacement characters loaded for as long as the patch is set. */
+	TSharedPtr<FStreamableHandle> SpeakerHandle;
+
+	TSharedPtr<FStreamableHandle> DirectedAtHandle;
+
+	bool bCharacterLoadsRequested = false;
+
+	/** Returns the patched copy of the given bit of the fragment. */
+	const FYapBit& GetBit(const FYapBit& SourceBit, EYapMaturitySetting MaturitySetting) const;
+
+	/** Starts async loads of the replacement characters; registered characters load through the world's character manager. */
+	void RequestCharacterLoads(UWorld* World);
+
+	/** The replacement speaker. If it has not finished loading, it is only sync-loaded when LoadContext is Sync. */
+	UObject* GetSpeaker(UWorld* World, EYapLoadContext LoadContext) const;
+
+	/** The replacement directed-at character. If it has not finished loading, it is only sync-loaded when LoadContext is Sync. */
+	UObject* GetDirectedAt(UWorld* World, EYapLoadContext LoadContext) const;
+};
+
+// ================================================================================================
+
+/**
+ * Runtime bit replacement (see UFlowNode_YapReplaceFragment). Holds sparse patches keyed by fragment GUID or fragment ID; FYapFragment's
+ * getters resolve against it. Fragment content is shared by every instance of a flow asset and is never modified; patched bits are
+ * copies owned by the overlay. When no world has any patches, fragment getters skip the lookup entirely.
+ */
+class YAP_API FYapFragmentOverlay
+{
+public:
+	~FYapFragmentOverlay();
+
+	// ------------------------------------------
+	// STATE
+	// ------------------------------------------
+private:
+	TMap<FGuid, FYapFragmentPatch> PatchesByGuid;
+
+	TMap<FName, FYapFragmentPatch> PatchesByID;
+
+	/** Patches across every world. Overlays are only used on the game thread. */
+	static int32 NumPatchesAllWorlds;
+
+	// ------------------------------------------
+	// API
+	// ------------------------------------------
+public:
+	/** False means no fragment anywhere has been patched, and getters can read fragment content directly. */
+	static bool HasAnyPatches() { return NumPatchesAllWorlds > 0; }
+
+	bool IsEmpty() const { return PatchesByGuid.IsEmpty() && PatchesByID.IsEmpty(); }
+
+	/** Replaces any previous patch of the same fragment. */
+	void SetPatch(const FGuid& FragmentGuid, const FYapBitReplacement& Replacement);
+
+	void SetPatch(FName FragmentID, const FYapBitReplacement& Replacement);
+
+	bool ClearPatch(const FGuid& FragmentGuid);
+
+	bool ClearPatch(FName FragmentID);
+
+	void Reset();
+
+	/** A patch by GUID wins over a patch by fragment ID. */
+	const FYapFragmentPatch* Find(const FYapFragment& Fragment) const;
+
+	/** Starts loading the replacement characters of every patch which has not requested them yet. Call after setting or loading patches. */
+	void RequestCharacterLoads(UWorld* World);
+
+	/** Drops every patched copy, so they are rebuilt from current fragment content on next read. */
+	void InvalidatePatchedBits();
+
+	/** Only the sparse replacements are saved; patched bits are rebuilt on demand. */
+	void Serialize(FArchive& Ar);
+};
@@ -0,0 +1,67 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Engine/TimerHandle.h"
+
+#include "YapFragmentRunState.generated.h"
+
+struct FStreamableHandle;
+class UYapCondition;
+
+// ================================================================================================
+
+UENUM()
+enum class EYapFragmentRunState : uint8
+{
+	Idle		= 0,
+	Running		= 1,
+	//InPadding	= 2,
+};
+
+// ================================================================================================
+
+/**
+ * Everything about a fragment which changes while a flow asset instance runs. Fragment content (FYapFragment) is immutable at runtime and
+ * shared with the template node; each running dialogue node only owns one of these per fragment.
+ */
+USTRUCT()
+struct YAP_API FYapFragmentRunState
+{
+	GENERATED_BODY()
+
+	/** How many times this fragment has ran. Persists only within this flow asset's lifespan (resets every Start) unless Persist Dialogue State is enabled. */
+	UPROPERTY(Transient)
+	int32 ActivationCount = 0;
+
+	UPROPERTY(Transient)
+	EYapFragmentRunState RunState = EYapFragmentRunState::Idle;
+
+	/** When was the current running fragment started? */
+	UPROPERTY(Transient)
+	double StartTime = -1;
+
+	/** When did the most recently ran fragment finish? */
+	UPROPERTY(Transient)
+	double EndTime = -1;
+
+	UPROPERTY(Transient)
+	FTimerHandle PaddingTimerHandle;
+
+	UPROPERTY(Transient)
+	bool bAwaitingManualAdvance = false;
+
+	/** This node instance's copies of the fragment's conditions. Conditions are instanced per flow asset instance so they can reach the world. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UYapCondition>> Conditions;
+
+	/** Keeps the speaker loaded once preloaded. */
+	TSharedPtr<FStreamableHandle> SpeakerHandle;
+
+	/** Keeps the directed-at character loaded once preloaded. */
+	TSharedPtr<FStreamableHandle> DirectedAtHandle;
+
+	/** Keeps the speaker's portrait for this fragment's mood streamed in while the fragment is up next or running. */
+	TSharedPtr<FStreamableHandle> PortraitHandle;
+};
@@ -0,0 +1,141 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "GameplayTagContainer.h"
+#include "Containers/Ticker.h"
+#include "Styling/SlateBrush.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "Yap/Interfaces/IYapCharacterInterface.h"
+
+#include "YapPortraitAtlas.generated.h"
+
+class UTexture2D;
+class UTextureRenderTarget2D;
+struct FStreamableHandle;
+
+// ================================================================================================
+
+USTRUCT()
+struct FYapPortraitAtlasSlot
+{
+	GENERATED_BODY()
+
+	TObjectKey<UObject> Character;
+
+	FGameplayTag MoodTag;
+
+	/** The source portrait, held only until it has been drawn into the atlas. */
+	UPROPERTY(Transient)
+	TObjectPtr<UTexture2D> PendingTexture;
+
+	TSharedPtr<FStreamableHandle> LoadHandle;
+
+	/** GFrameCounter when the slot was last asked for. Slots asked for this frame are never evicted. */
+	uint64 LastUsedFrame = 0;
+
+	/** FPlatformTime::Seconds when the portrait was requested; drawing stops waiting for full mip residency after a while. */
+	double RequestTime = 0.0;
+
+	bool bOccupied = false;
+
+	bool bReady = false;
+};
+
+// ================================================================================================
+
+/**
+ * Optional (see Project Settings, Portrait Atlas). Packs the portraits dialogue UI asks for into one shared render target, so a prompt menu or
+ * group conversation draws every portrait from the same texture in a single batch. Portraits are scaled into fixed-size square cells; when the
+ * atlas is full, the least recently used cell is reused. Source portraits are streamed in (see IYapCharacterInterface::RequestPortrait), drawn
+ * once, and released.
+ *
+ * Ask for a portrait every frame you show it. The first calls return false while it streams in and is drawn.
+ */
+UCLASS()
+class YAP_API UYapPortraitAtlas : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UYapPortraitAtlas* Get(const UObject* WorldContext)
+	{
+		const UWorld* World = IsValid(WorldContext) ? WorldContext->GetWorld() : nullptr;
+
+		return IsValid(World) ? World->GetSubsystem<UYapPortraitAtlas>() : nullptr;
+	}
+
+	// ------------------------------------------
+	// STATE
+protected:
+	UPROPERTY(Transient)
+	TObjectPtr<UTextureRenderTarget2D> Atlas;
+
+	UPROPERTY(Transient)
+	TArray<FYapPortraitAtlasSlot> Slots;
+
+	TMap<TTuple<TObjectKey<UObject>, FGameplayTag>, int32> SlotLookup;
+
+	/** Slots waiting for their portrait to load and stream in before being drawn. */
+	TArray<int32> PendingSlots;
+
+	int32 CellsPerRow = 0;
+
+	int32 CellSize = 0;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	static constexpr double MaxStreamingWait = 2.0;
+
+	// ------------------------------------------
+	// API
+public:
+	UFUNCTION(BlueprintCallable, Category = "Yap|Portrait Atlas")
+	UTextureRenderTarget2D* GetAtlasTexture() const { return Atlas; }
+
+	/** Finds the portrait's cell in the atlas, adding it if needed. Returns false until the portrait has been drawn, or if every cell is in use this frame. */
+	UFUNCTION(BlueprintCallable, Category = "Yap|Portrait Atlas")
+	bool GetPortraitRect(const TScriptInterface<IYapCharacterInterface> Character, FGameplayTag MoodTag, FVector2D& UVMin, FVector2D& UVMax);
+
+	/** As GetPortraitRect, but fills in a brush which draws the portrait's cell of the atlas. */
+	UFUNCTION(BlueprintCallable, Category = "Yap|Portrait Atlas")
+	bool GetPortraitBrush(const TScriptInterface<IYapCharacterInterface> Character, FGameplayTag MoodTag, FSlateBrush& Brush);
+
+	bool FindOrAddPortrait(const UObject* Character, FGameplayTag MoodTag, FBox2f& OutUVs);
+
+	/** Forgets every portrait. Cells are redrawn as they are asked for again. */
+	UFUNCTION(BlueprintCallable, Category = "Yap|Portrait Atlas")
+	void Flush();
+
+	int32 GetNumCells() const { return Slots.Num(); }
+
+	int32 GetNumUsedCells() const { return SlotLookup.Num(); }
+
+	// ------------------------------------------
+	// UWorldSubsystem overrides
+protected:
+	bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	void Deinitialize() override;
+
+	// ------------------------------------------
+	// INTERNAL
+protected:
+	/** A free cell, or the least recently used cell which was not asked for this frame. INDEX_NONE if none. */
+	int32 AcquireSlot();
+
+	void ReleaseSlot(int32 SlotIndex);
+
+	void OnPortraitLoaded(int32 SlotIndex, const UTexture2D* Texture);
+
+	/** Draws every pending portrait which is fully streamed in. */
+	bool DrawPendingSlots(float DeltaTime);
+
+	FBox2f GetSlotUVs(int32 SlotIndex) const;
+};
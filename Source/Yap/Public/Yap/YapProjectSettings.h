@@ -10,11 +10,15 @@
 #include "Editor/YapAudioIDFormat.h"
 #include "Yap/YapBroker.h"
 #include "Yap/GameplayTagFilterHelper.h"
+#include "Yap/Enums/YapMaturitySetting.h"
+#include "Yap/Enums/YapSyncLoadPolicy.h"
+#include "Yap/Enums/YapTimingOnlyMode.h"
 
 #include "YapProjectSettings.generated.h"
 
 class UYapBroker;
 class UTexture2D;
+class ITargetPlatform;
 enum class EYapDialogueProgressionFlags : uint8;
 enum class EYapMaturitySetting : uint8;
 enum class EYapAudioPriority : uint8;
@@ -28,6 +32,7 @@ class YAP_API UYapProjectSettings : public UDeveloperSettings, public FGameplayT
 	
 #if WITH_EDITOR
 	friend class FDetailCustomization_YapProjectSettings;
+	friend class FYapEditorModule;
 #endif
 	
 	// ============================================================================================
@@ -65,6 +70,18 @@ protected:
 	
 	UPROPERTY(Config, EditAnywhere, Category = "Core")
 	TSoftObjectPtr<UYapNodeConfig> DefaultNodeConfig;
+
+	/** Treat {Argument} tokens in dialogue and title text as format arguments, filled in at runtime by your broker's Get Text Argument (e.g. "Welcome back, {PlayerName}."). Leave off if your dialogue uses literal braces or backticks. */
+	UPROPERTY(Config, EditAnywhere, Category = "Core")
+	bool bFormatDialogueTextArguments = false;
+
+	/** Run dialogue from IDs and the dialogue database's precomputed speech times only: no character, audio or portrait loads, and handlers receive IDs without text, speaker objects or audio. Requires the dialogue database (see Cooking). */
+	UPROPERTY(Config, EditAnywhere, Category = "Core")
+	EYapTimingOnlyMode TimingOnlyMode = EYapTimingOnlyMode::Off;
+
+	/** Keep node and fragment activation counts when a flow asset finishes, so activation limits hold for the whole game session (including across map travel) rather than one run of the flow asset. Saved with UYapSubsystem::SaveDialogueState. */
+	UPROPERTY(Config, EditAnywhere, Category = "Core")
+	bool bPersistDialogueState = false;
 	
 	// - - - - - EDITOR - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 	
@@ -111,6 +128,38 @@ protected:
 	UPROPERTY(Config, EditAnywhere, Category = "Error Handling")
 	TSoftObjectPtr<UTexture2D> DefaultPortraitTexture;
 
+	/** What to do when Yap has to synchronously load dialogue content during gameplay. Use Skip or Fail to guarantee that dialogue never hitches; run Yap.SyncLoads to list every sync load and where it came from. */
+	UPROPERTY(Config, EditAnywhere, Category = "Error Handling")
+	EYapSyncLoadPolicy SyncLoadPolicy = EYapSyncLoadPolicy::Warn;
+
+	// - - - - - PORTRAIT ATLAS  - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+	/** Create the Yap Portrait Atlas world subsystem during play, which packs on-screen portraits into one texture so dialogue UIs can draw them in a single batch. */
+	UPROPERTY(Config, EditAnywhere, Category = "Portrait Atlas", DisplayName = "Enable Portrait Atlas")
+	bool bEnablePortraitAtlas = false;
+
+	/** Width and height of the atlas texture in pixels. */
+	UPROPERTY(Config, EditAnywhere, Category = "Portrait Atlas", meta = (EditCondition = "bEnablePortraitAtlas", ClampMin = 256, ClampMax = 8192))
+	int32 PortraitAtlasSize = 2048;
+
+	/** Every portrait is scaled into a square cell of this many pixels. An atlas of 2048 with cells of 256 holds 64 portraits. */
+	UPROPERTY(Config, EditAnywhere, Category = "Portrait Atlas", meta = (EditCondition = "bEnablePortraitAtlas", ClampMin = 32, ClampMax = 1024))
+	int32 PortraitAtlasCellSize = 256;
+
+	// - - - - - COOKING - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
+
+	/** When cooking, flatten every dialogue fragment into Content/Yap/DialogueDatabase.yapdb so game code can query lines without loading flow assets. The editor adds Content/Yap to Directories to Always Stage as Non-UFS while this is enabled, so the file is packaged loose and can be memory-mapped. */
+	UPROPERTY(Config, EditAnywhere, Category = "Cooking")
+	bool bBuildDialogueDatabaseOnCook = false;
+
+	/** When cooking, write Saved/Yap/CookedFragmentReport.csv listing how many bytes of fragment data were stripped from each flow asset. */
+	UPROPERTY(Config, EditAnywhere, Category = "Cooking")
+	bool bReportCookedFragmentSavings = false;
+
+	/** Platforms (by name, e.g. "Switch") whose builds are locked to one maturity level. Their cooked fragments keep only that level's bit; the other bit's text and audio path are not saved. When every platform in a cook is locked to the same level, audio which only the other level's bits use is not cooked (see the cook log). Pass -YapCookMaturity=ChildSafe or -YapCookMaturity=Mature to the cook to lock every platform, e.g. for a regional SKU. */
+	UPROPERTY(Config, EditAnywhere, Category = "Cooking")
+	TMap<FString, EYapMaturitySetting> CookedMaturityLevels;
+
 	// - - - - - OTHER - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - 
 
 	/** Optional. Setting this will helpfully filter character tag selectors.
@@ -168,11 +217,35 @@ public:
 
 	static bool GetSuppressBrokerWarnings() { return Get().bSuppressBrokerWarnings; }
 
+	static EYapSyncLoadPolicy GetSyncLoadPolicy() { return Get().SyncLoadPolicy; }
+
+	static bool GetBuildDialogueDatabaseOnCook() { return Get().bBuildDialogueDatabaseOnCook; }
+
+	static bool GetReportCookedFragmentSavings() { return Get().bReportCookedFragmentSavings; }
+
+#if WITH_EDITOR
+	/** The maturity level fragments are locked to when cooking for TargetPlatform, or Unspecified to keep both. */
+	static EYapMaturitySetting GetCookedMaturity(const ITargetPlatform* TargetPlatform);
+#endif
+
 	static const TSubclassOf<UYapBroker> GetBrokerClass();
 
 	static const TArray<TSoftClassPtr<UObject>>& GetAudioAssetClasses();
 
 	static const TSoftObjectPtr<UYapNodeConfig>& GetDefaultNodeConfig() { return Get().DefaultNodeConfig; }
+
+	static bool GetFormatDialogueTextArguments() { return Get().bFormatDialogueTextArguments; }
+
+	static bool GetPersistDialogueState() { return Get().bPersistDialogueState; }
+
+	static bool GetEnablePortraitAtlas() { return Get().bEnablePortraitAtlas; }
+
+	static int32 GetPortraitAtlasSize() { return Get().PortraitAtlasSize; }
+
+	static int32 GetPortraitAtlasCellSize() { return Get().PortraitAtlasCellSize; }
+
+	/** True if dialogue in this world should run timing-only, per TimingOnlyMode and the world's net mode. */
+	static bool IsTimingOnly(const UWorld* World);
 	
 	static const TArray<const UClass*> GetAllowableCharacterClasses();
 
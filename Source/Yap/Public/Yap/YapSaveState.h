@@ -0,0 +1,103 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/SoftObjectPath.h"
+
+// ================================================================================================
+
+/** Everything about one dialogue node which outlives its flow asset instance. Fragments are keyed by GUID so records survive reordering. */
+struct YAP_API FYapNodeSaveRecord
+{
+	int32 NodeActivationCount = 0;
+
+	/** Fragment which ran most recently. Invalid if none has. */
+	FGuid LastRanFragment;
+
+	/** Only fragments which have ran are stored. */
+	TMap<FGuid, int32> FragmentActivationCounts;
+
+	bool IsEmpty() const { return NodeActivationCount == 0 && !LastRanFragment.IsValid() && FragmentActivationCounts.IsEmpty(); }
+
+	bool operator==(const FYapNodeSaveRecord& Other) const;
+
+	bool operator!=(const FYapNodeSaveRecord& Other) const { return !(*this == Other); }
+};
+
+// ================================================================================================
+
+/** Identifies a dialogue node across flow asset instances. Node GUIDs are only unique within one flow asset; duplicated assets share them. */
+struct YAP_API FYapNodeSaveKey
+{
+	/** The flow asset the node was authored in; for running instances, their template asset. */
+	FSoftObjectPath FlowAsset;
+
+	FGuid NodeGuid;
+
+	bool operator==(const FYapNodeSaveKey& Other) const { return NodeGuid == Other.NodeGuid && FlowAsset == Other.FlowAsset; }
+
+	friend uint32 GetTypeHash(const FYapNodeSaveKey& Key) { return HashCombine(GetTypeHash(Key.NodeGuid), GetTypeHash(Key.FlowAsset)); }
+};
+
+// ================================================================================================
+
+/**
+ * Yap's own save snapshot: dialogue runtime state keyed by flow asset and node GUID, independent of Flow's SaveGame handling. Loading a snapshot only fills
+ * this store; dialogue nodes pick up their record when their flow asset is next instanced, so no flow asset is loaded to restore it.
+ *
+ * The binary form is a header (magic, version, flags) followed by each flow asset's path and its records sorted by node GUID, with counts
+ * written as packed integers.
+ * A delta only holds the records which changed since the previous save; an empty record in a delta erases the node's state.
+ */
+class YAP_API FYapDialogueSaveState
+{
+public:
+	static const uint32 FileMagic;
+
+	static const uint32 FileVersion;
+
+	/** Snapshots from this version on are followed by the subsystem's fragment replacements (see UYapSubsystem::SaveDialogueState). */
+	static constexpr uint32 ReplacementsVersion = 3;
+
+	// ------------------------------------------
+	// STATE
+	// ------------------------------------------
+private:
+	TMap<FYapNodeSaveKey, FYapNodeSaveRecord> Records;
+
+	/** Nodes whose record changed since the last save. */
+	TSet<FYapNodeSaveKey> DirtyNodes;
+
+	// ------------------------------------------
+	// API
+	// ------------------------------------------
+public:
+	const FYapNodeSaveRecord* Find(const FYapNodeSaveKey& Key) const;
+
+	/** Stores the node's current state. Empty records are removed. */
+	void Store(const FYapNodeSaveKey& Key, FYapNodeSaveRecord&& Record);
+
+	void Remove(const FYapNodeSaveKey& Key);
+
+	void Reset();
+
+	int32 Num() const { return Records.Num(); }
+
+	bool HasChanges() const { return !DirtyNodes.IsEmpty(); }
+
+	/** Writes every record, or only the ones which changed since the last write. Clears the changed set. */
+	void Write(FArchive& Ar, bool bDelta);
+
+	/** Reads a snapshot written by Write. A full snapshot replaces the store; a delta is applied on top of it. Returns false on unknown data. OutVersion is the FileVersion it was written with. */
+	bool Read(FArchive& Ar, uint32& OutVersion);
+
+	bool Read(FArchive& Ar) { uint32 Version; return Read(Ar, Version); }
+
+private:
+	static void SerializeRecord(FArchive& Ar, FYapNodeSaveRecord& Record);
+
+	/** Version 1 keyed records by node GUID alone; they are read with no flow asset and matched by GUID. */
+	static bool ReadVersion1Records(FArchive& Ar, TArray<TPair<FYapNodeSaveKey, FYapNodeSaveRecord>>& OutRecords);
+};
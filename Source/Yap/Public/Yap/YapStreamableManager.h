@@ -4,7 +4,33 @@
 #pragma once
 #include "Engine/StreamableManager.h"
 
-class FYapStreamableManager
+/** Pass as the call site of a sync load. */
+#define YAP_SYNC_LOAD_SITE __FUNCTION__
+
+/** One synchronous load which Yap performed (or refused) during gameplay. */
+struct FYapSyncLoadRecord
+{
+	FSoftObjectPath AssetPath;
+
+	/** Function that requested the load, see YAP_SYNC_LOAD_SITE. */
+	const ANSICHAR* CallSite = nullptr;
+
+	/** FPlatformTime::Seconds at the time of the load. */
+	double Time = 0.0;
+
+	uint64 Frame = 0;
+
+	/** False if the sync load policy refused the load. */
+	bool bLoaded = true;
+};
+
+// ================================================================================================
+
+/**
+ * All of Yap's loading goes through here. Sync loads are funneled through a single choke point which counts and records them,
+ * and applies the project's sync load policy (see UYapProjectSettings::SyncLoadPolicy) while gameplay is running.
+ */
+class YAP_API FYapStreamableManager
 {
 public:
 	static FStreamableManager& Get()
@@ -12,4 +38,89 @@ public:
 		static FStreamableManager Instance;
 		return Instance;
 	}
+
+	/** Async load through Yap's streamable manager. The returned handle is tracked for stats. */
+	static TSharedPtr<FStreamableHandle> RequestAsyncLoad(const FSoftObjectPath& Path, FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	/** Sync load through Yap's streamable manager. Returns null if the sync load policy refused the load. */
+	static TSharedPtr<FStreamableHandle> RequestSyncLoad(const FSoftObjectPath& Path, const ANSICHAR* CallSite);
+
+	/**
+	 * Sync load of a soft pointer. Returns the object straight away if it is already loaded. Returns null if the sync load policy refused the load.
+	 * Required loads (things Yap cannot run without, such as the broker class) are always performed, but still recorded.
+	 */
+	static UObject* LoadSynchronous(const FSoftObjectPath& Path, const ANSICHAR* CallSite, bool bRequired = false);
+
+	template<typename T>
+	static T* LoadSynchronous(const TSoftObjectPtr<T>& SoftPtr, const ANSICHAR* CallSite, bool bRequired = false)
+	{
+		if (!SoftPtr.IsPending())
+		{
+			return SoftPtr.Get();
+		}
+
+		return Cast<T>(LoadSynchronous(SoftPtr.ToSoftObjectPath(), CallSite, bRequired));
+	}
+
+	template<typename T>
+	static UClass* LoadSynchronous(const TSoftClassPtr<T>& SoftPtr, const ANSICHAR* CallSite, bool bRequired = false)
+	{
+		if (!SoftPtr.IsPending())
+		{
+			return SoftPtr.Get();
+		}
+
+		return Cast<UClass>(LoadSynchronous(SoftPtr.ToSoftObjectPath(), CallSite, bRequired));
+	}
+
+	/** Number of handles issued by Yap which are still alive and active. */
+	static int32 GetOutstandingHandleCount();
+
+	/** Number of sync loads since startup, including editor-time loads. */
+	static int32 GetSyncLoadCount() { return SyncLoadCount; }
+
+	/** The most recent sync loads attempted while gameplay was running (up to MaxSyncLoadRecords), oldest first. */
+	static void GetSyncLoadRecords(TArray<FYapSyncLoadRecord>& OutRecords);
+
+	static void ClearSyncLoadRecords();
+
+	static constexpr int32 MaxSyncLoadRecords = 256;
+
+	static void DumpSyncLoadRecords(FOutputDevice& Ar);
+	
+private:
+	/** Counts and records the load and applies the sync load policy. Returns false if the load must not happen. */
+	static bool PermitSyncLoad(const FSoftObjectPath& Path, const ANSICHAR* CallSite, bool bRequired);
+	
+	static void TrackHandle(const TSharedPtr<FStreamableHandle>& Handle);
+
+	/** Streaming callbacks can issue new requests, so access is guarded by TrackedHandlesLock. */
+	static TArray<TWeakPtr<FStreamableHandle>> TrackedHandles;
+
+	static FCriticalSection TrackedHandlesLock;
+
+	/** Ring buffer; once full, NextSyncLoadRecord is the oldest entry and is overwritten next. */
+	static TArray<FYapSyncLoadRecord> SyncLoadRecords;
+
+	static int32 NextSyncLoadRecord;
+
+	static int32 SyncLoadCount;
+
+	friend struct FYapSyncLoadFailureScope;
+
+	/** Incremented whenever the Fail policy refuses a load; read by FYapSyncLoadFailureScope. */
+	static uint32 FailedLoadCounter;
+};
+
+// ================================================================================================
+
+/** Wrap the work of starting a speech in one of these; if the Fail policy refused a load inside the scope, the speech should not run. */
+struct FYapSyncLoadFailureScope
+{
+	FYapSyncLoadFailureScope() : StartCounter(FYapStreamableManager::FailedLoadCounter) { }
+
+	bool HasFailed() const { return FYapStreamableManager::FailedLoadCounter != StartCounter; }
+
+private:
+	uint32 StartCounter;
 };
@@ -11,9 +11,14 @@
 #include "Enums/YapMaturitySetting.h"
 #include "Yap/YapRunningFragment.h"
 #include "Yap/YapBitReplacement.h"
+#include "Yap/YapFragmentOverlay.h"
 #include "Yap/YapDataStructures.h"
+#include "Yap/YapSaveState.h"
+#include "Yap/Debug/YapEventRecorder.h"
+#include "Yap/YapTrace.h"
 #include "Subsystems/WorldSubsystem.h"
 #include "Engine/TimerHandle.h"
+#include "Containers/Ticker.h"
 #include "Engine/World.h"
 #include "UObject/ObjectKey.h"
 
@@ -22,11 +27,13 @@
 class UYapCharacterManager;
 class UYapConversationHandler;
 class UYapBroker;
+class UYapNodeConfig;
 struct FYapPromptHandle;
 class IYapConversationHandler;
 struct FYapBit;
 class UYapCharacterComponent;
 class UYapSquirrel;
+class UFlowNode_YapDialogue;
 enum class EYapMaturitySetting : uint8;
 
 // ================================================================================================
@@ -40,6 +47,9 @@ DECLARE_DYNAMIC_DELEGATE_ThreeParams(FYapSpeechEventHandler, UObject*, Instigato
 UDELEGATE()
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FYapSpeechEvent, UObject*, Instigator, FYapSpeechHandle, Handle, EYapSpeechCompleteResult, Result);
 
+/** Result of ResolveTaggedFragment. The node is null if the fragment could not be found. A node resolved from an unloaded asset is its template, not a running instance. */
+DECLARE_DELEGATE_TwoParams(FYapOnFragmentResolved, const UFlowNode_YapDialogue* /* DialogueNode */, uint8 /* FragmentIndex */);
+
 // ================================================================================================
 
 USTRUCT()
@@ -152,6 +162,8 @@ public:
 	FYapConversationHandle FindSpeechConversationHandle(const FYapSpeechHandle& Handle);
 
 	bool IsSpeechRunning(const FYapSpeechHandle& Handle) const;
+
+	int32 GetSpeechCount() const { return AllSpeech.Num(); }
 	
 // ----------------------------------------------
 	
@@ -174,6 +186,16 @@ public:
 	FYapConversationHandle* FindConversationHandleByOwner(const UObject* Owner);
 	
 	FYapConversation* FindConversation(const FYapConversationHandle& ConversationHandle);
+
+	bool HasConversation(const FYapConversationHandle& ConversationHandle) const { return Conversations.Contains(ConversationHandle); }
+
+	int32 GetConversationCount() const { return Conversations.Num(); }
+
+// ----------------------------------------------
+
+public:
+	/** Prints every speech, owner/speaker index and conversation in this map. */
+	void Dump(FOutputDevice& Ar) const;
 };
 
 // ================================================================================================
@@ -240,6 +262,8 @@ class YAP_API UYapSubsystem : public UWorldSubsystem
 friend class UFlowNode_YapDialogue;
 friend struct FYapFragment;
 friend struct FYapPromptHandle;
+friend class UYapEventReplayDriver;
+friend struct FYapBenchmark;
 	
 public:
 	UYapSubsystem();
@@ -260,6 +284,10 @@ protected:
 	UPROPERTY(Transient)
 	TObjectPtr<UYapBroker> Broker;
 
+	/** The project's default node config, loaded when the subsystem initializes so that running dialogue never has to load it. */
+	UPROPERTY(Transient)
+	TObjectPtr<const UYapNodeConfig> DefaultNodeConfig;
+
 	/** Queue of conversations. The top one is always going to be "active". If two "Open Conversation" nodes run, the second one will wait in this queue until the first one closes. */
 	UPROPERTY(Transient)
 	TArray<FYapConversationHandle> ConversationQueue;
@@ -268,19 +296,18 @@ protected:
 	//UPROPERTY(Transient)
 	//TMap<FYapSpeechHandle, FYapConversationHandle> SpeechConversationMapping;
 	
-	/** Stores which conversation a given prompt is a part of */
-	UPROPERTY(Transient)
-	TMap<FYapPromptHandle, FYapConversationHandle> PromptHandleConversationTags;
+	/** The menu each known prompt belongs to. Handles are removed as soon as their set is released. */
+	TMap<FYapPromptHandle, TSharedRef<FYapPromptSet>> PromptSets;
 
-	// TODO dialogue node FName map?
-	// TODO change this up, should instead use Flow asset instance + flow node instance + fragment FName 
-	/** Stores the tag of a fragment and the owning dialogue node where that fragment can be found */
-	UPROPERTY(Transient)
-	TMap<FGameplayTag, UFlowNode_YapDialogue*> TaggedFragments;
+	/** The menu each conversation is currently building or showing. */
+	TMap<FYapConversationHandle, TSharedRef<FYapPromptSet>> ConversationPromptSets;
 
-	/** Stores overrides of bit replacements. Currently, can only store one at a time per fragment; new assignments simply replace the old one. */
+	/** Stores the ID of a fragment and the owning (running) dialogue node where that fragment can be found. Nodes register themselves on initialize. */
 	UPROPERTY(Transient)
-	TMap<FGameplayTag, FYapBitReplacement> BitReplacements;
+	TMap<FName, TObjectPtr<UFlowNode_YapDialogue>> TaggedFragments;
+
+	/** Runtime bit replacements. One per fragment; new assignments simply replace the old one. */
+	FYapFragmentOverlay FragmentOverlay;
 
 	/** All registered character components. */
 	UPROPERTY(Transient)
@@ -292,6 +319,49 @@ protected:
 
 	static bool bGetGameMaturitySettingWarningIssued;
 
+	/** Captures subsystem events for debugging and replay. Idle unless started. */
+	FYapEventRecorder EventRecorder;
+
+	struct FYapFastForwardStep
+	{
+		TWeakObjectPtr<UFlowNode_YapDialogue> Node;
+
+		uint8 FragmentIndex = 0;
+	};
+	
+	struct FYapFastForward
+	{
+		const UObject* ConversationOwner = nullptr;
+
+		EYapSkipTarget Target = EYapSkipTarget::NextPrompt;
+
+		/** Guards against dialogue which loops forever. */
+		int32 RemainingFragments = 0;
+
+		bool bActive = false;
+
+		/** Skipped fragments waiting to advance; SkipConversation drains these in a loop so a long conversation doesn't recurse once per fragment. */
+		TArray<FYapFastForwardStep> PendingSteps;
+
+		FYapData_ConversationSkipped Summary;
+	};
+
+	/** Set while SkipConversation runs. Everything it triggers is synchronous, so this never outlives the call. */
+	TOptional<FYapFastForward> FastForward;
+
+	static constexpr int32 MaxSkippedFragments = 1000;
+
+	/** Dialogue state for worlds without a game instance; others share UYapDialogueStateSubsystem's. See GetDialogueSaveState. */
+	FYapDialogueSaveState LocalDialogueSaveState;
+
+	/** Instanced dialogue nodes, captured into the dialogue save state when saving. */
+	TArray<TWeakObjectPtr<UFlowNode_YapDialogue>> LiveDialogueNodes;
+
+#if STATS
+	/** Pushes live counts into STATGROUP_Yap once per frame. */
+	FTSTicker::FDelegateHandle StatsTickerHandle;
+#endif
+
 public:
 	static void BindToSpeechFinish(const UObject* WorldContextObject, const FYapSpeechHandle& Handle, const FYapSpeechEventDelegate& Delegate);
 	
@@ -317,6 +387,16 @@ public:
 	UYapSquirrel& GetNoiseGenerator() const { return *NoiseGenerator; }
 
 	static UYapCharacterManager& GetCharacterManager(const UObject* WorldContextObject);
+
+	FYapEventRecorder& GetEventRecorder() { return EventRecorder; }
+
+	/** Prints the subsystem's runtime state, including the full active speech map. Run from the console with Yap.Dump. */
+	void DumpState(FOutputDevice& Ar) const;
+
+protected:
+	void UpdateStats() const;
+
+public:
 	
 	// =========================================
 	// PUBLIC API - Your game should use these
@@ -375,15 +455,41 @@ public:
 
 public:	
 	UYapBroker& GetBroker();
+
+	/** Null if the project has no default node config set, or it failed to load. */
+	const UYapNodeConfig* GetDefaultNodeConfig() const { return DefaultNodeConfig; }
 	
 	static EYapMaturitySetting GetCurrentMaturitySetting(const UWorld* World);
 
-	/**  */
-	FYapFragment* FindTaggedFragment(const FGameplayTag& FragmentTag);
+	/** Finds a fragment by ID in any running flow asset. O(1). */
+	const FYapFragment* FindFragmentByID(FName FragmentID) const;
 	
-protected:  // TODO should some of these be public?
-	/**  */
-	void RegisterTaggedFragment(const FGameplayTag& FragmentTag, UFlowNode_YapDialogue* DialogueNode);
+	/** Legacy wrapper; finds by the tag's name. */
+	const FYapFragment* FindTaggedFragment(const FGameplayTag& FragmentTag) const;
+
+	/** Replaces parts of a fragment's bits in this world, without touching the flow asset. Any fragment with the ID is affected, running or not. */
+	static void SetFragmentReplacement(const UObject* WorldContext, FName FragmentID, const FYapBitReplacement& Replacement);
+
+	static void SetFragmentReplacement(const UObject* WorldContext, const FGuid& FragmentGuid, const FYapBitReplacement& Replacement);
+
+	/** Restores the fragment's own content. */
+	static void ClearFragmentReplacement(const UObject* WorldContext, FName FragmentID);
+
+	static void ClearFragmentReplacement(const UObject* WorldContext, const FGuid& FragmentGuid);
+
+	const FYapFragmentOverlay& GetFragmentOverlay() const { return FragmentOverlay; }
+
+	/**
+	 * Finds a fragment by ID anywhere in the project. Fragments in running flow assets resolve immediately; otherwise the cooked dialogue
+	 * database is used to find and async load the owning flow asset, and the callback runs once it is loaded.
+	 */
+	void ResolveTaggedFragment(FName FragmentID, FYapOnFragmentResolved OnResolved);
+	
+	/** Called by dialogue nodes as they initialize. */
+	void RegisterTaggedFragment(FName FragmentID, UFlowNode_YapDialogue* DialogueNode);
+
+	/** Called by dialogue nodes as they deinitialize. */
+	void UnregisterTaggedFragment(FName FragmentID, const UFlowNode_YapDialogue* DialogueNode);
 
 public:
 	// Main open conversation function, and is called by the Open Conversation flow node
@@ -419,6 +525,19 @@ protected:
 	/**  */
 	void OnFinishedBroadcastingPrompts(const FYapData_PlayerPromptsReady& Data, FYapDialogueNodeClassType NodeType);
 
+	/** Tells handlers to discard a conversation's prompt entries, which are about to be broadcast again. */
+	void OnPromptsRefreshed(const FYapData_PlayerPromptsRefreshed& Data, FYapDialogueNodeClassType NodeType);
+
+	/** Releases the menu which the prompt belongs to. None of its handles can be chosen afterwards. Does nothing if the menu was already released. */
+	void ReleasePromptSet(const FYapPromptHandle& Handle);
+
+	void ReleasePromptSet(const TSharedRef<FYapPromptSet>& PromptSet);
+
+	void ReleaseConversationPromptSet(const FYapConversationHandle& ConversationHandle);
+
+	/** Warns about prompt sets which outlived their conversation, or (when the world ends) about any set which was never released. */
+	void CheckForLeakedPrompts(bool bWorldEnding) const;
+
 public:
 	void RunSpeech(const FYapData_SpeechBegins& SpeechData, FYapDialogueNodeClassType NodeType, const FYapSpeechHandle& SpeechHandle);
 
@@ -464,8 +583,60 @@ public:
 	/** Used to complete all running speech within a given conversation; supposed to be used for "skip" or "continue/advance" type buttons */
 	static void AdvanceConversation(UObject* Instigator, const FYapConversationHandle& ConversationHandle);
 	
-	// TODO: ability to instantly playback/skip through multiple nodes until some sort of target point is hit, maybe a custom node? (imagine skipping an entire cutscene)
-	// static bool SkipConversationTo(???);
+	/**
+	 * Fast-forwards a conversation: running speech is advanced and every following fragment in the conversation's flow asset resolves
+	 * instantly (conditions, activation counts, start/end pins and sequencing all apply) instead of being spoken. Handlers see no events
+	 * for skipped fragments, only a single OnConversationSkipped afterwards. Returns the number of fragments skipped.
+	 */
+	static int32 SkipConversation(UObject* Instigator, const FYapConversationHandle& ConversationHandle, EYapSkipTarget Target);
+
+	/** True while SkipConversation is resolving the conversation owned by ConversationOwner. */
+	bool IsFastForwarding(const UObject* ConversationOwner) const;
+
+	/** Only meaningful while IsFastForwarding. */
+	EYapSkipTarget GetFastForwardTarget() const;
+
+protected:
+	/** Dialogue nodes call this for every fragment they resolve while fast-forwarding. The fragment is advanced from later, by SkipConversation. */
+	void RecordFastForwardFragment(UFlowNode_YapDialogue* DialogueNode, uint8 FragmentIndex, bool bAutoChosenPrompt);
+
+	/** Ends fast-forwarding early; whatever runs next plays normally. The summary is still broadcast when SkipConversation returns. */
+	void StopFastForward(bool bStoppedAtPrompt);
+
+public:
+	/**
+	 * Writes dialogue state (node and fragment activation counts, last ran fragments, fragment replacements) into a compact versioned binary blob for your save game.
+	 * With bDelta, only state which changed since the previous save is written; load the last full snapshot and then each delta, in order.
+	 */
+	static bool SaveDialogueState(const UObject* WorldContext, TArray<uint8>& OutData, bool bDelta = false);
+
+	/** Restores a blob from SaveDialogueState. Running dialogue nodes are updated now; others pick up their state when their flow asset next starts. */
+	static bool LoadDialogueState(const UObject* WorldContext, const TArray<uint8>& Data);
+
+protected:
+	/** Dialogue node instances call this when instanced, and are given their saved state if there is any. */
+	void RegisterDialogueNode(UFlowNode_YapDialogue* DialogueNode);
+
+	void UnregisterDialogueNode(UFlowNode_YapDialogue* DialogueNode);
+
+	/** Dialogue state which outlives flow asset instances and map travel; see SaveDialogueState. */
+	FYapDialogueSaveState& GetDialogueSaveState();
+
+	/** Save state is keyed by the node's template asset, so every instance of a flow asset shares its nodes' records. */
+	static FYapNodeSaveKey MakeSaveKey(const UFlowNode_YapDialogue* DialogueNode);
+
+#if WITH_EDITOR
+public:
+	/**
+	 * The editor calls this when a dialogue node's fragments are edited during a play session. Running instances of the node (found through
+	 * their template asset and node GUID) pick up the edit: instances which read the edited node's fragments resize their run state, and
+	 * instances holding their own copy copy the edited fragments in. This also drops what was derived from the old content (replacement
+	 * copies, formatted text, dialogue database entries) and re-broadcasts open prompts.
+	 */
+	static void HotPatchDialogueNode(const UFlowNode_YapDialogue* EditedNode);
+#endif
+
+public:
 
 	bool EmitSpeechResult(const FYapSpeechHandle& Handle, EYapSpeechCompleteResult Result);
 	
@@ -508,6 +679,8 @@ protected:
 	template<typename TUInterface, typename TIInterface, auto TFunction, auto TExecFunction, typename... TArgs>
 	static void BroadcastEventHandlerFunc(TArray<TObjectPtr<UObject>>* HandlersArray, TArgs&&... Args)
 	{
+		YAP_TRACE_SCOPE(UYapSubsystem::BroadcastEventHandlerFunc);
+		
 		if (!HandlersArray)
 		{
 			UE_LOG(LogYap, Error, TEXT("No handlers are currently registered for this type group!"));
@@ -9,16 +9,32 @@
 
 // ================================================================================================
 
+/** Word, character and grapheme counts of one piece of text. The dialogue database stores one per culture for every line. */
+struct FYapTextCounts
+{
+	/** Line-break delimited words; for scripts without spaces (CJK, Thai) this is roughly one per character or phrase. */
+	uint16 Words = 0;
+
+	/** Non-whitespace code points. */
+	uint16 Characters = 0;
+
+	/** User-perceived characters (grapheme clusters), excluding whitespace. */
+	uint16 Graphemes = 0;
+};
+
+// ================================================================================================
+
 /**
  * This is a simple wrapper for FText so that it can include a cached word count.
  */
 USTRUCT(BlueprintType)
 struct YAP_API FYapText
 {
+	friend struct FYapBit;
+	
 #if WITH_EDITOR
 	friend class SFlowGraphNode_YapFragmentWidget;
 	friend class FYapEditableTextPropertyHandle;
-	friend struct FYapBit;
 	
 #endif
 	
@@ -44,6 +60,20 @@ public:
 
 	int32 GetWordCount() const { return WordCount; }
 
+	/**
+	 * Counts words, characters and graphemes of any string. Safe to call from any thread. Counts saturate at 65535.
+	 * Text in space-delimited scripts (Latin through Arabic, plus dashes, quotes and other general punctuation) is classified 16 bytes at a time with SSE2/NEON; other scripts use ICU break iterators.
+	 */
+	static FYapTextCounts CountText(const FString& InText);
+
+	/** Word count only, with the same fast path as CountText. This is the broker's default word count. Safe to call from any thread. */
+	static int32 CountWords(const FString& InText);
+
+#if WITH_EDITOR
+	/** Recounts the cached word count of many texts through the broker, across all cores when the broker allows it. Returns how many changed. */
+	static int32 RecountWords(TConstArrayView<FYapText*> Texts);
+#endif
+
 	// --------------------------------------------------------------------------------------------
 	// INTERNAL
 	// --------------------------------------------------------------------------------------------
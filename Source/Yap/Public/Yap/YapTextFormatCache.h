@@ -0,0 +1,58 @@
+﻿// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license. 
+
+#pragma once
+
+#include "Internationalization/Text.h"
+#include "Internationalization/TextKey.h"
+
+class UYapBroker;
+
+// ================================================================================================
+
+/**
+ * Formats {Argument} tokens in dialogue text with values from the broker (UYapBroker::GetTextArgument). Each pattern is compiled into an
+ * FTextFormat once and kept; each formatted result is kept per set of argument values, so repeated lines cost a map lookup. Everything is
+ * dropped when the text revision changes (culture change or live localization update), so patterns recompile once per culture.
+ *
+ * Game thread only. Enable with the project setting Format Dialogue Text Arguments.
+ */
+class YAP_API FYapTextFormatCache
+{
+public:
+	static FYapTextFormatCache& Get();
+
+	/** Returns Pattern itself if it has no arguments. SpeakerID and DirectedAtID are passed through to the broker. */
+	FText Format(const FText& Pattern, FName SpeakerID, FName DirectedAtID, const UYapBroker& Broker);
+
+	void Reset();
+
+	int32 NumPatterns() const { return KeyedPatterns.Num() + LiteralPatterns.Num(); }
+
+private:
+	struct FPattern
+	{
+		FTextFormat Format;
+
+		/** Argument names in the order they appear in the pattern; empty if there is nothing to format. */
+		TArray<FString> ArgumentNames;
+
+		/** Same as ArgumentNames, to hand to the broker without a name table lookup per call. */
+		TArray<FName> ArgumentFNames;
+
+		/** Formatted text keyed by the argument values it was formatted with. */
+		TMap<FString, FText> Results;
+	};
+
+	FPattern& FindOrCompile(const FText& Pattern);
+
+	/** Localized text is keyed by its ID; text without one (culture invariant, FromString) by its string. */
+	TMap<FTextId, FPattern> KeyedPatterns;
+
+	TMap<FString, FPattern> LiteralPatterns;
+
+	uint16 TextRevision = 0;
+
+	/** Bark-style lines with an unbounded argument (a counter, a timestamp) would otherwise grow without limit. */
+	static constexpr int32 MaxResultsPerPattern = 64;
+};
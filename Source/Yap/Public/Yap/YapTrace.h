@@ -0,0 +1,72 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+struct FYapSpeechHandle;
+enum class EYapSpeechCompleteResult : uint8;
+
+// Yap's Insights channel. Enable with -trace=cpu,yap (or "Trace.Enable Yap" at runtime).
+#define YAP_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+#if YAP_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_EXTERN(YapChannel, YAP_API);
+
+#define YAP_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, YapChannel)
+
+/** Marks the fragment currently being run so that any load waits inside it are attributed to it. */
+#define YAP_TRACE_FRAGMENT_CONTEXT(FragmentGuid) Yap::Trace::FFragmentContextScope PREPROCESSOR_JOIN(YapFragmentContext_, __LINE__)(FragmentGuid)
+
+/** Times a blocking load and emits a LoadWait event with the asset path and current fragment. */
+#define YAP_TRACE_LOAD_WAIT(AssetPath) Yap::Trace::FLoadWaitScope PREPROCESSOR_JOIN(YapLoadWait_, __LINE__)(AssetPath)
+
+#else
+
+#define YAP_TRACE_SCOPE(Name)
+#define YAP_TRACE_FRAGMENT_CONTEXT(FragmentGuid)
+#define YAP_TRACE_LOAD_WAIT(AssetPath)
+
+#endif
+
+namespace Yap
+{
+	namespace Trace
+	{
+	YAP_API void SpeechBegin(const FYapSpeechHandle& Handle, FName SpeakerID, FName Conversation, float SpeechTime);
+
+	YAP_API void SpeechEnd(const FYapSpeechHandle& Handle, EYapSpeechCompleteResult Result);
+
+	YAP_API void FragmentBegin(const FGuid& FragmentGuid, const FYapSpeechHandle& Handle, const UObject* DialogueNode);
+
+	YAP_API void LoadWait(const FSoftObjectPath& AssetPath, uint64 StartCycle, uint64 EndCycle);
+
+#if YAP_TRACE_ENABLED
+	struct YAP_API FFragmentContextScope
+	{
+		FFragmentContextScope(const FGuid& FragmentGuid);
+
+		~FFragmentContextScope();
+
+	private:
+		FGuid PreviousGuid;
+	};
+
+	struct YAP_API FLoadWaitScope
+	{
+		FLoadWaitScope(const FSoftObjectPath& InAssetPath);
+
+		~FLoadWaitScope();
+
+	private:
+		FSoftObjectPath AssetPath;
+
+		uint64 StartCycle;
+	};
+#endif
+	}
+}
@@ -44,6 +44,7 @@ public class Yap : ModuleRules
 				"Slate",
 				"SlateCore",
 				"DeveloperSettings", 
+				"Json",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -0,0 +1,22 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/Commandlets/YapBuildDialogueDatabaseCommandlet.h"
+
+#include "YapEditor/YapDialogueDatabaseBuilder.h"
+
+UYapBuildDialogueDatabaseCommandlet::UYapBuildDialogueDatabaseCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UYapBuildDialogueDatabaseCommandlet::Main(const FString& Params)
+{
+	FString OutputPath;
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	return FYapDialogueDatabaseBuilder::Build(OutputPath) ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/Commandlets/YapPathCoverageCommandlet.h"
+
+#include "FlowAsset.h"
+#include "Async/ParallelFor.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Yap/Debug/YapDialogueSimulator.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapEditorLog.h"
+
+namespace Yap
+{
+	namespace Coverage
+	{
+	bool HasDialogue(const UFlowAsset& FlowAsset)
+	{
+		for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset.GetNodes())
+		{
+			if (Pair.Value && Pair.Value->IsA<UFlowNode_YapDialogue>())
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/** Sampling reports what was seen rather than what is possible; fold it into the same shape as a symbolic report. */
+	FYapPathCoverageReport FromSimulation(FYapPreparedSimulation& Prepared, int32 NumLines)
+	{
+		const FYapSimulationReport Simulation = FYapDialogueSimulator::Simulate(Prepared);
+
+		FYapPathCoverageReport Report;
+		Report.FlowAsset = Simulation.FlowAsset;
+		Report.Lines = NumLines;
+		Report.ReachableLines = NumLines - Simulation.UnreachableFragments.Num();
+		Report.Paths = Simulation.Paths.Num();
+		Report.UnreachableFragments = Simulation.UnreachableFragments;
+
+		for (const FYapSimulatedPath& Path : Simulation.Paths)
+		{
+			Report.LongestPathSeconds = FMath::Max(Report.LongestPathSeconds, Path.MaxPlaytime);
+		}
+
+		for (const FYapSimulatedFragmentRef& Prompt : Simulation.EmptyPrompts)
+		{
+			Report.DeadBranches.Add({ Prompt.NodeGuid, Prompt.NodeName, NAME_None, FString::Printf(TEXT("Prompt had no valid options %i times"), Prompt.Count) });
+		}
+
+		return Report;
+	}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+UYapPathCoverageCommandlet::UYapPathCoverageCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 UYapPathCoverageCommandlet::Main(const FString& Params)
+{
+	FYapSimulationSettings Settings;
+
+	const bool bSampled = FParse::Param(*Params, TEXT("Sampled"));
+
+	FParse::Value(*Params, TEXT("Runs="), Settings.RunCount);
+	FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+	FParse::Value(*Params, TEXT("ConditionChance="), Settings.ConditionPassChance);
+	FParse::Value(*Params, TEXT("MaxPaths="), Settings.MaxExploredPaths);
+
+	if (bSampled)
+	{
+		Settings.Conditions = EYapSimulatedConditions::Random;
+	}
+
+	FString OutputDir = FPaths::ProjectSavedDir() / TEXT("Yap") / TEXT("Coverage");
+	FParse::Value(*Params, TEXT("Output="), OutputDir);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> FlowAssets;
+	AssetRegistry.GetAssetsByClass(UFlowAsset::StaticClass()->GetClassPathName(), FlowAssets, true);
+
+	// Flattening reads UObjects and may load audio for speech times, so it stays on the game thread
+	TArray<TSharedPtr<FYapPreparedSimulation>> Prepared;
+	TArray<int32> LineCounts;
+
+	for (const FAssetData& AssetData : FlowAssets)
+	{
+		const UFlowAsset* FlowAsset = Cast<UFlowAsset>(AssetData.GetAsset());
+
+		if (!FlowAsset || !Yap::Coverage::HasDialogue(*FlowAsset))
+		{
+			continue;
+		}
+
+		if (TSharedPtr<FYapPreparedSimulation> Simulation = FYapDialogueSimulator::Prepare(nullptr, FlowAsset, Settings))
+		{
+			int32 NumLines = 0;
+
+			for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset->GetNodes())
+			{
+				if (const UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Pair.Value))
+				{
+					NumLines += DialogueNode->GetNumFragments();
+				}
+			}
+
+			Prepared.Add(Simulation);
+			LineCounts.Add(NumLines);
+		}
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	TArray<FYapPathCoverageReport> Reports;
+	Reports.SetNum(Prepared.Num());
+
+	ParallelFor(Prepared.Num(), [&] (int32 Index)
+	{
+		Reports[Index] = bSampled ? Yap::Coverage::FromSimulation(*Prepared[Index], LineCounts[Index]) : FYapDialogueSimulator::Explore(*Prepared[Index]);
+	});
+
+	const double ExploreSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+	// Worst coverage first
+	Reports.Sort([] (const FYapPathCoverageReport& A, const FYapPathCoverageReport& B)
+	{
+		return (A.Lines - A.ReachableLines) > (B.Lines - B.ReachableLines);
+	});
+
+	FString Summary = TEXT("Asset,Lines,ReachableLines,Paths,PathLimitReached,LongestPathSeconds,DeadBranches\n");
+	FString Details = TEXT("Asset,Node,NodeGuid,Pin,Fragment,Reason\n");
+
+	int32 TotalLines = 0;
+	int32 TotalReachable = 0;
+	int32 TotalDead = 0;
+	double LongestPath = 0.0;
+
+	for (const FYapPathCoverageReport& Report : Reports)
+	{
+		const FString Asset = Report.FlowAsset.ToString();
+
+		Summary += FString::Printf(TEXT("%s,%i,%i,%i,%s,%.2f,%i\n"), *Asset, Report.Lines, Report.ReachableLines, Report.Paths,
+			Report.bPathLimitReached ? TEXT("true") : TEXT("false"), Report.LongestPathSeconds, Report.DeadBranches.Num());
+
+		for (const FYapDeadBranch& Branch : Report.DeadBranches)
+		{
+			Details += FString::Printf(TEXT("%s,%s,%s,%s,,\"%s\"\n"), *Asset, *Branch.NodeName, *Branch.NodeGuid.ToString(), *Branch.PinName.ToString(), *Branch.Reason);
+		}
+
+		for (const FYapSimulatedFragmentRef& Fragment : Report.UnreachableFragments)
+		{
+			Details += FString::Printf(TEXT("%s,%s,%s,,%i,\"Fragment is unreachable\"\n"), *Asset, *Fragment.NodeName, *Fragment.NodeGuid.ToString(), Fragment.FragmentIndex);
+		}
+
+		TotalLines += Report.Lines;
+		TotalReachable += Report.ReachableLines;
+		TotalDead += Report.DeadBranches.Num();
+		LongestPath = FMath::Max(LongestPath, Report.LongestPathSeconds);
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Path coverage (%s): %i of %i lines reachable in %i assets, %i dead branches, longest path %.1f s; explored in %.3f s"),
+		bSampled ? TEXT("sampled") : TEXT("symbolic"), TotalReachable, TotalLines, Reports.Num(), TotalDead, LongestPath, ExploreSeconds);
+
+	const FString SummaryPath = OutputDir / TEXT("Coverage.csv");
+	const FString DetailsPath = OutputDir / TEXT("DeadBranches.csv");
+
+	if (!FFileHelper::SaveStringToFile(Summary, *SummaryPath) || !FFileHelper::SaveStringToFile(Details, *DetailsPath))
+	{
+		UE_LOG(LogYapEditor, Error, TEXT("Failed to write path coverage report to <%s>"), *OutputDir);
+		return 1;
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Path coverage report written to <%s>"), *OutputDir);
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/Commandlets/YapReassignAudioIDsCommandlet.h"
+
+#include "FlowAsset.h"
+#include "FileHelpers.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Yap/YapNodeConfig.h"
+#include "Yap/YapProjectSettings.h"
+#include "Yap/Editor/YapAudioIDAllocator.h"
+#include "Yap/Editor/YapAudioIDFormat.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapEditorLog.h"
+
+UYapReassignAudioIDsCommandlet::UYapReassignAudioIDsCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 UYapReassignAudioIDsCommandlet::Main(const FString& Params)
+{
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+	const bool bAll = FParse::Param(*Params, TEXT("All"));
+	const bool bRandom = !FParse::Param(*Params, TEXT("Sequential"));
+
+	FString Path = TEXT("/Game");
+	FParse::Value(*Params, TEXT("Path="), Path);
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add(FName(Path));
+	Filter.bRecursivePaths = true;
+	Filter.ClassPaths.Add(UFlowAsset::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+
+	TArray<FAssetData> FlowAssets;
+	AssetRegistry.GetAssets(Filter, FlowAssets);
+
+	TArray<UFlowNode_YapDialogue*> DialogueNodes;
+
+	for (const FAssetData& AssetData : FlowAssets)
+	{
+		UFlowAsset* FlowAsset = Cast<UFlowAsset>(AssetData.GetAsset());
+
+		if (!FlowAsset)
+		{
+			continue;
+		}
+
+		for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset->GetNodes())
+		{
+			if (UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Pair.Value))
+			{
+				DialogueNodes.Add(DialogueNode);
+			}
+		}
+	}
+
+	FYapAudioIDAllocator& Allocator = FYapAudioIDAllocator::Get();
+
+	// Record every existing ID first, so none of them is handed out again (including to the nodes that currently have them, with -All)
+	TArray<FString> ExistingIDs;
+	ExistingIDs.Reserve(DialogueNodes.Num());
+
+	for (const UFlowNode_YapDialogue* DialogueNode : DialogueNodes)
+	{
+		if (!DialogueNode->AudioID.IsEmpty())
+		{
+			ExistingIDs.Add(DialogueNode->AudioID);
+		}
+	}
+
+	const int32 NumNewlyRecorded = Allocator.Reserve(ExistingIDs);
+
+	// Nodes to re-ID, grouped by format so each format is allocated in one batch
+	TMap<const FYapAudioIDFormat*, TArray<UFlowNode_YapDialogue*>> NodesByFormat;
+
+	TSet<FString> SeenIDs;
+	SeenIDs.Reserve(DialogueNodes.Num());
+
+	for (UFlowNode_YapDialogue* DialogueNode : DialogueNodes)
+	{
+		bool bDuplicate = false;
+
+		if (!DialogueNode->AudioID.IsEmpty())
+		{
+			SeenIDs.Add(DialogueNode->AudioID, &bDuplicate);
+		}
+
+		if (bAll || bDuplicate || DialogueNode->AudioID.IsEmpty())
+		{
+			NodesByFormat.FindOrAdd(&DialogueNode->GetNodeConfig().GetAudioIDFormat()).Add(DialogueNode);
+		}
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	TSet<UPackage*> ChangedPackages;
+	int32 NumReassigned = 0;
+
+	for (TPair<const FYapAudioIDFormat*, TArray<UFlowNode_YapDialogue*>>& Pair : NodesByFormat)
+	{
+		TArray<UFlowNode_YapDialogue*>& Nodes = Pair.Value;
+
+		TArray<FString> NewIDs;
+		Allocator.AllocateMany(*Pair.Key, UYapProjectSettings::GetIllegalAudioIDCharacters(), Nodes.Num(), bRandom, NewIDs);
+
+		if (NewIDs.Num() < Nodes.Num())
+		{
+			UE_LOG(LogYapEditor, Error, TEXT("Ran out of audio IDs of the format '%s'; %i nodes were not given a new ID"), *Pair.Key->NodeIDFormat, Nodes.Num() - NewIDs.Num());
+		}
+
+		for (int32 i = 0; i < NewIDs.Num(); ++i)
+		{
+			UFlowNode_YapDialogue* DialogueNode = Nodes[i];
+
+			UE_LOG(LogYapEditor, Verbose, TEXT("%s: audio ID %s -> %s"), *DialogueNode->GetPathName(), *DialogueNode->AudioID, *NewIDs[i]);
+
+			DialogueNode->Modify();
+			DialogueNode->AudioID = NewIDs[i];
+
+			DialogueNode->MarkPackageDirty();
+			ChangedPackages.Add(DialogueNode->GetPackage());
+
+			++NumReassigned;
+		}
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Checked %i dialogue nodes in %i flow assets under %s (%i IDs newly recorded), reassigned %i audio IDs in %.3f s"), DialogueNodes.Num(), FlowAssets.Num(), *Path, NumNewlyRecorded, NumReassigned, FPlatformTime::Seconds() - StartSeconds);
+
+	// Record the new IDs now, even if the assets are not saved
+	Allocator.Flush();
+
+	if (!bSave || ChangedPackages.Num() == 0)
+	{
+		return 0;
+	}
+
+	if (!UEditorLoadingAndSavingUtils::SavePackages(ChangedPackages.Array(), true))
+	{
+		UE_LOG(LogYapEditor, Error, TEXT("Failed to save some of the %i flow assets with reassigned audio IDs"), ChangedPackages.Num());
+		return 1;
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Saved %i flow assets"), ChangedPackages.Num());
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/Commandlets/YapRecountWordsCommandlet.h"
+
+#include "FlowAsset.h"
+#include "FileHelpers.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapEditorLog.h"
+
+UYapRecountWordsCommandlet::UYapRecountWordsCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+int32 UYapRecountWordsCommandlet::Main(const FString& Params)
+{
+	const bool bSave = !FParse::Param(*Params, TEXT("NoSave"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> FlowAssets;
+	AssetRegistry.GetAssetsByClass(UFlowAsset::StaticClass()->GetClassPathName(), FlowAssets, true);
+
+	struct FAssetTexts
+	{
+		UFlowAsset* FlowAsset;
+
+		int32 First;
+
+		int32 Num;
+	};
+
+	TArray<FAssetTexts> Assets;
+	TArray<FYapText*> Texts;
+
+	for (const FAssetData& AssetData : FlowAssets)
+	{
+		UFlowAsset* FlowAsset = Cast<UFlowAsset>(AssetData.GetAsset());
+
+		if (!FlowAsset)
+		{
+			continue;
+		}
+
+		const int32 First = Texts.Num();
+
+		for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset->GetNodes())
+		{
+			if (UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Pair.Value))
+			{
+				for (FYapFragment& Fragment : DialogueNode->GetFragmentsMutable())
+				{
+					Fragment.GetTextsMutable(Texts);
+				}
+			}
+		}
+
+		if (Texts.Num() > First)
+		{
+			Assets.Add({ FlowAsset, First, Texts.Num() - First });
+		}
+	}
+
+	TArray<int32> OldWordCounts;
+	OldWordCounts.Reserve(Texts.Num());
+
+	for (const FYapText* Text : Texts)
+	{
+		OldWordCounts.Add(Text->GetWordCount());
+	}
+
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	const int32 NumChanged = FYapText::RecountWords(Texts);
+
+	UE_LOG(LogYapEditor, Display, TEXT("Recounted %i texts in %i flow assets in %.3f s, %i changed"), Texts.Num(), Assets.Num(), FPlatformTime::Seconds() - StartSeconds, NumChanged);
+
+	TArray<UPackage*> ChangedPackages;
+
+	for (const FAssetTexts& Asset : Assets)
+	{
+		for (int32 Index = Asset.First; Index < Asset.First + Asset.Num; ++Index)
+		{
+			if (Texts[Index]->GetWordCount() != OldWordCounts[Index])
+			{
+				Asset.FlowAsset->MarkPackageDirty();
+				ChangedPackages.Add(Asset.FlowAsset->GetPackage());
+				break;
+			}
+		}
+	}
+
+	if (!bSave || ChangedPackages.Num() == 0)
+	{
+		return 0;
+	}
+
+	if (!UEditorLoadingAndSavingUtils::SavePackages(ChangedPackages, true))
+	{
+		UE_LOG(LogYapEditor, Error, TEXT("Failed to save some of the %i flow assets with changed word counts"), ChangedPackages.Num());
+		return 1;
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Saved %i flow assets"), ChangedPackages.Num());
+
+	return 0;
+}
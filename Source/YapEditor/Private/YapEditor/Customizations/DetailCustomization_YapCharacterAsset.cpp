@@ -588,10 +588,10 @@ bool FDetailCustomization_YapCharacterAsset::FixupOldPortraitsMap()
 		
 		FYapPortraitList& List = NewPortraitsMapPtr->FindOrAdd(ExistingMoodTag.RequestDirectParent());
 
-		TObjectPtr<UTexture2D>& PortraitTexture = List.Map.FindOrAdd(ExistingMoodTag.GetTagName());
+		TSoftObjectPtr<UTexture2D>& PortraitTexture = List.Map.FindOrAdd(ExistingMoodTag.GetTagName());
 
 		// We already assigned a new portrait texture, notify the user
-		if (PortraitTexture != nullptr)
+		if (!PortraitTexture.IsNull())
 		{
 			EAppReturnType::Type Return = FMessageDialog::Open(
 				EAppMsgType::OkCancel,
@@ -599,7 +599,7 @@ bool FDetailCustomization_YapCharacterAsset::FixupOldPortraitsMap()
 						LOCTEXT("YapCharacterAsset_PortraitAlreadyAssigned_Message", "Tag {0} already assigned.\nOld: {1}\nCurrent: {2}\n\nPress OK to ignore the old portrait and continue, or press Cancel to stop."),
 						FText::FromName(ExistingMoodTag.GetTagName()),
 						FText::FromString(OldPortrait.GetName()),
-						FText::FromString(PortraitTexture.GetName())),
+						FText::FromString(PortraitTexture.GetAssetName())),
 						LOCTEXT("YapCharacterAsset_PortraitAlreadyAssigned_Title", "Portrait Conflict")
 				);
 
@@ -616,7 +616,7 @@ bool FDetailCustomization_YapCharacterAsset::FixupOldPortraitsMap()
 			}
 		}
 
-		PortraitTexture = OldPortrait;
+		PortraitTexture = OldPortrait.Get();
 	}
 	
 	OldPortraitsMapPtr->Empty();
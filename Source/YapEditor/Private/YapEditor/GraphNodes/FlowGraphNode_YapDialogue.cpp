@@ -19,6 +19,7 @@
 #include "YapEditor/YapEditorEvents.h"
 #include "YapEditor/YapEditorLog.h"
 #include "YapEditor/YapEditorSubsystem.h"
+#include "YapEditor/YapAudioIDIndex.h"
 #include "YapEditor/YapTransactions.h"
 #include "YapEditor/Globals/YapTagHelpers.h"
 #include "YapEditor/NodeWidgets/SFlowGraphNode_YapDialogueWidget.h"
@@ -131,6 +132,8 @@ void UFlowGraphNode_YapDialogue::RecalculateTextOnAllFragments()
 	
 	FYapScopedTransaction T(FName("Default"), FText::Format(LOCTEXT("RecalculateTextLength_Command","Recalculate text length on {0} {0}|plural(one=node,other=nodes)"), Nodes.Num()), nullptr);
 
+	TArray<FYapText*> Texts;
+
 	for (UObject* Node : Nodes)
 	{
 		if (UFlowGraphNode_YapDialogue* DialogeGraphNode = Cast<UFlowGraphNode_YapDialogue>(Node))
@@ -140,11 +143,12 @@ void UFlowGraphNode_YapDialogue::RecalculateTextOnAllFragments()
 
 			for (FYapFragment& Fragment : DialogueNode->GetFragmentsMutable())
 			{
-				// TODO
-				// Fragment.GetBitMutable().RecacheSpeakingTime();
+				Fragment.GetTextsMutable(Texts);
 			}
 		}
 	}
+
+	FYapText::RecountWords(Texts);
 }
 
 void UFlowGraphNode_YapDialogue::RegenerateNodeAudioID()
@@ -218,8 +222,7 @@ void UFlowGraphNode_YapDialogue::AutoAssignAudioOnAllFragments()
 	}
 
 	// Yap does not prevent conflicts between audio IDs across the whole project; only within a single Flow asset. Conflicts are segregated by folders for different Flow assets.
-	TMap<FString, TArray<FAssetData>> AudioAssetsByAudioID;
-	GroupAudioAssetsByTags(AudioAssetsByAudioID);
+	FYapAudioIDIndex& AudioIDIndex = FYapAudioIDIndex::Get();
 
 	FYapTransactions::BeginModify(INVTEXT("TODO"), GetFlowAsset());
 
@@ -233,9 +236,6 @@ void UFlowGraphNode_YapDialogue::AutoAssignAudioOnAllFragments()
 	
 	for (uint8 FragmentIndex = 0; FragmentIndex < GetYapDialogueNode()->GetNumFragments(); ++FragmentIndex)
 	{
-		int32 AudioIDLen = GetYapDialogueNode()->GetAudioIDRoot().Len();
-		int32 FragmentIDLen = 3; // TODO magic number move this to project settings or some other constant
-	
 		FYapFragment& Fragment = GetYapDialogueNode()->Fragments[FragmentIndex];
 
 		FNumberFormattingOptions Args;
@@ -244,20 +244,20 @@ void UFlowGraphNode_YapDialogue::AutoAssignAudioOnAllFragments()
 		
 		FString AudioID = GetYapDialogueNode()->GetAudioIDRoot() + "-" + (FText::AsNumber(FragmentIndex, &Args)).ToString(); // TODO build some way for users to define their own sequencing. Maybe move this to a default in the Broker?
 
-		TArray<FAssetData>* CandidateAudioAssets = AudioAssetsByAudioID.Find(AudioID);
+		const TArray<FAssetData>* CandidateAudioAssets = AudioIDIndex.Find(AudioID);
 
 		if (CandidateAudioAssets)
 		{
 			bool bAssignedMature = false;
 			bool bAssignedChildSafe = false;
 
+			// TODO documentation and configurable suffixes for child safe stuff or for mature stuff
+			const FString ChildSafeAudioID = AudioID + TEXT("-Safe");
+			
 			// All of these assets have the correct audio ID. We need to find ones that are in the correct subfolder for this dialogue node.
 			for (const FAssetData& Data : *CandidateAudioAssets)
 			{
-				FRegexPattern ChildSafe(FString::Format(TEXT("[a-zA-Z]{{0}}-\\d{{1}}-Safe"), {AudioIDLen, FragmentIDLen})); // TODO documentation and configurable suffixes for child safe stuff or for mature stuff
-				FRegexMatcher ChildSafeMatch(ChildSafe, Data.GetObjectPathString());
-
-				if (ChildSafeMatch.FindNext())
+				if (Data.GetObjectPathString().Contains(ChildSafeAudioID))
 				{
 					if (bAssignedChildSafe)
 					{
@@ -352,62 +352,4 @@ void UFlowGraphNode_YapDialogue::AddFragment(int32 InsertionIndex)
 	Node->InsertFragment(NewFragment, InsertionIndex);
 }
 
-void UFlowGraphNode_YapDialogue::GatherAllAudioAssets(TArray<FAssetData>& AllAudioAssets)
-{
-	FAssetRegistryModule& AssetRegistryModule = FModuleManager::Get().LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry"));
-	IAssetRegistry& AssetRegistry = AssetRegistryModule.Get();
-
-	// Discover all audio assets 
-	const UYapNodeConfig& Config = GetYapDialogueNode()->GetNodeConfig();
-
-	const FDirectoryPath& FlowAssetsRoot = Config.GetFlowAssetsRootFolder();
-	
-	const TArray<TSoftClassPtr<UObject>>& AudioAssetClasses = UYapProjectSettings::GetAudioAssetClasses();
-	TArray<FTopLevelAssetPath> AudioAssetClassPaths;
-
-	auto AlgoTransform = [] (const TSoftClassPtr<UObject>& Obj) { return Obj->GetClassPathName(); };
-	Algo::Transform(AudioAssetClasses, AudioAssetClassPaths, AlgoTransform);
-	
-	FARFilter Filter;
-	Filter.ClassPaths = AudioAssetClassPaths;
-
-	AssetRegistry.GetAssets(Filter, AllAudioAssets, true);
-}
-
-void UFlowGraphNode_YapDialogue::GroupAudioAssetsByTags(TMap<FString, TArray<FAssetData>>& AudioAssetsByAudioID)
-{
-	TArray<FAssetData> AllAudioAssets;
-	
-	GatherAllAudioAssets(AllAudioAssets);
-	
-	int32 AudioIDLen = GetYapDialogueNode()->GetAudioIDRoot().Len();
-	int32 FragmentIDLen = 3; // TODO magic number move this to project settings or some other constant
-	
-	// Matches AAA-555, and allows for the start or end to be 'end of string' or a 'non-alphanumeric' character
-	const FRegexPattern Regex(FString::Format(TEXT("(^| |[^a-zA-Z\\d\\s:])[a-zA-Z]{{0}}-\\d{{1}}([^a-zA-Z\\d\\s:]| |$)"), {AudioIDLen, FragmentIDLen} ));
-	
-	// Matches AAA-555 specifically
-	const FRegexPattern RegexActual(FString::Format(TEXT("[a-zA-Z]{{0}}-\\d{{1}}"), {AudioIDLen, FragmentIDLen}));
-	
-	for (const FAssetData& AssetData : AllAudioAssets)
-	{
-		FString ObjectPathString = AssetData.GetObjectPathString();
-		
-		FRegexMatcher Matcher(Regex, *ObjectPathString);
-		
-		if (Matcher.FindNext())
-		{
-			FRegexMatcher ID(RegexActual, Matcher.GetCaptureGroup(0));
-
-			if (ID.FindNext())
-			{
-				FString AudioID(ID.GetCaptureGroup(0));
-
-				TArray<FAssetData>& AudioAssetsWithTag = AudioAssetsByAudioID.FindOrAdd(AudioID);
-				AudioAssetsWithTag.Add(AssetData);
-			}
-		}
-	}
-}
-
 #undef LOCTEXT_NAMESPACE
@@ -196,7 +196,7 @@ TSharedRef<SWidget> SFlowGraphNode_YapFragmentWidget::PopupContentGetter_Dialogu
 
 int32 SFlowGraphNode_YapFragmentWidget::GetFragmentActivationCount() const
 {
-	return GetFragment().GetActivationCount();
+	return GetFragmentRunState().ActivationCount;
 }
 
 int32 SFlowGraphNode_YapFragmentWidget::GetFragmentActivationLimit() const
@@ -369,12 +369,12 @@ TSharedRef<SWidget> SFlowGraphNode_YapFragmentWidget::CreateFragmentHighlightWid
 
 EVisibility SFlowGraphNode_YapFragmentWidget::Visibility_FragmentHighlight() const
 {
-	if (GetFragment().IsAwaitingManualAdvance() || FragmentRecentlyRan())
+	if (GetFragmentRunState().bAwaitingManualAdvance || FragmentRecentlyRan())
 	{
 		return EVisibility::HitTestInvisible;
 	}
 
-	if (GetFragment().IsActivationLimitMet())
+	if (GetFragment().IsActivationLimitMet(GetFragmentRunState().ActivationCount))
 	{
 		return EVisibility::HitTestInvisible;
 	}
@@ -394,12 +394,12 @@ FSlateColor SFlowGraphNode_YapFragmentWidget::BorderBackgroundColor_FragmentHigh
 		return YapColor::White_Glass;
 	}
 
-	if (GetFragment().IsAwaitingManualAdvance())
+	if (GetFragmentRunState().bAwaitingManualAdvance)
 	{
 		return YapColor::Yellow_Glass;
 	}
 	
-	if (GetFragment().IsActivationLimitMet())
+	if (GetFragment().IsActivationLimitMet(GetFragmentRunState().ActivationCount))
 	{
 		return YapColor::Red_Glass;
 	}
@@ -413,12 +413,12 @@ FSlateColor SFlowGraphNode_YapFragmentWidget::BorderBackgroundColor_FragmentHigh
 	
 	UWorld* World = GEditor->GetCurrentPlayWorld(GEditor->PlayWorld);
 	
-	if (World)// && GetFragment().GetStartTime() >= 0.0)
+	if (World)// && GetFragmentRunState().StartTime >= 0.0)
 	{
 		float MinOpaqueTime = 1.0f;
 		float FadeTime = 0.5f;
 
-		float EndTime = FMath::Max(GetFragment().GetStartTime() + MinOpaqueTime, GetFragment().GetEndTime());
+		float EndTime = FMath::Max(GetFragmentRunState().StartTime + MinOpaqueTime, GetFragmentRunState().EndTime);
 
 		float Elapsed = World->GetTimeSeconds() - EndTime;
 
@@ -1122,9 +1122,9 @@ TOptional<float> SFlowGraphNode_YapFragmentWidget::Percent_FragmentTime() const
 		return NullOpt;
 	}
 	
-	if (GetFragment().GetStartTime() >= GetFragment().GetEndTime())
+	if (GetFragmentRunState().StartTime >= GetFragmentRunState().EndTime)
 	{
-		return GEditor->PlayWorld->GetTimeSeconds() - GetFragment().GetStartTime();
+		return GEditor->PlayWorld->GetTimeSeconds() - GetFragmentRunState().StartTime;
 	}
 	else
 	{
@@ -2220,6 +2220,11 @@ FYapFragment& SFlowGraphNode_YapFragmentWidget::GetFragmentMutable() const
 	return const_cast<FYapFragment&>(GetFragment());
 }
 
+const FYapFragmentRunState& SFlowGraphNode_YapFragmentWidget::GetFragmentRunState() const
+{
+	return GetDialogueNode()->GetFragmentRunState(FragmentIndex);
+}
+
 EYapMaturitySetting SFlowGraphNode_YapFragmentWidget::GetDisplayMaturitySetting() const
 {
 	if (GEditor->PlayWorld)
@@ -2272,7 +2277,7 @@ bool SFlowGraphNode_YapFragmentWidget::HasCompleteChildSafeData() const
 
 bool SFlowGraphNode_YapFragmentWidget::FragmentIsRunning() const
 {
-	return GetFragment().GetStartTime() > GetFragment().GetEndTime();
+	return GetFragmentRunState().StartTime > GetFragmentRunState().EndTime;
 }
 
 bool SFlowGraphNode_YapFragmentWidget::FragmentRecentlyRan() const
@@ -2284,9 +2289,9 @@ bool SFlowGraphNode_YapFragmentWidget::FragmentRecentlyRan() const
 	
 	UWorld* World = GEditor->GetCurrentPlayWorld(GEditor->PlayWorld);
 	
-	if (World && GetFragment().GetStartTime() >= 0.0)
+	if (World && GetFragmentRunState().StartTime >= 0.0)
 	{
-		float Elapsed = World->GetTimeSeconds() - GetFragment().GetEndTime();
+		float Elapsed = World->GetTimeSeconds() - GetFragmentRunState().EndTime;
 		return Elapsed <= 2.0f;
 	}
 
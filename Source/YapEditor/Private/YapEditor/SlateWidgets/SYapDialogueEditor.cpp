@@ -965,7 +965,7 @@ TOptional<float> SYapDialogueEditor::Value_TimeSetting_TextTime(EYapMaturitySett
 {
 	const UYapNodeConfig& NodeConfig = DialogueNode->GetNodeConfig();
 	
-	return GetFragment().GetBit(GEditor->EditorWorld, MaturitySetting).GetTextTime(NodeConfig);
+	return GetFragment().GetBit(GEditor->EditorWorld, MaturitySetting).GetTextTime(GEditor->EditorWorld, NodeConfig);
 }
 
 TOptional<float> SYapDialogueEditor::Value_TimeSetting_ManualTime(EYapMaturitySetting MaturitySetting) const
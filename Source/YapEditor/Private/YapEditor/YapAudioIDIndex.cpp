@@ -0,0 +1,258 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/YapAudioIDIndex.h"
+
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Async/ParallelFor.h"
+#include "Internationalization/Regex.h"
+#include "Yap/YapProjectSettings.h"
+#include "YapEditor/YapEditorLog.h"
+
+const TCHAR* FYapAudioIDIndex::AudioIDPattern = TEXT("(?<![a-zA-Z\\d])[a-zA-Z]+-\\d+(?![a-zA-Z\\d])");
+
+namespace Yap::AudioIDIndex
+{
+	void FindAudioIDs(const FRegexPattern& Pattern, const FString& ObjectPath, TArray<FString>& OutAudioIDs)
+	{
+		FRegexMatcher Matcher(Pattern, ObjectPath);
+
+		while (Matcher.FindNext())
+		{
+			OutAudioIDs.AddUnique(Matcher.GetCaptureGroup(0));
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapAudioIDIndex::~FYapAudioIDIndex()
+{
+	Reset();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapAudioIDIndex& FYapAudioIDIndex::Get()
+{
+	static FYapAudioIDIndex Index;
+	return Index;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+const TArray<FAssetData>* FYapAudioIDIndex::Find(const FString& AudioID)
+{
+	if (bBuilt)
+	{
+		TArray<FTopLevelAssetPath> CurrentClasses;
+		GetIndexedClasses(CurrentClasses);
+
+		if (CurrentClasses != IndexedClasses)
+		{
+			Reset();
+		}
+	}
+
+	if (!bBuilt)
+	{
+		Build();
+	}
+
+	return AssetsByAudioID.Find(AudioID);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::Reset()
+{
+	if (FAssetRegistryModule* AssetRegistryModule = FModuleManager::GetModulePtr<FAssetRegistryModule>(TEXT("AssetRegistry")))
+	{
+		IAssetRegistry& AssetRegistry = AssetRegistryModule->Get();
+
+		AssetRegistry.OnAssetAdded().Remove(AssetAddedHandle);
+		AssetRegistry.OnAssetRemoved().Remove(AssetRemovedHandle);
+		AssetRegistry.OnAssetRenamed().Remove(AssetRenamedHandle);
+	}
+
+	AssetAddedHandle.Reset();
+	AssetRemovedHandle.Reset();
+	AssetRenamedHandle.Reset();
+
+	AssetsByAudioID.Empty();
+	AudioIDsByAsset.Empty();
+	IndexedClasses.Empty();
+
+	bBuilt = false;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::Build()
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+
+	GetIndexedClasses(IndexedClasses);
+
+	TArray<FAssetData> AudioAssets;
+
+	if (IndexedClasses.Num() > 0)
+	{
+		FARFilter Filter;
+		Filter.ClassPaths = IndexedClasses;
+
+		AssetRegistry.GetAssets(Filter, AudioAssets, true);
+	}
+
+	// Each task compiles its own pattern, so matchers never share regex state across threads
+	TArray<TArray<FString>> AudioIDsPerAsset;
+	AudioIDsPerAsset.SetNum(AudioAssets.Num());
+
+	struct FTaskContext
+	{
+		TUniquePtr<FRegexPattern> Pattern;
+	};
+
+	TArray<FTaskContext> TaskContexts;
+
+	ParallelForWithTaskContext(TaskContexts, AudioAssets.Num(), [&AudioAssets, &AudioIDsPerAsset] (FTaskContext& Context, int32 AssetIndex)
+	{
+		if (!Context.Pattern.IsValid())
+		{
+			Context.Pattern = MakeUnique<FRegexPattern>(AudioIDPattern);
+		}
+
+		Yap::AudioIDIndex::FindAudioIDs(*Context.Pattern, AudioAssets[AssetIndex].GetObjectPathString(), AudioIDsPerAsset[AssetIndex]);
+	});
+
+	AssetsByAudioID.Reserve(AudioAssets.Num());
+	AudioIDsByAsset.Reserve(AudioAssets.Num());
+
+	for (int32 i = 0; i < AudioAssets.Num(); ++i)
+	{
+		AddAsset(AudioAssets[i], MoveTemp(AudioIDsPerAsset[i]));
+	}
+
+	AssetAddedHandle = AssetRegistry.OnAssetAdded().AddRaw(this, &FYapAudioIDIndex::OnAssetAdded);
+	AssetRemovedHandle = AssetRegistry.OnAssetRemoved().AddRaw(this, &FYapAudioIDIndex::OnAssetRemoved);
+	AssetRenamedHandle = AssetRegistry.OnAssetRenamed().AddRaw(this, &FYapAudioIDIndex::OnAssetRenamed);
+
+	bBuilt = true;
+
+	UE_LOG(LogYapEditor, Display, TEXT("Indexed %i audio IDs from %i audio assets in %.2f ms"), AssetsByAudioID.Num(), AudioAssets.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::OnAssetAdded(const FAssetData& AssetData)
+{
+	if (!IsIndexedClass(AssetData))
+	{
+		return;
+	}
+
+	const FRegexPattern Pattern(AudioIDPattern);
+
+	TArray<FString> AudioIDs;
+	Yap::AudioIDIndex::FindAudioIDs(Pattern, AssetData.GetObjectPathString(), AudioIDs);
+
+	RemoveAsset(AssetData.GetSoftObjectPath());
+	AddAsset(AssetData, MoveTemp(AudioIDs));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::OnAssetRemoved(const FAssetData& AssetData)
+{
+	if (IsIndexedClass(AssetData))
+	{
+		RemoveAsset(AssetData.GetSoftObjectPath());
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath)
+{
+	if (!IsIndexedClass(AssetData))
+	{
+		return;
+	}
+
+	RemoveAsset(FSoftObjectPath(OldObjectPath));
+	OnAssetAdded(AssetData);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::AddAsset(const FAssetData& AssetData, TArray<FString>&& AudioIDs)
+{
+	if (AudioIDs.Num() == 0)
+	{
+		return;
+	}
+
+	for (const FString& AudioID : AudioIDs)
+	{
+		AssetsByAudioID.FindOrAdd(AudioID).Add(AssetData);
+	}
+
+	AudioIDsByAsset.Add(AssetData.GetSoftObjectPath(), MoveTemp(AudioIDs));
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::RemoveAsset(const FSoftObjectPath& ObjectPath)
+{
+	TArray<FString> AudioIDs;
+
+	if (!AudioIDsByAsset.RemoveAndCopyValue(ObjectPath, AudioIDs))
+	{
+		return;
+	}
+
+	for (const FString& AudioID : AudioIDs)
+	{
+		TArray<FAssetData>* Assets = AssetsByAudioID.Find(AudioID);
+
+		if (!Assets)
+		{
+			continue;
+		}
+
+		Assets->RemoveAllSwap([&ObjectPath] (const FAssetData& AssetData)
+		{
+			return AssetData.GetSoftObjectPath() == ObjectPath;
+		});
+
+		if (Assets->Num() == 0)
+		{
+			AssetsByAudioID.Remove(AudioID);
+		}
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+
+bool FYapAudioIDIndex::IsIndexedClass(const FAssetData& AssetData) const
+{
+	return IndexedClasses.Contains(AssetData.AssetClassPath);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapAudioIDIndex::GetIndexedClasses(TArray<FTopLevelAssetPath>& OutClassPaths)
+{
+	OutClassPaths.Reset();
+
+	for (const TSoftClassPtr<UObject>& AudioAssetClass : UYapProjectSettings::GetAudioAssetClasses())
+	{
+		if (!AudioAssetClass.IsNull())
+		{
+			OutClassPaths.AddUnique(AudioAssetClass.ToSoftObjectPath().GetAssetPath());
+		}
+	}
+}
@@ -0,0 +1,109 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/YapCookedFragmentReport.h"
+
+#include "FlowAsset.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/FileHelper.h"
+#include "Yap/YapFragment.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapEditorLog.h"
+
+#define LOCTEXT_NAMESPACE "YapEditor"
+
+bool FYapCookedFragmentReport::Run(const FString& OutputPath)
+{
+	const FString Path = OutputPath.IsEmpty() ? GetDefaultPath() : OutputPath;
+	
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> FlowAssets;
+	AssetRegistry.GetAssetsByClass(UFlowAsset::StaticClass()->GetClassPathName(), FlowAssets, true);
+
+	TArray<FYapCookedFragmentReportRow> Rows;
+
+	for (const FAssetData& AssetData : FlowAssets)
+	{
+		if (const UFlowAsset* FlowAsset = Cast<UFlowAsset>(AssetData.GetAsset()))
+		{
+			FYapCookedFragmentReportRow Row = MeasureAsset(FlowAsset);
+
+			if (Row.NumFragments > 0)
+			{
+				Rows.Add(MoveTemp(Row));
+			}
+		}
+	}
+
+	// Biggest savings first
+	Rows.Sort([] (const FYapCookedFragmentReportRow& A, const FYapCookedFragmentReportRow& B)
+	{
+		return (A.EditorBytes - A.CookedBytes) > (B.EditorBytes - B.CookedBytes);
+	});
+
+	FYapCookedFragmentReportRow Total;
+	
+	FString Csv = TEXT("Asset,Fragments,EditorBytes,CookedBytes,BytesSaved\n");
+
+	for (const FYapCookedFragmentReportRow& Row : Rows)
+	{
+		Csv += FString::Printf(TEXT("%s,%i,%lld,%lld,%lld\n"), *Row.Asset.ToString(), Row.NumFragments, Row.EditorBytes, Row.CookedBytes, Row.EditorBytes - Row.CookedBytes);
+
+		Total.NumFragments += Row.NumFragments;
+		Total.EditorBytes += Row.EditorBytes;
+		Total.CookedBytes += Row.CookedBytes;
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Cooked fragment report: %i fragments in %i assets, %lld bytes -> %lld bytes (%lld bytes saved)"), Total.NumFragments, Rows.Num(), Total.EditorBytes, Total.CookedBytes, Total.EditorBytes - Total.CookedBytes);
+	
+	if (!FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogYapEditor, Error, TEXT("Failed to write cooked fragment report to <%s>"), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FString FYapCookedFragmentReport::GetDefaultPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Yap") / TEXT("CookedFragmentReport.csv");
+}
+
+// ------------------------------------------------------------------------------------------------
+
+FYapCookedFragmentReportRow FYapCookedFragmentReport::MeasureAsset(const UFlowAsset* FlowAsset)
+{
+	FYapCookedFragmentReportRow Row;
+	Row.Asset = FSoftObjectPath(FlowAsset);
+	
+	for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset->GetNodes())
+	{
+		const UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Pair.Value);
+
+		if (!DialogueNode)
+		{
+			continue;
+		}
+
+		for (const FYapFragment& Fragment : DialogueNode->GetFragments())
+		{
+			int64 EditorBytes;
+			int64 CookedBytes;
+			
+			Fragment.MeasureSerializedSize(EditorBytes, CookedBytes);
+
+			Row.NumFragments++;
+			Row.EditorBytes += EditorBytes;
+			Row.CookedBytes += CookedBytes;
+		}
+	}
+
+	return Row;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,178 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/YapDialogueDatabaseBuilder.h"
+
+#include "FlowAsset.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "Internationalization/TextLocalizationResource.h"
+#include "Misc/Paths.h"
+#include "Yap/YapFragment.h"
+#include "Yap/Enums/YapLoadContext.h"
+#include "Yap/Enums/YapMaturitySetting.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapEditorLog.h"
+
+#define LOCTEXT_NAMESPACE "YapEditor"
+
+bool FYapDialogueDatabaseBuilder::Build(const FString& OutputPath)
+{
+	const FString Path = OutputPath.IsEmpty() ? FYapDialogueDatabase::GetDefaultPath() : OutputPath;
+	
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> FlowAssets;
+	AssetRegistry.GetAssetsByClass(UFlowAsset::StaticClass()->GetClassPathName(), FlowAssets, true);
+
+	TArray<FYapDialogueDatabaseEntry> Entries;
+
+	for (const FAssetData& AssetData : FlowAssets)
+	{
+		if (const UFlowAsset* FlowAsset = Cast<UFlowAsset>(AssetData.GetAsset()))
+		{
+			GatherAsset(FlowAsset, Entries);
+		}
+	}
+
+	UE_LOG(LogYapEditor, Display, TEXT("Gathered %i dialogue fragments from %i flow assets"), Entries.Num(), FlowAssets.Num());
+
+	TArray<FString> Cultures;
+	GatherTextCounts(Entries, Cultures);
+	
+	return FYapDialogueDatabase::Write(Path, MoveTemp(Entries), Cultures);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueDatabaseBuilder::GatherTextCounts(TArray<FYapDialogueDatabaseEntry>& Entries, TArray<FString>& OutCultures)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+	
+	// One merged resource per culture across all of the game's localization targets
+	TMap<FString, FTextLocalizationResource> Resources;
+
+	for (const FString& LocalizationPath : FPaths::GetGameLocalizationPaths())
+	{
+		TArray<FString> CultureDirectories;
+		IFileManager::Get().FindFiles(CultureDirectories, *(LocalizationPath / TEXT("*")), false, true);
+
+		for (const FString& Culture : CultureDirectories)
+		{
+			Resources.FindOrAdd(Culture).LoadFromDirectory(LocalizationPath / Culture, 0);
+		}
+	}
+
+	Resources.KeySort(TLess<FString>());
+
+	TArray<const FTextLocalizationResource*> CultureResources;
+	OutCultures.Reset(Resources.Num());
+
+	for (const TPair<FString, FTextLocalizationResource>& Pair : Resources)
+	{
+		OutCultures.Add(Pair.Key);
+		CultureResources.Add(&Pair.Value);
+	}
+
+	if (OutCultures.Num() == 0)
+	{
+		UE_LOG(LogYapEditor, Display, TEXT("No compiled localization found; dialogue database will not contain per-culture text counts"));
+		return;
+	}
+
+	// Lines missing from a culture count their source text, which is what the game will display
+	ParallelFor(Entries.Num(), [&Entries, &CultureResources] (int32 EntryIndex)
+	{
+		FYapDialogueDatabaseEntry& Entry = Entries[EntryIndex];
+		Entry.TextCounts.SetNumZeroed(CultureResources.Num() * 2);
+
+		for (int32 Culture = 0; Culture < CultureResources.Num(); ++Culture)
+		{
+			for (int32 Column = 0; Column < 2; ++Column)
+			{
+				const FString* Localized = &Entry.TextSource[Column];
+
+				if (!Entry.TextKey[Column].IsEmpty())
+				{
+					const FTextId TextId(*Entry.TextNamespace[Column], *Entry.TextKey[Column]);
+
+					if (const FTextLocalizationResource::FEntry* Found = CultureResources[Culture]->Entries.Find(TextId))
+					{
+						Localized = &Found->LocalizedString.Get();
+					}
+				}
+
+				Entry.TextCounts[Culture * 2 + Column] = FYapText::CountText(*Localized);
+			}
+		}
+	});
+
+	UE_LOG(LogYapEditor, Display, TEXT("Counted text of %i fragments in %i cultures in %.2f s"), Entries.Num(), OutCultures.Num(), FPlatformTime::Seconds() - StartSeconds);
+}
+
+// ------------------------------------------------------------------------------------------------
+
+void FYapDialogueDatabaseBuilder::GatherAsset(const UFlowAsset* FlowAsset, TArray<FYapDialogueDatabaseEntry>& OutEntries)
+{
+	const FSoftObjectPath AssetPath(FlowAsset);
+
+	// Sort nodes so the output is deterministic between cooks
+	TArray<const UFlowNode_YapDialogue*> DialogueNodes;
+	
+	for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset->GetNodes())
+	{
+		if (const UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Pair.Value))
+		{
+			DialogueNodes.Add(DialogueNode);
+		}
+	}
+
+	DialogueNodes.Sort([] (const UFlowNode_YapDialogue& A, const UFlowNode_YapDialogue& B)
+	{
+		return A.GetGuid() < B.GetGuid();
+	});
+
+	for (const UFlowNode_YapDialogue* DialogueNode : DialogueNodes)
+	{
+		const UYapNodeConfig& Config = DialogueNode->GetNodeConfig();
+		const TArray<FYapFragment>& Fragments = DialogueNode->GetFragments();
+
+		for (int32 FragmentIndex = 0; FragmentIndex < Fragments.Num(); ++FragmentIndex)
+		{
+			const FYapFragment& Fragment = Fragments[FragmentIndex];
+			
+			FYapDialogueDatabaseEntry& Entry = OutEntries.AddDefaulted_GetRef();
+			Entry.FragmentGuid = Fragment.GetGuid();
+			Entry.FragmentID = Fragment.GetFragmentID();
+			Entry.SpeakerID = Fragment.GetSpeakerTag().GetTagName();
+			Entry.MoodTag = Fragment.GetMoodTag().GetTagName();
+			Entry.OwningAsset = AssetPath;
+			Entry.NodeGuid = DialogueNode->GetGuid();
+			Entry.FragmentIndex = static_cast<uint8>(FragmentIndex);
+
+			const EYapMaturitySetting Columns[2] = { EYapMaturitySetting::Mature, EYapMaturitySetting::ChildSafe };
+			
+			for (int32 Column = 0; Column < 2; ++Column)
+			{
+				// Fragments without child-safe data resolve to the mature bit here
+				const FYapBit& Bit = Fragment.GetBit(nullptr, Columns[Column]);
+				const FText& Text = Bit.GetDialogueText();
+
+				Entry.TextNamespace[Column] = FTextInspector::GetNamespace(Text).Get(FString());
+				Entry.TextKey[Column] = FTextInspector::GetKey(Text).Get(FString());
+				
+				if (const FString* Source = FTextInspector::GetSourceString(Text))
+				{
+					Entry.TextSource[Column] = *Source;
+				}
+
+				Entry.SpeechTime[Column] = Fragment.GetSpeechTime(nullptr, Columns[Column], EYapLoadContext::Sync, Config).Get(-1.0f);
+				Entry.AudioAsset[Column] = Bit.GetDialogueAudioAsset_SoftPtr<UObject>().ToSoftObjectPath();
+			}
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
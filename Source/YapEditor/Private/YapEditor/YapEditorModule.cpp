@@ -19,6 +19,12 @@
 #include "YapEditor/Customizations/PropertyCustomization_YapPortraitList.h"
 #include "YapEditor/Customizations/PropertyCustomization_YapCharacterIdentity.h"
 #include "YapEditor/Globals/YapEditorFuncs.h"
+#include "YapEditor/YapDialogueDatabaseBuilder.h"
+#include "YapEditor/YapCookedFragmentReport.h"
+#include "YapEditor/YapEditorLog.h"
+#include "YapEditor/YapStrippedAudioFilter.h"
+#include "GameDelegates.h"
+#include "Settings/ProjectPackagingSettings.h"
 
 #define LOCTEXT_NAMESPACE "YapEditor"
 
@@ -69,6 +75,12 @@ void FYapEditorModule::StartupModule()
 		FCanExecuteAction());
 	
 	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FYapEditorModule::RegisterMenus));
+
+	ModifyCookHandle = FGameDelegates::Get().GetModifyCookDelegate().AddRaw(this, &FYapEditorModule::OnModifyCook);
+
+	ProjectSettingsChangedHandle = GetMutableDefault<UYapProjectSettings>()->OnSettingChanged().AddRaw(this, &FYapEditorModule::OnProjectSettingsChanged);
+
+	StageDialogueDatabase();
 }
 
 void FYapEditorModule::ShutdownModule()
@@ -76,6 +88,13 @@ void FYapEditorModule::ShutdownModule()
 	// FGPGEditorModuleBase implementation START
 	ShutdownModuleBase();
 	// FGPGEditorModuleBase implementation END
+
+	FGameDelegates::Get().GetModifyCookDelegate().Remove(ModifyCookHandle);
+
+	if (UObjectInitialized())
+	{
+		GetMutableDefault<UYapProjectSettings>()->OnSettingChanged().Remove(ProjectSettingsChangedHandle);
+	}
 }
 
 void FYapEditorModule::OpenYapProjectSettings()
@@ -113,6 +132,68 @@ void FYapEditorModule::RegisterMenus()
 	Entry1.SetCommandList(PluginCommands);
 }
 
+void FYapEditorModule::OnModifyCook(TArray<FName>& PackagesToCook, TArray<FName>& PackagesToNeverCook)
+{
+	if (UYapProjectSettings::GetBuildDialogueDatabaseOnCook())
+	{
+		FYapDialogueDatabaseBuilder::Build();
+
+		// Normally already done by the editor; a build script may have read the staging settings before this cook started
+		if (StageDialogueDatabase())
+		{
+			UE_LOG(LogYapEditor, Warning, TEXT("Content/Yap was not set to be staged; it is now, but this build may not include the dialogue database. Package again if it is missing."));
+		}
+	}
+
+	if (UYapProjectSettings::GetReportCookedFragmentSavings())
+	{
+		FYapCookedFragmentReport::Run();
+	}
+
+	FYapStrippedAudioFilter::ModifyCook(PackagesToNeverCook);
+}
+
+void FYapEditorModule::OnProjectSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	if (PropertyChangedEvent.GetMemberPropertyName() == GET_MEMBER_NAME_CHECKED(UYapProjectSettings, bBuildDialogueDatabaseOnCook))
+	{
+		StageDialogueDatabase();
+	}
+}
+
+bool FYapEditorModule::StageDialogueDatabase()
+{
+	if (!UYapProjectSettings::GetBuildDialogueDatabaseOnCook())
+	{
+		return false;
+	}
+
+	UProjectPackagingSettings* PackagingSettings = GetMutableDefault<UProjectPackagingSettings>();
+
+	// Relative to Content; non-UFS so that the file can be memory-mapped
+	const FString Directory = TEXT("Yap");
+
+	const bool bAlreadyStaged = PackagingSettings->DirectoriesToAlwaysStageAsNonUFS.ContainsByPredicate([&Directory] (const FDirectoryPath& Path)
+	{
+		return Path.Path.Equals(Directory, ESearchCase::IgnoreCase);
+	});
+
+	if (bAlreadyStaged)
+	{
+		return false;
+	}
+
+	FDirectoryPath StagedDirectory;
+	StagedDirectory.Path = Directory;
+
+	PackagingSettings->DirectoriesToAlwaysStageAsNonUFS.Add(StagedDirectory);
+	PackagingSettings->TryUpdateDefaultConfigFile();
+
+	UE_LOG(LogYapEditor, Display, TEXT("Added Content/Yap to Directories to Always Stage as Non-UFS so the dialogue database is packaged"));
+
+	return true;
+}
+
 TSharedRef<SWidget> FYapEditorModule::GenerateYapComboMenuContent(TSharedRef<FUICommandList> InCommandList)
 {
 	static const FName MenuName("Yap.EditorCommands");
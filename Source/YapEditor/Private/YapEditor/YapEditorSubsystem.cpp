@@ -16,6 +16,10 @@
 #include "Framework/Application/SlateApplication.h"
 #include "Subsystems/AssetEditorSubsystem.h"
 #include "UObject/ObjectSaveContext.h"
+#include "Misc/TransactionObjectEvent.h"
+#include "Yap/YapSubsystem.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapAudioIDIndex.h"
 #include "YapEditor/YapDeveloperSettings.h"
 #include "YapEditor/Globals/YapTagHelpers.h"
 
@@ -97,6 +101,8 @@ void UYapEditorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 #endif
 
 	FCoreUObjectDelegates::OnObjectPreSave.AddUObject(this, &ThisClass::OnObjectPresave);
+
+	FCoreUObjectDelegates::OnObjectTransacted.AddUObject(this, &ThisClass::OnObjectTransacted);
 }
 
 void UYapEditorSubsystem::Deinitialize()
@@ -106,6 +112,10 @@ void UYapEditorSubsystem::Deinitialize()
 		FSlateApplication::Get().UnregisterInputPreProcessor(InputTracker);
 	}
 
+	FCoreUObjectDelegates::OnObjectTransacted.RemoveAll(this);
+
+	FYapAudioIDIndex::Get().Reset();
+
 	Super::Deinitialize();
 }
 
@@ -117,6 +127,25 @@ void UYapEditorSubsystem::OnObjectPresave(UObject* Object, FObjectPreSaveContext
 	}
 }
 
+void UYapEditorSubsystem::OnObjectTransacted(UObject* Object, const FTransactionObjectEvent& Event)
+{
+	// Snapshots are sent while a value is still being dragged; wait for the finished edit (or an undo/redo)
+	if (Event.GetEventType() == ETransactionObjectEventType::Snapshot)
+	{
+		return;
+	}
+
+	if (!GEditor || !GEditor->IsPlaySessionInProgress())
+	{
+		return;
+	}
+
+	if (const UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Object))
+	{
+		UYapSubsystem::HotPatchDialogueNode(DialogueNode);
+	}
+}
+
 void UYapEditorSubsystem::CleanupDialogueTags()
 {
 	for (auto It = TagsPendingDeletion.CreateIterator(); It; ++It)
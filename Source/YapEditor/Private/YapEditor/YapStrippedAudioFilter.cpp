@@ -0,0 +1,141 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#include "YapEditor/YapStrippedAudioFilter.h"
+
+#include "FlowAsset.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Interfaces/ITargetPlatform.h"
+#include "Interfaces/ITargetPlatformManagerModule.h"
+#include "Yap/YapFragment.h"
+#include "Yap/YapProjectSettings.h"
+#include "Yap/Enums/YapMaturitySetting.h"
+#include "Yap/Nodes/FlowNode_YapDialogue.h"
+#include "YapEditor/YapEditorLog.h"
+
+#define LOCTEXT_NAMESPACE "YapEditor"
+
+int32 FYapStrippedAudioFilter::ModifyCook(TArray<FName>& PackagesToNeverCook)
+{
+	const EYapMaturitySetting CookedMaturity = GetCookedMaturity();
+
+	const TArray<FName> StrippedPackages = FindStrippedAudioPackages(CookedMaturity);
+
+	for (const FName& PackageName : StrippedPackages)
+	{
+		UE_LOG(LogYapEditor, Verbose, TEXT("Not cooking %s; only stripped dialogue bits use it"), *PackageName.ToString());
+	}
+
+	PackagesToNeverCook.Append(StrippedPackages);
+
+	UE_LOG(LogYapEditor, Display, TEXT("Dialogue cooked maturity %s: kept %i audio assets of stripped bits out of the cook"),
+		*StaticEnum<EYapMaturitySetting>()->GetNameStringByValue(static_cast<int64>(CookedMaturity)), StrippedPackages.Num());
+
+	return StrippedPackages.Num();
+}
+
+// ------------------------------------------------------------------------------------------------
+
+EYapMaturitySetting FYapStrippedAudioFilter::GetCookedMaturity()
+{
+	// One cook can target several platforms, and packages to never cook apply to all of them
+	const TArray<ITargetPlatform*>& Platforms = GetTargetPlatformManagerRef().GetActiveTargetPlatforms();
+
+	if (Platforms.IsEmpty())
+	{
+		return EYapMaturitySetting::Unspecified;
+	}
+
+	const EYapMaturitySetting CookedMaturity = UYapProjectSettings::GetCookedMaturity(Platforms[0]);
+
+	for (const ITargetPlatform* Platform : Platforms)
+	{
+		if (UYapProjectSettings::GetCookedMaturity(Platform) != CookedMaturity)
+		{
+			return EYapMaturitySetting::Unspecified;
+		}
+	}
+
+	return CookedMaturity;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+TArray<FName> FYapStrippedAudioFilter::FindStrippedAudioPackages(EYapMaturitySetting CookedMaturity)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> FlowAssets;
+	AssetRegistry.GetAssetsByClass(UFlowAsset::StaticClass()->GetClassPathName(), FlowAssets, true);
+
+	TSet<FName> DialoguePackages;
+	TSet<FName> StrippedPackages;
+	TSet<FName> KeptPackages;
+
+	for (const FAssetData& AssetData : FlowAssets)
+	{
+		const UFlowAsset* FlowAsset = Cast<UFlowAsset>(AssetData.GetAsset());
+
+		if (!FlowAsset)
+		{
+			continue;
+		}
+
+		DialoguePackages.Add(AssetData.PackageName);
+
+		for (const TPair<FGuid, UFlowNode*>& Pair : FlowAsset->GetNodes())
+		{
+			const UFlowNode_YapDialogue* DialogueNode = Cast<UFlowNode_YapDialogue>(Pair.Value);
+
+			if (!DialogueNode)
+			{
+				continue;
+			}
+
+			for (const FYapFragment& Fragment : DialogueNode->GetFragments())
+			{
+				const FSoftObjectPath StrippedAudio = Fragment.GetStrippedAudioAsset(CookedMaturity);
+
+				for (const FYapBit* Bit : { &Fragment.GetMatureBit(), &Fragment.GetChildSafeBit() })
+				{
+					const FSoftObjectPath Audio = Bit->GetDialogueAudioAsset_SoftPtr<UObject>().ToSoftObjectPath();
+
+					if (!Audio.IsNull())
+					{
+						(Audio == StrippedAudio ? StrippedPackages : KeptPackages).Add(Audio.GetLongPackageFName());
+					}
+				}
+			}
+		}
+	}
+
+	TArray<FName> Result;
+
+	for (const FName& PackageName : StrippedPackages)
+	{
+		// Another fragment's kept bit uses it
+		if (KeptPackages.Contains(PackageName))
+		{
+			continue;
+		}
+
+		// Something other than dialogue uses it
+		TArray<FName> Referencers;
+		AssetRegistry.GetReferencers(PackageName, Referencers);
+
+		const bool bReferencedElsewhere = Referencers.ContainsByPredicate([&DialoguePackages] (const FName& Referencer)
+		{
+			return !DialoguePackages.Contains(Referencer);
+		});
+
+		if (!bReferencedElsewhere)
+		{
+			Result.Add(PackageName);
+		}
+	}
+
+	return Result;
+}
+
+#undef LOCTEXT_NAMESPACE
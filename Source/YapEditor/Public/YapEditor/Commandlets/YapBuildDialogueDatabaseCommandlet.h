@@ -0,0 +1,23 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "YapBuildDialogueDatabaseCommandlet.generated.h"
+
+/**
+ * Builds the flattened dialogue database without cooking.
+ * Usage: UnrealEditor-Cmd.exe <Project> -run=YapBuildDialogueDatabase [-Output=<path>]
+ */
+UCLASS()
+class UYapBuildDialogueDatabaseCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UYapBuildDialogueDatabaseCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
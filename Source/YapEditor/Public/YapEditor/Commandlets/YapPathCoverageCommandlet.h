@@ -0,0 +1,25 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "YapPathCoverageCommandlet.generated.h"
+
+/**
+ * Explores every flow asset containing Yap dialogue and writes a coverage report: reachable lines, longest path in seconds and dead branches.
+ * Assets are flattened on the game thread, then explored in parallel. Conditions are symbolic (each may pass or fail) unless -Sampled is given,
+ * which instead runs -Runs playthroughs per asset with conditions passing at -ConditionChance.
+ * Usage: UnrealEditor-Cmd.exe <Project> -run=YapPathCoverage [-Sampled] [-Runs=<n>] [-Seed=<n>] [-ConditionChance=<0..1>] [-MaxPaths=<n>] [-Output=<dir>]
+ */
+UCLASS()
+class UYapPathCoverageCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UYapPathCoverageCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,26 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "YapReassignAudioIDsCommandlet.generated.h"
+
+/**
+ * Gives new audio IDs to the dialogue nodes in every flow asset under a folder, e.g. after copying in dialogue from another project or
+ * merging branches. Every ID already in the folder is recorded in the audio ID registry first; then nodes with no ID, or an ID another node
+ * in the folder already has, are given new ones from FYapAudioIDAllocator in one batch. -All re-IDs every node. -Sequential hands out the
+ * first free IDs instead of random ones.
+ * Usage: UnrealEditor-Cmd.exe <Project> -run=YapReassignAudioIDs [-Path=/Game/Dialogue] [-All] [-Sequential] [-NoSave]
+ */
+UCLASS()
+class UYapReassignAudioIDsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UYapReassignAudioIDsCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
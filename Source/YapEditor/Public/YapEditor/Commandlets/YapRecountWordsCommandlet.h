@@ -0,0 +1,24 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "YapRecountWordsCommandlet.generated.h"
+
+/**
+ * Recounts the cached word count of every fragment's text in every flow asset, e.g. after changing the broker's word count rules, and saves
+ * the assets whose counts changed. Counting runs across all cores unless the broker's word count is implemented in Blueprint.
+ * Usage: UnrealEditor-Cmd.exe <Project> -run=YapRecountWords [-NoSave]
+ */
+UCLASS()
+class UYapRecountWordsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UYapRecountWordsCommandlet();
+
+	int32 Main(const FString& Params) override;
+};
@@ -60,11 +60,6 @@ public:
 	void RandomizeAudioID();
 	
 	void AddFragment(int32 InsertionIndex = INDEX_NONE);
-
-protected:
-	void GatherAllAudioAssets(TArray<FAssetData>& AllAudioAssets);
-
-	void GroupAudioAssetsByTags(TMap<FString, TArray<FAssetData>>& AudioAssetsByAudioID);
 };
 
 #undef LOCTEXT_NAMESPACE
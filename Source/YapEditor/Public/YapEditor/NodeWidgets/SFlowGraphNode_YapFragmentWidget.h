@@ -328,6 +328,8 @@ protected:
 	FYapFragment& GetFragmentMutable();
 
 	FYapFragment& GetFragmentMutable() const;
+
+	const FYapFragmentRunState& GetFragmentRunState() const;
 	
 	// ------------
 public:
@@ -0,0 +1,66 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "AssetRegistry/AssetData.h"
+
+// ================================================================================================
+
+/**
+ * Every audio asset in the project (of the audio asset classes in project settings), keyed by the audio IDs in its object path, e.g.
+ * /Game/VO/ABC-001-Safe is found under ABC-001. Built on first use, with the object paths matched in parallel, then kept current from asset
+ * registry add, remove and rename events, so auto-linking audio to a node is one map lookup per fragment. Rebuilt if the audio asset classes
+ * change. Game thread only.
+ */
+class YAPEDITOR_API FYapAudioIDIndex
+{
+public:
+	~FYapAudioIDIndex();
+
+	static FYapAudioIDIndex& Get();
+
+	/** Audio assets with the audio ID as a whole token of their object path. Case-insensitive; null if there are none. */
+	const TArray<FAssetData>* Find(const FString& AudioID);
+
+	/** Drops the index and stops listening to the asset registry; the next Find rebuilds it. UYapEditorSubsystem calls this on shutdown. */
+	void Reset();
+
+	int32 NumAudioIDs() const { return AssetsByAudioID.Num(); }
+
+private:
+	void Build();
+
+	void OnAssetAdded(const FAssetData& AssetData);
+
+	void OnAssetRemoved(const FAssetData& AssetData);
+
+	void OnAssetRenamed(const FAssetData& AssetData, const FString& OldObjectPath);
+
+	void AddAsset(const FAssetData& AssetData, TArray<FString>&& AudioIDs);
+
+	void RemoveAsset(const FSoftObjectPath& ObjectPath);
+
+	bool IsIndexedClass(const FAssetData& AssetData) const;
+
+	static void GetIndexedClasses(TArray<FTopLevelAssetPath>& OutClassPaths);
+
+	/** Audio ID tokens: letters, a dash and digits, with no letter or digit directly before or after. */
+	static const TCHAR* AudioIDPattern;
+
+	TMap<FString, TArray<FAssetData>> AssetsByAudioID;
+
+	/** Reverse of AssetsByAudioID, to remove an asset without scanning every ID. */
+	TMap<FSoftObjectPath, TArray<FString>> AudioIDsByAsset;
+
+	/** The audio asset classes the index was built for. */
+	TArray<FTopLevelAssetPath> IndexedClasses;
+
+	bool bBuilt = false;
+
+	FDelegateHandle AssetAddedHandle;
+
+	FDelegateHandle AssetRemovedHandle;
+
+	FDelegateHandle AssetRenamedHandle;
+};
@@ -0,0 +1,33 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+class UFlowAsset;
+
+// ================================================================================================
+
+struct FYapCookedFragmentReportRow
+{
+	FSoftObjectPath Asset;
+
+	int32 NumFragments = 0;
+
+	int64 EditorBytes = 0;
+
+	int64 CookedBytes = 0;
+};
+
+// ================================================================================================
+
+/** Reports how many bytes the cook-time fragment transform (see FYapFragment::MakeCookedCopy) saves in every flow asset. Runs at cook start if enabled in project settings. */
+struct YAPEDITOR_API FYapCookedFragmentReport
+{
+	/** Measures every flow asset and writes a CSV. Uses GetDefaultPath() if no path is given. */
+	static bool Run(const FString& OutputPath = FString());
+
+	/** Saved/Yap/CookedFragmentReport.csv */
+	static FString GetDefaultPath();
+
+	static FYapCookedFragmentReportRow MeasureAsset(const UFlowAsset* FlowAsset);
+};
@@ -0,0 +1,20 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+#include "Yap/YapDialogueDatabase.h"
+
+class UFlowAsset;
+
+/** Flattens every dialogue fragment in the project into an FYapDialogueDatabase file. Runs automatically at cook start, or via the YapBuildDialogueDatabase commandlet. */
+struct YAPEDITOR_API FYapDialogueDatabaseBuilder
+{
+	/** Gathers all flow assets and writes the database. Uses FYapDialogueDatabase::GetDefaultPath() if no path is given. */
+	static bool Build(const FString& OutputPath = FString());
+
+	static void GatherAsset(const UFlowAsset* FlowAsset, TArray<FYapDialogueDatabaseEntry>& OutEntries);
+
+	/** Counts every line's text in every culture with compiled LocRes files, in parallel. Fills each entry's TextCounts to match OutCultures. */
+	static void GatherTextCounts(TArray<FYapDialogueDatabaseEntry>& Entries, TArray<FString>& OutCultures);
+};
@@ -36,12 +36,23 @@ public:
 private:
     void RegisterMenus();
 
+    void OnModifyCook(TArray<FName>& PackagesToCook, TArray<FName>& PackagesToNeverCook);
+
+    void OnProjectSettingsChanged(UObject* Settings, FPropertyChangedEvent& PropertyChangedEvent);
+
+    /** The dialogue database is a loose file in Content/Yap; adds that folder to the packaging settings' non-UFS staging directories. Returns true if it had to be added. */
+    static bool StageDialogueDatabase();
+
     static TSharedRef< SWidget > GenerateYapComboMenuContent( TSharedRef<FUICommandList> InCommandList );
     
 private:
     TSharedPtr<FUICommandList> PluginCommands;
 
     TSharedPtr<FUICommandList> YapComboActions;
+
+    FDelegateHandle ModifyCookHandle;
+
+    FDelegateHandle ProjectSettingsChangedHandle;
 };
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
@@ -15,6 +15,7 @@ class FYapInputTracker;
 struct FYapFragment;
 struct FSlateImageBrush;
 class IPropertyHandle;
+class FTransactionObjectEvent;
 
 #define LOCTEXT_NAMESPACE "YapEditor"
 
@@ -63,6 +64,9 @@ public:
 
 	void OnObjectPresave(UObject* Object, FObjectPreSaveContext Context);
 
+	/** Pushes edits of dialogue nodes made during a play session to their running instances. */
+	void OnObjectTransacted(UObject* Object, const FTransactionObjectEvent& Event);
+
 	void CleanupDialogueTags();
 	
 	FYapInputTracker* GetInputTracker();
@@ -0,0 +1,24 @@
+// Copyright Ghost Pepper Games, Inc. All Rights Reserved.
+// This work is MIT-licensed. Feel free to use it however you wish, within the confines of the MIT license.
+
+#pragma once
+
+enum class EYapMaturitySetting : uint8;
+
+// ================================================================================================
+
+/**
+ * Keeps the audio of fragment bits the cook strips (see FYapFragment::MakeCookedCopy) out of the cook. The cooked flow assets no longer
+ * reference that audio, but the cooker still finds it through the soft references it collects while loading them. Runs at cook start.
+ */
+struct YAPEDITOR_API FYapStrippedAudioFilter
+{
+	/** Adds every stripped audio package to PackagesToNeverCook and logs a summary line. Returns how many were added. */
+	static int32 ModifyCook(TArray<FName>& PackagesToNeverCook);
+
+	/** The maturity level every platform being cooked is locked to, or Unspecified if any platform keeps both or they differ. */
+	static EYapMaturitySetting GetCookedMaturity();
+
+	/** Audio packages which only stripped bits of dialogue fragments reference, when cooking for CookedMaturity. */
+	static TArray<FName> FindStrippedAudioPackages(EYapMaturitySetting CookedMaturity);
+};
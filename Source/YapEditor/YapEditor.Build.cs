@@ -27,6 +27,8 @@ public class YapEditor : ModuleRules
                 "PropertyEditor",
                 "AssetTools",
                 "DetailCustomizations",
+                "DeveloperToolSettings",
+                "TargetPlatform",
                 
                 "Flow",
                 "FlowEditor",